@@ -78,10 +78,7 @@ void BaseQLogger::addPacketFrameImpl(
       QuicStreamFrame* f = static_cast<QuicStreamFrame*>(frame);
       event->frames_.push_back(std::make_unique<StreamFrameLog>(
           f->stream_id, f->offset, f->data_length, f->fin));
-      stream_map_[f->stream_id]++;
-      
-      // Get first video frame end time
-      getVideoFrameEndTime(f);
+      addFrameStatsImpl(frame_type, frame);
       break;
     }
     // Ack Frame
@@ -101,7 +98,7 @@ void BaseQLogger::addPacketFrameImpl(
       QuicRstStreamFrame* f = static_cast<QuicRstStreamFrame*>(frame);
       event->frames_.push_back(std::make_unique<RstStreamFrameLog>(
           f->stream_id, f->error_code, f->byte_offset));
-      stream_map_[f->stream_id]++;
+      addFrameStatsImpl(frame_type, frame);
       break;
     }
     // Connection Close Frame
@@ -123,7 +120,7 @@ void BaseQLogger::addPacketFrameImpl(
       QuicWindowUpdateFrame* f = static_cast<QuicWindowUpdateFrame*>(frame);
       event->frames_.push_back(std::make_unique<WindowUpdateFrameLog>(
           f->stream_id, f->max_data));
-      stream_map_[f->stream_id]++;
+      addFrameStatsImpl(frame_type, frame);
       break;
     }
     // Blocked Frame
@@ -131,7 +128,7 @@ void BaseQLogger::addPacketFrameImpl(
       QuicBlockedFrame* f = static_cast<QuicBlockedFrame*>(frame);
       event->frames_.push_back(std::make_unique<BlockedFrameLog>(
           f->stream_id));
-      stream_map_[f->stream_id]++;          
+      addFrameStatsImpl(frame_type, frame);
       break;
     }
     // Stop Waiting Frame
@@ -201,7 +198,7 @@ void BaseQLogger::addPacketFrameImpl(
     case QuicFrameType::STOP_SENDING_FRAME: {
       QuicStopSendingFrame* f = static_cast<QuicStopSendingFrame*>(frame);
       event->frames_.push_back(std::make_unique<StopSendingFrameLog>(f->stream_id, f->error_code));
-      stream_map_[f->stream_id]++;    
+      addFrameStatsImpl(frame_type, frame);
       break;
     }
     // Message Frame
@@ -414,6 +411,33 @@ void* BaseQLogger::getFrameType(const QuicFrame& frame) {
     return fv;
 }
 
+void BaseQLogger::addFrameStatsImpl(QuicFrameType frame_type, void* frame) {
+  switch (frame_type) {
+    case QuicFrameType::STREAM_FRAME: {
+      QuicStreamFrame* f = static_cast<QuicStreamFrame*>(frame);
+      stream_map_[f->stream_id]++;
+
+      // Get first video frame end time
+      getVideoFrameEndTime(f);
+      break;
+    }
+    case QuicFrameType::RST_STREAM_FRAME:
+      stream_map_[static_cast<QuicRstStreamFrame*>(frame)->stream_id]++;
+      break;
+    case QuicFrameType::WINDOW_UPDATE_FRAME:
+      stream_map_[static_cast<QuicWindowUpdateFrame*>(frame)->stream_id]++;
+      break;
+    case QuicFrameType::BLOCKED_FRAME:
+      stream_map_[static_cast<QuicBlockedFrame*>(frame)->stream_id]++;
+      break;
+    case QuicFrameType::STOP_SENDING_FRAME:
+      stream_map_[static_cast<QuicStopSendingFrame*>(frame)->stream_id]++;
+      break;
+    default:
+      break;
+  }
+}
+
 void BaseQLogger::getVideoFrameEndTime(QuicStreamFrame* frame) { 
   auto it = sid_first_frame_msg_map_.find(frame->stream_id);
   if (it == sid_first_frame_msg_map_.end() || it->second.send_frame_end_time != std::chrono::microseconds::zero()) {
@@ -81,6 +81,10 @@ class BaseQLogger : public QLogger {
       const QuicFrames& nonretransmittable_frames,
       bool is_packet_recvd);
 
+  // Bookkeeping shared by every output format: per stream frame counts and
+  // the first video frame end time.
+  void addFrameStatsImpl(QuicFrameType frame_type, void* frame);
+
   void* getFrameType(const quic::QuicFrame& frame);
 
   void getVideoFrameEndTime(QuicStreamFrame* frame);
@@ -9,8 +9,22 @@ namespace quic {
 
 ConnectionDebugVisitor::ConnectionDebugVisitor(
   FileQLogger* qlogger, QuicConnection* connection)
+  : ConnectionDebugVisitor(qlogger, connection,
+                           qlogger == NULL ? QLogFilter() : qlogger->filter()) {
+}
+
+ConnectionDebugVisitor::ConnectionDebugVisitor(
+  FileQLogger* qlogger, QuicConnection* connection, QLogFilter filter)
   : qlogger_(qlogger),
-    connection_(connection) {
+    connection_(connection),
+    filter_(filter) {
+}
+
+bool ConnectionDebugVisitor::SamplePacket(uint32_t sample_interval, uint64_t* count) {
+  if (sample_interval == 0) {
+    return false;
+  }
+  return (*count)++ % sample_interval == 0;
 }
 
 void ConnectionDebugVisitor::OnPacketReceived(
@@ -21,6 +35,7 @@ void ConnectionDebugVisitor::OnPacketReceived(
     return;
   }
   packet_length_ = packet.length();
+  log_current_packet_ = SamplePacket(filter_.packet_received_sample_interval, &received_packet_count_);
 }
 
 
@@ -36,6 +51,10 @@ void ConnectionDebugVisitor::OnPacketSent(
   if (qlogger_ == NULL || connection_ == NULL) {
     return;
   }
+  if (!SamplePacket(filter_.packet_sent_sample_interval, &sent_packet_count_)) {
+    (qlogger_)->CountPacketSent(packet_length, retransmittable_frames, nonretransmittable_frames);
+    return;
+  }
   (qlogger_)->AddPacket(packet_number.ToUint64(), packet_length, transmission_type,
                          encryption_level, retransmittable_frames, nonretransmittable_frames, false);
 }
@@ -66,16 +85,51 @@ void ConnectionDebugVisitor::OnPacketHeader(
   } else {
     // packet has google quic frames
   }
+  if (!log_current_packet_) {
+    (qlogger_)->CountPacketReceived(packet_length_);
+    return;
+  }
+  if ((qlogger_)->binary_format()) {
+    (qlogger_)->StartBinaryPacketEvent(header, packet_length_);
+    binary_packet_open_ = true;
+    return;
+  }
   current_event_ = (qlogger_)->CreatePacketEvent(header, packet_length_, true);
 }
 
 void ConnectionDebugVisitor::OnPacketComplete() {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_.get() == NULL) {
+  if (qlogger_ == NULL || connection_ == NULL) {
+    return;
+  }
+  if (binary_packet_open_) {
+    binary_packet_open_ = false;
+    (qlogger_)->FinishBinaryPacketEvent();
+    return;
+  }
+  if (current_event_.get() == NULL) {
     return;
   }
   (qlogger_)->FinishCreatePacketEvent(std::move(current_event_));
 }
 
+void ConnectionDebugVisitor::AddFrame(QuicFrameType frame_type, void* frame) {
+  if (qlogger_ == NULL || connection_ == NULL) {
+    return;
+  }
+  if (!log_current_packet_) {
+    (qlogger_)->CountPacketFrame(frame_type, frame);
+    return;
+  }
+  if (binary_packet_open_) {
+    (qlogger_)->AddBinaryPacketFrame(frame_type, frame);
+    return;
+  }
+  if (current_event_ == NULL) {
+    return;
+  }
+  (qlogger_)->AddPacketFrame(current_event_.get(), frame_type, frame, true);
+}
+
 void ConnectionDebugVisitor::OnConnectionClosed(
   const QuicConnectionCloseFrame& frame,
   ConnectionCloseSource source) {
@@ -87,169 +141,111 @@ void ConnectionDebugVisitor::OnConnectionClosed(
 }
 
 void ConnectionDebugVisitor::OnStreamFrame(const QuicStreamFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::STREAM_FRAME, const_cast<QuicStreamFrame*>(&frame), true);
+  AddFrame(QuicFrameType::STREAM_FRAME, const_cast<QuicStreamFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnCryptoFrame(const QuicCryptoFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::CRYPTO_FRAME, const_cast<QuicCryptoFrame*>(&frame), true);
+  AddFrame(QuicFrameType::CRYPTO_FRAME, const_cast<QuicCryptoFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnStopWaitingFrame(const QuicStopWaitingFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::STOP_WAITING_FRAME, const_cast<QuicStopWaitingFrame*>(&frame), true);
+  AddFrame(QuicFrameType::STOP_WAITING_FRAME, const_cast<QuicStopWaitingFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnPaddingFrame(const QuicPaddingFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::PADDING_FRAME, const_cast<QuicPaddingFrame*>(&frame), true);
+  AddFrame(QuicFrameType::PADDING_FRAME, const_cast<QuicPaddingFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnPingFrame(const QuicPingFrame& frame, QuicTime::Delta) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::PING_FRAME, const_cast<QuicPingFrame*>(&frame), true);
+  AddFrame(QuicFrameType::PING_FRAME, const_cast<QuicPingFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnGoAwayFrame(const QuicGoAwayFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::GOAWAY_FRAME, const_cast<QuicGoAwayFrame*>(&frame), true);
+  AddFrame(QuicFrameType::GOAWAY_FRAME, const_cast<QuicGoAwayFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnRstStreamFrame(const QuicRstStreamFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::RST_STREAM_FRAME, const_cast<QuicRstStreamFrame*>(&frame), true);
+  AddFrame(QuicFrameType::RST_STREAM_FRAME, const_cast<QuicRstStreamFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnConnectionCloseFrame(
     const QuicConnectionCloseFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::CONNECTION_CLOSE_FRAME, const_cast<QuicConnectionCloseFrame*>(&frame), true);
+  AddFrame(QuicFrameType::CONNECTION_CLOSE_FRAME, const_cast<QuicConnectionCloseFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnWindowUpdateFrame(
     const QuicWindowUpdateFrame& frame, const QuicTime& receive_time) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::WINDOW_UPDATE_FRAME, const_cast<QuicWindowUpdateFrame*>(&frame), true);
+  AddFrame(QuicFrameType::WINDOW_UPDATE_FRAME, const_cast<QuicWindowUpdateFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnBlockedFrame(const QuicBlockedFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::BLOCKED_FRAME, const_cast<QuicBlockedFrame*>(&frame), true);
+  AddFrame(QuicFrameType::BLOCKED_FRAME, const_cast<QuicBlockedFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnHandshakeDoneFrame(const QuicHandshakeDoneFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::HANDSHAKE_DONE_FRAME, const_cast<QuicHandshakeDoneFrame*>(&frame), true);
+  AddFrame(QuicFrameType::HANDSHAKE_DONE_FRAME, const_cast<QuicHandshakeDoneFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnNewConnectionIdFrame(
        const QuicNewConnectionIdFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::NEW_CONNECTION_ID_FRAME, const_cast<QuicNewConnectionIdFrame*>(&frame), true);
+  AddFrame(QuicFrameType::NEW_CONNECTION_ID_FRAME, const_cast<QuicNewConnectionIdFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnMaxStreamsFrame(const QuicMaxStreamsFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::MAX_STREAMS_FRAME, const_cast<QuicMaxStreamsFrame*>(&frame), true);
+  AddFrame(QuicFrameType::MAX_STREAMS_FRAME, const_cast<QuicMaxStreamsFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnStreamsBlockedFrame(const QuicStreamsBlockedFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::STREAMS_BLOCKED_FRAME, const_cast<QuicStreamsBlockedFrame*>(&frame), true);
+  AddFrame(QuicFrameType::STREAMS_BLOCKED_FRAME, const_cast<QuicStreamsBlockedFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnPathResponseFrame(const QuicPathResponseFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::PATH_RESPONSE_FRAME, const_cast<QuicPathResponseFrame*>(&frame), true);
+  AddFrame(QuicFrameType::PATH_RESPONSE_FRAME, const_cast<QuicPathResponseFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnPathChallengeFrame(const QuicPathChallengeFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::PATH_CHALLENGE_FRAME, const_cast<QuicPathChallengeFrame*>(&frame), true);
+  AddFrame(QuicFrameType::PATH_CHALLENGE_FRAME, const_cast<QuicPathChallengeFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnStopSendingFrame(const QuicStopSendingFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::STOP_SENDING_FRAME, const_cast<QuicStopSendingFrame*>(&frame), true);
+  AddFrame(QuicFrameType::STOP_SENDING_FRAME, const_cast<QuicStopSendingFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnMessageFrame(const QuicMessageFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::MESSAGE_FRAME, const_cast<QuicMessageFrame*>(&frame), true);
+  AddFrame(QuicFrameType::MESSAGE_FRAME, const_cast<QuicMessageFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnNewTokenFrame(const QuicNewTokenFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::NEW_TOKEN_FRAME, const_cast<QuicNewTokenFrame*>(&frame), true);
+  AddFrame(QuicFrameType::NEW_TOKEN_FRAME, const_cast<QuicNewTokenFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnRetireConnectionIdFrame(const QuicRetireConnectionIdFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::RETIRE_CONNECTION_ID_FRAME, const_cast<QuicRetireConnectionIdFrame*>(&frame), true);
+  AddFrame(QuicFrameType::RETIRE_CONNECTION_ID_FRAME, const_cast<QuicRetireConnectionIdFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnAckFrequencyFrame(const QuicAckFrequencyFrame& frame) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
-    return;
-  }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::ACK_FREQUENCY_FRAME, const_cast<QuicAckFrequencyFrame*>(&frame), true);
+  AddFrame(QuicFrameType::ACK_FREQUENCY_FRAME, const_cast<QuicAckFrequencyFrame*>(&frame));
 }
 
 void ConnectionDebugVisitor::OnAckFrameStart(
     QuicTime::Delta ack_delay_time) {
-  if (qlogger_ == NULL || connection_ == NULL || current_event_ == NULL) {
+  if (qlogger_ == NULL || connection_ == NULL ||
+      (current_event_ == NULL && !binary_packet_open_)) {
     return;
   }
-  ack_frame_.reset();
-  ack_frame_ = std::make_unique<QuicAckFrame>();
+  // The frame is only read while it is logged, so it is reused across acks.
+  if (ack_frame_ == NULL) {
+    ack_frame_ = std::make_unique<QuicAckFrame>();
+  } else {
+    ack_frame_->packets.Clear();
+  }
   ack_frame_->ack_delay_time = ack_delay_time;
 }
 
 void ConnectionDebugVisitor::OnAckRange(
     QuicPacketNumber start, QuicPacketNumber end) {
   if (qlogger_ == NULL || connection_ == NULL ||
-      current_event_ == NULL || ack_frame_ == NULL) {
+      (current_event_ == NULL && !binary_packet_open_) || ack_frame_ == NULL) {
     return;
   }
   //*: Because the interval uses half-closed range `[)` and causes confusion,
@@ -259,11 +255,12 @@ void ConnectionDebugVisitor::OnAckRange(
 
 void ConnectionDebugVisitor::OnAckFrameEnd(
     QuicPacketNumber start) {
-  if (qlogger_ == NULL || connection_ == NULL ||
-      current_event_ == NULL || ack_frame_ == NULL) {
+  // Filtered packets leave the frame alone, and acks do not count towards the
+  // summary.
+  if (ack_frame_ == NULL || !log_current_packet_) {
     return;
   }
-  (qlogger_)->AddPacketFrame(current_event_.get(), QuicFrameType::ACK_FRAME, ack_frame_.get(), true);
+  AddFrame(QuicFrameType::ACK_FRAME, ack_frame_.get());
 }
 
 void ConnectionDebugVisitor::OnIncomingAck(
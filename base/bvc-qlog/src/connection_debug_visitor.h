@@ -11,8 +11,12 @@ namespace quic {
 
 class ConnectionDebugVisitor : public quic::QuicConnectionDebugVisitor {
  public:
+  // Applies the filter |qlogger| was configured with.
   ConnectionDebugVisitor(quic::FileQLogger* qlogger,
                               quic::QuicConnection* connection);
+  ConnectionDebugVisitor(quic::FileQLogger* qlogger,
+                              quic::QuicConnection* connection,
+                              quic::QLogFilter filter);
   ~ConnectionDebugVisitor() override {}
 
   virtual void OnPacketSent(quic::QuicPacketNumber /*packet_number*/,
@@ -222,11 +226,22 @@ class ConnectionDebugVisitor : public quic::QuicConnectionDebugVisitor {
                             quic::QuicTime /*detection_time*/) override;
 
  private:
+  // Adds |frame| to the packet currently being received.
+  void AddFrame(quic::QuicFrameType frame_type, void* frame);
+  // Returns whether the next packet counted by |count| is logged.
+  bool SamplePacket(uint32_t sample_interval, uint64_t* count);
+
   quic::FileQLogger*                        qlogger_;
   quic::QuicConnection*                     connection_;
   std::unique_ptr<quic::QLogPacketEvent>    current_event_;
   std::unique_ptr<quic::QuicAckFrame>       ack_frame_;
   uint64_t                                  packet_length_;
+  bool                                      binary_packet_open_ = false;
+  quic::QLogFilter                          filter_;
+  uint64_t                                  sent_packet_count_ = 0;
+  uint64_t                                  received_packet_count_ = 0;
+  // Sampling decision for the datagram being processed.
+  bool                                      log_current_packet_ = true;
  };
 } // namespace bvc
 
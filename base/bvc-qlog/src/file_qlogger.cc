@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -78,62 +79,71 @@ void FileQLogger::SetFirstFrame(QuicStreamId id, unsigned long long int size, qu
 #endif
 
 void FileQLogger::InitialSummary() {
-  Document initial_summary;
-  GenerateIndexMap();
-  initial_summary.SetObject();
-  Document::AllocatorType& summary_allocator = initial_summary.GetAllocator();
-
-  Value value;
-  uint32_t duration = (num_events_ == 0) ? 0 : end_time_.count()/1000;
-
-  value.SetInt(1);  
-  initial_summary.AddMember(Value(kQLogTraceCountField, summary_allocator).Move(), 
-                            value, 
-                            summary_allocator); 
-
-  value.SetInt64(duration);
-  initial_summary.AddMember("max_duration", value, summary_allocator);  
-
-  value.SetInt64(num_events_);
-  initial_summary.AddMember("total_event_count", value, summary_allocator);  
-
-  value.SetObject();
-  AddSummary(value, summary_allocator);
-  initial_summary.AddMember("report_summary", value, summary_allocator);
-  AddMapInSummary(value, initial_summary, summary_allocator);
-
-  Document copy_summary;
-  copy_summary.CopyFrom(initial_summary, copy_summary.GetAllocator());
-  pre_summary_ = std::make_shared<Document>(std::move(initial_summary));
-  last_summary_ = std::make_shared<Document>(std::move(copy_summary));
+  summary_snapshot_ = std::make_shared<QLogSummarySnapshot>(CollectSummaryCounters(), CollectSummaryMaps());
+  summary_updates_ = 0;
+  published_stream_count_ = stream_map_.size();
+#ifndef QLOG_FOR_QBONE
+  published_uri_count_ = uri_map_.size();
+#endif
 }
 
 void FileQLogger::UpdateSummary() {
-  lock_->WriterLock();
-  GenerateIndexMap();
-  uint32_t duration = (num_events_ == 0) ? 0 : end_time_.count()/1000;
-  Document tmp_document;
-  tmp_document.SetObject();
-  Document::AllocatorType& tmp_allocator = tmp_document.GetAllocator();
-
-  Value value;
-
-  value.SetInt(1);  
-  tmp_document.AddMember(Value(kQLogTraceCountField, tmp_allocator).Move(), value, tmp_allocator);
-  
-  value.SetInt64(duration);
-  tmp_document.AddMember("max_duration", value, tmp_allocator);  
+  if (summary_snapshot_ == nullptr) {
+    return;
+  }
+  summary_snapshot_->Publish(CollectSummaryCounters());
+  if (++summary_updates_ % kQLogSummaryMapRefreshInterval == 0 || SummaryMapsChanged()) {
+    summary_snapshot_->PublishMaps(CollectSummaryMaps());
+    published_stream_count_ = stream_map_.size();
+#ifndef QLOG_FOR_QBONE
+    published_uri_count_ = uri_map_.size();
+#endif
+  }
+}
 
-  value.SetInt64(num_events_);
-  tmp_document.AddMember("total_event_count", value, tmp_allocator);
+bool FileQLogger::SummaryMapsChanged() const {
+#ifndef QLOG_FOR_QBONE
+  if (uri_map_.size() != published_uri_count_) {
+    return true;
+  }
+#endif
+  return stream_map_.size() != published_stream_count_;
+}
 
-  value.SetObject();
-  AddSummary(value, tmp_allocator);
-  tmp_document.AddMember("report_summary", value, tmp_allocator);
-  AddMapInSummary(value, tmp_document, tmp_allocator);
+QLogSummaryCounters FileQLogger::CollectSummaryCounters() const {
+  QLogSummaryCounters counters;
+  counters.num_events = num_events_;
+  counters.end_time_us = end_time_.count();
+  counters.total_bytes_sent = report_summary_.total_bytes_sent;
+  counters.total_packets_sent = report_summary_.total_packets_sent;
+  counters.total_bytes_recvd = report_summary_.total_bytes_recvd;
+  counters.total_packets_recvd = report_summary_.total_packets_recvd;
+  counters.total_packets_lost = report_summary_.total_packets_lost;
+  counters.dropped_events = dropped_events();
+  counters.total_startup_duration = report_summary_.total_startup_duration;
+  counters.total_drain_duration = report_summary_.total_drain_duration;
+  counters.total_probebw_duration = report_summary_.total_probebw_Duration;
+  counters.total_probertt_duration = report_summary_.total_probertt_duration;
+  counters.total_not_recovery_duration = report_summary_.total_not_recovery_duration;
+  counters.total_growth_duration = report_summary_.total_growth_duration;
+  counters.total_conservation_duration = report_summary_.total_conservation_duration;
+  counters.smoothed_min_rtt = smoothed_min_rtt_;
+  counters.smoothed_max_bandwidth = smoothed_max_bandwidth_;
+  counters.sum_of_mean_deviation = sum_of_mean_deviation_;
+  counters.num_of_congestion_message = num_of_congestion_message_;
+  counters.quic_version = report_summary_.quic_version;
+  counters.congestion_type = congestion_type_;
+  counters.used_zero_rtt = report_summary_.used_zero_rtt;
+  return counters;
+}
 
-  *last_summary_ = std::move(tmp_document);
-  lock_->WriterUnlock(); 
+std::shared_ptr<const QLogSummaryMaps> FileQLogger::CollectSummaryMaps() const {
+  auto maps = std::make_shared<QLogSummaryMaps>();
+  maps->stream_map.assign(stream_map_.begin(), stream_map_.end());
+#ifndef QLOG_FOR_QBONE
+  maps->uri_map = uri_map_;
+#endif
+  return maps;
 }
 
 void FileQLogger::SummaryReportOnAlarm() {
@@ -198,6 +208,9 @@ void FileQLogger::CreateBaseJson() {
 }
 
 void FileQLogger::SwitchSpdlogObject(const std::string& tmp_path, const std::string& final_path, uint64_t switch_qlog_index) {
+  if (binary_format()) {
+    DrainBinaryWriter(true);
+  }
   path_ = tmp_path;
   SetFileObject();
 
@@ -212,7 +225,7 @@ void FileQLogger::SwitchSpdlogObject(const std::string& tmp_path, const std::str
 }
 
 void FileQLogger::SetFileObject() {
-  absl::StrAppend(&path_, "/", dcid_->ToString(), ".qlog");
+  absl::StrAppend(&path_, "/", dcid_->ToString(), FileExtension());
   if(!spdlog::details::os::path_exists(path_)) {
     spdlog::details::os::create_dir(spdlog::details::os::dir_name(path_));
   }
@@ -224,12 +237,166 @@ void FileQLogger::SetFileObject() {
 }
 
 void FileQLogger::SetSpdlogObject() {
-  auto file_sink = std::make_shared<sinks::sequence_file_sink_st>(path_, final_path_, max_size_, max_file_, metadata_head_, metadata_head_extra_, last_summary_, pre_summary_, lock_);
+  auto file_sink = std::make_shared<sinks::sequence_file_sink_st>(path_, final_path_, max_size_, max_file_, metadata_head_, metadata_head_extra_, summary_snapshot_);
   auto formatter = std::make_unique<pattern_formatter>("%v", pattern_time_type::local, std::string(""));
   logger_ = std::make_shared<async_logger>(dcid_->ToString(), std::move(file_sink), tp_, async_overflow_policy::block);  
   logger_->set_formatter(std::move(formatter));
 }
 
+void FileQLogger::SetBinarySpdlogObject() {
+  // Every split file starts with the file and trace headers.
+  char host[100] = {0};
+  gethostname(host, sizeof(host));
+  std::string dcidStr = (!dcid_ || dcid_->IsEmpty()) ? "" : dcid_->ToString();
+  std::string scidStr = (!scid_ || scid_->IsEmpty()) ? "" : scid_->ToString();
+  binary_writer_->WriteFileHeader();
+  binary_writer_->WriteTraceHeader(system_startTime_, vantagePoint_, dcidStr, scidStr,
+                                   protocolType_, self_address_, host);
+  std::string file_head;
+  binary_writer_->Drain([&file_head](const char* data, size_t length) {
+    file_head.append(data, length);
+  });
+
+  auto file_sink = std::make_shared<sinks::binary_file_sink_st>(path_, final_path_, max_size_, max_file_, std::move(file_head));
+  auto formatter = std::make_unique<pattern_formatter>("%v", pattern_time_type::local, std::string(""));
+  logger_ = std::make_shared<async_logger>(dcid_->ToString(), std::move(file_sink), tp_, async_overflow_policy::block);
+  logger_->set_formatter(std::move(formatter));
+  // DROP_NEWEST and SAMPLE leave the writer's default of dropping the new
+  // record when the ring buffer is full.
+  if (overflow_policy_ == QLogOverflowPolicy::BLOCK) {
+    binary_writer_->set_overflow_sink([this](const char* data, size_t length) {
+      logger_->log(level::info, string_view_t(data, length));
+    });
+  } else {
+    binary_writer_->set_discard_oldest_on_overflow(
+        overflow_policy_ == QLogOverflowPolicy::DROP_OLDEST);
+  }
+}
+
+void FileQLogger::DrainBinaryWriter(bool force) {
+  if (logger_ == nullptr) {
+    return;
+  }
+  const uint64_t records_dropped = binary_writer_->records_dropped();
+  if (records_dropped != reported_records_dropped_) {
+    QLogQueueGauge::RecordDropped(records_dropped - reported_records_dropped_);
+    reported_records_dropped_ = records_dropped;
+  }
+  // While the queue is full the records stay in the ring buffer, which drops
+  // the newest or the oldest ones once it is full itself.
+  if (!force && (!binary_writer_->NeedsDrain() || !QueueHasRoom())) {
+    return;
+  }
+  binary_writer_->Drain([this](const char* data, size_t length) {
+    logger_->log(level::info, string_view_t(data, length));
+  });
+}
+
+void FileQLogger::SetOverflowPolicy(
+    QLogOverflowPolicy policy,
+    std::size_t queue_capacity,
+    uint32_t sample_interval) {
+  overflow_policy_ = policy;
+  queue_high_watermark_ = static_cast<std::size_t>(queue_capacity * kQLogQueueHighWatermark);
+  sample_interval_ = std::max<uint32_t>(sample_interval, 1);
+}
+
+uint64_t FileQLogger::dropped_events() const {
+  return dropped_events_ + (binary_format() ? binary_writer_->records_dropped() : 0);
+}
+
+bool FileQLogger::QueueHasRoom() {
+  if (tp_ == nullptr) {
+    return true;
+  }
+  if (overflow_policy_ == QLogOverflowPolicy::BLOCK) {
+    if (post_counter_++ % kQLogQueueGaugeInterval == 0) {
+      QLogQueueGauge::RecordDepth(tp_->queue_size());
+    }
+    return true;
+  }
+  last_queue_depth_ = tp_->queue_size();
+  QLogQueueGauge::RecordDepth(last_queue_depth_);
+  return last_queue_depth_ < queue_high_watermark_;
+}
+
+bool FileQLogger::SampleEvent() {
+  if (overflow_policy_ != QLogOverflowPolicy::SAMPLE ||
+      last_queue_depth_ < queue_high_watermark_ / 2) {
+    return true;
+  }
+  // Nothing is posted while events are sampled out, so refresh the depth on
+  // the sampled events themselves.
+  if (sample_counter_++ % sample_interval_ != 0) {
+    return false;
+  }
+  return QueueHasRoom();
+}
+
+bool FileQLogger::AdmitBinaryEvent() {
+  ++num_events_;
+  if (!fileObj_) {
+    return false;
+  }
+  if (!SampleEvent()) {
+    ++dropped_events_;
+    QLogQueueGauge::RecordDropped(1);
+    return false;
+  }
+  return true;
+}
+
+void FileQLogger::PostEvents() {
+  if (QueueHasRoom()) {
+    UpdateSummary();
+    logger_->info(logstring_);
+    event_posted_ = event_posted_ || !pending_event_starts_.empty();
+    logstring_.clear();
+    pending_event_starts_.clear();
+    return;
+  }
+  if (overflow_policy_ == QLogOverflowPolicy::DROP_OLDEST) {
+    // Hold the events back and retry with the next ones.
+    DiscardOldestEvents();
+    return;
+  }
+  dropped_events_ += pending_event_starts_.size();
+  QLogQueueGauge::RecordDropped(pending_event_starts_.size());
+  logstring_.clear();
+  pending_event_starts_.clear();
+}
+
+void FileQLogger::DiscardOldestEvents() {
+  // Always keep the newest event, however large.
+  size_t discarded = 0;
+  while (discarded + 1 < pending_event_starts_.size() &&
+         logstring_.size() - pending_event_starts_[discarded] >
+             kQLogMaxPendingBytes) {
+    ++discarded;
+  }
+  if (discarded == 0) {
+    return;
+  }
+  size_t cut = pending_event_starts_[discarded];
+  // Every event but the first posted starts with its separator; keep the
+  // output valid if that one goes.
+  if (!event_posted_ && logstring_[cut] == ',') {
+    ++cut;
+  }
+  logstring_.erase(0, cut);
+  pending_event_starts_.erase(pending_event_starts_.begin(),
+                              pending_event_starts_.begin() + discarded);
+  for (size_t& start : pending_event_starts_) {
+    start = start >= cut ? start - cut : 0;
+  }
+  dropped_events_ += discarded;
+  QLogQueueGauge::RecordDropped(discarded);
+}
+
+const char* FileQLogger::FileExtension() const {
+  return binary_format() ? kQLogBinaryFileExtension : kQLogJsonFileExtension;
+}
+
 void FileQLogger::SetupStream() {
   // create the output file
   if (dcid_->IsEmpty()) {
@@ -238,13 +405,12 @@ void FileQLogger::SetupStream() {
   }
   endLine_ = pretty_json_ ? "\n" : "";
 
-  absl::StrAppend(&final_path_, "/", dcid_->ToString(), "_", switch_qlog_index_, "_", switch_spdlog_index_,".qlog");  
-  if (lock_ == nullptr) {
-    lock_ = std::make_shared<quic::QuicMutex>();
-  }
+  absl::StrAppend(&final_path_, "/", dcid_->ToString(), "_", switch_qlog_index_, "_", switch_spdlog_index_, FileExtension());
   InitialSummary();
 
-  if (fileObj_) {
+  if (fileObj_ && binary_format()) {
+    SetBinarySpdlogObject();
+  } else if (fileObj_) {
     CreateBaseJson();    
     SetSpdlogObject();
     logger_->info(metadata_head_);
@@ -281,10 +447,18 @@ void FileQLogger::FinishStream() {
   Writer<StringBuffer> writer(buffer);
   summaryJson.Accept(writer);
   std::string summary = buffer.GetString();
+
+  if (fileObj_ && binary_format()) {
+    binary_writer_->WriteSummary(summary);
+    DrainBinaryWriter(true);
+    logger_->flush();
+    fileObj_.close();
+    return;
+  }
   
   if (fileObj_) {
     // logger remaining event
-    if(log_event_buffer_ != 0 && !logstring_.empty()) {
+    if(!logstring_.empty()) {
       logger_->info(logstring_);
     }
     // finish copying the line that was stopped on
@@ -325,11 +499,22 @@ void FileQLogger::FinishStream() {
 void FileQLogger::HandleEvent(std::unique_ptr<QLogEvent> event) {
   if (streaming_) {
     ++num_events_;
+    if (!SampleEvent()) {
+      ++dropped_events_;
+      QLogQueueGauge::RecordDropped(1);
+      return;
+    }
     Document eventjson = event->ToJson();
 
     buffer_.Clear();
     writer_.Reset(buffer_);
     eventjson.Accept(writer_);
+    if (fileObj_ && binary_format()) {
+      binary_writer_->WriteJsonEvent(event->ref_time_,
+          absl::string_view(buffer_.GetString(), buffer_.GetSize()));
+      DrainBinaryWriter(false);
+      return;
+    }
     std::string event_json = buffer_.GetString();
     if (fileObj_) {
       std::stringstream eventBuffer;
@@ -340,7 +525,11 @@ void FileQLogger::HandleEvent(std::unique_ptr<QLogEvent> event) {
         eventBuffer << event_json;
       }
 
-      if (num_events_ > 1) {
+      // num_events_ also counts the events dropped before this one.
+      const bool separator =
+          event_posted_ || !pending_event_starts_.empty();
+      pending_event_starts_.push_back(logstring_.size());
+      if (separator) {
         absl::StrAppend(&logstring_, ",");
       }
       // add padding to every line in the event
@@ -349,8 +538,7 @@ void FileQLogger::HandleEvent(std::unique_ptr<QLogEvent> event) {
       }
 
       if(log_event_buffer_ == 0 || num_events_ % log_event_buffer_ == 0) {
-        logger_->info(logstring_);
-        logstring_.clear();
+        PostEvents();
       }
     }
   } else {
@@ -391,6 +579,18 @@ void FileQLogger::AddPacket(
   auto ref_time = std::chrono::duration_cast<std::chrono::microseconds>(
       std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
   end_time_ = ref_time;
+  if (binary_format()) {
+    report_summary_.total_packets_sent++;
+    report_summary_.total_bytes_sent += packet_length;
+    if (AdmitBinaryEvent()) {
+      binary_writer_->StartPacketSent(ref_time, packet_number, packet_length, transmission_type, encryption_level);
+    }
+    AddBinaryFrames(retransmittable_frames);
+    AddBinaryFrames(nonretransmittable_frames);
+    binary_writer_->FinishPacket();
+    DrainBinaryWriter(false);
+    return;
+  }
   std::string packet_type;
   if (encryption_level >= ENCRYPTION_FORWARD_SECURE) {
     packet_type = std::string(kShortHeaderPacketType);
@@ -447,6 +647,72 @@ void FileQLogger::AddPacket(
   return;
 }
 
+void FileQLogger::CountPacketSent(
+    uint64_t packet_length,
+    const QuicFrames& retransmittable_frames,
+    const QuicFrames& nonretransmittable_frames) {
+  end_time_ = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
+  report_summary_.total_packets_sent++;
+  report_summary_.total_bytes_sent += packet_length;
+  for (const QuicFrame& frame : retransmittable_frames) {
+    void* fv = getFrameType(frame);
+    if (fv != NULL) {
+      addFrameStatsImpl(frame.type, fv);
+    }
+  }
+  for (const QuicFrame& frame : nonretransmittable_frames) {
+    void* fv = getFrameType(frame);
+    if (fv != NULL) {
+      addFrameStatsImpl(frame.type, fv);
+    }
+  }
+}
+
+void FileQLogger::CountPacketReceived(uint64_t packet_size) {
+  end_time_ = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
+  report_summary_.total_packets_recvd++;
+  report_summary_.total_bytes_recvd += packet_size;
+}
+
+void FileQLogger::CountPacketFrame(QuicFrameType frame_type, void* frame) {
+  addFrameStatsImpl(frame_type, frame);
+}
+
+void FileQLogger::AddBinaryFrames(const QuicFrames& frames) {
+  for (const QuicFrame& frame : frames) {
+    void* fv = getFrameType(frame);
+    if (fv != NULL) {
+      addFrameStatsImpl(frame.type, fv);
+      binary_writer_->AddPacketFrame(frame.type, fv);
+    }
+  }
+}
+
+void FileQLogger::StartBinaryPacketEvent(
+    const QuicPacketHeader& packet_header,
+    uint64_t packet_size) {
+  auto ref_time = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
+  end_time_ = ref_time;
+  report_summary_.total_packets_recvd++;
+  report_summary_.total_bytes_recvd += packet_size;
+  if (AdmitBinaryEvent()) {
+    binary_writer_->StartPacketReceived(ref_time, packet_header, packet_size);
+  }
+}
+
+void FileQLogger::AddBinaryPacketFrame(QuicFrameType frame_type, void* frame) {
+  addFrameStatsImpl(frame_type, frame);
+  binary_writer_->AddPacketFrame(frame_type, frame);
+}
+
+void FileQLogger::FinishBinaryPacketEvent() {
+  binary_writer_->FinishPacket();
+  DrainBinaryWriter(false);
+}
+
 std::unique_ptr<QLogPacketEvent> FileQLogger::CreatePacketEvent(
     const QuicPacketHeader& packet_header,
     uint64_t packet_size,
@@ -664,6 +930,13 @@ void FileQLogger::AddBBRCongestionMetricUpdate(
     current_state_ = bbr_state->recovery_state;
   }
   end_time_ = ref_time;
+  if (binary_format()) {
+    if (AdmitBinaryEvent()) {
+      binary_writer_->WriteBBRCongestionMetricUpdate(ref_time, bytes_inflight, current_cwnd, congestion_event, *bbr_state);
+      DrainBinaryWriter(false);
+    }
+    return;
+  }
   HandleEvent(std::make_unique<quic::QLogBBRCongestionMetricUpdateEvent>(
       bytes_inflight,
       current_cwnd,
@@ -707,6 +980,13 @@ void FileQLogger::AddCubicCongestionMetricUpdate(
   }
   sum_of_mean_deviation_ += std::abs(cubic_state->mean_deviation.ToMicroseconds() - smoothed_mean_deviation_);
   end_time_ = ref_time;
+  if (binary_format()) {
+    if (AdmitBinaryEvent()) {
+      binary_writer_->WriteCubicCongestionMetricUpdate(ref_time, bytes_inflight, current_cwnd, congestion_event, *cubic_state);
+      DrainBinaryWriter(false);
+    }
+    return;
+  }
   HandleEvent(std::make_unique<quic::QLogCubicCongestionMetricUpdateEvent>(
       bytes_inflight,
       current_cwnd,
@@ -780,6 +1060,13 @@ void FileQLogger::AddBBR2CongestionMetricUpdate(
     current_bbr2mode_ = bbr_state->mode;
   }
   end_time_ = ref_time;
+  if (binary_format()) {
+    if (AdmitBinaryEvent()) {
+      binary_writer_->WriteBBR2CongestionMetricUpdate(ref_time, bytes_inflight, current_cwnd, congestion_event, *bbr_state);
+      DrainBinaryWriter(false);
+    }
+    return;
+  }
   HandleEvent(std::make_unique<quic::QLogBBR2CongestionMetricUpdateEvent>(
       bytes_inflight,
       current_cwnd,
@@ -887,6 +1174,13 @@ void FileQLogger::AddPacketLost(
       std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
   end_time_ = ref_time;
   report_summary_.total_packets_lost++;
+  if (binary_format()) {
+    if (AdmitBinaryEvent()) {
+      binary_writer_->WritePacketLost(ref_time, lost_packet_num, level, type);
+      DrainBinaryWriter(false);
+    }
+    return;
+  }
   HandleEvent(std::make_unique<quic::QLogPacketLostEvent>(
       lost_packet_num, level, type, ref_time));
 }
@@ -918,6 +1212,13 @@ void FileQLogger::AddMetricUpdate(
   auto ref_time = std::chrono::duration_cast<std::chrono::microseconds>(
 	std::chrono::steady_clock::now().time_since_epoch()) - steady_startTime_;
   end_time_ = ref_time;
+  if (binary_format()) {
+    if (AdmitBinaryEvent()) {
+      binary_writer_->WriteMetricUpdate(ref_time, latest_rtt, mrtt, srtt, ack_delay);
+      DrainBinaryWriter(false);
+    }
+    return;
+  }
   HandleEvent(std::make_unique<quic::QLogMetricUpdateEvent>(
       latest_rtt, mrtt, srtt, ack_delay, ref_time));
 }
@@ -1007,28 +1308,7 @@ void FileQLogger::ToJsonBase(Document& j, Document& traces) {
 }
 
 void FileQLogger::AddSummary(Value& value, Document::AllocatorType& summary_allocator) {
-  value.AddMember("total_bytes_sent", report_summary_.total_bytes_sent, summary_allocator);
-  value.AddMember("total_packets_sent", report_summary_.total_packets_sent, summary_allocator);
-  value.AddMember("total_bytes_recvd", report_summary_.total_bytes_recvd, summary_allocator);
-  value.AddMember("total_packets_recvd", report_summary_.total_packets_recvd, summary_allocator);
-  value.AddMember("total_packets_lost", report_summary_.total_packets_lost, summary_allocator);
-  value.AddMember("quic_transport_version", Value(QuicVersionToString(report_summary_.quic_version).c_str(), summary_allocator).Move(), summary_allocator);
-  value.AddMember("connection_duration", ((int)(index_map_.at("duration") * 100 + 0.5)) / 100.0, summary_allocator);  
-#ifndef QLOG_FOR_QBONE
-  value.AddMember("used_zero_rtt", report_summary_.used_zero_rtt, summary_allocator);
-  value.AddMember("smoothed_min_rtt", (int)(smoothed_min_rtt_ / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("smoothed_max_bandwidth", (int)((smoothed_max_bandwidth_ / 8) * 100 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("average_difference", ((int)(index_map_.at("average_difference") * 100 + 0.5)) / 100.0, summary_allocator);
-  if (congestion_type_ == CongestionControlType::kBBR) {
-    AddBBRSummary(value, summary_allocator);
-  } else if (congestion_type_==CongestionControlType::kBBRv2) {
-    AddBBR2Summary(value, summary_allocator);
-  } else if (congestion_type_==CongestionControlType::kCubicBytes) {
-    AddCubicSummary(value, summary_allocator);
-  } else {
-    // TODO : Other CC Algorithm
-  }
-#endif
+  QLogSummarySnapshot::AddReportSummary(CollectSummaryCounters(), value, summary_allocator);
 }
 
 void FileQLogger::AddMapInSummary(Value& value, Value& tmp_document, Document::AllocatorType& tmp_allocator) {
@@ -1100,39 +1380,8 @@ void FileQLogger::GenerateQboneReport(Document& summary) {
   }
 }
 #else
-void FileQLogger::AddBBRSummary(Value& value, Document::AllocatorType& summary_allocator) {
-  value.AddMember("total_startup_duration", (int)(report_summary_.total_startup_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_drain_duration", (int)(report_summary_.total_drain_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_probebw_Duration", (int)(report_summary_.total_probebw_Duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_probertt_duration", (int)(report_summary_.total_probertt_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_not_recovery_duration", (int)(report_summary_.total_not_recovery_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_growth_duration", (int)(report_summary_.total_growth_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_conservation_duration", (int)(report_summary_.total_conservation_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("congestion_type", "BBR", summary_allocator);
-  value.AddMember("startup_duration_ratio", ((int)(index_map_.at("startup_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("drain_duration_ratio", ((int)(index_map_.at("drain_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("probebw_duration_ratio", ((int)(index_map_.at("probebw_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("probertt_duration_ratio", ((int)(index_map_.at("probertt_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("not_recovery_duration_ratio", ((int)(index_map_.at("not_recovery_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("growth_duration_ratio", ((int)(index_map_.at("growth_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("conservation_duration_ratio", ((int)(index_map_.at("conservation_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-}
-
-void FileQLogger::AddBBR2Summary(Value& value, Document::AllocatorType& summary_allocator) {
-  value.AddMember("total_startup_duration", (int)(report_summary_.total_startup_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_drain_duration", (int)(report_summary_.total_drain_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_probebw_Duration", (int)(report_summary_.total_probebw_Duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("total_probertt_duration", (int)(report_summary_.total_probertt_duration / 10 + 0.5) / 100.0, summary_allocator);
-  value.AddMember("congestion_type", "BBRv2", summary_allocator);
-  value.AddMember("startup_duration_ratio", ((int)(index_map_.at("startup_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("drain_duration_ratio", ((int)(index_map_.at("drain_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("probebw_duration_ratio", ((int)(index_map_.at("probebw_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-  value.AddMember("probertt_duration_ratio", ((int)(index_map_.at("probertt_duration_ratio") * 10000 + 0.5)) / 10000.0, summary_allocator);
-}
-
-void FileQLogger::AddCubicSummary(Value& value, Document::AllocatorType& summary_allocator) {
-  value.AddMember("congestion_type", "Cubic", summary_allocator);
-}
+
+
 
 void FileQLogger::WriteLogCallbackByDuration(size_t report_id_for_7000, size_t report_id_for_8000) {
   std::string dcidStr = (!dcid_ || dcid_->IsEmpty()) ? "" : dcid_->ToString();
@@ -15,8 +15,12 @@
 #include <regex>
 
 #include "base/bvc-qlog/src/base_qlogger.h"
+#include "base/bvc-qlog/src/qlog_binary_writer.h"
+#include "base/bvc-qlog/src/qlog_queue_gauge.h"
+#include "base/bvc-qlog/src/qlog_summary_snapshot.h"
 #include "base/bvc-qlog/src/qlogger_constants.h"
 #include "base/bvc-qlog/src/qlogger_types.h"
+#include "base/sinks/binary_file_sink.h"
 #include "base/sinks/sequence_file_sink.h"
 
 #include "gquiche/quic/core/quic_stream.h"
@@ -33,6 +37,10 @@ using namespace rapidjson;
 
 namespace quic {
 
+namespace test {
+class FileQLoggerTest;
+}
+
 class FileQLogger : public BaseQLogger {
  public:
   using QLogger::TransportSummaryArgs;
@@ -49,7 +57,10 @@ class FileQLogger : public BaseQLogger {
       uint64_t switch_qlog_index = 0,
       std::string protocol_type_in = kHTTP3ProtocolType,
       bool pretty_json = false,
-      bool streaming = true)
+      bool streaming = true,
+      QLogOutputFormat output_format = QLogOutputFormat::JSON,
+      const QLogOverflowConfig& overflow_config = QLogOverflowConfig(),
+      const QLogFilter& filter = QLogFilter())
       : BaseQLogger(vantage_point_in, std::move(protocol_type_in)),
         path_(std::move(path)),
         tp_(tp),
@@ -61,8 +72,16 @@ class FileQLogger : public BaseQLogger {
         switch_qlog_index_(switch_qlog_index),
         switch_spdlog_index_(0),
         aggregate_(true),	
+        filter_(filter),
         pretty_json_(pretty_json),
-        streaming_(streaming) {}
+        streaming_(streaming) {
+    // Binary records are only written in streaming mode.
+    if (streaming_ && output_format == QLogOutputFormat::BINARY) {
+      binary_writer_ = std::make_unique<QLogBinaryWriter>();
+    }
+    SetOverflowPolicy(overflow_config.policy, overflow_config.queue_capacity,
+                      overflow_config.sample_interval);
+  }
 
   ~FileQLogger() override {
     if (qlog_frames_processed_ != nullptr) {
@@ -95,6 +114,36 @@ class FileQLogger : public BaseQLogger {
       uint64_t packet_size,
       bool is_packet_recvd);
   void FinishCreatePacketEvent(std::unique_ptr<QLogPacketEvent> event);
+
+  // Summary-only accounting for packets ConnectionDebugVisitor filtered out.
+  void CountPacketSent(
+      uint64_t packet_length,
+      const QuicFrames& retransmittable_frames,
+      const QuicFrames& nonretransmittable_frames);
+  void CountPacketReceived(uint64_t packet_size);
+  void CountPacketFrame(QuicFrameType frame_type, void* frame);
+
+  // In binary mode received packets are encoded frame by frame as they are
+  // parsed, without building a QLogPacketEvent.
+  bool binary_format() const { return binary_writer_ != nullptr; }
+
+  // The filter ConnectionDebugVisitors of this connection apply by default.
+  const QLogFilter& filter() const { return filter_; }
+
+  // Sets how this connection reacts when the shared thread pool |tp| falls
+  // behind, overriding the constructor's |overflow_config|. |queue_capacity|
+  // is the queue size the pool was created with. Must be called before the
+  // dcid is set.
+  void SetOverflowPolicy(
+      QLogOverflowPolicy policy,
+      std::size_t queue_capacity,
+      uint32_t sample_interval = kQLogDefaultSampleInterval);
+  uint64_t dropped_events() const;
+  void StartBinaryPacketEvent(
+      const QuicPacketHeader& packet_header,
+      uint64_t packet_size);
+  void AddBinaryPacketFrame(QuicFrameType frame_type, void* frame);
+  void FinishBinaryPacketEvent();
   // serialized packet to be sent
   void AddPacket(
       uint64_t packet_number,
@@ -197,6 +246,8 @@ class FileQLogger : public BaseQLogger {
   void AddMapInSummary(Value& value, Value& tmp_document, Document::AllocatorType& tmp_allocator);
 
   void InitialSummary();
+  // Publishes the current summary to the file sink. Cheap enough to call for
+  // every posted batch of events; never blocks on the sink.
   void UpdateSummary();
   void SummaryReportOnAlarm();
   void SwitchSpdlogObject(const std::string& tmp_path, const std::string& final_path, uint64_t switch_qlog_index);
@@ -210,9 +261,6 @@ class FileQLogger : public BaseQLogger {
 #else
   void GetUriOfStream(std::string& method, QuicStreamId id, std::string& request_uri, std::string& range, std::string& trid);
   void SetFirstFrame(QuicStreamId id, unsigned long long int size, quic::QuicStreamOffset stream_offset, std::string trid, std::string protocol, uint64_t request_index, std::chrono::microseconds receive_request_time);
-  void AddBBRSummary(Value& value, Document::AllocatorType& summary_allocator);
-  void AddBBR2Summary(Value& value, Document::AllocatorType& summary_allocator);
-  void AddCubicSummary(Value& value, Document::AllocatorType& summary_allocator);  
   void WriteLogCallbackByDuration(size_t report_id_for_7000, size_t report_id_for_8000);
   void GetCallbackIdByDuration(size_t& report_id_for_7000, size_t& report_id_for_8000);  
   void GenerateBvcReport(Document& summary);
@@ -230,13 +278,27 @@ class FileQLogger : public BaseQLogger {
 #endif
 
  private:
+  friend class test::FileQLoggerTest;
+
   void GenerateFirstFrameReport();
   void CreateBaseJson();
   void SetFileObject();
   void SetSpdlogObject();
+  void SetBinarySpdlogObject();
+  void DrainBinaryWriter(bool force);
+  void AddBinaryFrames(const QuicFrames& frames);
+  const char* FileExtension() const;
   void SetupStream();
   void FinishStream();
   void HandleEvent(std::unique_ptr<QLogEvent> event);
+  void PostEvents();
+  void DiscardOldestEvents();
+  bool QueueHasRoom();
+  bool SampleEvent();
+  bool AdmitBinaryEvent();
+  QLogSummaryCounters CollectSummaryCounters() const;
+  std::shared_ptr<const QLogSummaryMaps> CollectSummaryMaps() const;
+  bool SummaryMapsChanged() const;
 
   std::string path_;
   std::string basePadding_ = "  ";
@@ -267,9 +329,10 @@ class FileQLogger : public BaseQLogger {
   uint64_t init_cwnd_;
   uint64_t switch_qlog_index_;
   uint64_t switch_spdlog_index_;  
-  std::shared_ptr<Document> pre_summary_;
-  std::shared_ptr<Document> last_summary_;
-  std::shared_ptr<quic::QuicMutex> lock_;
+  std::shared_ptr<QLogSummarySnapshot> summary_snapshot_;
+  uint64_t summary_updates_ = 0;
+  size_t published_stream_count_ = 0;
+  size_t published_uri_count_ = 0;
 
 #ifndef QLOG_FOR_QBONE
   mutable std::vector<std::pair<std::string, std::vector<int>>> uri_map_;
@@ -282,6 +345,23 @@ class FileQLogger : public BaseQLogger {
   std::string peer_address_;
   bool aggregate_;
   std::unique_ptr<QLogFramesProcessed> qlog_frames_processed_;
+  std::unique_ptr<QLogBinaryWriter> binary_writer_;
+  QLogFilter filter_;
+
+  QLogOverflowPolicy overflow_policy_ = QLogOverflowPolicy::BLOCK;
+  std::size_t queue_high_watermark_ = 0;
+  std::size_t last_queue_depth_ = 0;
+  uint32_t sample_interval_ = kQLogDefaultSampleInterval;
+  uint64_t sample_counter_ = 0;
+  uint64_t post_counter_ = 0;
+  uint64_t dropped_events_ = 0;
+  // Where each event in logstring_ that has not been posted yet starts.
+  std::vector<size_t> pending_event_starts_;
+  // Whether an event has been posted to logger_, so that the next one needs
+  // a separator.
+  bool event_posted_ = false;
+  // Binary writer drops already reported to QLogQueueGauge.
+  uint64_t reported_records_dropped_ = 0;
   std::string packet_type_now_;
 
   //current BBR mode timestamp to calculate time
@@ -0,0 +1,106 @@
+#include "base/bvc-qlog/src/file_qlogger.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "rapidjson/document.h"
+#include "spdlog/async.h"
+
+namespace quic {
+namespace test {
+
+namespace {
+
+constexpr size_t kQueueCapacity = 1024;
+constexpr size_t kMaxFileSize = 1024 * 1024;
+constexpr size_t kMaxFiles = 10;
+constexpr char kConnectionId[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+}  // namespace
+
+class FileQLoggerTest : public QuicTestWithParam<QLogOverflowPolicy> {
+ protected:
+  FileQLoggerTest()
+      : dir_(::testing::TempDir() + "/file_qlogger_test"),
+        connection_id_(kConnectionId, sizeof(kConnectionId)),
+        tp_(std::make_shared<spdlog::details::thread_pool>(kQueueCapacity, 1)) {
+    QLogOverflowConfig overflow_config;
+    overflow_config.policy = GetParam();
+    overflow_config.queue_capacity = kQueueCapacity;
+    logger_ = std::make_unique<FileQLogger>(
+        VantagePoint::IS_SERVER, dir_, dir_ + "/final", tp_, kMaxFileSize,
+        kMaxFiles, /*init_cwnd=*/10, /*log_event_buffer=*/0,
+        /*switch_qlog_index=*/0, kHTTP3ProtocolType, /*pretty_json=*/false,
+        /*streaming=*/true, QLogOutputFormat::JSON, overflow_config);
+    path_ = dir_ + "/" + connection_id_.ToString() + kQLogJsonFileExtension;
+    std::remove(path_.c_str());
+    logger_->SetDcid(connection_id_, "127.0.0.1:443", "127.0.0.1:1234");
+  }
+
+  // Makes the queue look full, or not, to the logger.
+  void SetQueueFull(bool full) {
+    logger_->queue_high_watermark_ = full ? 0 : kQueueCapacity;
+  }
+
+  // Closes the logger, waits for the thread pool to write everything out and
+  // returns the qlog file.
+  std::string CloseLogger() {
+    logger_.reset();
+    tp_.reset();
+    return ReadFile(path_);
+  }
+
+  std::string dir_;
+  std::string path_;
+  QuicConnectionId connection_id_;
+  std::shared_ptr<spdlog::details::thread_pool> tp_;
+  std::unique_ptr<FileQLogger> logger_;
+};
+
+INSTANTIATE_TEST_SUITE_P(Policies, FileQLoggerTest,
+                         ::testing::Values(QLogOverflowPolicy::DROP_NEWEST,
+                                           QLogOverflowPolicy::DROP_OLDEST,
+                                           QLogOverflowPolicy::SAMPLE));
+
+// The events following a dropped first event must not start with a
+// separator.
+TEST_P(FileQLoggerTest, DroppedFirstEventKeepsOutputValid) {
+  SetQueueFull(true);
+  if (GetParam() == QLogOverflowPolicy::DROP_OLDEST) {
+    // Only dropped once the held back events outgrow their backlog.
+    logger_->AddConnectionClose(QUIC_NO_ERROR,
+                                std::string(kQLogMaxPendingBytes, 'x'),
+                                ConnectionCloseSource::FROM_SELF);
+  }
+  logger_->AddPacketLost(1, ENCRYPTION_FORWARD_SECURE, LOSS_RETRANSMISSION);
+  if (GetParam() != QLogOverflowPolicy::DROP_OLDEST) {
+    EXPECT_EQ(1u, logger_->dropped_events());
+  }
+  SetQueueFull(false);
+  logger_->AddPacketLost(2, ENCRYPTION_FORWARD_SECURE, LOSS_RETRANSMISSION);
+  logger_->AddPacketLost(3, ENCRYPTION_FORWARD_SECURE, LOSS_RETRANSMISSION);
+  EXPECT_EQ(1u, logger_->dropped_events());
+
+  const std::string contents = CloseLogger();
+  rapidjson::Document qlog;
+  qlog.Parse(contents.data(), contents.size());
+  ASSERT_FALSE(qlog.HasParseError()) << contents;
+  const rapidjson::Value& events = qlog["traces"][0]["events"];
+  const size_t expected_events =
+      GetParam() == QLogOverflowPolicy::DROP_OLDEST ? 3 : 2;
+  EXPECT_EQ(expected_events, events.Size()) << contents;
+}
+
+}  // namespace test
+}  // namespace quic
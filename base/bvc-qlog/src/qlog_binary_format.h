@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace quic {
+
+// Binary qlog ("bqlog") layout.
+//
+// A file starts with kQLogBinaryMagic followed by one version byte, then a
+// sequence of records. Every record has the same fixed 3-byte header:
+//
+//   | type (u8) | body length (u16, little endian) | body ... |
+//
+// The body always starts with the event's relative time in microseconds,
+// followed by the record specific fields. Integers inside the body are
+// LEB128 varints, enums are single bytes and strings are a varint length
+// followed by the raw bytes. Packet records carry their frames back to back
+// until the end of the body, each frame prefixed by its QuicFrameType byte.
+// Readers skip record types they do not understand by their body length.
+//
+// A record whose body is longer than kQLogMaxRecordBodySize is split: the
+// first kQLogMaxRecordBodySize bytes keep the record's type, and the rest
+// follows in CONTINUATION records, each up to kQLogMaxRecordBodySize bytes of
+// raw body without a relative time of their own. A record and its
+// continuations are always written, dropped and rotated as one unit.
+constexpr char kQLogBinaryMagic[4] = {'B', 'Q', 'L', 'G'};
+constexpr uint8_t kQLogBinaryVersion = 1;
+constexpr size_t kQLogBinaryFileHeaderSize = sizeof(kQLogBinaryMagic) + 1;
+constexpr size_t kQLogRecordHeaderSize = 3;
+constexpr size_t kQLogMaxRecordBodySize = UINT16_MAX;
+
+// Records larger than this are built outside of the per-connection scratch
+// buffer (see QLogBinaryWriter::WriteJsonEvent).
+constexpr size_t kQLogMaxScratchRecordSize = 2048;
+// Long ack frames are cut down to their most recent ranges.
+constexpr size_t kQLogMaxAckRangesPerFrame = 64;
+constexpr size_t kQLogDefaultRingBufferSize = 16 * 1024;
+constexpr auto kQLogBinaryFileExtension = ".bqlog";
+constexpr auto kQLogJsonFileExtension = ".qlog";
+
+enum class QLogRecordType : uint8_t {
+  TRACE_HEADER = 1,
+  PACKET_SENT = 2,
+  PACKET_RECEIVED = 3,
+  BBR_CONGESTION_METRIC_UPDATE = 4,
+  BBR2_CONGESTION_METRIC_UPDATE = 5,
+  CUBIC_CONGESTION_METRIC_UPDATE = 6,
+  PACKET_LOST = 7,
+  METRIC_UPDATE = 8,
+  // Infrequent events are kept as their serialized JSON form.
+  JSON_EVENT = 9,
+  SUMMARY = 10,
+  CONTINUATION = 11,
+};
+
+// Packet header form of a packet record.
+enum class QLogPacketForm : uint8_t {
+  SHORT_HEADER = 0,
+  GOOGLE_QUIC = 1,
+  LONG_HEADER = 2,
+};
+
+// Marks packet records that have no transmission type (received packets).
+constexpr uint8_t kQLogNoTransmissionType = 0xff;
+
+inline size_t QLogVarintLength(uint64_t value) {
+  size_t length = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++length;
+  }
+  return length;
+}
+
+// Writes |value| at |out| and returns the number of bytes written. |out| must
+// have room for QLogVarintLength(value) bytes.
+inline size_t QLogEncodeVarint(uint64_t value, uint8_t* out) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = static_cast<uint8_t>(value);
+  return length;
+}
+
+} // namespace quic
@@ -0,0 +1,506 @@
+#include "base/bvc-qlog/src/qlog_binary_reader.h"
+
+#include <cstring>
+#include <memory>
+
+#include "base/bvc-qlog/src/qlogger_constants.h"
+#include "base/bvc-qlog/src/qlogger_types.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace quic {
+
+namespace {
+
+// Bounds checked view over one record body. Reads past the end return zero
+// values and mark the cursor as failed.
+class QLogRecordCursor {
+ public:
+  explicit QLogRecordCursor(absl::string_view data) : data_(data) {}
+
+  bool ok() const { return ok_; }
+  bool empty() const { return offset_ >= data_.size(); }
+
+  uint8_t ReadByte() {
+    if (offset_ >= data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<uint8_t>(data_[offset_++]);
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = ReadByte();
+      if (!ok_) {
+        return 0;
+      }
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    ok_ = false;
+    return 0;
+  }
+
+  absl::string_view ReadString() {
+    uint64_t length = ReadVarint();
+    if (!ok_ || length > data_.size() - offset_) {
+      ok_ = false;
+      return absl::string_view();
+    }
+    absl::string_view value = data_.substr(offset_, length);
+    offset_ += length;
+    return value;
+  }
+
+ private:
+  absl::string_view data_;
+  size_t offset_ = 0;
+  bool ok_ = true;
+};
+
+std::string PacketTypeString(QLogRecordCursor& cursor) {
+  auto form = static_cast<QLogPacketForm>(cursor.ReadByte());
+  switch (form) {
+    case QLogPacketForm::SHORT_HEADER:
+      return std::string(kShortHeaderPacketType);
+    case QLogPacketForm::GOOGLE_QUIC:
+      return std::string(kGooglePacketType);
+    case QLogPacketForm::LONG_HEADER:
+    default:
+      return std::string(toQlogString(
+          static_cast<QuicLongHeaderType>(cursor.ReadByte())));
+  }
+}
+
+std::unique_ptr<QLogFrame> ReadFrame(QLogRecordCursor& cursor) {
+  auto frame_type = static_cast<QuicFrameType>(cursor.ReadByte());
+  switch (frame_type) {
+    case QuicFrameType::STREAM_FRAME: {
+      QuicStreamId stream_id = cursor.ReadVarint();
+      uint64_t offset = cursor.ReadVarint();
+      uint64_t length = cursor.ReadVarint();
+      bool fin = cursor.ReadByte();
+      return std::make_unique<StreamFrameLog>(stream_id, offset, length, fin);
+    }
+    case QuicFrameType::ACK_FRAME: {
+      uint64_t ack_delay = cursor.ReadVarint();
+      uint64_t num_ranges = cursor.ReadVarint();
+      PacketNumberQueue packets;
+      for (uint64_t i = 0; i < num_ranges && cursor.ok(); ++i) {
+        uint64_t min = cursor.ReadVarint();
+        uint64_t length = cursor.ReadVarint();
+        if (length > 0) {
+          packets.AddRange(QuicPacketNumber(min), QuicPacketNumber(min + length));
+        }
+      }
+      return std::make_unique<AckFrameLog>(packets, ack_delay);
+    }
+    case QuicFrameType::RST_STREAM_FRAME: {
+      QuicStreamId stream_id = cursor.ReadVarint();
+      auto error_code = static_cast<QuicRstStreamErrorCode>(cursor.ReadVarint());
+      uint64_t offset = cursor.ReadVarint();
+      return std::make_unique<RstStreamFrameLog>(stream_id, error_code, offset);
+    }
+    case QuicFrameType::CONNECTION_CLOSE_FRAME: {
+      auto close_type = static_cast<QuicConnectionCloseType>(cursor.ReadByte());
+      uint64_t wire_error_code = cursor.ReadVarint();
+      auto quic_error_code = static_cast<QuicErrorCode>(cursor.ReadVarint());
+      uint64_t transport_close_frame_type = cursor.ReadVarint();
+      std::string details(cursor.ReadString());
+      return std::make_unique<ConnectionCloseFrameLog>(
+          close_type, wire_error_code, quic_error_code, details,
+          transport_close_frame_type);
+    }
+    case QuicFrameType::GOAWAY_FRAME: {
+      auto error_code = static_cast<QuicErrorCode>(cursor.ReadVarint());
+      QuicStreamId last_good_stream_id = cursor.ReadVarint();
+      std::string reason(cursor.ReadString());
+      return std::make_unique<GoAwayFrameLog>(error_code, last_good_stream_id, reason);
+    }
+    case QuicFrameType::WINDOW_UPDATE_FRAME: {
+      QuicStreamId stream_id = cursor.ReadVarint();
+      uint64_t max_data = cursor.ReadVarint();
+      return std::make_unique<WindowUpdateFrameLog>(stream_id, max_data);
+    }
+    case QuicFrameType::BLOCKED_FRAME:
+      return std::make_unique<BlockedFrameLog>(cursor.ReadVarint());
+    case QuicFrameType::CRYPTO_FRAME: {
+      auto level = static_cast<EncryptionLevel>(cursor.ReadByte());
+      uint64_t offset = cursor.ReadVarint();
+      uint64_t length = cursor.ReadVarint();
+      return std::make_unique<CryptoFrameLog>(level, offset, length);
+    }
+    case QuicFrameType::NEW_CONNECTION_ID_FRAME: {
+      std::string connection_id = absl::BytesToHexString(cursor.ReadString());
+      uint64_t sequence_number = cursor.ReadVarint();
+      return std::make_unique<NewConnectionIdFrameLog>(connection_id, sequence_number);
+    }
+    case QuicFrameType::MAX_STREAMS_FRAME: {
+      uint64_t stream_count = cursor.ReadVarint();
+      bool unidirectional = cursor.ReadByte();
+      return std::make_unique<MaxStreamsFrameLog>(stream_count, unidirectional);
+    }
+    case QuicFrameType::STREAMS_BLOCKED_FRAME: {
+      uint64_t stream_count = cursor.ReadVarint();
+      bool unidirectional = cursor.ReadByte();
+      return std::make_unique<StreamsBlockedFrameLog>(stream_count, unidirectional);
+    }
+    case QuicFrameType::PATH_RESPONSE_FRAME:
+      return std::make_unique<PathResponseFrameLog>(
+          absl::BytesToHexString(cursor.ReadString()));
+    case QuicFrameType::PATH_CHALLENGE_FRAME:
+      return std::make_unique<PathChallengeFrameLog>(
+          absl::BytesToHexString(cursor.ReadString()));
+    case QuicFrameType::STOP_SENDING_FRAME: {
+      QuicStreamId stream_id = cursor.ReadVarint();
+      auto error_code = static_cast<QuicRstStreamErrorCode>(cursor.ReadVarint());
+      return std::make_unique<StopSendingFrameLog>(stream_id, error_code);
+    }
+    case QuicFrameType::MESSAGE_FRAME: {
+      uint32_t message_id = cursor.ReadVarint();
+      uint64_t length = cursor.ReadVarint();
+      return std::make_unique<MessageFrameLog>(message_id, length);
+    }
+    case QuicFrameType::RETIRE_CONNECTION_ID_FRAME:
+      return std::make_unique<RetireConnectionIdFrameLog>(cursor.ReadVarint());
+    case QuicFrameType::ACK_FREQUENCY_FRAME: {
+      uint64_t sequence_number = cursor.ReadVarint();
+      uint64_t packet_tolerance = cursor.ReadVarint();
+      uint64_t max_ack_delay = cursor.ReadVarint();
+      bool ignore_order = cursor.ReadByte();
+      return std::make_unique<AckFrequencyFrameLog>(
+          sequence_number, packet_tolerance, max_ack_delay, ignore_order);
+    }
+    case QuicFrameType::PADDING_FRAME:
+      return std::make_unique<PaddingFrameLog>();
+    case QuicFrameType::PING_FRAME:
+      return std::make_unique<PingFrameLog>();
+    case QuicFrameType::STOP_WAITING_FRAME:
+      return std::make_unique<StopWaitingFrameLog>();
+    case QuicFrameType::HANDSHAKE_DONE_FRAME:
+      return std::make_unique<HandshakeDoneFrameLog>();
+    case QuicFrameType::MTU_DISCOVERY_FRAME:
+      return std::make_unique<MTUDiscoveryFrameLog>();
+    case QuicFrameType::NEW_TOKEN_FRAME:
+      return std::make_unique<NewTokenFrameLog>();
+    default:
+      return nullptr;
+  }
+}
+
+Document ReadPacketEvent(
+    QLogRecordCursor& cursor,
+    std::chrono::microseconds ref_time,
+    QLogEventType event_type) {
+  QLogPacketEvent event;
+  event.ref_time_ = ref_time;
+  event.event_type_ = event_type;
+  event.packet_num_ = cursor.ReadVarint();
+  event.packet_size_ = cursor.ReadVarint();
+  event.packet_type_ = PacketTypeString(cursor);
+  uint8_t transmission_type = cursor.ReadByte();
+  if (transmission_type != kQLogNoTransmissionType) {
+    event.transmission_type_ = std::string(
+        toQlogString(static_cast<TransmissionType>(transmission_type)));
+  }
+  while (cursor.ok() && !cursor.empty()) {
+    std::unique_ptr<QLogFrame> frame = ReadFrame(cursor);
+    if (frame == nullptr) {
+      // Frame layout unknown to this reader, the rest of the packet is lost.
+      break;
+    }
+    event.frames_.push_back(std::move(frame));
+  }
+  return event.ToJson();
+}
+
+// Builds [ref_time, "metric_update", "congestion_metric_update", data], the
+// same array the QLog*CongestionMetricUpdateEvent classes produce.
+Document CongestionEventJson(
+    std::chrono::microseconds ref_time,
+    Value& data,
+    Document::AllocatorType& allocator) {
+  Document j(&allocator);
+  j.SetArray();
+  j.PushBack(Value(quiche::QuicheTextUtilsImpl::Uint64ToString(ref_time.count()).c_str(), allocator).Move(), allocator);
+  j.PushBack("metric_update", allocator);
+  j.PushBack(Value(ToString(QLogEventType::CONGESTION_METRIC_UPDATE).data(), allocator).Move(), allocator);
+  j.PushBack(data, allocator);
+  return j;
+}
+
+void AddCongestionCommon(
+    QLogRecordCursor& cursor,
+    CongestionControlType type,
+    Value& value,
+    Document::AllocatorType& allocator) {
+  value.SetObject();
+  value.AddMember("bytes_in_flight", cursor.ReadVarint(), allocator);
+  value.AddMember("current_cwnd", cursor.ReadVarint(), allocator);
+  std::string congestion_event(cursor.ReadString());
+  value.AddMember("congestion_event",
+                  Value(congestion_event.c_str(), allocator).Move(),
+                  allocator);
+  value.AddMember("congestion_control_type",
+                  Value(toQlogString(type).data(), allocator).Move(),
+                  allocator);
+}
+
+Document ReadCongestionEvent(
+    QLogRecordCursor& cursor,
+    std::chrono::microseconds ref_time,
+    QLogRecordType type,
+    Document::AllocatorType& allocator) {
+  Value value;
+  Value state(kObjectType);
+  switch (type) {
+    case QLogRecordType::BBR_CONGESTION_METRIC_UPDATE:
+      AddCongestionCommon(cursor, kBBR, value, allocator);
+      state.AddMember("mode",
+                      Value(toQlogString(static_cast<BbrSender::Mode>(cursor.ReadByte())).data(), allocator).Move(),
+                      allocator);
+      state.AddMember("max_bandwidth", cursor.ReadVarint(), allocator);
+      state.AddMember("round_trip_counter", cursor.ReadVarint(), allocator);
+      state.AddMember("gain_cycle_index", static_cast<int>(cursor.ReadVarint()), allocator);
+      state.AddMember("min_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("latest_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("smoothed_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("mean_deviation", cursor.ReadVarint(), allocator);
+      state.AddMember("recovery_state",
+                      Value(toQlogString(static_cast<BbrSender::RecoveryState>(cursor.ReadByte())).data(), allocator).Move(),
+                      allocator);
+      break;
+    case QLogRecordType::BBR2_CONGESTION_METRIC_UPDATE:
+      AddCongestionCommon(cursor, kBBRv2, value, allocator);
+      state.AddMember("mode",
+                      Value(toQlogString(static_cast<Bbr2Mode>(cursor.ReadByte())).data(), allocator).Move(),
+                      allocator);
+      state.AddMember("bandwidth_hi", cursor.ReadVarint(), allocator);
+      state.AddMember("bandwidth_lo", cursor.ReadVarint(), allocator);
+      state.AddMember("bandwidth_est", cursor.ReadVarint(), allocator);
+      state.AddMember("round_trip_counter", cursor.ReadVarint(), allocator);
+      state.AddMember("min_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("latest_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("smoothed_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("mean_deviation", cursor.ReadVarint(), allocator);
+      state.AddMember("inflight_hi", cursor.ReadVarint(), allocator);
+      state.AddMember("inflight_lo", cursor.ReadVarint(), allocator);
+      break;
+    case QLogRecordType::CUBIC_CONGESTION_METRIC_UPDATE:
+    default:
+      AddCongestionCommon(cursor, kCubicBytes, value, allocator);
+      state.AddMember("min_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("latest_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("smoothed_rtt", cursor.ReadVarint(), allocator);
+      state.AddMember("mean_deviation", cursor.ReadVarint(), allocator);
+      state.AddMember("bandwidth_est", cursor.ReadVarint(), allocator);
+      break;
+  }
+  value.AddMember("state", state, allocator);
+  return CongestionEventJson(ref_time, value, allocator);
+}
+
+void AddTraceHeader(
+    QLogRecordCursor& cursor,
+    Document& qlog,
+    Value& trace) {
+  Document::AllocatorType& allocator = qlog.GetAllocator();
+  uint64_t reference_time = cursor.ReadVarint();
+  auto vantage_point = static_cast<VantagePoint>(cursor.ReadByte());
+  std::string dcid(cursor.ReadString());
+  std::string scid(cursor.ReadString());
+  std::string protocol_type(cursor.ReadString());
+  std::string self_address(cursor.ReadString());
+  std::string host_name(cursor.ReadString());
+
+  Value value(kObjectType);
+  value.AddMember("dcid", Value(dcid.c_str(), allocator).Move(), allocator);
+  value.AddMember("protocol_type", Value(protocol_type.c_str(), allocator).Move(), allocator);
+  value.AddMember("reference_time", reference_time, allocator);
+  value.AddMember("scid", Value(scid.c_str(), allocator).Move(), allocator);
+  trace.AddMember("common_fields", value, allocator);
+
+  value.SetObject();
+  value.AddMember("time_offset", 0, allocator);
+  value.AddMember("time_units", Value(kQLogTimeUnits, allocator).Move(), allocator);
+  trace.AddMember("configuration", value, allocator);
+
+  trace.AddMember("description", Value(kQLogTraceDescription, allocator).Move(), allocator);
+  trace.AddMember("events", Value(kArrayType).Move(), allocator);
+  trace.AddMember("title", Value(kQLogTraceTitle, allocator).Move(), allocator);
+
+  value.SetObject();
+  value.AddMember("type", Value(vantagePointString(vantage_point).data(), allocator).Move(), allocator);
+  value.AddMember("ip", Value(self_address.c_str(), allocator).Move(), allocator);
+  value.AddMember("name", Value(host_name.c_str(), allocator).Move(), allocator);
+  trace.AddMember("vantage_point", value, allocator);
+}
+
+} // namespace
+
+bool QLogBinaryReader::ToJson(absl::string_view input, Document& qlog) {
+  if (input.size() < kQLogBinaryFileHeaderSize ||
+      memcmp(input.data(), kQLogBinaryMagic, sizeof(kQLogBinaryMagic)) != 0 ||
+      static_cast<uint8_t>(input[sizeof(kQLogBinaryMagic)]) != kQLogBinaryVersion) {
+    return false;
+  }
+  qlog.SetObject();
+  Document::AllocatorType& allocator = qlog.GetAllocator();
+  qlog.AddMember(Value(kQLogDescriptionField, allocator).Move(),
+                 Value(kQLogDescription, allocator).Move(),
+                 allocator);
+  qlog.AddMember(Value(kQLogVersionField, allocator).Move(),
+                 Value(kQLogVersion, allocator).Move(),
+                 allocator);
+  qlog.AddMember(Value(kQLogTitleField, allocator).Move(),
+                 Value(kQLogTitle, allocator).Move(),
+                 allocator);
+
+  Value trace(kObjectType);
+  Value events(kArrayType);
+  Value summary;
+
+  size_t offset = kQLogBinaryFileHeaderSize;
+  while (input.size() - offset >= kQLogRecordHeaderSize) {
+    auto type = static_cast<QLogRecordType>(input[offset]);
+    size_t body_length = static_cast<uint8_t>(input[offset + 1]) |
+                         (static_cast<uint8_t>(input[offset + 2]) << 8);
+    offset += kQLogRecordHeaderSize;
+    if (body_length > input.size() - offset) {
+      // Truncated tail, e.g. the process died before the last flush.
+      ++records_skipped_;
+      break;
+    }
+    absl::string_view body = input.substr(offset, body_length);
+    offset += body_length;
+    if (type == QLogRecordType::CONTINUATION) {
+      // Its record was lost, e.g. to the start of a rotated file.
+      ++records_skipped_;
+      continue;
+    }
+    std::string joined_body;
+    while (input.size() - offset >= kQLogRecordHeaderSize &&
+           static_cast<QLogRecordType>(input[offset]) ==
+               QLogRecordType::CONTINUATION) {
+      size_t continuation_length =
+          static_cast<uint8_t>(input[offset + 1]) |
+          (static_cast<uint8_t>(input[offset + 2]) << 8);
+      if (continuation_length >
+          input.size() - offset - kQLogRecordHeaderSize) {
+        break;
+      }
+      if (joined_body.empty()) {
+        joined_body.assign(body.data(), body.size());
+      }
+      joined_body.append(input.data() + offset + kQLogRecordHeaderSize,
+                         continuation_length);
+      offset += kQLogRecordHeaderSize + continuation_length;
+    }
+    QLogRecordCursor cursor(joined_body.empty() ? body
+                                                : absl::string_view(joined_body));
+    auto ref_time = std::chrono::microseconds(cursor.ReadVarint());
+
+    Document event(&allocator);
+    switch (type) {
+      case QLogRecordType::TRACE_HEADER:
+        if (!trace.HasMember("common_fields")) {
+          AddTraceHeader(cursor, qlog, trace);
+        }
+        break;
+      case QLogRecordType::PACKET_SENT:
+        event.CopyFrom(ReadPacketEvent(cursor, ref_time, QLogEventType::PACKET_SENT), allocator);
+        break;
+      case QLogRecordType::PACKET_RECEIVED:
+        event.CopyFrom(ReadPacketEvent(cursor, ref_time, QLogEventType::PACKET_RECEIVED), allocator);
+        break;
+      case QLogRecordType::BBR_CONGESTION_METRIC_UPDATE:
+      case QLogRecordType::BBR2_CONGESTION_METRIC_UPDATE:
+      case QLogRecordType::CUBIC_CONGESTION_METRIC_UPDATE:
+        event = ReadCongestionEvent(cursor, ref_time, type, allocator);
+        break;
+      case QLogRecordType::PACKET_LOST: {
+        uint64_t lost_packet_num = cursor.ReadVarint();
+        auto level = static_cast<EncryptionLevel>(cursor.ReadByte());
+        auto transmission_type = static_cast<TransmissionType>(cursor.ReadByte());
+        event.CopyFrom(QLogPacketLostEvent(lost_packet_num, level, transmission_type, ref_time).ToJson(), allocator);
+        break;
+      }
+      case QLogRecordType::METRIC_UPDATE: {
+        auto latest_rtt = std::chrono::microseconds(cursor.ReadVarint());
+        auto min_rtt = std::chrono::microseconds(cursor.ReadVarint());
+        auto smoothed_rtt = std::chrono::microseconds(cursor.ReadVarint());
+        auto ack_delay = std::chrono::microseconds(cursor.ReadVarint());
+        event.CopyFrom(QLogMetricUpdateEvent(latest_rtt, min_rtt, smoothed_rtt, ack_delay, ref_time).ToJson(), allocator);
+        break;
+      }
+      case QLogRecordType::JSON_EVENT:
+      case QLogRecordType::SUMMARY: {
+        absl::string_view json = cursor.ReadString();
+        Document parsed(&allocator);
+        parsed.Parse(json.data(), json.size());
+        if (parsed.HasParseError()) {
+          ++records_skipped_;
+          continue;
+        }
+        if (type == QLogRecordType::SUMMARY) {
+          summary = parsed.Move();
+        } else {
+          event = std::move(parsed);
+        }
+        break;
+      }
+      default:
+        ++records_skipped_;
+        continue;
+    }
+    if (!cursor.ok()) {
+      ++records_skipped_;
+      continue;
+    }
+    ++records_read_;
+    if (event.IsArray()) {
+      events.PushBack(event.Move(), allocator);
+    }
+  }
+
+  if (!trace.HasMember("common_fields")) {
+    return false;
+  }
+  trace["events"] = events;
+  Value traces(kArrayType);
+  traces.PushBack(trace, allocator);
+  qlog.AddMember("traces", traces, allocator);
+  if (!summary.IsNull()) {
+    qlog.AddMember("summary", summary, allocator);
+  }
+  return true;
+}
+
+bool QLogBinaryReader::ToJsonString(
+    absl::string_view input,
+    std::string* output,
+    bool pretty_json) {
+  Document qlog;
+  if (!ToJson(input, qlog)) {
+    return false;
+  }
+  StringBuffer buffer;
+  if (pretty_json) {
+    PrettyWriter<StringBuffer> writer(buffer);
+    qlog.Accept(writer);
+  } else {
+    Writer<StringBuffer> writer(buffer);
+    qlog.Accept(writer);
+  }
+  output->assign(buffer.GetString(), buffer.GetSize());
+  return true;
+}
+
+} // namespace quic
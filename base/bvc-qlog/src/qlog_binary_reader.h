@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "base/bvc-qlog/src/qlog_binary_format.h"
+#include "absl/strings/string_view.h"
+#include "rapidjson/document.h"
+
+namespace quic {
+
+// Expands a binary qlog written by FileQLogger (QLogOutputFormat::BINARY)
+// back into the JSON document FileQLogger produces in JSON mode, so the
+// result can be loaded by qvis and the existing tooling.
+class QLogBinaryReader {
+ public:
+  QLogBinaryReader() = default;
+
+  // Returns false if |input| is not a binary qlog. Truncated or unknown
+  // records at the end of the input are skipped.
+  bool ToJson(absl::string_view input, rapidjson::Document& qlog);
+  bool ToJsonString(absl::string_view input, std::string* output, bool pretty_json);
+
+  uint64_t records_read() const { return records_read_; }
+  uint64_t records_skipped() const { return records_skipped_; }
+
+ private:
+  uint64_t records_read_ = 0;
+  uint64_t records_skipped_ = 0;
+};
+
+} // namespace quic
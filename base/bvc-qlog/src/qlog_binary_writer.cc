@@ -0,0 +1,550 @@
+#include "base/bvc-qlog/src/qlog_binary_writer.h"
+
+#include <cstring>
+
+#include "gquiche/quic/core/frames/quic_frame.h"
+
+namespace quic {
+
+QLogRingBuffer::QLogRingBuffer(size_t capacity)
+    : data_(new uint8_t[capacity]),
+      capacity_(capacity) {}
+
+bool QLogRingBuffer::Fits(size_t length) const {
+  if (size_ == 0) {
+    return length <= capacity_;
+  }
+  if (wrapped_) {
+    return length <= head_ - tail_;
+  }
+  return length <= capacity_ - tail_ || length <= head_;
+}
+
+bool QLogRingBuffer::Append(absl::string_view first, absl::string_view second) {
+  const size_t length = first.size() + second.size();
+  if (!Fits(length)) {
+    return false;
+  }
+  if (size_ == 0) {
+    Clear();
+  } else if (!wrapped_ && length > capacity_ - tail_) {
+    // Records never straddle the end of the storage.
+    wrap_end_ = tail_;
+    tail_ = 0;
+    wrapped_ = true;
+  }
+  memcpy(data_.get() + tail_, first.data(), first.size());
+  memcpy(data_.get() + tail_ + first.size(), second.data(), second.size());
+  tail_ += length;
+  size_ += length;
+  return true;
+}
+
+void QLogRingBuffer::DiscardOldest() {
+  if (size_ == 0) {
+    return;
+  }
+  // A split record goes together with its continuations.
+  do {
+    const uint8_t* header = data_.get() + head_;
+    const size_t body_length =
+        header[1] | (static_cast<size_t>(header[2]) << 8);
+    const size_t length = kQLogRecordHeaderSize + body_length;
+    head_ += length;
+    size_ -= length;
+    if (size_ == 0) {
+      Clear();
+    } else if (wrapped_ && head_ == wrap_end_) {
+      head_ = 0;
+      wrapped_ = false;
+    }
+  } while (size_ > 0 && data_[head_] ==
+                            static_cast<uint8_t>(QLogRecordType::CONTINUATION));
+}
+
+void QLogRingBuffer::Clear() {
+  size_ = 0;
+  head_ = 0;
+  tail_ = 0;
+  wrap_end_ = 0;
+  wrapped_ = false;
+}
+
+QLogBinaryWriter::QLogBinaryWriter(size_t ring_buffer_size)
+    : ring_(ring_buffer_size) {}
+
+void QLogBinaryWriter::WriteFileHeader() {
+  uint8_t header[kQLogBinaryFileHeaderSize];
+  memcpy(header, kQLogBinaryMagic, sizeof(kQLogBinaryMagic));
+  header[sizeof(kQLogBinaryMagic)] = kQLogBinaryVersion;
+  Commit(absl::string_view(reinterpret_cast<const char*>(header),
+                            sizeof(header)));
+}
+
+void QLogBinaryWriter::WriteTraceHeader(
+    std::chrono::microseconds reference_time,
+    VantagePoint vantage_point,
+    absl::string_view dcid,
+    absl::string_view scid,
+    absl::string_view protocol_type,
+    absl::string_view self_address,
+    absl::string_view host_name) {
+  BeginRecord(QLogRecordType::TRACE_HEADER, std::chrono::microseconds::zero());
+  WriteVarint(reference_time.count());
+  WriteByte(static_cast<uint8_t>(vantage_point));
+  WriteString(dcid);
+  WriteString(scid);
+  WriteString(protocol_type);
+  WriteString(self_address);
+  WriteString(host_name);
+  EndRecord();
+}
+
+void QLogBinaryWriter::StartPacketSent(
+    std::chrono::microseconds ref_time,
+    uint64_t packet_number,
+    uint64_t packet_length,
+    TransmissionType transmission_type,
+    EncryptionLevel encryption_level) {
+  BeginRecord(QLogRecordType::PACKET_SENT, ref_time);
+  WriteVarint(packet_number);
+  WriteVarint(packet_length);
+  if (encryption_level >= ENCRYPTION_FORWARD_SECURE) {
+    WriteByte(static_cast<uint8_t>(QLogPacketForm::SHORT_HEADER));
+  } else {
+    WriteByte(static_cast<uint8_t>(QLogPacketForm::LONG_HEADER));
+    WriteByte(encryptionLevelToLongHeaderType(encryption_level));
+  }
+  WriteByte(static_cast<uint8_t>(transmission_type));
+}
+
+void QLogBinaryWriter::StartPacketReceived(
+    std::chrono::microseconds ref_time,
+    const QuicPacketHeader& packet_header,
+    uint64_t packet_size) {
+  BeginRecord(QLogRecordType::PACKET_RECEIVED, ref_time);
+  WriteVarint(packet_header.packet_number.IsInitialized() ?
+              packet_header.packet_number.ToUint64() : 0);
+  WriteVarint(packet_size);
+  if (packet_header.form == IETF_QUIC_SHORT_HEADER_PACKET) {
+    WriteByte(static_cast<uint8_t>(QLogPacketForm::SHORT_HEADER));
+  } else if (packet_header.form == GOOGLE_QUIC_PACKET) {
+    WriteByte(static_cast<uint8_t>(QLogPacketForm::GOOGLE_QUIC));
+  } else {
+    WriteByte(static_cast<uint8_t>(QLogPacketForm::LONG_HEADER));
+    WriteByte(packet_header.long_packet_type);
+  }
+  WriteByte(kQLogNoTransmissionType);
+}
+
+void QLogBinaryWriter::AddPacketFrame(QuicFrameType frame_type, const void* frame) {
+  if (!packet_open_ || frame == nullptr) {
+    return;
+  }
+  record_ = &packet_record_;
+  switch (frame_type) {
+    case QuicFrameType::STREAM_FRAME: {
+      auto* f = static_cast<const QuicStreamFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_id);
+      WriteVarint(f->offset);
+      WriteVarint(f->data_length);
+      WriteByte(f->fin);
+      break;
+    }
+    case QuicFrameType::ACK_FRAME: {
+      auto* f = static_cast<const QuicAckFrame*>(frame);
+      size_t num_ranges =
+          std::min(f->packets.NumIntervals(), kQLogMaxAckRangesPerFrame);
+      WriteByte(frame_type);
+      WriteVarint(f->ack_delay_time.ToMicroseconds());
+      WriteVarint(num_ranges);
+      // Keep the most recent ranges when the frame has to be cut down.
+      auto it = f->packets.rbegin();
+      for (size_t i = 0; i < num_ranges; ++i, ++it) {
+        WriteVarint(it->min().ToUint64());
+        WriteVarint(it->max().ToUint64() - it->min().ToUint64());
+      }
+      break;
+    }
+    case QuicFrameType::RST_STREAM_FRAME: {
+      auto* f = static_cast<const QuicRstStreamFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_id);
+      WriteVarint(f->error_code);
+      WriteVarint(f->byte_offset);
+      break;
+    }
+    case QuicFrameType::CONNECTION_CLOSE_FRAME: {
+      auto* f = static_cast<const QuicConnectionCloseFrame*>(frame);
+      WriteByte(frame_type);
+      WriteByte(f->close_type);
+      WriteVarint(f->wire_error_code);
+      WriteVarint(f->quic_error_code);
+      WriteVarint(f->transport_close_frame_type);
+      WriteString(f->error_details);
+      break;
+    }
+    case QuicFrameType::GOAWAY_FRAME: {
+      auto* f = static_cast<const QuicGoAwayFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->error_code);
+      WriteVarint(f->last_good_stream_id);
+      WriteString(f->reason_phrase);
+      break;
+    }
+    case QuicFrameType::WINDOW_UPDATE_FRAME: {
+      auto* f = static_cast<const QuicWindowUpdateFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_id);
+      WriteVarint(f->max_data);
+      break;
+    }
+    case QuicFrameType::BLOCKED_FRAME: {
+      auto* f = static_cast<const QuicBlockedFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_id);
+      break;
+    }
+    case QuicFrameType::CRYPTO_FRAME: {
+      auto* f = static_cast<const QuicCryptoFrame*>(frame);
+      WriteByte(frame_type);
+      WriteByte(f->level);
+      WriteVarint(f->offset);
+      WriteVarint(f->data_length);
+      break;
+    }
+    case QuicFrameType::NEW_CONNECTION_ID_FRAME: {
+      auto* f = static_cast<const QuicNewConnectionIdFrame*>(frame);
+      WriteByte(frame_type);
+      WriteString(absl::string_view(f->connection_id.data(),
+                                    f->connection_id.length()));
+      WriteVarint(f->sequence_number);
+      break;
+    }
+    case QuicFrameType::MAX_STREAMS_FRAME: {
+      auto* f = static_cast<const QuicMaxStreamsFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_count);
+      WriteByte(f->unidirectional);
+      break;
+    }
+    case QuicFrameType::STREAMS_BLOCKED_FRAME: {
+      auto* f = static_cast<const QuicStreamsBlockedFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_count);
+      WriteByte(f->unidirectional);
+      break;
+    }
+    case QuicFrameType::PATH_RESPONSE_FRAME: {
+      auto* f = static_cast<const QuicPathResponseFrame*>(frame);
+      WriteByte(frame_type);
+      WriteString(absl::string_view(
+          reinterpret_cast<const char*>(f->data_buffer.data()),
+          f->data_buffer.size()));
+      break;
+    }
+    case QuicFrameType::PATH_CHALLENGE_FRAME: {
+      auto* f = static_cast<const QuicPathChallengeFrame*>(frame);
+      WriteByte(frame_type);
+      WriteString(absl::string_view(
+          reinterpret_cast<const char*>(f->data_buffer.data()),
+          f->data_buffer.size()));
+      break;
+    }
+    case QuicFrameType::STOP_SENDING_FRAME: {
+      auto* f = static_cast<const QuicStopSendingFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->stream_id);
+      WriteVarint(f->error_code);
+      break;
+    }
+    case QuicFrameType::MESSAGE_FRAME: {
+      auto* f = static_cast<const QuicMessageFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->message_id);
+      WriteVarint(f->message_length);
+      break;
+    }
+    case QuicFrameType::RETIRE_CONNECTION_ID_FRAME: {
+      auto* f = static_cast<const QuicRetireConnectionIdFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->sequence_number);
+      break;
+    }
+    case QuicFrameType::ACK_FREQUENCY_FRAME: {
+      auto* f = static_cast<const QuicAckFrequencyFrame*>(frame);
+      WriteByte(frame_type);
+      WriteVarint(f->sequence_number);
+      WriteVarint(f->packet_tolerance);
+      WriteVarint(f->max_ack_delay.ToMilliseconds());
+      WriteByte(f->ignore_order);
+      break;
+    }
+    // Frames without fields worth logging.
+    case QuicFrameType::PADDING_FRAME:
+    case QuicFrameType::PING_FRAME:
+    case QuicFrameType::STOP_WAITING_FRAME:
+    case QuicFrameType::HANDSHAKE_DONE_FRAME:
+    case QuicFrameType::MTU_DISCOVERY_FRAME:
+    case QuicFrameType::NEW_TOKEN_FRAME:
+      WriteByte(frame_type);
+      break;
+    case QuicFrameType::NUM_FRAME_TYPES:
+    default:
+      break;
+  }
+}
+
+void QLogBinaryWriter::FinishPacket() {
+  if (packet_open_) {
+    record_ = &packet_record_;
+    EndRecord();
+  }
+}
+
+void QLogBinaryWriter::WriteBBRCongestionMetricUpdate(
+    std::chrono::microseconds ref_time,
+    uint64_t bytes_inflight,
+    uint64_t current_cwnd,
+    absl::string_view congestion_event,
+    const BbrSender::DebugState& state) {
+  BeginRecord(QLogRecordType::BBR_CONGESTION_METRIC_UPDATE, ref_time);
+  WriteVarint(bytes_inflight);
+  WriteVarint(current_cwnd);
+  WriteString(congestion_event);
+  WriteByte(state.mode);
+  WriteVarint(state.max_bandwidth.ToKBitsPerSecond());
+  WriteVarint(state.round_trip_count);
+  WriteVarint(state.gain_cycle_index);
+  WriteVarint(state.min_rtt.ToMicroseconds());
+  WriteVarint(state.latest_rtt.ToMicroseconds());
+  WriteVarint(state.smoothed_rtt.ToMicroseconds());
+  WriteVarint(state.mean_deviation.ToMicroseconds());
+  WriteByte(state.recovery_state);
+  EndRecord();
+}
+
+void QLogBinaryWriter::WriteBBR2CongestionMetricUpdate(
+    std::chrono::microseconds ref_time,
+    uint64_t bytes_inflight,
+    uint64_t current_cwnd,
+    absl::string_view congestion_event,
+    const Bbr2Sender::DebugState& state) {
+  BeginRecord(QLogRecordType::BBR2_CONGESTION_METRIC_UPDATE, ref_time);
+  WriteVarint(bytes_inflight);
+  WriteVarint(current_cwnd);
+  WriteString(congestion_event);
+  WriteByte(static_cast<uint8_t>(state.mode));
+  WriteVarint(state.bandwidth_hi.ToKBitsPerSecond());
+  WriteVarint(state.bandwidth_lo.ToKBitsPerSecond());
+  WriteVarint(state.bandwidth_est.ToKBitsPerSecond());
+  WriteVarint(state.round_trip_count);
+  WriteVarint(state.min_rtt.ToMicroseconds());
+  WriteVarint(state.latest_rtt.ToMicroseconds());
+  WriteVarint(state.smoothed_rtt.ToMicroseconds());
+  WriteVarint(state.mean_deviation.ToMicroseconds());
+  WriteVarint(state.inflight_hi);
+  WriteVarint(state.inflight_lo);
+  EndRecord();
+}
+
+void QLogBinaryWriter::WriteCubicCongestionMetricUpdate(
+    std::chrono::microseconds ref_time,
+    uint64_t bytes_inflight,
+    uint64_t current_cwnd,
+    absl::string_view congestion_event,
+    const TcpCubicSenderBytes::DebugState& state) {
+  BeginRecord(QLogRecordType::CUBIC_CONGESTION_METRIC_UPDATE, ref_time);
+  WriteVarint(bytes_inflight);
+  WriteVarint(current_cwnd);
+  WriteString(congestion_event);
+  WriteVarint(state.min_rtt.ToMicroseconds());
+  WriteVarint(state.latest_rtt.ToMicroseconds());
+  WriteVarint(state.smoothed_rtt.ToMicroseconds());
+  WriteVarint(state.mean_deviation.ToMicroseconds());
+  WriteVarint(state.bandwidth_est.ToKBitsPerSecond());
+  EndRecord();
+}
+
+void QLogBinaryWriter::WritePacketLost(
+    std::chrono::microseconds ref_time,
+    uint64_t lost_packet_num,
+    EncryptionLevel level,
+    TransmissionType type) {
+  BeginRecord(QLogRecordType::PACKET_LOST, ref_time);
+  WriteVarint(lost_packet_num);
+  WriteByte(level);
+  WriteByte(static_cast<uint8_t>(type));
+  EndRecord();
+}
+
+void QLogBinaryWriter::WriteMetricUpdate(
+    std::chrono::microseconds ref_time,
+    std::chrono::microseconds latest_rtt,
+    std::chrono::microseconds min_rtt,
+    std::chrono::microseconds smoothed_rtt,
+    std::chrono::microseconds ack_delay) {
+  BeginRecord(QLogRecordType::METRIC_UPDATE, ref_time);
+  WriteVarint(latest_rtt.count());
+  WriteVarint(min_rtt.count());
+  WriteVarint(smoothed_rtt.count());
+  WriteVarint(ack_delay.count());
+  EndRecord();
+}
+
+void QLogBinaryWriter::WriteJsonEvent(
+    std::chrono::microseconds ref_time,
+    absl::string_view json) {
+  WriteLargeRecord(QLogRecordType::JSON_EVENT, ref_time, json);
+}
+
+void QLogBinaryWriter::WriteSummary(absl::string_view json) {
+  WriteLargeRecord(QLogRecordType::SUMMARY, std::chrono::microseconds::zero(), json);
+}
+
+void QLogBinaryWriter::WriteLargeRecord(
+    QLogRecordType type,
+    std::chrono::microseconds ref_time,
+    absl::string_view payload) {
+  size_t body_length = QLogVarintLength(ref_time.count()) +
+                       QLogVarintLength(payload.size()) + payload.size();
+  if (kQLogRecordHeaderSize + body_length <= kQLogMaxScratchRecordSize) {
+    BeginRecord(type, ref_time);
+    WriteString(payload);
+    EndRecord();
+    return;
+  }
+  // Too large for the scratch area: emit the header and copy the payload
+  // straight into the ring buffer.
+  uint8_t header[kQLogRecordHeaderSize + 20];
+  size_t header_length = 0;
+  header[header_length++] = static_cast<uint8_t>(type);
+  header[header_length++] =
+      static_cast<uint8_t>(std::min(body_length, kQLogMaxRecordBodySize));
+  header[header_length++] =
+      static_cast<uint8_t>(std::min(body_length, kQLogMaxRecordBodySize) >> 8);
+  header_length += QLogEncodeVarint(ref_time.count(), header + header_length);
+  header_length += QLogEncodeVarint(payload.size(), header + header_length);
+  absl::string_view header_view(reinterpret_cast<const char*>(header),
+                                header_length);
+  bool committed;
+  if (body_length <= kQLogMaxRecordBodySize) {
+    committed = Commit(header_view, payload);
+  } else {
+    // Past the 16-bit body length, e.g. the summary of a long connection:
+    // split into continuation records, committed together.
+    std::string records(header_view);
+    size_t room = kQLogRecordHeaderSize + kQLogMaxRecordBodySize -
+                  header_length;
+    while (!payload.empty()) {
+      const size_t piece = std::min(room, payload.size());
+      records.append(payload.data(), piece);
+      payload.remove_prefix(piece);
+      if (!payload.empty()) {
+        const size_t next = std::min(payload.size(), kQLogMaxRecordBodySize);
+        records.push_back(static_cast<char>(QLogRecordType::CONTINUATION));
+        records.push_back(static_cast<char>(next & 0xff));
+        records.push_back(static_cast<char>(next >> 8));
+        room = next;
+      }
+    }
+    committed = Commit(records);
+  }
+  if (committed) {
+    ++records_written_;
+  } else {
+    ++records_dropped_;
+  }
+}
+
+void QLogBinaryWriter::BeginRecord(
+    QLogRecordType type,
+    std::chrono::microseconds ref_time) {
+  bool is_packet = type == QLogRecordType::PACKET_SENT ||
+                   type == QLogRecordType::PACKET_RECEIVED;
+  // Starting a packet drops a previous one that was never finished.
+  record_ = is_packet ? &packet_record_ : &event_record_;
+  packet_open_ = packet_open_ || is_packet;
+  record_->data[0] = static_cast<uint8_t>(type);
+  record_->length = kQLogRecordHeaderSize;
+  record_->overflow = false;
+  WriteVarint(ref_time.count());
+}
+
+void QLogBinaryWriter::EndRecord() {
+  if (record_ == &packet_record_) {
+    packet_open_ = false;
+  }
+  Scratch* record = record_;
+  record_ = &event_record_;
+  if (record->overflow) {
+    ++records_dropped_;
+    return;
+  }
+  size_t body_length = record->length - kQLogRecordHeaderSize;
+  record->data[1] = static_cast<uint8_t>(body_length & 0xff);
+  record->data[2] = static_cast<uint8_t>(body_length >> 8);
+  if (Commit(absl::string_view(reinterpret_cast<const char*>(record->data),
+                               record->length))) {
+    ++records_written_;
+  } else {
+    ++records_dropped_;
+  }
+}
+
+void QLogBinaryWriter::WriteByte(uint8_t value) {
+  if (record_->length + 1 > sizeof(record_->data)) {
+    record_->overflow = true;
+    return;
+  }
+  record_->data[record_->length++] = value;
+}
+
+void QLogBinaryWriter::WriteVarint(uint64_t value) {
+  if (record_->length + QLogVarintLength(value) > sizeof(record_->data)) {
+    record_->overflow = true;
+    return;
+  }
+  record_->length += QLogEncodeVarint(value, record_->data + record_->length);
+}
+
+void QLogBinaryWriter::WriteString(absl::string_view value) {
+  WriteVarint(value.size());
+  if (record_->length + value.size() > sizeof(record_->data)) {
+    record_->overflow = true;
+    return;
+  }
+  memcpy(record_->data + record_->length, value.data(), value.size());
+  record_->length += value.size();
+}
+
+bool QLogBinaryWriter::Commit(absl::string_view first, absl::string_view second) {
+  const size_t length = first.size() + second.size();
+  if (!ring_.Fits(length) && overflow_sink_) {
+    Drain(overflow_sink_);
+  } else if (discard_oldest_on_overflow_ && length <= ring_.capacity()) {
+    while (!ring_.Fits(length)) {
+      ring_.DiscardOldest();
+      ++records_dropped_;
+    }
+  }
+  if (ring_.Append(first, second)) {
+    bytes_written_ += length;
+    return true;
+  }
+  if (!overflow_sink_) {
+    return false;
+  }
+  // Larger than the whole ring buffer. The record is still handed over in one
+  // piece, so that the sink only splits its output at record boundaries.
+  std::string record;
+  record.reserve(length);
+  record.append(first.data(), first.size());
+  record.append(second.data(), second.size());
+  overflow_sink_(record.data(), record.size());
+  bytes_written_ += length;
+  return true;
+}
+
+} // namespace quic
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bvc-qlog/src/qlog_binary_format.h"
+#include "base/bvc-qlog/src/qlogger_constants.h"
+#include "gquiche/quic/core/quic_packets.h"
+#include "gquiche/quic/core/quic_types.h"
+#include "absl/strings/string_view.h"
+
+namespace quic {
+
+// Fixed capacity FIFO of whole records. The storage is allocated once, when
+// the owning connection's logger is created, and reused for the connection's
+// lifetime. A record is only appended whole and never wraps around the end of
+// the storage, so the buffered records are handed out in at most two pieces,
+// each of which ends at a record boundary.
+class QLogRingBuffer {
+ public:
+  explicit QLogRingBuffer(size_t capacity);
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return size_; }
+
+  // Whether a record of |length| bytes can be appended.
+  bool Fits(size_t length) const;
+
+  // Appends one record made of |first| followed by |second|, or nothing if it
+  // does not fit.
+  bool Append(absl::string_view first,
+              absl::string_view second = absl::string_view());
+
+  // Drops the oldest record. Relies on the record framing of
+  // qlog_binary_format.h, so the file header must have been drained first.
+  void DiscardOldest();
+
+  // Hands the buffered records to |sink|, oldest first, and empties the
+  // buffer. |sink| is called as sink(const char*, size_t).
+  template <typename Sink>
+  void Drain(Sink&& sink) {
+    const char* data = reinterpret_cast<const char*>(data_.get());
+    if (wrapped_) {
+      sink(data + head_, wrap_end_ - head_);
+      sink(data, tail_);
+    } else if (size_ > 0) {
+      sink(data + head_, tail_ - head_);
+    }
+    Clear();
+  }
+
+ private:
+  void Clear();
+
+  std::unique_ptr<uint8_t[]> data_;
+  size_t capacity_;
+  size_t size_ = 0;
+  // The records are stored in [head_, tail_), or once the writes have wrapped
+  // around, in [head_, wrap_end_) followed by [0, tail_).
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t wrap_end_ = 0;
+  bool wrapped_ = false;
+};
+
+// Encodes qlog events into compact binary records (see qlog_binary_format.h).
+// Records are built in a fixed scratch area and then committed to the ring
+// buffer, so encoding an event never touches the heap. Callers drain the ring
+// buffer into their output whenever NeedsDrain() returns true.
+class QLogBinaryWriter {
+ public:
+  explicit QLogBinaryWriter(size_t ring_buffer_size = kQLogDefaultRingBufferSize);
+  QLogBinaryWriter(const QLogBinaryWriter&) = delete;
+  QLogBinaryWriter& operator=(const QLogBinaryWriter&) = delete;
+
+  void WriteFileHeader();
+  void WriteTraceHeader(
+      std::chrono::microseconds reference_time,
+      VantagePoint vantage_point,
+      absl::string_view dcid,
+      absl::string_view scid,
+      absl::string_view protocol_type,
+      absl::string_view self_address,
+      absl::string_view host_name);
+
+  // A packet record stays open while its frames are added, so that received
+  // packets can be encoded while they are parsed frame by frame. Other records
+  // may be written while a packet is open (e.g. congestion updates triggered
+  // by an ack frame); they are committed first.
+  void StartPacketSent(
+      std::chrono::microseconds ref_time,
+      uint64_t packet_number,
+      uint64_t packet_length,
+      TransmissionType transmission_type,
+      EncryptionLevel encryption_level);
+  void StartPacketReceived(
+      std::chrono::microseconds ref_time,
+      const QuicPacketHeader& packet_header,
+      uint64_t packet_size);
+  void AddPacketFrame(QuicFrameType frame_type, const void* frame);
+  void FinishPacket();
+  bool packet_open() const { return packet_open_; }
+
+  void WriteBBRCongestionMetricUpdate(
+      std::chrono::microseconds ref_time,
+      uint64_t bytes_inflight,
+      uint64_t current_cwnd,
+      absl::string_view congestion_event,
+      const BbrSender::DebugState& state);
+  void WriteBBR2CongestionMetricUpdate(
+      std::chrono::microseconds ref_time,
+      uint64_t bytes_inflight,
+      uint64_t current_cwnd,
+      absl::string_view congestion_event,
+      const Bbr2Sender::DebugState& state);
+  void WriteCubicCongestionMetricUpdate(
+      std::chrono::microseconds ref_time,
+      uint64_t bytes_inflight,
+      uint64_t current_cwnd,
+      absl::string_view congestion_event,
+      const TcpCubicSenderBytes::DebugState& state);
+  void WritePacketLost(
+      std::chrono::microseconds ref_time,
+      uint64_t lost_packet_num,
+      EncryptionLevel level,
+      TransmissionType type);
+  void WriteMetricUpdate(
+      std::chrono::microseconds ref_time,
+      std::chrono::microseconds latest_rtt,
+      std::chrono::microseconds min_rtt,
+      std::chrono::microseconds smoothed_rtt,
+      std::chrono::microseconds ack_delay);
+
+  // Infrequent events keep their JSON form inside a JSON_EVENT record.
+  void WriteJsonEvent(std::chrono::microseconds ref_time, absl::string_view json);
+  void WriteSummary(absl::string_view json);
+
+  bool NeedsDrain() const { return ring_.size() >= ring_.capacity() / 2; }
+
+  template <typename Sink>
+  void Drain(Sink&& sink) {
+    ring_.Drain(std::forward<Sink>(sink));
+  }
+
+  // When the ring buffer is full, records are handed to the overflow sink if
+  // one is set. Otherwise the new record is dropped, or with
+  // discard_oldest_on_overflow the oldest buffered records are, until the new
+  // one fits. Dropped records are counted in records_dropped().
+  void set_overflow_sink(std::function<void(const char*, size_t)> sink) {
+    overflow_sink_ = std::move(sink);
+  }
+  void set_discard_oldest_on_overflow(bool discard) {
+    discard_oldest_on_overflow_ = discard;
+  }
+
+  uint64_t records_written() const { return records_written_; }
+  uint64_t records_dropped() const { return records_dropped_; }
+  uint64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  void BeginRecord(QLogRecordType type, std::chrono::microseconds ref_time);
+  void EndRecord();
+  void WriteByte(uint8_t value);
+  void WriteVarint(uint64_t value);
+  void WriteString(absl::string_view value);
+  void WriteLargeRecord(
+      QLogRecordType type,
+      std::chrono::microseconds ref_time,
+      absl::string_view payload);
+  // Copies the record made of |first| and |second| into the ring buffer,
+  // making room for it first as set up above. The overflow sink only ever
+  // receives whole records.
+  bool Commit(absl::string_view first,
+              absl::string_view second = absl::string_view());
+
+  struct Scratch {
+    uint8_t data[kQLogMaxScratchRecordSize];
+    size_t length = 0;
+    bool overflow = false;
+  };
+
+  QLogRingBuffer ring_;
+  Scratch packet_record_;
+  Scratch event_record_;
+  Scratch* record_ = &event_record_;
+  bool packet_open_ = false;
+
+  std::function<void(const char*, size_t)> overflow_sink_;
+  bool discard_oldest_on_overflow_ = false;
+  uint64_t records_written_ = 0;
+  uint64_t records_dropped_ = 0;
+  uint64_t bytes_written_ = 0;
+};
+
+} // namespace quic
@@ -0,0 +1,268 @@
+#include "base/bvc-qlog/src/qlog_binary_writer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/bvc-qlog/src/qlog_binary_reader.h"
+#include "base/sinks/binary_file_sink.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "spdlog/logger.h"
+#include "spdlog/pattern_formatter.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr size_t kRingBufferSize = 1024;
+constexpr size_t kMaxFileSize = 4096;
+constexpr size_t kMaxFiles = 100;
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+// Returns the relative time of every record in |records|.
+std::vector<uint64_t> RecordTimes(const std::string& records) {
+  std::vector<uint64_t> times;
+  size_t offset = 0;
+  while (offset + kQLogRecordHeaderSize <= records.size()) {
+    const uint8_t* header =
+        reinterpret_cast<const uint8_t*>(records.data() + offset);
+    const size_t body_length = header[1] | (header[2] << 8);
+    const uint8_t* body = header + kQLogRecordHeaderSize;
+    uint64_t time = 0;
+    for (int shift = 0;; shift += 7) {
+      time |= static_cast<uint64_t>(*body & 0x7f) << shift;
+      if ((*body++ & 0x80) == 0) {
+        break;
+      }
+    }
+    times.push_back(time);
+    offset += kQLogRecordHeaderSize + body_length;
+  }
+  EXPECT_EQ(records.size(), offset);
+  return times;
+}
+
+class QLogBinaryWriterTest : public QuicTest {
+ protected:
+  QLogBinaryWriterTest()
+      : base_path_(::testing::TempDir() + "/qlog_binary_writer_test.bqlog"),
+        final_path_(::testing::TempDir() + "/qlog_binary_writer_test_final" +
+                    kQLogBinaryFileExtension),
+        writer_(kRingBufferSize) {
+    for (size_t i = 1; i <= kMaxFiles; ++i) {
+      const std::string path =
+          spdlog::sinks::binary_file_sink_st::calc_filename(final_path_, i);
+      std::remove(path.c_str());
+    }
+  }
+
+  // Sets up |writer_| the way FileQLogger does, with rotated files of
+  // kMaxFileSize bytes.
+  void CreateLogger() {
+    writer_.WriteFileHeader();
+    writer_.WriteTraceHeader(std::chrono::microseconds(1000),
+                             VantagePoint::IS_SERVER, "dcid", "scid",
+                             "QUIC_VERSION_IETF_RFC_V1", "127.0.0.1:443",
+                             "host");
+    std::string file_head;
+    writer_.Drain([&file_head](const char* data, size_t length) {
+      file_head.append(data, length);
+    });
+    auto sink = std::make_shared<spdlog::sinks::binary_file_sink_st>(
+        base_path_, final_path_, kMaxFileSize, kMaxFiles, file_head);
+    logger_ = std::make_shared<spdlog::logger>("qlog_binary_writer_test",
+                                               std::move(sink));
+    logger_->set_formatter(std::make_unique<spdlog::pattern_formatter>(
+        "%v", spdlog::pattern_time_type::local, std::string("")));
+    writer_.set_overflow_sink([this](const char* data, size_t length) {
+      logger_->info(spdlog::string_view_t(data, length));
+    });
+  }
+
+  void DrainIfNeeded() {
+    if (writer_.NeedsDrain()) {
+      writer_.Drain([this](const char* data, size_t length) {
+        logger_->info(spdlog::string_view_t(data, length));
+      });
+    }
+  }
+
+  // Drains the writer, closes the logger and returns the number of files
+  // written.
+  size_t CloseLogger() {
+    writer_.Drain([this](const char* data, size_t length) {
+      logger_->info(spdlog::string_view_t(data, length));
+    });
+    logger_.reset();
+    size_t num_files = 0;
+    while (std::ifstream(spdlog::sinks::binary_file_sink_st::calc_filename(
+                             final_path_, num_files + 1))
+               .good()) {
+      ++num_files;
+    }
+    return num_files;
+  }
+
+  // Writes |num_records| records of varying sizes, the i-th one at relative
+  // time i, without draining, and returns what is left in the ring buffer.
+  std::string WriteWithoutDraining(uint64_t num_records) {
+    writer_.WriteFileHeader();
+    writer_.Drain([](const char*, size_t) {});
+    for (uint64_t i = 0; i < num_records; ++i) {
+      if (i % 7 == 0) {
+        writer_.WriteJsonEvent(std::chrono::microseconds(i),
+                               std::string(i % 50, 'x'));
+      } else {
+        writer_.WritePacketLost(std::chrono::microseconds(i), i,
+                                ENCRYPTION_FORWARD_SECURE,
+                                LOSS_RETRANSMISSION);
+      }
+    }
+    std::string records;
+    writer_.Drain([&records](const char* data, size_t length) {
+      records.append(data, length);
+    });
+    return records;
+  }
+
+  std::string base_path_;
+  std::string final_path_;
+  QLogBinaryWriter writer_;
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+TEST_F(QLogBinaryWriterTest, RotatedFilesDecodeOnTheirOwn) {
+  CreateLogger();
+  // Small records, and JSON events larger than the ring buffer and the
+  // scratch area, which go to the sink directly.
+  const std::string large_event =
+      "[\"" + std::string(3 * kRingBufferSize, 'x') + "\"]";
+  const uint64_t kNumRecords = 400;
+  for (uint64_t i = 0; i < kNumRecords; ++i) {
+    if (i % 100 == 99) {
+      writer_.WriteJsonEvent(std::chrono::microseconds(i), large_event);
+    } else {
+      writer_.WritePacketLost(std::chrono::microseconds(i), i,
+                              ENCRYPTION_FORWARD_SECURE, LOSS_RETRANSMISSION);
+    }
+    DrainIfNeeded();
+  }
+  // And the trace header.
+  EXPECT_EQ(kNumRecords + 1, writer_.records_written());
+  EXPECT_EQ(0u, writer_.records_dropped());
+
+  const size_t num_files = CloseLogger();
+  ASSERT_LT(2u, num_files);
+  QLogBinaryReader reader;
+  for (size_t i = 1; i <= num_files; ++i) {
+    const std::string contents = ReadFile(
+        spdlog::sinks::binary_file_sink_st::calc_filename(final_path_, i));
+    EXPECT_LE(contents.size(), kMaxFileSize) << "file " << i;
+    rapidjson::Document qlog;
+    EXPECT_TRUE(reader.ToJson(contents, qlog)) << "file " << i;
+    EXPECT_EQ(0u, reader.records_skipped()) << "file " << i;
+  }
+  // Each file starts with the trace header.
+  EXPECT_EQ(kNumRecords + num_files, reader.records_read());
+}
+
+TEST_F(QLogBinaryWriterTest, FullRingBufferDropsNewestRecords) {
+  const uint64_t kNumRecords = 500;
+  const std::vector<uint64_t> times =
+      RecordTimes(WriteWithoutDraining(kNumRecords));
+  ASSERT_FALSE(times.empty());
+  EXPECT_LT(0u, writer_.records_dropped());
+  EXPECT_EQ(kNumRecords, times.size() + writer_.records_dropped());
+  // The buffered records are kept; only new ones that no longer fit are
+  // dropped.
+  EXPECT_EQ(0u, times.front());
+  for (size_t i = 1; i < times.size(); ++i) {
+    EXPECT_LT(times[i - 1], times[i]);
+  }
+}
+
+TEST_F(QLogBinaryWriterTest, DiscardOldestEvictsOnlyWhatIsNeeded) {
+  writer_.set_discard_oldest_on_overflow(true);
+  const uint64_t kNumRecords = 500;
+  const std::vector<uint64_t> times =
+      RecordTimes(WriteWithoutDraining(kNumRecords));
+  ASSERT_FALSE(times.empty());
+  EXPECT_LT(0u, writer_.records_dropped());
+  EXPECT_EQ(kNumRecords, times.size() + writer_.records_dropped());
+  // The newest records survive, in order.
+  for (size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(kNumRecords - times.size() + i, times[i]);
+  }
+  // And fill the ring buffer, less than one record's worth of room aside.
+  EXPECT_LT(kRingBufferSize / 2, times.size() * 8);
+}
+
+// Summaries of long connections outgrow the 16-bit record body length.
+TEST_F(QLogBinaryWriterTest, LargeSummaryRoundTrips) {
+  std::string output;
+  writer_.set_overflow_sink([&output](const char* data, size_t length) {
+    output.append(data, length);
+  });
+  writer_.WriteFileHeader();
+  writer_.WriteTraceHeader(std::chrono::microseconds(1000),
+                           VantagePoint::IS_SERVER, "dcid", "scid",
+                           "QUIC_VERSION_IETF_RFC_V1", "127.0.0.1:443",
+                           "host");
+  const std::string large_value(3 * kQLogMaxRecordBodySize, 'x');
+  writer_.WriteJsonEvent(std::chrono::microseconds(7),
+                         "[\"7\",\"transport\",\"test\",\"" +
+                             large_value + "\"]");
+  writer_.WriteSummary("{\"large\":\"" + large_value + "\"}");
+  writer_.Drain([&output](const char* data, size_t length) {
+    output.append(data, length);
+  });
+  EXPECT_EQ(3u, writer_.records_written());
+  EXPECT_EQ(0u, writer_.records_dropped());
+
+  QLogBinaryReader reader;
+  rapidjson::Document qlog;
+  ASSERT_TRUE(reader.ToJson(output, qlog));
+  EXPECT_EQ(3u, reader.records_read());
+  EXPECT_EQ(0u, reader.records_skipped());
+  ASSERT_TRUE(qlog.HasMember("summary"));
+  EXPECT_EQ(large_value, qlog["summary"]["large"].GetString());
+  const rapidjson::Value& events = qlog["traces"][0]["events"];
+  ASSERT_EQ(1u, events.Size());
+  EXPECT_EQ(large_value, events[0][3].GetString());
+}
+
+TEST(QLogRingBufferTest, DiscardOldestDropsContinuations) {
+  QLogBinaryWriter writer(4 * kQLogMaxRecordBodySize);
+  writer.set_discard_oldest_on_overflow(true);
+  writer.WriteFileHeader();
+  writer.Drain([](const char*, size_t) {});
+  writer.WriteSummary(std::string(2 * kQLogMaxRecordBodySize, 'x'));
+  writer.WriteSummary(std::string(kQLogMaxRecordBodySize, 'y'));
+  // Only fits once the first summary, continuations included, is gone.
+  writer.WriteSummary(std::string(kQLogMaxRecordBodySize, 'z'));
+  EXPECT_EQ(3u, writer.records_written());
+  EXPECT_EQ(1u, writer.records_dropped());
+
+  std::string records;
+  writer.Drain([&records](const char* data, size_t length) {
+    records.append(data, length);
+  });
+  ASSERT_LT(0u, records.size());
+  EXPECT_EQ(static_cast<char>(QLogRecordType::SUMMARY), records[0]);
+  EXPECT_EQ(std::string::npos, records.find('x'));
+  EXPECT_NE(std::string::npos, records.find('y'));
+  EXPECT_NE(std::string::npos, records.find('z'));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,21 @@
+#include "base/bvc-qlog/src/qlog_queue_gauge.h"
+
+namespace quic {
+
+std::atomic<size_t> QLogQueueGauge::depth_{0};
+std::atomic<size_t> QLogQueueGauge::max_depth_{0};
+std::atomic<uint64_t> QLogQueueGauge::dropped_events_{0};
+
+void QLogQueueGauge::RecordDepth(size_t depth) {
+  depth_.store(depth, std::memory_order_relaxed);
+  size_t max_depth = max_depth_.load(std::memory_order_relaxed);
+  while (depth > max_depth &&
+         !max_depth_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+  }
+}
+
+void QLogQueueGauge::RecordDropped(uint64_t events) {
+  dropped_events_.fetch_add(events, std::memory_order_relaxed);
+}
+
+} // namespace quic
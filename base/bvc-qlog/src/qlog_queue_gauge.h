@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace quic {
+
+// Process wide view of the qlog thread pool queue shared by all FileQLoggers,
+// for operators sizing the pool. FileQLoggers report the queue depth they
+// observe while posting events and every event dropped by their overflow
+// policy.
+class QLogQueueGauge {
+ public:
+  static void RecordDepth(size_t depth);
+  static void RecordDropped(uint64_t events);
+
+  static size_t depth() { return depth_.load(std::memory_order_relaxed); }
+  static size_t max_depth() { return max_depth_.load(std::memory_order_relaxed); }
+  static uint64_t dropped_events() { return dropped_events_.load(std::memory_order_relaxed); }
+
+  // Starts a new max_depth() measurement period.
+  static void ResetMaxDepth() { max_depth_.store(depth(), std::memory_order_relaxed); }
+
+ private:
+  static std::atomic<size_t> depth_;
+  static std::atomic<size_t> max_depth_;
+  static std::atomic<uint64_t> dropped_events_;
+};
+
+} // namespace quic
@@ -0,0 +1,139 @@
+#include "base/bvc-qlog/src/qlog_summary_snapshot.h"
+
+#include <cstring>
+
+namespace quic {
+
+using rapidjson::Value;
+using rapidjson::Document;
+
+namespace {
+
+double DurationRatio(const QLogSummaryCounters& counters, uint64_t duration_us) {
+  return (counters.num_events == 0) ? 0 : (double)duration_us / counters.end_time_us;
+}
+
+double RoundRatio(double ratio) {
+  return ((int)(ratio * 10000 + 0.5)) / 10000.0;
+}
+
+} // namespace
+
+QLogSummarySnapshot::QLogSummarySnapshot(
+    const QLogSummaryCounters& initial,
+    std::shared_ptr<const QLogSummaryMaps> initial_maps)
+  : maps_(initial_maps),
+    reported_(initial),
+    reported_maps_(std::move(initial_maps)) {
+  uint64_t words[kWords] = {};
+  memcpy(words, &initial, sizeof(initial));
+  for (size_t i = 0; i < kWords; i++) {
+    words_[i].store(words[i], std::memory_order_relaxed);
+  }
+}
+
+void QLogSummarySnapshot::Publish(const QLogSummaryCounters& counters) {
+  uint64_t words[kWords] = {};
+  memcpy(words, &counters, sizeof(counters));
+
+  uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < kWords; i++) {
+    words_[i].store(words[i], std::memory_order_relaxed);
+  }
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void QLogSummarySnapshot::PublishMaps(std::shared_ptr<const QLogSummaryMaps> maps) {
+  std::atomic_store_explicit(&maps_, std::move(maps), std::memory_order_release);
+}
+
+QLogSummaryCounters QLogSummarySnapshot::Read() const {
+  uint64_t words[kWords];
+  uint64_t begin, end;
+  do {
+    begin = sequence_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < kWords; i++) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    end = sequence_.load(std::memory_order_relaxed);
+  } while ((begin & 1) != 0 || begin != end);
+
+  QLogSummaryCounters counters;
+  memcpy(&counters, words, sizeof(counters));
+  return counters;
+}
+
+std::shared_ptr<const QLogSummaryMaps> QLogSummarySnapshot::ReadMaps() const {
+  return std::atomic_load_explicit(&maps_, std::memory_order_acquire);
+}
+
+void QLogSummarySnapshot::Advance(
+    QLogSummaryCounters* current,
+    QLogSummaryCounters* previous,
+    std::shared_ptr<const QLogSummaryMaps>* current_maps,
+    std::shared_ptr<const QLogSummaryMaps>* previous_maps) {
+  *current = Read();
+  *current_maps = ReadMaps();
+  *previous = reported_;
+  *previous_maps = std::move(reported_maps_);
+  reported_ = *current;
+  reported_maps_ = *current_maps;
+}
+
+void QLogSummarySnapshot::AddReportSummary(
+    const QLogSummaryCounters& counters,
+    Value& value,
+    Document::AllocatorType& allocator) {
+  double duration = (counters.num_events == 0) ? 0 : (double)counters.end_time_us / 1000;
+  value.AddMember("total_bytes_sent", counters.total_bytes_sent, allocator);
+  value.AddMember("total_packets_sent", counters.total_packets_sent, allocator);
+  value.AddMember("total_bytes_recvd", counters.total_bytes_recvd, allocator);
+  value.AddMember("total_packets_recvd", counters.total_packets_recvd, allocator);
+  value.AddMember("total_packets_lost", counters.total_packets_lost, allocator);
+  value.AddMember("dropped_events", counters.dropped_events, allocator);
+  value.AddMember("quic_transport_version", Value(QuicVersionToString(counters.quic_version).c_str(), allocator).Move(), allocator);
+  value.AddMember("connection_duration", ((int)(duration * 100 + 0.5)) / 100.0, allocator);
+#ifndef QLOG_FOR_QBONE
+  double average_difference = (counters.num_of_congestion_message == 0) ? 0 : counters.sum_of_mean_deviation / counters.num_of_congestion_message;
+  value.AddMember("used_zero_rtt", counters.used_zero_rtt, allocator);
+  value.AddMember("smoothed_min_rtt", (int)(counters.smoothed_min_rtt / 10 + 0.5) / 100.0, allocator);
+  value.AddMember("smoothed_max_bandwidth", (int)((counters.smoothed_max_bandwidth / 8) * 100 + 0.5) / 100.0, allocator);
+  value.AddMember("average_difference", ((int)(average_difference * 100 + 0.5)) / 100.0, allocator);
+  if (counters.congestion_type == CongestionControlType::kBBR) {
+    value.AddMember("total_startup_duration", DurationInMs(counters.total_startup_duration), allocator);
+    value.AddMember("total_drain_duration", DurationInMs(counters.total_drain_duration), allocator);
+    value.AddMember("total_probebw_Duration", DurationInMs(counters.total_probebw_duration), allocator);
+    value.AddMember("total_probertt_duration", DurationInMs(counters.total_probertt_duration), allocator);
+    value.AddMember("total_not_recovery_duration", DurationInMs(counters.total_not_recovery_duration), allocator);
+    value.AddMember("total_growth_duration", DurationInMs(counters.total_growth_duration), allocator);
+    value.AddMember("total_conservation_duration", DurationInMs(counters.total_conservation_duration), allocator);
+    value.AddMember("congestion_type", "BBR", allocator);
+    value.AddMember("startup_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_startup_duration)), allocator);
+    value.AddMember("drain_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_drain_duration)), allocator);
+    value.AddMember("probebw_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_probebw_duration)), allocator);
+    value.AddMember("probertt_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_probertt_duration)), allocator);
+    value.AddMember("not_recovery_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_not_recovery_duration)), allocator);
+    value.AddMember("growth_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_growth_duration)), allocator);
+    value.AddMember("conservation_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_conservation_duration)), allocator);
+  } else if (counters.congestion_type == CongestionControlType::kBBRv2) {
+    value.AddMember("total_startup_duration", DurationInMs(counters.total_startup_duration), allocator);
+    value.AddMember("total_drain_duration", DurationInMs(counters.total_drain_duration), allocator);
+    value.AddMember("total_probebw_Duration", DurationInMs(counters.total_probebw_duration), allocator);
+    value.AddMember("total_probertt_duration", DurationInMs(counters.total_probertt_duration), allocator);
+    value.AddMember("congestion_type", "BBRv2", allocator);
+    value.AddMember("startup_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_startup_duration)), allocator);
+    value.AddMember("drain_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_drain_duration)), allocator);
+    value.AddMember("probebw_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_probebw_duration)), allocator);
+    value.AddMember("probertt_duration_ratio", RoundRatio(DurationRatio(counters, counters.total_probertt_duration)), allocator);
+  } else if (counters.congestion_type == CongestionControlType::kCubicBytes) {
+    value.AddMember("congestion_type", "Cubic", allocator);
+  } else {
+    // TODO : Other CC Algorithm
+  }
+#endif
+}
+
+} // namespace quic
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gquiche/quic/core/quic_types.h"
+#include "gquiche/quic/core/quic_versions.h"
+#include "rapidjson/document.h"
+
+namespace quic {
+
+// Raw values behind a connection's qlog summary. Ratios and rounded values
+// are derived when the summary is turned into JSON.
+struct QLogSummaryCounters {
+  uint64_t num_events = 0;
+  int64_t end_time_us = 0;
+  uint64_t total_bytes_sent = 0;
+  uint64_t total_packets_sent = 0;
+  uint64_t total_bytes_recvd = 0;
+  uint64_t total_packets_recvd = 0;
+  uint64_t total_packets_lost = 0;
+  uint64_t dropped_events = 0;
+  uint64_t total_startup_duration = 0;
+  uint64_t total_drain_duration = 0;
+  uint64_t total_probebw_duration = 0;
+  uint64_t total_probertt_duration = 0;
+  uint64_t total_not_recovery_duration = 0;
+  uint64_t total_growth_duration = 0;
+  uint64_t total_conservation_duration = 0;
+  double smoothed_min_rtt = 0;
+  double smoothed_max_bandwidth = 0;
+  double sum_of_mean_deviation = 0;
+  double num_of_congestion_message = 0;
+  QuicTransportVersion quic_version{};
+  CongestionControlType congestion_type{};
+  bool used_zero_rtt = false;
+};
+
+// Stream and request maps of a summary. They are published as immutable
+// copies, separately from the counters.
+struct QLogSummaryMaps {
+  std::vector<std::pair<std::size_t, std::size_t>> stream_map;
+#ifndef QLOG_FOR_QBONE
+  std::vector<std::pair<std::string, std::vector<int>>> uri_map;
+#endif
+};
+
+// Summary of one connection, written by the thread that owns the
+// FileQLogger and read by the qlog sink threads.
+//
+// The counters are published through a seqlock: the writer never waits and
+// never allocates, readers retry while a publish is in progress. Nothing is
+// converted to JSON until a reader asks for it.
+class QLogSummarySnapshot {
+ public:
+  QLogSummarySnapshot(const QLogSummaryCounters& initial,
+                      std::shared_ptr<const QLogSummaryMaps> initial_maps);
+  QLogSummarySnapshot(const QLogSummarySnapshot&) = delete;
+  QLogSummarySnapshot& operator=(const QLogSummarySnapshot&) = delete;
+
+  // Owner thread only.
+  void Publish(const QLogSummaryCounters& counters);
+  void PublishMaps(std::shared_ptr<const QLogSummaryMaps> maps);
+
+  // Any thread.
+  QLogSummaryCounters Read() const;
+  std::shared_ptr<const QLogSummaryMaps> ReadMaps() const;
+
+  // Returns the current summary and the one returned by the previous call,
+  // the initial summary on the first call. Only the sink writing the qlog
+  // file calls this, to report what changed since its last split.
+  void Advance(QLogSummaryCounters* current,
+               QLogSummaryCounters* previous,
+               std::shared_ptr<const QLogSummaryMaps>* current_maps,
+               std::shared_ptr<const QLogSummaryMaps>* previous_maps);
+
+  // Fills the "report_summary" object of the qlog summary.
+  static void AddReportSummary(const QLogSummaryCounters& counters,
+                               rapidjson::Value& value,
+                               rapidjson::Document::AllocatorType& allocator);
+
+  // Durations are reported in milliseconds with two decimals.
+  static double DurationInMs(uint64_t duration_us) {
+    return (int)(duration_us / 10 + 0.5) / 100.0;
+  }
+
+ private:
+  static_assert(std::is_trivially_copyable<QLogSummaryCounters>::value,
+                "QLogSummaryCounters is copied word by word");
+  static constexpr size_t kWords =
+      (sizeof(QLogSummaryCounters) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint64_t> words_[kWords];
+  std::shared_ptr<const QLogSummaryMaps> maps_;
+
+  QLogSummaryCounters reported_;
+  std::shared_ptr<const QLogSummaryMaps> reported_maps_;
+};
+
+} // namespace quic
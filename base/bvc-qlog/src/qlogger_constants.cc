@@ -209,4 +209,20 @@ quiche::QuicheStringPiece toQlogString(QuicConnectionCloseType close_type) {
   return "invalid_type";
 }
 
+bool ParseQLogOverflowPolicy(quiche::QuicheStringPiece name,
+                             QLogOverflowPolicy* policy) {
+  if (name == "block") {
+    *policy = QLogOverflowPolicy::BLOCK;
+  } else if (name == "drop_newest") {
+    *policy = QLogOverflowPolicy::DROP_NEWEST;
+  } else if (name == "drop_oldest") {
+    *policy = QLogOverflowPolicy::DROP_OLDEST;
+  } else if (name == "sample") {
+    *policy = QLogOverflowPolicy::SAMPLE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 }// namespace quic
@@ -91,6 +91,67 @@ constexpr quiche::QuicheStringPiece kQLogClientVantagePoint = "client";
 
 using VantagePoint = Perspective;
 
+// On-disk format of streaming qlogs. BINARY writes compact records (see
+// qlog_binary_format.h) that qlog_binary_converter turns back into JSON.
+enum class QLogOutputFormat : uint8_t {
+  JSON,
+  BINARY,
+};
+
+// Per connection filter applied by ConnectionDebugVisitor before any qlog
+// event is built. Packet events are kept for one packet out of every sample
+// interval, 0 drops them all. Filtered packets still count towards the
+// summary. Congestion, recovery and connection close events are always kept.
+// Usually built from the embedder's config and handed to FileQLogger, whose
+// ConnectionDebugVisitors pick it up.
+struct QLogFilter {
+  uint32_t packet_sent_sample_interval = 1;
+  uint32_t packet_received_sample_interval = 1;
+};
+
+// What a FileQLogger does when the shared logging thread pool falls behind.
+// BLOCK waits for room in the queue (the previous behavior). The others never
+// wait and count what they give up in the summary's dropped_events:
+//   DROP_NEWEST  drops the events that are about to be posted, and binary
+//                records once the connection's ring buffer is full.
+//   DROP_OLDEST  holds events back in the connection and, when that backlog
+//                is full, drops its oldest events until the new ones fit.
+//   SAMPLE       keeps one event out of every sample interval once the queue
+//                is half full and drops everything once it is full.
+enum class QLogOverflowPolicy : uint8_t {
+  BLOCK,
+  DROP_NEWEST,
+  DROP_OLDEST,
+  SAMPLE,
+};
+
+// The queue counts as full at this share of its capacity, leaving room for
+// the file head and summary messages that are always posted.
+constexpr double kQLogQueueHighWatermark = 0.9;
+constexpr uint32_t kQLogDefaultSampleInterval = 8;
+// Overflow handling of one FileQLogger, usually built once from the
+// embedder's config and shared by every connection. |queue_capacity| is the
+// queue size the shared thread pool was created with; BLOCK ignores it.
+struct QLogOverflowConfig {
+  QLogOverflowPolicy policy = QLogOverflowPolicy::BLOCK;
+  size_t queue_capacity = 0;
+  uint32_t sample_interval = kQLogDefaultSampleInterval;
+};
+
+// Parses the names used in config files: "block", "drop_newest",
+// "drop_oldest" and "sample". Returns false for anything else.
+bool ParseQLogOverflowPolicy(quiche::QuicheStringPiece name,
+                             QLogOverflowPolicy* policy);
+
+// Largest JSON backlog a connection holds back under DROP_OLDEST.
+constexpr size_t kQLogMaxPendingBytes = 64 * 1024;
+// With BLOCK the queue depth is only sampled for the gauge every this many
+// posts.
+constexpr uint32_t kQLogQueueGaugeInterval = 16;
+// The summary's stream and request maps are copied for the file sink when
+// they grow, and otherwise only every this many summary updates.
+constexpr uint64_t kQLogSummaryMapRefreshInterval = 64;
+
 quiche::QuicheStringPiece vantagePointString(VantagePoint vantage_point);
 
 quiche::QuicheStringPiece toQlogString(QuicFrameType frame);
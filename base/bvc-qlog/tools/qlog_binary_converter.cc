@@ -0,0 +1,66 @@
+// Converts binary qlog files (.bqlog) written by FileQLogger into the JSON
+// qlog format understood by qvis.
+//
+// Usage: qlog_binary_converter [--pretty] <input.bqlog> [output.qlog]
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "base/bvc-qlog/src/qlog_binary_reader.h"
+
+int main(int argc, char* argv[]) {
+  bool pretty_json = false;
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "--pretty") == 0) {
+    pretty_json = true;
+    ++arg;
+  }
+  if (arg >= argc) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--pretty] <input.bqlog> [output.qlog]" << std::endl;
+    return 1;
+  }
+
+  std::string input_path = argv[arg++];
+  std::string output_path;
+  if (arg < argc) {
+    output_path = argv[arg];
+  } else {
+    output_path = input_path;
+    size_t pos = output_path.rfind(quic::kQLogBinaryFileExtension);
+    if (pos != std::string::npos) {
+      output_path.erase(pos);
+    }
+    output_path += quic::kQLogJsonFileExtension;
+  }
+
+  std::ifstream input(input_path, std::ios::binary);
+  if (!input) {
+    std::cerr << "Failed to open " << input_path << std::endl;
+    return 1;
+  }
+  std::stringstream contents;
+  contents << input.rdbuf();
+  std::string data = contents.str();
+
+  quic::QLogBinaryReader reader;
+  std::string json;
+  if (!reader.ToJsonString(data, &json, pretty_json)) {
+    std::cerr << input_path << " is not a binary qlog file" << std::endl;
+    return 1;
+  }
+
+  std::ofstream output(output_path, std::ios::trunc);
+  if (!output) {
+    std::cerr << "Failed to open " << output_path << std::endl;
+    return 1;
+  }
+  output << json;
+  std::cout << "Converted " << reader.records_read() << " records ("
+            << reader.records_skipped() << " skipped) to " << output_path
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+#include "base/sinks/binary_file_sink.h"
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <tuple>
+
+#include "spdlog/common.h"
+#include "spdlog/details/file_helper.h"
+#include "spdlog/fmt/fmt.h"
+
+namespace spdlog {
+namespace sinks {
+
+template<typename Mutex>
+SPDLOG_INLINE binary_file_sink<Mutex>::binary_file_sink(
+  filename_t base_filename, filename_t final_filename, std::size_t max_size,
+  std::size_t max_files, std::string file_head, std::size_t free_file_number)
+  : base_filename_(std::move(base_filename)),
+    final_filename_(std::move(final_filename)),
+    max_size_(max_size),
+    max_files_(max_files),
+    free_file_number_(free_file_number),
+    file_head_(std::move(file_head)) {
+  file_helper_.open(base_filename_, true);
+  file_helper_.write(file_head_);
+  current_size_ = file_head_.size();
+}
+
+// e.g. calc_filename("logs/mylog.bqlog, 3) => "logs/mylog_3.bqlog".
+template<typename Mutex>
+SPDLOG_INLINE filename_t binary_file_sink<Mutex>::calc_filename(const filename_t &filename, std::size_t index) {
+  if (index == 0u) {
+    return filename;
+  }
+
+  filename_t basename, ext;
+  std::tie(basename, ext) = details::file_helper::split_by_extension(filename);
+  return fmt::format(SPDLOG_FILENAME_T("{}_{}{}"), basename, index, ext);
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
+  memory_buf_t formatted;
+  base_sink<Mutex>::formatter_->format(msg, formatted);
+  if (formatted.size() == 0) {
+    return;
+  }
+  // Messages are whole records, so rotating before the message that would
+  // cross max_size keeps every record in one file. A file always takes at
+  // least one message, even one larger than max_size.
+  if (current_size_ > file_head_.size() &&
+      current_size_ + formatted.size() > max_size_) {
+    flush_();
+    sequence_();
+    file_helper_.write(file_head_);
+    current_size_ = file_head_.size();
+
+    free_file_number_ = (free_file_number_ + 1) % max_files_;
+    if (free_file_number_ == 0)
+      free_file_number_ = 1;
+  }
+  file_helper_.write(formatted, 0);
+  current_size_ += formatted.size();
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::flush_() {
+  file_helper_.flush();
+}
+
+// $Path/tmp/Cid/Cid.bqlog  ->  $Path/Cid/Cid_1.bqlog, Cid_2.bqlog, ...
+template<typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sequence_() {
+  file_helper_.close();
+
+  filename_t target = calc_filename(final_filename_, free_file_number_);
+  if (!path_exists(target)) {
+    details::os::create_dir(details::os::dir_name(target));
+  }
+  (void)details::os::remove(target);
+  if (details::os::rename(base_filename_, target) != 0) {
+    std::cout<<"binary_file_sink: failed renaming " + details::os::filename_to_str(base_filename_) +
+               " to " + details::os::filename_to_str(target)<<std::endl;
+  }
+  file_helper_.reopen(true);
+}
+
+} // namespace sinks
+} // namespace spdlog
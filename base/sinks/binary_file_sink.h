@@ -0,0 +1,68 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include "customize_file_helper.h"
+
+#include "spdlog/sinks/base_sink.h"
+#include "spdlog/details/null_mutex.h"
+
+namespace spdlog {
+namespace sinks {
+
+using details::os::path_exists;
+//
+// sequence file sink for binary qlog records. Every message must hold whole
+// records and is written as-is; when the next message would grow the file
+// past max_size the file is moved to the next final file and the new file
+// starts with file_head, so every split file can be decoded on its own.
+//
+template<typename Mutex>
+class binary_file_sink final : public base_sink<Mutex> {
+public:
+  binary_file_sink(filename_t base_filename,
+                   filename_t final_filename,
+                   std::size_t max_size,
+                   std::size_t max_files,
+                   std::string file_head,
+                   std::size_t free_file_number = 1);
+
+  ~binary_file_sink() {
+    file_helper_.close();
+    filename_t target = calc_filename(final_filename_, free_file_number_);
+    if (!path_exists(target)) {
+      spdlog::details::os::create_dir(spdlog::details::os::dir_name(target));
+    }
+    std::rename(base_filename_.c_str(), target.c_str());
+  }
+
+  static filename_t calc_filename(const filename_t &filename, std::size_t index);
+
+protected:
+  void sink_it_(const details::log_msg &msg) override;
+  void flush_() override;
+
+private:
+  void sequence_();
+
+  filename_t base_filename_;
+  filename_t final_filename_;
+  std::size_t max_size_;
+  std::size_t max_files_;
+  std::size_t free_file_number_;
+  std::size_t current_size_;
+  std::string file_head_;
+
+  details::customize_file_helper file_helper_;
+};
+
+using binary_file_sink_mt = binary_file_sink<std::mutex>;
+using binary_file_sink_st = binary_file_sink<details::null_mutex>;
+
+} // namespace sinks
+} // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+#include "base/sinks/binary_file_sink-inl.h"
+#endif
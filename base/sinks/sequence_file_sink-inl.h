@@ -23,7 +23,7 @@ template<typename Mutex>
 
 SPDLOG_INLINE sequence_file_sink<Mutex>::sequence_file_sink(
   filename_t base_filename, filename_t final_filename, std::size_t max_size, std::size_t max_files, std::string metadata_head, 
-  std::string metadata_tail, std::shared_ptr<Document> last_summary, std::shared_ptr<Document> pre_summary, std::shared_ptr<quic::QuicMutex> lock, std::size_t free_file_number)
+  std::string metadata_tail, std::shared_ptr<quic::QLogSummarySnapshot> summary, std::size_t free_file_number)
   : base_filename_(std::move(base_filename)),
     final_filename_(std::move(final_filename)), 	
     max_size_(max_size),
@@ -31,9 +31,7 @@ SPDLOG_INLINE sequence_file_sink<Mutex>::sequence_file_sink(
     free_file_number_(free_file_number),
     metadata_head_(metadata_head),
     metadata_tail_(metadata_tail),
-    last_summary_(last_summary),
-    pre_summary_(pre_summary),
-    lock_(lock){
+    summary_(std::move(summary)){
   //file open
   file_helper_.open(calc_filename(base_filename_, 0),true);
   current_size_ = file_helper_.size(); // expensive. called only once
@@ -118,50 +116,44 @@ SPDLOG_INLINE std::string sequence_file_sink<Mutex>::currentSummary() {
   std::string msg;   
   absl::StrAppend(&msg, "\"summary\":");
 
-  lock_->WriterLock();
-  Document pre_summary;
-  pre_summary.CopyFrom(*pre_summary_, pre_summary.GetAllocator());
-
-  Document last_summary,tmp_summary;
-  last_summary.CopyFrom(*last_summary_, last_summary.GetAllocator());
-  tmp_summary.CopyFrom(*last_summary_, tmp_summary.GetAllocator());  
-  *pre_summary_ = std::move(tmp_summary);  
-  lock_->WriterUnlock(); 
+  // Built only here, when a file is split: the connection just publishes
+  // raw counters.
+  quic::QLogSummaryCounters last_summary, pre_summary;
+  std::shared_ptr<const quic::QLogSummaryMaps> last_maps, pre_maps;
+  summary_->Advance(&last_summary, &pre_summary, &last_maps, &pre_maps);
 
   Document summary;
   summary.SetObject();
   Document::AllocatorType& summary_allocator = summary.GetAllocator();
 
   Value key,value;
-  summary.AddMember("trace_count", last_summary["trace_count"].GetInt64(), summary_allocator);   
-  summary.AddMember("max_duration", last_summary["max_duration"].GetInt64(), summary_allocator);  
-  summary.AddMember("total_event_count", last_summary["total_event_count"].GetInt64() - pre_summary["total_event_count"].GetInt64(), summary_allocator);  
+  summary.AddMember("trace_count", 1, summary_allocator);   
+  summary.AddMember("max_duration", (last_summary.num_events == 0) ? 0 : last_summary.end_time_us / 1000, summary_allocator);  
+  summary.AddMember("total_event_count", last_summary.num_events - pre_summary.num_events, summary_allocator);  
 
+  quic::QLogSummaryCounters delta = last_summary;
+  delta.total_bytes_sent -= pre_summary.total_bytes_sent;
+  delta.total_bytes_recvd -= pre_summary.total_bytes_recvd;
+  delta.total_packets_recvd -= pre_summary.total_packets_recvd;
+  delta.total_packets_sent -= pre_summary.total_packets_sent;
+  delta.total_packets_lost -= pre_summary.total_packets_lost;
   value.SetObject();
-  value = std::move(last_summary["report_summary"]);
-  value["total_bytes_sent"] = value["total_bytes_sent"].GetInt64() - pre_summary["report_summary"]["total_bytes_sent"].GetInt64();
-  value["total_bytes_recvd"] = value["total_bytes_recvd"].GetInt64() - pre_summary["report_summary"]["total_bytes_recvd"].GetInt64();
-  value["total_packets_recvd"] = value["total_packets_recvd"].GetInt64() - pre_summary["report_summary"]["total_packets_recvd"].GetInt64();
-  value["total_packets_sent"] = value["total_packets_sent"].GetInt64() - pre_summary["report_summary"]["total_packets_sent"].GetInt64();
-  value["total_packets_lost"] = value["total_packets_lost"].GetInt64() - pre_summary["report_summary"]["total_packets_lost"].GetInt64();
-  if(value["congestion_type"] != "Cubic") {
-    value.AddMember("pre_startup_duration", value["total_startup_duration"].GetDouble() - pre_summary["report_summary"]["total_startup_duration"].GetDouble(), summary_allocator);
-    value.AddMember("pre_drain_duration", value["total_drain_duration"].GetDouble() - pre_summary["report_summary"]["total_drain_duration"].GetDouble(), summary_allocator);
-    value.AddMember("pre_probebw_duration", value["total_probebw_duration"].GetDouble() - pre_summary["report_summary"]["total_probebw_duration"].GetDouble(), summary_allocator);
-    value.AddMember("pre_probertt_duration", value["total_probertt_duration"].GetDouble() - pre_summary["report_summary"]["total_probertt_duration"].GetDouble(), summary_allocator);
+  quic::QLogSummarySnapshot::AddReportSummary(delta, value, summary_allocator);
+#ifndef QLOG_FOR_QBONE
+  if (last_summary.congestion_type == quic::kBBR || last_summary.congestion_type == quic::kBBRv2) {
+    using quic::QLogSummarySnapshot;
+    value.AddMember("pre_startup_duration", QLogSummarySnapshot::DurationInMs(last_summary.total_startup_duration) - QLogSummarySnapshot::DurationInMs(pre_summary.total_startup_duration), summary_allocator);
+    value.AddMember("pre_drain_duration", QLogSummarySnapshot::DurationInMs(last_summary.total_drain_duration) - QLogSummarySnapshot::DurationInMs(pre_summary.total_drain_duration), summary_allocator);
+    value.AddMember("pre_probebw_duration", QLogSummarySnapshot::DurationInMs(last_summary.total_probebw_duration) - QLogSummarySnapshot::DurationInMs(pre_summary.total_probebw_duration), summary_allocator);
+    value.AddMember("pre_probertt_duration", QLogSummarySnapshot::DurationInMs(last_summary.total_probertt_duration) - QLogSummarySnapshot::DurationInMs(pre_summary.total_probertt_duration), summary_allocator);
   }
+#endif
   summary.AddMember("report_summary", value, summary_allocator);
 
   std::unordered_map<std::size_t, std::size_t> last_stream;
   std::unordered_map<std::size_t, std::size_t> pre_stream;
-  auto lastStream_arr = last_summary["stream_map"].GetArray();
-  auto preStream_arr = pre_summary["stream_map"].GetArray();
-  for(auto it = lastStream_arr.Begin(); it != lastStream_arr.End(); it++) {
-    last_stream.insert({(*it)[0].GetInt64(), (*it)[1].GetInt64()});
-  }
-  for(auto it = preStream_arr.Begin(); it != preStream_arr.End(); it++) {
-    pre_stream.insert({(*it)[0].GetInt64(), (*it)[1].GetInt64()});
-  }
+  last_stream.insert(last_maps->stream_map.begin(), last_maps->stream_map.end());
+  pre_stream.insert(pre_maps->stream_map.begin(), pre_maps->stream_map.end());
   std::unordered_set<std::size_t> res;  
   for(auto it = last_stream.begin(); it!= last_stream.end(); it++) {
     res.insert(it->first);
@@ -184,19 +176,18 @@ SPDLOG_INLINE std::string sequence_file_sink<Mutex>::currentSummary() {
   summary.AddMember("stream_map", value, summary_allocator);
 #else
   std::unordered_map<std::string, std::vector<int>> last_map;
-  auto lastMap_arr = last_summary["uri_map"].GetArray();  
-  for(auto it = lastMap_arr.Begin(); it != lastMap_arr.End(); it++) {
+  for(auto it = last_maps->uri_map.begin(); it != last_maps->uri_map.end(); it++) {
     std::vector<int> temp_vector;
-    for(auto vector_it =(*it)[1].GetArray().Begin(); vector_it!= (*it)[1].GetArray().End(); vector_it++) {
-      if(res.find(vector_it->GetInt64()) == res.end()) {
+    for(auto vector_it = it->second.begin(); vector_it != it->second.end(); vector_it++) {
+      if(res.find(*vector_it) == res.end()) {
         continue;
       }
-      temp_vector.push_back(vector_it->GetInt64());
+      temp_vector.push_back(*vector_it);
     }
     if(temp_vector.size() == 0 ){
       continue;
     }
-    last_map.insert({(*it)[0].GetString(), temp_vector});
+    last_map.insert({it->first, temp_vector});
   }
   
   Value uriMap_value;
@@ -7,8 +7,8 @@
 #include <vector>
 
 #include "customize_file_helper.h"
+#include "base/bvc-qlog/src/qlog_summary_snapshot.h"
 #include "base/bvc-qlog/src/qlogger_types.h"
-#include "gquiche/quic/platform/api/quic_mutex.h"
 
 #include "spdlog/sinks/base_sink.h"
 #include "spdlog/details/file_helper.h"
@@ -19,7 +19,6 @@
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
 
-using quic::QuicMutex;
 namespace spdlog {
 namespace sinks {
 
@@ -37,9 +36,7 @@ public:
                      std::size_t max_files,
                      std::string metadata_head,
                      std::string metadata_tail,
-                     std::shared_ptr<Document> last_summary,
-                     std::shared_ptr<Document> pre_summary,
-		     std::shared_ptr<quic::QuicMutex> lock,
+                     std::shared_ptr<quic::QLogSummarySnapshot> summary,
                      std::size_t free_file_number = 1 );
   static filename_t calc_filename(const filename_t &filename, std::size_t index);
 
@@ -75,9 +72,7 @@ private:
   size_t metadata_head_size_;
   size_t metadata_tail_size_;
    
-  std::shared_ptr<Document> last_summary_;
-  std::shared_ptr<Document> pre_summary_;
-  std::shared_ptr<quic::QuicMutex> lock_;
+  std::shared_ptr<quic::QLogSummarySnapshot> summary_;
 
   details::customize_file_helper file_helper_;
 
@@ -31,6 +31,13 @@ class QUICHE_EXPORT_PRIVATE QuicheMemSlice {
   QuicheMemSlice(std::unique_ptr<char[]> buffer, size_t length)
       : impl_(std::move(buffer), length) {}
 
+  // Constructs a QuicheMemSlice of the |length| bytes at |buffer| without
+  // copying them. |owner| keeps them alive as long as the slice does, e.g. a
+  // cached response body shared by the streams sending it.
+  QuicheMemSlice(std::shared_ptr<const void> owner, const char* buffer,
+                 size_t length)
+      : impl_(std::move(owner), buffer, length) {}
+
   // Ensures the use of the in-place constructor (below) is intentional.
   struct InPlace {};
 
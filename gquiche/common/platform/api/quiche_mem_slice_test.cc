@@ -6,6 +6,7 @@
 
 #include <cstring>
 #include <memory>
+#include <string>
 
 #include "absl/strings/string_view.h"
 #include "gquiche/common/platform/api/quiche_test.h"
@@ -99,6 +100,24 @@ TEST_F(QuicheMemSliceTest, SliceFromBuffer) {
   EXPECT_EQ(slice.length(), kTestString.length());
 }
 
+TEST_F(QuicheMemSliceTest, SliceSharingOwnedData) {
+  auto body = std::make_shared<const std::string>("shared response body");
+  QuicheMemSlice slice(body, body->data() + 7, 8);
+  EXPECT_EQ(body->data() + 7, slice.data());
+  EXPECT_EQ("response", slice.AsStringView());
+  EXPECT_EQ(2, body.use_count());
+
+  QuicheMemSlice moved = std::move(slice);
+  EXPECT_EQ("response", moved.AsStringView());
+  EXPECT_EQ(nullptr, slice.data());  // NOLINT(bugprone-use-after-move)
+  EXPECT_TRUE(slice.empty());
+  EXPECT_EQ(2, body.use_count());
+
+  moved.Reset();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(1, body.use_count());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quiche
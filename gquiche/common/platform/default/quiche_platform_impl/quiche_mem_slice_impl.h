@@ -1,6 +1,9 @@
 #ifndef QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_MEM_SLICE_IMPL_H_
 #define QUICHE_COMMON_PLATFORM_DEFAULT_QUICHE_PLATFORM_IMPL_QUICHE_MEM_SLICE_IMPL_H_
 
+#include <memory>
+#include <utility>
+
 #include "gquiche/common/platform/api/quiche_export.h"
 #include "gquiche/common/quiche_buffer_allocator.h"
 #include "gquiche/common/simple_buffer_allocator.h"
@@ -21,6 +24,10 @@ class QUICHE_EXPORT_PRIVATE QuicheMemSliceImpl {
                              QuicheBufferDeleter(SimpleBufferAllocator::Get())),
                          length)) {}
 
+  QuicheMemSliceImpl(std::shared_ptr<const void> owner, const char* buffer,
+                     size_t length)
+      : owner_(std::move(owner)), shared_data_(buffer), shared_length_(length) {}
+
   QuicheMemSliceImpl(const QuicheMemSliceImpl& other) = delete;
   QuicheMemSliceImpl& operator=(const QuicheMemSliceImpl& other) = delete;
 
@@ -31,14 +38,27 @@ class QUICHE_EXPORT_PRIVATE QuicheMemSliceImpl {
 
   ~QuicheMemSliceImpl() = default;
 
-  void Reset() { buffer_ = QuicheBuffer(); }
+  void Reset() {
+    buffer_ = QuicheBuffer();
+    owner_.reset();
+  }
 
-  const char* data() const { return buffer_.data(); }
-  size_t length() const { return buffer_.size(); }
-  bool empty() const { return buffer_.empty(); }
+  const char* data() const {
+    return owner_ != nullptr ? shared_data_ : buffer_.data();
+  }
+  size_t length() const {
+    return owner_ != nullptr ? shared_length_ : buffer_.size();
+  }
+  bool empty() const { return length() == 0; }
 
  private:
   QuicheBuffer buffer_;
+  // If set, the slice is the |shared_length_| bytes at |shared_data_|, which
+  // |owner_| keeps alive, instead of |buffer_|. Moving from the slice clears
+  // it.
+  std::shared_ptr<const void> owner_;
+  const char* shared_data_ = nullptr;
+  size_t shared_length_ = 0;
 };
 
 }  // namespace quiche
@@ -0,0 +1,145 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_batch_writer.h"
+
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The packets sent per submission.
+constexpr uint32_t kRingEntries = 64;
+
+}  // namespace
+
+QuicIoUringBatchWriter::QuicIoUringBatchWriter(
+    std::unique_ptr<QuicBatchWriterBuffer> batch_buffer, int fd)
+    : QuicSendmmsgBatchWriter(std::move(batch_buffer), fd),
+      use_sendmmsg_(false) {}
+
+QuicIoUringBatchWriter::FlushImplResult QuicIoUringBatchWriter::FlushImpl() {
+  if (!use_sendmmsg_ && !ring_.initialized() &&
+      !ring_.Initialize(kRingEntries)) {
+    QUIC_LOG(WARNING) << "Failed to set up io_uring, sending with sendmmsg: "
+                      << strerror(errno);
+    use_sendmmsg_ = true;
+  }
+  if (use_sendmmsg_) {
+    return QuicSendmmsgBatchWriter::FlushImpl();
+  }
+
+  QUICHE_DCHECK(!IsWriteBlocked());
+  QUICHE_DCHECK(!buffered_writes().empty());
+
+  FlushImplResult result = {WriteResult(WRITE_STATUS_OK, 0),
+                            /*num_packets_sent=*/0, /*bytes_written=*/0};
+  WriteResult& write_result = result.write_result;
+
+  auto first = buffered_writes().cbegin();
+  const auto last = buffered_writes().cend();
+  while (first != last) {
+    const auto chunk_last =
+        first + std::min<ptrdiff_t>(std::distance(first, last), kRingEntries);
+    QuicMMsgHdr mhdr(
+        first, chunk_last, kCmsgSpaceForIp,
+        [](QuicMMsgHdr* mhdr, int i, const BufferedWrite& buffered_write) {
+          mhdr->SetIpInNextCmsg(i, buffered_write.self_address);
+        });
+
+    int num_packets_sent;
+    write_result = WriteMultiplePackets(&mhdr, &num_packets_sent);
+    QUIC_DVLOG(1) << "WriteMultiplePackets sent " << num_packets_sent
+                  << " out of " << mhdr.num_msgs()
+                  << " packets. WriteResult=" << write_result;
+
+    if (write_result.status != WRITE_STATUS_OK) {
+      QUICHE_DCHECK_EQ(0, num_packets_sent);
+      break;
+    }
+
+    first += num_packets_sent;
+
+    result.num_packets_sent += num_packets_sent;
+    result.bytes_written += write_result.bytes_written;
+  }
+
+  // Call PopBufferedWrite() even if write_result.status is not WRITE_STATUS_OK,
+  // to deal with partial writes.
+  batch_buffer().PopBufferedWrite(result.num_packets_sent);
+
+  if (write_result.status != WRITE_STATUS_OK) {
+    return result;
+  }
+
+  QUIC_BUG_IF(quic_io_uring_batch_writer_not_flushed,
+              !buffered_writes().empty())
+      << "All packets should have been written on a successful return";
+  write_result.bytes_written = result.bytes_written;
+  return result;
+}
+
+WriteResult QuicIoUringBatchWriter::WriteMultiplePackets(
+    QuicMMsgHdr* mhdr, int* num_packets_sent) {
+  *num_packets_sent = 0;
+  const int num_msgs = mhdr->num_msgs();
+  for (int i = 0; i < num_msgs; ++i) {
+    io_uring_sqe* sqe = ring_.GetSqe();
+    QUICHE_DCHECK(sqe != nullptr);
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd();
+    sqe->addr = reinterpret_cast<uint64_t>(&mhdr->mhdr()[i].msg_hdr);
+    sqe->msg_flags = MSG_DONTWAIT;
+    sqe->flags = i + 1 < num_msgs ? IOSQE_IO_LINK : 0;
+    sqe->user_data = i;
+  }
+
+  // Waits for the whole chain, whose requests reference |mhdr|.
+  int result = ring_.Submit(num_msgs, QuicTime::Delta::Infinite());
+  if (result < 0 && result != -EINTR) {
+    // Nothing was submitted, and the requests cannot be taken back.
+    QUIC_LOG(ERROR) << "io_uring_enter() failed, sending with sendmmsg: "
+                    << strerror(-result);
+    use_sendmmsg_ = true;
+    return QuicLinuxSocketUtils::WriteMultiplePackets(fd(), mhdr,
+                                                      num_packets_sent);
+  }
+  while (ring_.PeekCqe(num_msgs - 1) == nullptr) {
+    ring_.Submit(num_msgs, QuicTime::Delta::Infinite());
+  }
+
+  // The requests complete in order, but the completions of the cancelled
+  // ones may come first.
+  int first_error = 0;
+  int first_failed = num_msgs;
+  for (int i = 0; i < num_msgs; ++i) {
+    const io_uring_cqe* cqe = ring_.PeekCqe(i);
+    const int index = static_cast<int>(cqe->user_data);
+    if (cqe->res < 0 && index < first_failed) {
+      first_failed = index;
+      first_error = -cqe->res;
+    }
+  }
+  ring_.ConsumeCqes(num_msgs);
+
+  *num_packets_sent = first_failed;
+  if (first_failed > 0) {
+    return WriteResult(WRITE_STATUS_OK, mhdr->num_bytes_sent(first_failed));
+  }
+  return WriteResult((first_error == EAGAIN || first_error == EWOULDBLOCK)
+                         ? WRITE_STATUS_BLOCKED
+                         : WRITE_STATUS_ERROR,
+                     first_error);
+}
+
+}  // namespace quic
@@ -0,0 +1,46 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_BATCH_WRITER_H_
+#define QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_BATCH_WRITER_H_
+
+#include <memory>
+
+#include "gquiche/quic/core/batch_writer/quic_sendmmsg_batch_writer.h"
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/quic_linux_socket_utils.h"
+
+namespace quic {
+
+// Sends a batch of packets, to any peers, as a chain of linked sendmsg
+// requests on an io_uring(7), submitted and completed in one system call.
+// The requests do not wait for the socket to become writable: the first one
+// that would block fails, cancelling the rest of the chain, so that like
+// with sendmmsg the packets sent are always the first ones of the batch.
+//
+// The ring is set up by the first flush, on the thread running the event
+// loop. If that fails, the writer falls back to sendmmsg.
+class QUIC_EXPORT_PRIVATE QuicIoUringBatchWriter
+    : public QuicSendmmsgBatchWriter {
+ public:
+  QuicIoUringBatchWriter(std::unique_ptr<QuicBatchWriterBuffer> batch_buffer,
+                         int fd);
+
+  FlushImplResult FlushImpl() override;
+
+ private:
+  // Sends the packets of |mhdr| and sets |num_packets_sent| to the number of
+  // packets sent. Returns the result of the first failed send, if no packet
+  // was sent.
+  WriteResult WriteMultiplePackets(QuicMMsgHdr* mhdr, int* num_packets_sent);
+
+  QuicIoUring ring_;
+  // True if io_uring could not be set up, and packets are sent with
+  // sendmmsg.
+  bool use_sendmmsg_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_BATCH_WRITER_H_
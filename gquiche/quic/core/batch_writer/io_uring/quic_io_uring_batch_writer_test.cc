@@ -0,0 +1,167 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_batch_writer.h"
+
+#include <sys/socket.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+#include "gquiche/quic/platform/api/quic_ip_address.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/platform/api/quic_socket_address.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const size_t kPacketSize = 100;
+
+class TestQuicIoUringBatchWriter : public QuicIoUringBatchWriter {
+ public:
+  using QuicIoUringBatchWriter::batch_buffer;
+  using QuicIoUringBatchWriter::buffered_writes;
+  using QuicIoUringBatchWriter::QuicIoUringBatchWriter;
+};
+
+class QuicIoUringBatchWriterTest : public QuicTest {
+ protected:
+  QuicIoUringBatchWriterTest() : self_fd_(-1), peer_fd_(-1) {}
+
+  ~QuicIoUringBatchWriterTest() override {
+    if (self_fd_ >= 0) {
+      socket_api_.Destroy(self_fd_);
+    }
+    if (peer_fd_ >= 0) {
+      socket_api_.Destroy(peer_fd_);
+    }
+  }
+
+  // Returns false, after logging why, if the test should be skipped.
+  bool CreateSockets() {
+    if (!QuicIoUring::IsSupported()) {
+      QUIC_LOG(WARNING) << "Test skipped since io_uring is not supported.";
+      return false;
+    }
+    self_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                  kDefaultSocketReceiveBuffer);
+    peer_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                  kDefaultSocketReceiveBuffer);
+    EXPECT_LE(0, self_fd_);
+    EXPECT_LE(0, peer_fd_);
+    const QuicSocketAddress any(QuicIpAddress::Loopback4(), 0);
+    EXPECT_TRUE(socket_api_.Bind(self_fd_, any));
+    EXPECT_TRUE(socket_api_.Bind(peer_fd_, any));
+    EXPECT_EQ(0, peer_address_.FromSocket(peer_fd_));
+    writer_ = std::make_unique<TestQuicIoUringBatchWriter>(
+        std::make_unique<QuicBatchWriterBuffer>(), self_fd_);
+    return true;
+  }
+
+  // Buffers |count| packets to |peer_address|, each starting with its index.
+  void BufferPackets(int count, const QuicSocketAddress& peer_address) {
+    for (int i = 0; i < count; ++i) {
+      char buffer[kPacketSize] = {};
+      memcpy(buffer, &next_index_, sizeof(next_index_));
+      ++next_index_;
+      ASSERT_TRUE(writer_->batch_buffer()
+                      .PushBufferedWrite(buffer, sizeof(buffer),
+                                         QuicIpAddress::Loopback4(),
+                                         peer_address, nullptr, 0)
+                      .succeeded);
+    }
+  }
+
+  // Returns the indices of the packets queued on the peer socket.
+  std::vector<uint32_t> ReceivePackets() {
+    std::vector<uint32_t> indices;
+    char buffer[kPacketSize];
+    while (recv(peer_fd_, buffer, sizeof(buffer), MSG_DONTWAIT) ==
+           static_cast<ssize_t>(kPacketSize)) {
+      uint32_t index;
+      memcpy(&index, buffer, sizeof(index));
+      indices.push_back(index);
+    }
+    return indices;
+  }
+
+  QuicUdpSocketApi socket_api_;
+  int self_fd_;
+  int peer_fd_;
+  QuicSocketAddress peer_address_;
+  uint32_t next_index_ = 0;
+  std::unique_ptr<TestQuicIoUringBatchWriter> writer_;
+};
+
+TEST_F(QuicIoUringBatchWriterTest, SendsMoreThanARing) {
+  if (!CreateSockets()) {
+    return;
+  }
+  const int kNumPackets = 100;
+  BufferPackets(kNumPackets, peer_address_);
+
+  auto result = writer_->FlushImpl();
+  EXPECT_EQ(WRITE_STATUS_OK, result.write_result.status);
+  EXPECT_EQ(kNumPackets, result.num_packets_sent);
+  EXPECT_EQ(kNumPackets * kPacketSize, result.bytes_written);
+  EXPECT_EQ(kNumPackets * kPacketSize, result.write_result.bytes_written);
+  EXPECT_TRUE(writer_->buffered_writes().empty());
+
+  std::vector<uint32_t> indices = ReceivePackets();
+  ASSERT_EQ(static_cast<size_t>(kNumPackets), indices.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(static_cast<uint32_t>(i), indices[i]);
+  }
+}
+
+// An IPv6 peer cannot be reached from the IPv4 socket: the third send fails,
+// cancelling the last two.
+TEST_F(QuicIoUringBatchWriterTest, FailedSendCancelsTheRestOfTheChain) {
+  if (!CreateSockets()) {
+    return;
+  }
+  BufferPackets(2, peer_address_);
+  BufferPackets(1, QuicSocketAddress(QuicIpAddress::Loopback6(),
+                                     peer_address_.port()));
+  BufferPackets(2, peer_address_);
+
+  auto result = writer_->FlushImpl();
+  EXPECT_EQ(WRITE_STATUS_ERROR, result.write_result.status);
+  EXPECT_EQ(EAFNOSUPPORT, result.write_result.error_code);
+  EXPECT_EQ(2, result.num_packets_sent);
+  EXPECT_EQ(2 * kPacketSize, result.bytes_written);
+  EXPECT_EQ(3u, writer_->buffered_writes().size());
+
+  std::vector<uint32_t> indices = ReceivePackets();
+  ASSERT_EQ(2u, indices.size());
+  EXPECT_EQ(0u, indices[0]);
+  EXPECT_EQ(1u, indices[1]);
+}
+
+// The first send of the chain fails, so none is sent.
+TEST_F(QuicIoUringBatchWriterTest, FailedFirstSendSendsNothing) {
+  if (!CreateSockets()) {
+    return;
+  }
+  BufferPackets(1, QuicSocketAddress(QuicIpAddress::Loopback6(),
+                                     peer_address_.port()));
+  BufferPackets(3, peer_address_);
+
+  auto result = writer_->FlushImpl();
+  EXPECT_EQ(WRITE_STATUS_ERROR, result.write_result.status);
+  EXPECT_EQ(EAFNOSUPPORT, result.write_result.error_code);
+  EXPECT_EQ(0, result.num_packets_sent);
+  EXPECT_EQ(0u, result.bytes_written);
+  EXPECT_EQ(4u, writer_->buffered_writes().size());
+  EXPECT_TRUE(ReceivePackets().empty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,196 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_packet_reader.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "gquiche/quic/core/quic_constants.h"
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+namespace {
+
+// The ring only carries the recvmsg request.
+constexpr uint32_t kRingEntries = 8;
+constexpr uint16_t kBufferGroup = 0;
+
+// The completions handled per call, so that a flood of packets does not
+// starve the other sockets.
+constexpr unsigned kMaxPacketsPerCall = kMaxPacketsPerReadMmsgCall;
+
+}  // namespace
+
+QuicIoUringPacketReader::QuicIoUringPacketReader(bool enable_gro)
+    : QuicPacketReader(enable_gro),
+      payload_size_(enable_gro ? kGroReadBufferSize : kMaxIncomingPacketSize),
+      use_recvmmsg_(false),
+      armed_(false) {
+  memset(&msghdr_, 0, sizeof(msghdr_));
+  msghdr_.msg_namelen = sizeof(sockaddr_storage);
+  msghdr_.msg_controllen = kDefaultUdpPacketControlBufferSize;
+}
+
+QuicIoUringPacketReader::~QuicIoUringPacketReader() = default;
+
+bool QuicIoUringPacketReader::Initialize() {
+  const size_t buffer_size = sizeof(io_uring_recvmsg_out) +
+                             msghdr_.msg_namelen + msghdr_.msg_controllen +
+                             payload_size_;
+  const uint16_t num_buffers =
+      gro_enabled() ? kNumIoUringGroReadBuffers : kNumIoUringReadBuffers;
+  // Every completion of the request takes a buffer but the one ending it, so
+  // the completion queue only overflows, which also ends the request, if the
+  // completions of a whole buffer ring are left unconsumed. It leaves room for
+  // two.
+  return ring_.Initialize(kRingEntries, /*cq_entries=*/2 * num_buffers) &&
+         ring_.RegisterBufferRing(kBufferGroup, num_buffers, buffer_size);
+}
+
+bool QuicIoUringPacketReader::ArmReceive(int fd) {
+  io_uring_sqe* sqe = ring_.GetSqe();
+  if (sqe == nullptr) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(&msghdr_);
+  sqe->len = 1;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kBufferGroup;
+  armed_ = true;
+  return true;
+}
+
+bool QuicIoUringPacketReader::ReadAndDispatchPackets(
+    int fd, int port, const QuicClock& clock, ProcessPacketInterface* processor,
+    QuicPacketCount* packets_dropped) {
+  if (!use_recvmmsg_ && !ring_.initialized() && !Initialize()) {
+    QUIC_LOG(WARNING) << "Failed to set up io_uring, reading with recvmmsg: "
+                      << strerror(errno);
+    use_recvmmsg_ = true;
+  }
+  if (use_recvmmsg_) {
+    return QuicPacketReader::ReadAndDispatchPackets(fd, port, clock, processor,
+                                                    packets_dropped);
+  }
+
+  if (!armed_ && !ArmReceive(fd)) {
+    QUIC_LOG_FIRST_N(ERROR, 10) << "Failed to queue the recvmsg request";
+    return false;
+  }
+  // Receives the packets queued on the socket.
+  int result = ring_.Submit();
+  if (result < 0 && result != -EINTR) {
+    QUIC_LOG_FIRST_N(ERROR, 10)
+        << "io_uring_enter() failed: " << strerror(-result);
+  }
+
+  // Use clock.Now() as the packet receipt time, the time between packet
+  // arriving at the host and now is considered part of the network delay.
+  QuicTime now = clock.Now();
+
+  bool rearm = false;
+  unsigned num_cqes = 0;
+  // The packets are processed in batches, so buffers are only recycled once
+  // all of them have been.
+  PacketBatch batch(processor);
+  uint16_t buffer_ids[kMaxPacketsPerCall];
+  unsigned num_buffers = 0;
+  while (num_cqes < kMaxPacketsPerCall) {
+    io_uring_cqe* cqe = ring_.PeekCqe(num_cqes);
+    if (cqe == nullptr) {
+      break;
+    }
+    ++num_cqes;
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+      armed_ = false;
+      // Out of buffers, the packets left wait on the socket. Other errors
+      // wait for the next packet not to spin.
+      rearm = cqe->res >= 0 || cqe->res == -ENOBUFS;
+    }
+    if (cqe->res < 0) {
+      if (cqe->res != -ENOBUFS) {
+        QUIC_LOG_FIRST_N(ERROR, 100)
+            << "Error reading packets: " << strerror(-cqe->res);
+      }
+      continue;
+    }
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+      QUIC_BUG(quic_io_uring_recvmsg_without_buffer)
+          << "recvmsg completed without a buffer";
+      continue;
+    }
+    const uint16_t buffer_id = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    DispatchBuffer(ring_.buffer(buffer_id), cqe->res, port, now, &batch);
+    buffer_ids[num_buffers++] = buffer_id;
+  }
+  batch.Flush();
+  for (unsigned i = 0; i < num_buffers; ++i) {
+    ring_.RecycleBuffer(buffer_ids[i]);
+  }
+  ring_.ConsumeCqes(num_cqes);
+  ring_.CommitBuffers();
+
+  // We may not have handled all of the completions, or of the packets queued
+  // on the socket.
+  return num_cqes == kMaxPacketsPerCall || rearm;
+}
+
+void QuicIoUringPacketReader::DispatchBuffer(char* buffer, size_t length,
+                                             int port, QuicTime now,
+                                             PacketBatch* batch) {
+  // The buffer holds the header, then the name and control parts, of the
+  // sizes of the request's msghdr, then the payload.
+  const auto* out = reinterpret_cast<const io_uring_recvmsg_out*>(buffer);
+  const size_t payload_offset =
+      sizeof(*out) + msghdr_.msg_namelen + msghdr_.msg_controllen;
+  if (ABSL_PREDICT_FALSE(length < payload_offset ||
+                         out->payloadlen > length - payload_offset)) {
+    QUIC_BUG(quic_io_uring_recvmsg_short_buffer)
+        << "recvmsg completed with " << length << " bytes";
+    return;
+  }
+  if (ABSL_PREDICT_FALSE(out->flags & MSG_CTRUNC)) {
+    QUIC_BUG(quic_io_uring_recvmsg_control_truncated)
+        << "Control buffer too small. size:" << msghdr_.msg_controllen
+        << ", need:" << out->controllen;
+    return;
+  }
+  if (ABSL_PREDICT_FALSE(out->flags & MSG_TRUNC)) {
+    QUIC_LOG_FIRST_N(WARNING, 100)
+        << "Received truncated QUIC packet: buffer size:" << payload_size_;
+    return;
+  }
+
+  char* name = buffer + sizeof(*out);
+  char* control = name + msghdr_.msg_namelen;
+  QuicUdpPacketInfo packet_info;
+  if (out->namelen > 0 && out->namelen <= msghdr_.msg_namelen) {
+    packet_info.SetPeerAddress(QuicSocketAddress(
+        reinterpret_cast<const sockaddr*>(name), out->namelen));
+  }
+  BitMask64 packet_info_interested(
+      QuicUdpPacketInfoBit::DROPPED_PACKETS, QuicUdpPacketInfoBit::V4_SELF_IP,
+      QuicUdpPacketInfoBit::V6_SELF_IP, QuicUdpPacketInfoBit::RECV_TIMESTAMP,
+      QuicUdpPacketInfoBit::TTL, QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER);
+  if (gro_enabled()) {
+    packet_info_interested.Set(QuicUdpPacketInfoBit::IS_GRO);
+  }
+  msghdr hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.msg_control = control;
+  hdr.msg_controllen = out->controllen;
+  socket_api().ReadControlMessages(&hdr, packet_info_interested, &packet_info);
+
+  DispatchPackets(control + msghdr_.msg_controllen, out->payloadlen,
+                  packet_info, port, now, QuicPooledPacketBuffer(), batch);
+}
+
+}  // namespace quic
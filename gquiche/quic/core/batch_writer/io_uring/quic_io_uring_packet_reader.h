@@ -0,0 +1,85 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_PACKET_READER_H_
+#define QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_PACKET_READER_H_
+
+#include <sys/socket.h>
+
+#include <cstddef>
+
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/quic_clock.h"
+#include "gquiche/quic/core/quic_packet_reader.h"
+#include "gquiche/quic/core/quic_packets.h"
+#include "gquiche/quic/core/quic_process_packet_interface.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+
+namespace quic {
+
+namespace test {
+class QuicIoUringPacketReaderTest;
+}
+
+// The buffers the kernel receives into, without and with UDP GRO.
+const int kNumIoUringReadBuffers = 512;
+const int kNumIoUringGroReadBuffers = 32;
+
+// Reads packets with a multishot recvmsg request on an io_uring(7), which the
+// kernel completes into buffers it picks from a provided buffer ring, one
+// completion per packet, without a system call per batch of packets other
+// than the one collecting the completions.
+//
+// The socket is still registered with the event loop: the ring is set up
+// with deferred task running, so packets stay queued on the socket, and the
+// socket readable, until ReadAndDispatchPackets() collects them.
+//
+// The ring is set up by the first ReadAndDispatchPackets(), on the thread
+// running the event loop. If that fails, the reader falls back to recvmmsg.
+// Unlike with QuicPacketReader, the packets handed to the processor do not
+// reference their buffer, which goes back to the kernel once the processor
+// returns: packets kept beyond that are copied.
+class QUIC_EXPORT_PRIVATE QuicIoUringPacketReader : public QuicPacketReader {
+ public:
+  // See QuicPacketReader for |enable_gro|.
+  explicit QuicIoUringPacketReader(bool enable_gro);
+  QuicIoUringPacketReader(const QuicIoUringPacketReader&) = delete;
+  QuicIoUringPacketReader& operator=(const QuicIoUringPacketReader&) = delete;
+
+  ~QuicIoUringPacketReader() override;
+
+  // QuicPacketReader implementation. Only ever reads from one |fd|.
+  bool ReadAndDispatchPackets(int fd, int port, const QuicClock& clock,
+                              ProcessPacketInterface* processor,
+                              QuicPacketCount* packets_dropped) override;
+
+ private:
+  friend class test::QuicIoUringPacketReaderTest;
+
+  // Sets up the ring and its buffers.
+  bool Initialize();
+  // Queues the multishot recvmsg request.
+  bool ArmReceive(int fd);
+  // Adds the packet received in |buffer|, of |length| bytes in all, to
+  // |batch|.
+  void DispatchBuffer(char* buffer, size_t length, int port, QuicTime now,
+                      PacketBatch* batch);
+
+  // The room for the payload in each buffer.
+  const size_t payload_size_;
+
+  QuicIoUring ring_;
+  // True if io_uring could not be set up, and packets are read with
+  // QuicPacketReader.
+  bool use_recvmmsg_;
+  // Whether the recvmsg request is in the ring.
+  bool armed_;
+  // The sizes of the name and control parts of the buffers, which the kernel
+  // takes from the request's msghdr.
+  msghdr msghdr_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_BATCH_WRITER_IO_URING_QUIC_IO_URING_PACKET_READER_H_
@@ -0,0 +1,168 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_packet_reader.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+#include "gquiche/quic/platform/api/quic_ip_address.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/platform/api/quic_socket_address.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "gquiche/quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+
+namespace {
+
+const size_t kPacketSize = 100;
+
+// Records the index each packet was sent with.
+class RecordingPacketProcessor : public ProcessPacketInterface {
+ public:
+  void ProcessPacket(const QuicSocketAddress& /*self_address*/,
+                     const QuicSocketAddress& /*peer_address*/,
+                     const QuicReceivedPacket& packet) override {
+    EXPECT_EQ(kPacketSize, packet.length());
+    uint32_t index;
+    memcpy(&index, packet.data(), sizeof(index));
+    indices_.push_back(index);
+  }
+
+  const std::vector<uint32_t>& indices() const { return indices_; }
+
+ private:
+  std::vector<uint32_t> indices_;
+};
+
+}  // namespace
+
+class QuicIoUringPacketReaderTest : public QuicTest {
+ protected:
+  QuicIoUringPacketReaderTest() : self_fd_(-1), peer_fd_(-1), next_index_(0) {}
+
+  ~QuicIoUringPacketReaderTest() override {
+    if (self_fd_ >= 0) {
+      socket_api_.Destroy(self_fd_);
+    }
+    if (peer_fd_ >= 0) {
+      socket_api_.Destroy(peer_fd_);
+    }
+  }
+
+  // Returns false, after logging why, if the test should be skipped.
+  bool CreateSockets() {
+    if (!QuicIoUring::IsSupported()) {
+      QUIC_LOG(WARNING) << "Test skipped since io_uring is not supported.";
+      return false;
+    }
+    self_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                  kDefaultSocketReceiveBuffer);
+    peer_fd_ = socket_api_.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                                  kDefaultSocketReceiveBuffer);
+    EXPECT_LE(0, self_fd_);
+    EXPECT_LE(0, peer_fd_);
+    const QuicSocketAddress any(QuicIpAddress::Loopback4(), 0);
+    EXPECT_TRUE(socket_api_.Bind(self_fd_, any));
+    EXPECT_TRUE(socket_api_.Bind(peer_fd_, any));
+    EXPECT_EQ(0, self_address_.FromSocket(self_fd_));
+    return true;
+  }
+
+  // Sends |count| packets to the reader's socket, each starting with its
+  // index.
+  void SendPackets(int count) {
+    char buffer[kPacketSize] = {};
+    QuicUdpPacketInfo packet_info;
+    packet_info.SetPeerAddress(self_address_);
+    for (int i = 0; i < count; ++i) {
+      memcpy(buffer, &next_index_, sizeof(next_index_));
+      ++next_index_;
+      ASSERT_EQ(WRITE_STATUS_OK,
+                socket_api_.WritePacket(peer_fd_, buffer, sizeof(buffer),
+                                        packet_info)
+                    .status);
+    }
+  }
+
+  // Reads until |processor| received all the packets sent, and returns the
+  // number of times the multishot recvmsg request had to be queued again.
+  int ReadAll(QuicIoUringPacketReader* reader) {
+    int num_rearms = 0;
+    for (int i = 0; i < 1000 && processor_.indices().size() < next_index_;
+         ++i) {
+      QuicPacketCount packets_dropped = 0;
+      reader->ReadAndDispatchPackets(self_fd_, self_address_.port(), clock_,
+                                     &processor_, &packets_dropped);
+      if (!reader->armed_) {
+        ++num_rearms;
+      }
+    }
+    return num_rearms;
+  }
+
+  bool use_recvmmsg(const QuicIoUringPacketReader& reader) const {
+    return reader.use_recvmmsg_;
+  }
+
+  void ExpectAllReceivedInOrder() const {
+    ASSERT_EQ(next_index_, processor_.indices().size());
+    for (uint32_t i = 0; i < next_index_; ++i) {
+      EXPECT_EQ(i, processor_.indices()[i]);
+    }
+  }
+
+  QuicUdpSocketApi socket_api_;
+  int self_fd_;
+  int peer_fd_;
+  QuicSocketAddress self_address_;
+  uint32_t next_index_;
+  MockClock clock_;
+  RecordingPacketProcessor processor_;
+};
+
+TEST_F(QuicIoUringPacketReaderTest, ReadsABatchPerCall) {
+  if (!CreateSockets()) {
+    return;
+  }
+  QuicIoUringPacketReader reader(/*enable_gro=*/false);
+  SendPackets(2 * kMaxPacketsPerReadMmsgCall);
+
+  QuicPacketCount packets_dropped = 0;
+  EXPECT_TRUE(reader.ReadAndDispatchPackets(
+      self_fd_, self_address_.port(), clock_, &processor_, &packets_dropped));
+  ASSERT_FALSE(use_recvmmsg(reader));
+  EXPECT_EQ(static_cast<size_t>(kMaxPacketsPerReadMmsgCall),
+            processor_.indices().size());
+
+  EXPECT_EQ(0, ReadAll(&reader));
+  ExpectAllReceivedInOrder();
+}
+
+// Sends more packets than the completion queue holds, in bursts larger than
+// the buffer ring, so that the request ends when it runs out of buffers.
+TEST_F(QuicIoUringPacketReaderTest, RearmsWhenOutOfBuffers) {
+  if (!CreateSockets()) {
+    return;
+  }
+  QuicIoUringPacketReader reader(/*enable_gro=*/true);
+  const int kBurstSize = 3 * kNumIoUringGroReadBuffers;
+  const int kNumBursts = 8;
+
+  int num_rearms = 0;
+  for (int i = 0; i < kNumBursts; ++i) {
+    SendPackets(kBurstSize);
+    num_rearms += ReadAll(&reader);
+    ASSERT_FALSE(use_recvmmsg(reader));
+  }
+  ExpectAllReceivedInOrder();
+  EXPECT_LE(kNumBursts * 2, num_rearms);
+}
+
+}  // namespace test
+}  // namespace quic
@@ -6,6 +6,7 @@
 
 #include "gquiche/quic/platform/api/quic_logging.h"
 #include "gquiche/quic/core/batch_writer/xsk/quic_xdp_socket_utils.h"
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_checksum.h"
 
 #define DEFAULT_PACKET_SIZE    1518
 
@@ -322,6 +323,11 @@ void kick_tx(xsk_socket_info *xsk)
 {
   int ret;
 
+  if (xsk->socket_config.bind_flags & XDP_COPY) {
+    xsk_stats_add(xsk->stats.copy_tx_sendtos);
+  } else {
+    xsk_stats_add(xsk->stats.tx_wakeup_sendtos);
+  }
   ret = sendto(xsk_socket__fd(xsk->xsk), NULL, 0, MSG_DONTWAIT, NULL, 0);
   if (ret >= 0 || errno == ENOBUFS || errno == EAGAIN ||
       errno == EBUSY || errno == ENETDOWN)
@@ -330,21 +336,34 @@ void kick_tx(xsk_socket_info *xsk)
   return;
 }
 
-void complete_tx(xsk_socket_info *xsk)
+/* Without XDP_USE_NEED_WAKEUP every submission needs a sendto(); with it,
+ * only those the kernel is not already processing. */
+static bool tx_needs_wakeup(xsk_socket_info *xsk)
 {
-  unsigned int completed;
-  uint32_t idx;
+  if (!(xsk->socket_config.bind_flags & XDP_USE_NEED_WAKEUP)) {
+    return true;
+  }
+  return xsk_ring_prod__needs_wakeup(&xsk->tx);
+}
 
+void wakeup_tx(xsk_socket_info *xsk)
+{
   if (!xsk->outstanding_tx) {
     return;
   }
-
-  bool need_wakeup = 
-       xsk->socket_config.bind_flags & XDP_USE_NEED_WAKEUP ? true : false;
-
-  if (!need_wakeup || xsk_ring_prod__needs_wakeup(&xsk->tx)) {
+  if (tx_needs_wakeup(xsk)) {
     kick_tx(xsk);
+  } else {
+    xsk_stats_add(xsk->stats.tx_wakeups_skipped);
   }
+}
+
+static void reap_tx(xsk_socket_info *xsk)
+{
+  unsigned int completed;
+  uint32_t idx;
+
+  xsk_stats_add(xsk->stats.tx_reaps);
   // from bpf/xsk.h, XSK_RING_CONS__DEFAULT_NUM_DESCS : 2048
   completed = xsk_ring_cons__peek(&xsk->umem->cq, XSK_RING_CONS__DEFAULT_NUM_DESCS, &idx);
   if (completed > 0) {
@@ -354,9 +373,68 @@ void complete_tx(xsk_socket_info *xsk)
     }
     xsk_ring_cons__release(&xsk->umem->cq, completed);
     xsk->outstanding_tx -= completed;
+    xsk_stats_add(xsk->stats.tx_frames_reaped, completed);
   }
 }
 
+void complete_tx(xsk_socket_info *xsk)
+{
+  if (!xsk->outstanding_tx) {
+    return;
+  }
+  wakeup_tx(xsk);
+  reap_tx(xsk);
+}
+
+void submit_tx(xsk_socket_info *xsk, uint32_t nums)
+{
+  if (nums == 0) {
+    return;
+  }
+  xsk_ring_prod__submit(&xsk->tx, nums);
+  xsk->outstanding_tx += nums;
+  wakeup_tx(xsk);
+  // Completions are not urgent while frames are plentiful: reap them in
+  // batches rather than after every submission.
+  if (xsk->outstanding_tx >= kXskTxReapBatch ||
+      xsk->umem_frame_free < kXskTxLowFreeFrames) {
+    reap_tx(xsk);
+  }
+}
+
+void wakeup_fill(xsk_socket_info *xsk)
+{
+  if (!xsk_ring_prod__needs_wakeup(&xsk->umem->fq)) {
+    return;
+  }
+  xsk_stats_add(xsk->stats.fill_wakeups);
+  recvfrom(xsk_socket__fd(xsk->xsk), NULL, 0, MSG_DONTWAIT, NULL, NULL);
+}
+
+size_t xsk_packet_header_size(const QuicIpAddress& self_address)
+{
+  if (self_address.IsIPv4()) {
+    return PKT_HDR_SIZE;
+  }
+  if (self_address.IsIPv6()) {
+    return PKT6_HDR_SIZE;
+  }
+  return 0;
+}
+
+static size_t xsk_packet_header_size(const QuicUdpPacketInfo& packet_info)
+{
+  if (packet_info.HasValue(QuicUdpPacketInfoBit::V4_SELF_IP) &&
+      packet_info.self_v4_ip().IsInitialized()) {
+    return PKT_HDR_SIZE;
+  }
+  if (packet_info.HasValue(QuicUdpPacketInfoBit::V6_SELF_IP) &&
+      packet_info.self_v6_ip().IsInitialized()) {
+    return PKT6_HDR_SIZE;
+  }
+  return 0;
+}
+
 
 // private
 void QuicXdpSocketUtils::HandleRecvEthPkt(
@@ -456,10 +534,17 @@ size_t QuicXdpSocketUtils::ReadMultiplePackets(
   rcvd = xsk_ring_cons__peek(&xsk->rx, results->size(), &idx_rx);
 
   if (!rcvd) {
+    // The kernel may have stopped filling the RX ring for want of a wakeup.
+    xsk_stats_add(xsk->stats.rx_empty_polls);
+    wakeup_fill(xsk);
     return 0;
   }
 
   ret = xsk_ring_prod__reserve(&xsk->umem->fq, rcvd, idx_fq);
+  if (ret < rcvd) {
+    xsk_stats_add(xsk->stats.fill_fail_polls);
+    wakeup_fill(xsk);
+  }
   ret = std::min(rcvd, ret);
   for (int i = 0; i < ret; i++) {
     uint64_t addr = xsk_ring_cons__rx_desc(&xsk->rx, idx_rx)->addr;
@@ -493,6 +578,7 @@ void QuicXdpSocketUtils::ReleaseRxRing(
   }
   xsk_ring_prod__submit(&xsk->umem->fq, nums);
   xsk_ring_cons__release(&xsk->rx, nums);
+  wakeup_fill(xsk);
 }
 
 WriteResult QuicXdpSocketUtils::WriteMultiplePackets(
@@ -518,6 +604,12 @@ WriteResult QuicXdpSocketUtils::WriteMultiplePackets(
 
   uint32_t idx;
   int reserved_writes = xsk_ring_prod__reserve(&xsk->tx, nums_to_write, &idx);
+  if (reserved_writes == 0) {
+    // The kernel has not consumed the ring, make sure it is working on it.
+    xsk_stats_add(xsk->stats.tx_ring_full);
+    complete_tx(xsk);
+    reserved_writes = xsk_ring_prod__reserve(&xsk->tx, nums_to_write, &idx);
+  }
   *num_packets_sent = std::min(reserved_writes, nums_to_write);
 
   int bytes_writen = 0;
@@ -545,9 +637,7 @@ WriteResult QuicXdpSocketUtils::WriteMultiplePackets(
     bytes_writen += it->payload_buf_len;
   }
 
-  xsk_ring_prod__submit(&xsk->tx, *num_packets_sent);
-  xsk->outstanding_tx += *num_packets_sent;
-  complete_tx(xsk);
+  submit_tx(xsk, *num_packets_sent);
 
   if (*num_packets_sent == 0) {
     return WriteResult(WRITE_STATUS_BLOCKED, EWOULDBLOCK);
@@ -577,23 +667,38 @@ WriteResult QuicXdpSocketUtils::WritePacket(
   }
 
   char* eth_pkt_data = (char*)xsk_umem__get_data(xsk->umem->buffer, addr);
-  AssemblePktHdr(eth_pkt_data, packet_buffer_len, 
-      packet_info, self_udp_port, self_mac_addr, peer_mac_addr);
+  memcpy(eth_pkt_data + xsk_packet_header_size(packet_info),
+         packet_buffer, packet_buffer_len);
 
-  int hdr_size = 0;
-  if (packet_info.HasValue(QuicUdpPacketInfoBit::V4_SELF_IP) &&
-      packet_info.self_v4_ip().IsInitialized()) {
-    hdr_size = PKT_HDR_SIZE;
-  } else if (packet_info.HasValue(QuicUdpPacketInfoBit::V6_SELF_IP) &&
-      packet_info.self_v6_ip().IsInitialized()) {
-    hdr_size = PKT6_HDR_SIZE;
+  return WriteUmemFrame(xsk, addr, packet_buffer_len, packet_info,
+                        self_udp_port, self_mac_addr, peer_mac_addr);
+}
+
+WriteResult QuicXdpSocketUtils::WriteUmemFrame(
+  xsk_socket_info *xsk,
+  uint64_t addr,
+  size_t packet_buffer_len,
+  const QuicUdpPacketInfo& packet_info,
+  const uint16_t self_udp_port,
+  const unsigned char* self_mac_addr,
+  const unsigned char* peer_mac_addr)
+{
+  size_t hdr_size = xsk_packet_header_size(packet_info);
+  if (!packet_info.HasValue(QuicUdpPacketInfoBit::PEER_ADDRESS) ||
+      hdr_size == 0) {
+    xsk_free_umem_frame(xsk, addr);
+    return WriteResult(WRITE_STATUS_ERROR, EINVAL);
   }
 
-  memcpy(eth_pkt_data + hdr_size, packet_buffer, packet_buffer_len);
+  // The payload is in place already, the IPv6 UDP checksum covers it.
+  char* eth_pkt_data = (char*)xsk_umem__get_data(xsk->umem->buffer, addr);
+  AssemblePktHdr(eth_pkt_data, packet_buffer_len, 
+      packet_info, self_udp_port, self_mac_addr, peer_mac_addr);
 
   uint32_t idx;
   // batch size equal 1
-  while (xsk->outstanding_tx && xsk_ring_prod__reserve(&xsk->tx,1 , &idx) < 1) {
+  while (xsk_ring_prod__reserve(&xsk->tx,1 , &idx) < 1) {
+    xsk_stats_add(xsk->stats.tx_ring_full);
     complete_tx(xsk);
   }
 
@@ -601,9 +706,7 @@ WriteResult QuicXdpSocketUtils::WritePacket(
   tx_desc->addr = addr;
   tx_desc->len = packet_buffer_len + hdr_size;
 
-  xsk_ring_prod__submit(&xsk->tx, 1);
-  xsk->outstanding_tx++;
-  complete_tx(xsk);
+  submit_tx(xsk, 1);
 
   // status and bytes_writen, refer to QuicDefaultPacketWriter::WriteResult
   return WriteResult(WRITE_STATUS_OK, packet_buffer_len);
@@ -650,8 +753,10 @@ void QuicXdpSocketUtils::AssemblePktHdr(
     ip_hdr->saddr = self_v4_addr.s_addr;
     ip_hdr->daddr = peer_v4_addr.s_addr;
 
+    /* IP header checksum */
     ip_hdr->check = 0;
-    ip_hdr->check = ip_fast_csum((const void *)ip_hdr, ip_hdr->ihl);
+    ip_hdr->check = QuicXskChecksumFinish(
+        QuicXskChecksumPartial(ip_hdr, sizeof(struct iphdr), 0));
 
     struct udphdr *udp_hdr = (struct udphdr *)(eth_pkt_data +
             sizeof(struct ethhdr) +
@@ -697,12 +802,17 @@ void QuicXdpSocketUtils::AssemblePktHdr(
     udp_hdr->dest = htons(peer_udp_port);
     udp_hdr->len = htons(udp_pkt_size);
 
-    /* UDP header checksum*/
+    /* UDP header checksum, over the pseudo header, the UDP header and the
+     * payload, which must be in place already. */
     udp_hdr->check = 0;
-    //udp_hdr->check = udp_csum(ip6_hdr->saddr, ip6_hdr->daddr, UDP6_PKT_SIZE,
-    //        IPPROTO_UDP, (uint16_t *)ip6_hdr);
-    udp_hdr->check = tcp_udp_v6_checksum(&ip6_hdr->saddr, &ip6_hdr->daddr, IPPROTO_UDP, 
-                         udp_hdr, ntohs(ip6_hdr->payload_len));
+    uint64_t sum = QuicXskChecksumPartial(&ip6_hdr->saddr,
+                                          2 * sizeof(ip6_hdr->saddr), 0);
+    sum += udp_hdr->len;
+    sum += htons(IPPROTO_UDP);
+    sum = QuicXskChecksumPartial(udp_hdr, udp_pkt_size, sum);
+    uint16_t check = QuicXskChecksumFinish(sum);
+    /* A zero UDP checksum means none, which IPv6 does not allow. */
+    udp_hdr->check = check == 0 ? 0xffff : check;
 #endif
   }
 }
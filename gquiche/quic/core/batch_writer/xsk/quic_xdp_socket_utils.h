@@ -59,8 +59,24 @@ uint64_t xsk_alloc_umem_frame(xsk_socket_info *xsk);
 void xsk_free_umem_frame(xsk_socket_info *xsk, uint64_t frame);
 uint64_t xsk_umem_free_frames(xsk_socket_info *xsk);
 
+// Completions are reaped once this many transmissions are outstanding, or
+// once fewer than kXskTxLowFreeFrames frames are free.
+constexpr uint32_t kXskTxReapBatch = 64;
+constexpr uint32_t kXskTxLowFreeFrames = 256;
+
+// sendto() on the socket, unconditionally.
 void kick_tx(xsk_socket_info *xsk);
+// Kicks the kernel if transmissions are outstanding and it asks for it, see
+// xsk_ring_prod__needs_wakeup().
+void wakeup_tx(xsk_socket_info *xsk);
+// Wakes the kernel up if needed and recycles the frames of all completed
+// transmissions. For callers short of frames or TX ring space.
 void complete_tx(xsk_socket_info *xsk);
+// Submits |nums| reserved TX descriptors, wakes the kernel up if needed and
+// reaps completions when they are due.
+void submit_tx(xsk_socket_info *xsk, uint32_t nums);
+// Wakes the kernel up if it waits for the fill ring to be refilled.
+void wakeup_fill(xsk_socket_info *xsk);
 
 uint16_t udp_csum_new(in_addr_t src_addr, in_addr_t dest_addr, size_t len, const uint16_t *buff);
 
@@ -70,6 +86,23 @@ extern __be16 tcp_udp_v6_checksum(
 		const struct in6_addr *dst_ip,
 		u8 protocol, const void *payload, u32 len);
 
+// Returns the size of the Ethernet, IP and UDP headers in front of the
+// payloads sent from |self_address|, or 0 if it is neither IPv4 nor IPv6.
+// Payloads are serialized this far into their UMEM frames so that the
+// headers can be written in front of them in place.
+size_t xsk_packet_header_size(const QuicIpAddress& self_address);
+
+// How the payloads given to an xsk writer got into their UMEM frames.
+struct QuicXskTxCopyStats {
+  // Packets accepted by the writer.
+  uint64_t packets = 0;
+  // Those of them which were serialized elsewhere and copied into a frame,
+  // and their payload bytes. The others were encrypted in place, into the
+  // location returned by GetNextWriteLocation().
+  uint64_t packets_copied = 0;
+  uint64_t bytes_copied = 0;
+};
+
 // class derived from class BufferedWrite
 struct XskBufferedWrite {
   XskBufferedWrite(const char* umem_area,
@@ -168,6 +201,18 @@ class QuicXdpSocketUtils {
     const unsigned char* self_mac_addr,
     const unsigned char* peer_mac_addr);
 
+  // Sends the |packet_buffer_len| bytes of payload already in UMEM frame
+  // |addr|, after xsk_packet_header_size() bytes of room for the headers.
+  // Takes the frame back if the write fails.
+  WriteResult WriteUmemFrame(
+    xsk_socket_info *xsk,
+    uint64_t addr,
+    size_t packet_buffer_len,
+    const QuicUdpPacketInfo& packet_info,
+    const uint16_t self_udp_port,
+    const unsigned char* self_mac_addr,
+    const unsigned char* peer_mac_addr);
+
   WriteResult WriteMultiplePackets(
     xsk_socket_info        *xsk,
     const ConstIteratorT&  first,
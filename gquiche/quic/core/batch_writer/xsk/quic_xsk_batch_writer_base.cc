@@ -81,7 +81,9 @@ WriteResult QuicXskBatchWriterBase::InternalWritePacket(
       flush = flush || (batch_buffer_->GetNextWriteLocation(self_address, nullptr) == nullptr);
     } else {
       //there's no space for umem frame, force a flush and try involk PushBufferedWrite again below.
-      complete_tx(xsk_);
+      if (xsk_umem_free_frames(xsk_) == 0) {
+        complete_tx(xsk_);
+      }
       if (buffered_writes().size() == 0) {
         WriteResult result(WRITE_STATUS_BLOCKED, 0);
         return result;
@@ -57,7 +57,8 @@ class QuicXskBatchWriterBase : public QuicPacketWriter {
       const QuicSocketAddress& /*peer_address*/) final {
     // No need to explicitly delete QuicBatchWriterBuffer.
     char* loc = batch_buffer_->GetNextWriteLocation(self_address, nullptr);
-    if (loc == nullptr) {
+    if (loc == nullptr && xsk_umem_free_frames(xsk_) == 0) {
+      // Out of frames: recycle the completed ones for the next packet.
       complete_tx(xsk_);
     }
     return {loc, nullptr};
@@ -65,6 +66,10 @@ class QuicXskBatchWriterBase : public QuicPacketWriter {
 
   WriteResult Flush() override;
 
+  const QuicXskTxCopyStats& copy_stats() const {
+    return batch_buffer_->copy_stats();
+  }
+
  protected:
   const QuicXskBatchWriterBuffer& batch_buffer() const { return *batch_buffer_; }
   QuicXskBatchWriterBuffer& batch_buffer() { return *batch_buffer_; }
@@ -7,14 +7,22 @@ namespace quic {
 
 QuicXskBatchWriterBuffer::QuicXskBatchWriterBuffer(xsk_socket_info* xsk)
     : xsk_(xsk),
-      next_write_location_(nullptr) {}
+      next_write_umem_frame_(INVALID_UMEM_FRAME) {}
+
+QuicXskBatchWriterBuffer::~QuicXskBatchWriterBuffer() {
+  Clear();
+  if (next_write_umem_frame_ != INVALID_UMEM_FRAME) {
+    xsk_free_umem_frame(xsk_, next_write_umem_frame_);
+  }
+}
 
 void QuicXskBatchWriterBuffer::Clear() {
+  // The dropped writes never reached the TX ring, so no completion will
+  // return their frames.
   while(!buffered_writes_.empty()) {
-    //xsk_free_umem_frame(xsk_, buffered_writes_.front().addr);
+    xsk_free_umem_frame(xsk_, buffered_writes_.front().addr);
     buffered_writes_.pop_front();
   }
-  buffered_writes_.clear();
 }
 
 std::string QuicXskBatchWriterBuffer::DebugString() const {
@@ -30,36 +38,31 @@ bool QuicXskBatchWriterBuffer::Invariants() const {
 }
 
 char* QuicXskBatchWriterBuffer::GetNextWriteLocation(const QuicIpAddress& self_address, uint64_t* addr_ptr) {
-  char *loc = nullptr;
   if (buffered_writes_.size() >= 64) {
-    return loc;
+    return nullptr;
   }
 
-  uint64_t addr;
-  if (!next_write_location_) {
-    addr = xsk_alloc_umem_frame(xsk_);
-    if (addr == INVALID_UMEM_FRAME) {
+  const size_t hdr_size = xsk_packet_header_size(self_address);
+  if (hdr_size == 0) {
+    return nullptr;
+  }
+
+  if (next_write_umem_frame_ == INVALID_UMEM_FRAME) {
+    next_write_umem_frame_ = xsk_alloc_umem_frame(xsk_);
+    if (next_write_umem_frame_ == INVALID_UMEM_FRAME) {
       QUIC_LOG(ERROR) << "[GetNextWriteLocation]xsk_alloc_umem_frame failed.";
-	    return nullptr;
-    }
-    //get loc
-    char* eth_pkt_data = (char*)xsk_umem__get_data((char*)xsk_->umem->buffer, addr);
-    if (self_address.IsIPv4()) {
-      loc = eth_pkt_data + PKT_HDR_SIZE;
-    } else if (self_address.IsIPv6()) {
-      loc = eth_pkt_data + PKT6_HDR_SIZE;
+      return nullptr;
     }
-    next_write_location_ = loc;
-    next_write_umem_frame_ = addr;
-  } else {
-    addr = next_write_umem_frame_;
-    loc = next_write_location_;
   }
 
+  // The offset follows the address family of each call, so a reserved frame
+  // is never handed out with room for the wrong headers.
+  char* eth_pkt_data = (char*)xsk_umem__get_data(
+      (char*)xsk_->umem->buffer, next_write_umem_frame_);
   if (addr_ptr) {
-    *addr_ptr = addr;
+    *addr_ptr = next_write_umem_frame_;
   }
-  return loc;
+  return eth_pkt_data + hdr_size;
 }
 
 QuicXskBatchWriterBuffer::PushResult QuicXskBatchWriterBuffer::PushBufferedWrite(
@@ -78,11 +81,14 @@ QuicXskBatchWriterBuffer::PushResult QuicXskBatchWriterBuffer::PushBufferedWrite
     return result;
   }
 
+  ++copy_stats_.packets;
   if (next_write_location != buffer) {
     memcpy(next_write_location, buffer, buf_len);
     result.buffer_copied = true;
+    ++copy_stats_.packets_copied;
+    copy_stats_.bytes_copied += buf_len;
   }
-  next_write_location_ = nullptr;
+  next_write_umem_frame_ = INVALID_UMEM_FRAME;
 
   char *umem_buffer = (char*)xsk_->umem->buffer;
   buffered_writes_.emplace_back(
@@ -100,6 +106,7 @@ QuicXskBatchWriterBuffer::PushResult QuicXskBatchWriterBuffer::PushBufferedWrite
 void QuicXskBatchWriterBuffer::UndoLastPush() {
 //recycle the latest buffered
   if (!buffered_writes_.empty()) {
+    xsk_free_umem_frame(xsk_, buffered_writes_.back().addr);
     buffered_writes_.pop_back();
   }
 }
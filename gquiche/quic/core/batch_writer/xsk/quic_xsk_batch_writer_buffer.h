@@ -13,13 +13,20 @@ namespace quic {
 class QuicXskBatchWriterBuffer {
  public:
   QuicXskBatchWriterBuffer(xsk_socket_info* xsk);
+  ~QuicXskBatchWriterBuffer();
 
-  // Clear all buffered writes, but leave the internal buffer intact.
+  // Clear all buffered writes and return their UMEM frames.
   void Clear();
 
+  // Returns where the payload of the next write goes: xsk_packet_header_size()
+  // bytes into a reserved UMEM frame, leaving room for the headers. The frame
+  // stays reserved, and the location stays valid for the same address family,
+  // until a write is pushed. Returns nullptr if no more writes can be
+  // buffered or no frame is free.
   char* GetNextWriteLocation(const QuicIpAddress& self_address, uint64_t* addr_ptr);
 
-  // Push a buffered write to the back.
+  // Push a buffered write to the back. Unless |buffer| is the location
+  // returned by GetNextWriteLocation(), it is copied there.
   struct PushResult {
     bool succeeded;
     bool buffer_copied;
@@ -54,6 +61,8 @@ class QuicXskBatchWriterBuffer {
   // PushBufferedWrite() increases this; PopBufferedWrite decreases this.
   size_t SizeInUse() const;
 
+  const QuicXskTxCopyStats& copy_stats() const { return copy_stats_; }
+
   // Rounded up from |kMaxGsoPacketSize|, which is the maximum allowed
   // size of a GSO packet.
   static const size_t kBufferSize = 64 * 1024;
@@ -66,8 +75,9 @@ class QuicXskBatchWriterBuffer {
   //not owned.
   xsk_socket_info*                              xsk_;
   quiche::QuicheCircularDeque<XskBufferedWrite> buffered_writes_;
+  // The frame reserved by GetNextWriteLocation(), or INVALID_UMEM_FRAME.
   uint64_t                                      next_write_umem_frame_;
-  char*                                         next_write_location_;
+  QuicXskTxCopyStats                            copy_stats_;
 };
 
 }  // namespace quic
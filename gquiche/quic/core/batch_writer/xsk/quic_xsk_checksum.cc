@@ -0,0 +1,193 @@
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_checksum.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace quic {
+
+namespace {
+
+using PartialFunction = uint64_t (*)(const uint8_t*, size_t, uint64_t);
+
+// 32-bit words into a 64-bit accumulator, as ip_checksum_partial() in
+// quic_xdp_socket_utils.cc. Also finishes the tails of the vector kernels.
+uint64_t PartialScalar(const uint8_t* p, size_t len, uint64_t sum) {
+  for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    sum += word;
+    p += sizeof(word);
+  }
+  if (len >= sizeof(uint16_t)) {
+    uint16_t word;
+    memcpy(&word, p, sizeof(word));
+    sum += word;
+    p += sizeof(word);
+    len -= sizeof(word);
+  }
+  if (len > 0) {
+    // Pad the last byte: it is the first one of a 16-bit word.
+    uint16_t word = 0;
+    memcpy(&word, p, 1);
+    sum += word;
+  }
+  return sum;
+}
+
+#if defined(__x86_64__)
+
+// The vector kernels zero-extend 32-bit words into 64-bit lanes and add
+// those up, so no carry is lost before the final fold.
+
+__attribute__((target("sse2"))) uint64_t PartialSse2(const uint8_t* p,
+                                                     size_t len,
+                                                     uint64_t sum) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc0 = zero;
+  __m128i acc1 = zero;
+  for (; len >= 64; len -= 64, p += 64) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+    __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v0, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v0, zero));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v1, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v1, zero));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v2, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v2, zero));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v3, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v3, zero));
+  }
+  for (; len >= 16; len -= 16, p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, zero));
+    acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, zero));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes),
+                   _mm_add_epi64(acc0, acc1));
+  return PartialScalar(p, len, sum + lanes[0] + lanes[1]);
+}
+
+__attribute__((target("avx2"))) uint64_t PartialAvx2(const uint8_t* p,
+                                                     size_t len,
+                                                     uint64_t sum) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i acc0 = zero;
+  __m256i acc1 = zero;
+  for (; len >= 128; len -= 128, p += 128) {
+    __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 64));
+    __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 96));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v2, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v2, zero));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v3, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v3, zero));
+  }
+  for (; len >= 32; len -= 32, p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v, zero));
+    acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v, zero));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes),
+                      _mm256_add_epi64(acc0, acc1));
+  return PartialScalar(p, len,
+                       sum + lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+#endif  // defined(__x86_64__)
+
+PartialFunction GetPartialFunction(QuicXskChecksumKernel kernel) {
+  switch (kernel) {
+#if defined(__x86_64__)
+    case QuicXskChecksumKernel::kSse2:
+      return PartialSse2;
+    case QuicXskChecksumKernel::kAvx2:
+      return PartialAvx2;
+#endif
+    default:
+      return PartialScalar;
+  }
+}
+
+QuicXskChecksumKernel SelectKernel() {
+  if (QuicXskChecksumKernelSupported(QuicXskChecksumKernel::kAvx2)) {
+    return QuicXskChecksumKernel::kAvx2;
+  }
+  if (QuicXskChecksumKernelSupported(QuicXskChecksumKernel::kSse2)) {
+    return QuicXskChecksumKernel::kSse2;
+  }
+  return QuicXskChecksumKernel::kScalar;
+}
+
+// Selected once, on first use.
+PartialFunction SelectedPartialFunction() {
+  static const PartialFunction partial = GetPartialFunction(SelectKernel());
+  return partial;
+}
+
+}  // namespace
+
+bool QuicXskChecksumKernelSupported(QuicXskChecksumKernel kernel) {
+  switch (kernel) {
+    case QuicXskChecksumKernel::kScalar:
+      return true;
+#if defined(__x86_64__)
+    case QuicXskChecksumKernel::kSse2:
+      // Part of the x86-64 baseline.
+      return true;
+    case QuicXskChecksumKernel::kAvx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+QuicXskChecksumKernel QuicXskChecksumSelectedKernel() {
+  static const QuicXskChecksumKernel kernel = SelectKernel();
+  return kernel;
+}
+
+uint64_t QuicXskChecksumPartialWithKernel(QuicXskChecksumKernel kernel,
+                                          const void* data, size_t len,
+                                          uint64_t sum) {
+  return GetPartialFunction(kernel)(static_cast<const uint8_t*>(data), len,
+                                    sum);
+}
+
+uint64_t QuicXskChecksumPartial(const void* data, size_t len, uint64_t sum) {
+  return SelectedPartialFunction()(static_cast<const uint8_t*>(data), len,
+                                   sum);
+}
+
+uint16_t QuicXskChecksumFold16(uint64_t sum) {
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t>(sum);
+}
+
+uint16_t QuicXskChecksumReplace(uint16_t check, const void* old_data,
+                                const void* new_data, size_t len) {
+  // ~HC + ~m + m'
+  uint64_t sum = static_cast<uint16_t>(~check);
+  sum += static_cast<uint16_t>(
+      ~QuicXskChecksumFold16(PartialScalar(
+          static_cast<const uint8_t*>(old_data), len, 0)));
+  sum += PartialScalar(static_cast<const uint8_t*>(new_data), len, 0);
+  return QuicXskChecksumFinish(sum);
+}
+
+}  // namespace quic
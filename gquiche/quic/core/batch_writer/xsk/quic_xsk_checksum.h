@@ -0,0 +1,49 @@
+#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_CHECKSUM_H_
+#define QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace quic {
+
+// Internet checksum (RFC 1071) helpers for the packets the xsk writers
+// assemble. Sums are of native order 16-bit words, like the kernel's csum
+// helpers, so a folded checksum can be stored as is.
+
+enum class QuicXskChecksumKernel {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+// Adds the ones' complement sum of |len| bytes at |data| to |sum|. An odd
+// trailing byte is padded with zero. |data| needs no alignment; partial sums
+// of consecutive chunks may be added up as long as the chunks start at even
+// offsets. Uses the AVX2 kernel if the CPU supports it, else SSE2. AVX-512
+// measured no faster on packet sized inputs.
+uint64_t QuicXskChecksumPartial(const void* data, size_t len, uint64_t sum);
+
+// Folds |sum| to 16 bits without complementing it.
+uint16_t QuicXskChecksumFold16(uint64_t sum);
+
+// Folds and complements |sum| into the value of a checksum field.
+inline uint16_t QuicXskChecksumFinish(uint64_t sum) {
+  return static_cast<uint16_t>(~QuicXskChecksumFold16(sum));
+}
+
+// Updates checksum field |check| for |len| (even) bytes changing from
+// |old_data| to |new_data|, as in RFC 1624 eqn. 3.
+uint16_t QuicXskChecksumReplace(uint16_t check, const void* old_data,
+                                const void* new_data, size_t len);
+
+// For tests and benchmarks.
+bool QuicXskChecksumKernelSupported(QuicXskChecksumKernel kernel);
+QuicXskChecksumKernel QuicXskChecksumSelectedKernel();
+// |kernel| must be supported.
+uint64_t QuicXskChecksumPartialWithKernel(QuicXskChecksumKernel kernel,
+                                          const void* data, size_t len,
+                                          uint64_t sum);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_CHECKSUM_H_
@@ -0,0 +1,126 @@
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_checksum.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "gquiche/quic/core/batch_writer/xsk/quic_xdp_socket_utils.h"
+#include "gquiche/quic/core/crypto/quic_random.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicXskChecksumKernel kKernels[] = {
+    QuicXskChecksumKernel::kScalar,
+    QuicXskChecksumKernel::kSse2,
+    QuicXskChecksumKernel::kAvx2,
+};
+
+// 0x0000 and 0xffff are both zero in ones' complement.
+uint16_t Normalize(uint16_t value) {
+  return value == 0xffff ? 0 : value;
+}
+
+class QuicXskChecksumTest : public QuicTest {
+ protected:
+  QuicXskChecksumTest() : random_(QuicRandom::GetInstance()) {}
+
+  std::vector<uint8_t> RandomBytes(size_t len) {
+    std::vector<uint8_t> bytes(len);
+    random_->RandBytes(bytes.data(), len);
+    return bytes;
+  }
+
+  QuicRandom* random_;
+};
+
+TEST_F(QuicXskChecksumTest, ScalarAlwaysSupported) {
+  EXPECT_TRUE(QuicXskChecksumKernelSupported(QuicXskChecksumKernel::kScalar));
+  EXPECT_TRUE(QuicXskChecksumKernelSupported(QuicXskChecksumSelectedKernel()));
+}
+
+TEST_F(QuicXskChecksumTest, KnownValue) {
+  // RFC 1071, section 3.
+  const uint8_t data[] = {0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7};
+  for (QuicXskChecksumKernel kernel : kKernels) {
+    if (!QuicXskChecksumKernelSupported(kernel)) {
+      continue;
+    }
+    EXPECT_EQ(htons(0xddf2),
+              QuicXskChecksumFold16(QuicXskChecksumPartialWithKernel(
+                  kernel, data, sizeof(data), 0)));
+  }
+}
+
+// Every kernel agrees with the scalar code of quic_xdp_socket_utils.cc for
+// random lengths, contents and alignments.
+TEST_F(QuicXskChecksumTest, KernelsMatchUdpV6Checksum) {
+  std::vector<uint8_t> buffer = RandomBytes(64 * 1024 + 64);
+  in6_addr source;
+  in6_addr dest;
+  random_->RandBytes(&source, sizeof(source));
+  random_->RandBytes(&dest, sizeof(dest));
+
+  for (int i = 0; i < 10000; ++i) {
+    const size_t offset = random_->RandUint64() % 64;
+    const size_t len = i % 100 == 0 ? random_->RandUint64() % (64 * 1024)
+                                    : random_->RandUint64() % 1600;
+    random_->RandBytes(buffer.data() + offset, len);
+    const uint8_t* data = buffer.data() + offset;
+    const uint16_t expected =
+        tcp_udp_v6_checksum(&source, &dest, IPPROTO_UDP, data, len);
+
+    // The pseudo header, as tcp_udp_v6_checksum() sums it.
+    uint64_t pseudo_header = QuicXskChecksumPartial(&source, sizeof(source), 0);
+    pseudo_header = QuicXskChecksumPartial(&dest, sizeof(dest), pseudo_header);
+    pseudo_header += htonl(len) & 0xffff;
+    pseudo_header += htonl(len) >> 16;
+    pseudo_header += htons(IPPROTO_UDP);
+
+    for (QuicXskChecksumKernel kernel : kKernels) {
+      if (!QuicXskChecksumKernelSupported(kernel)) {
+        continue;
+      }
+      uint64_t sum =
+          QuicXskChecksumPartialWithKernel(kernel, data, len, pseudo_header);
+      EXPECT_EQ(expected, QuicXskChecksumFinish(sum))
+          << "kernel " << static_cast<int>(kernel) << " offset " << offset
+          << " len " << len;
+    }
+  }
+}
+
+TEST_F(QuicXskChecksumTest, MatchesIpFastCsum) {
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint8_t> header = RandomBytes(20);
+    EXPECT_EQ(ip_fast_csum(header.data(), 5),
+              QuicXskChecksumFinish(
+                  QuicXskChecksumPartial(header.data(), header.size(), 0)));
+  }
+}
+
+TEST_F(QuicXskChecksumTest, Replace) {
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint8_t> before = RandomBytes(40);
+    std::vector<uint8_t> after = before;
+    const size_t offset = 2 * (random_->RandUint64() % 16);
+    random_->RandBytes(after.data() + offset, 8);
+
+    const uint16_t check =
+        QuicXskChecksumFinish(QuicXskChecksumPartial(before.data(), 40, 0));
+    const uint16_t expected =
+        QuicXskChecksumFinish(QuicXskChecksumPartial(after.data(), 40, 0));
+    const uint16_t updated = QuicXskChecksumReplace(
+        check, before.data() + offset, after.data() + offset, 8);
+    EXPECT_EQ(Normalize(expected), Normalize(updated));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,79 @@
+// XDP program loaded by QuicXskSocket. UDP datagrams for the QUIC server
+// port are redirected to the AF_XDP socket bound to the queue they arrived
+// on; everything else, and datagrams of queues without a socket, goes to the
+// kernel stack.
+//
+// A socket only accepts the frames of the queue it is bound to, so the
+// program cannot move a connection to another queue. With several queues,
+// the QuicXskMultiQueueServer workers steer by connection ID among
+// themselves.
+//
+// Built with: clang -O2 -target bpf -c quic_xsk_redirect_kern.c
+
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/in.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/udp.h>
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+#define QUIC_XSK_MAX_QUEUES 64
+
+struct {
+  __uint(type, BPF_MAP_TYPE_XSKMAP);
+  __uint(max_entries, QUIC_XSK_MAX_QUEUES);
+  __type(key, __u32);
+  __type(value, __u32);
+} xsks_map SEC(".maps");
+
+// Entry 0 holds the server's UDP port, in host byte order.
+struct {
+  __uint(type, BPF_MAP_TYPE_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, __u32);
+  __type(value, __u32);
+} quic_port_map SEC(".maps");
+
+SEC("xdp")
+int quic_xsk_redirect(struct xdp_md* ctx) {
+  void* data = (void*)(long)ctx->data;
+  void* data_end = (void*)(long)ctx->data_end;
+  struct ethhdr* eth = data;
+  struct udphdr* udp;
+  __u32 key = 0;
+  __u32* port;
+
+  if ((void*)(eth + 1) > data_end) {
+    return XDP_PASS;
+  }
+  if (eth->h_proto == bpf_htons(ETH_P_IP)) {
+    struct iphdr* ip = (void*)(eth + 1);
+    // QuicXdpSocketUtils only parses IPv4 headers without options.
+    if ((void*)(ip + 1) > data_end || ip->protocol != IPPROTO_UDP ||
+        ip->ihl != 5) {
+      return XDP_PASS;
+    }
+    udp = (void*)(ip + 1);
+  } else if (eth->h_proto == bpf_htons(ETH_P_IPV6)) {
+    struct ipv6hdr* ip6 = (void*)(eth + 1);
+    if ((void*)(ip6 + 1) > data_end || ip6->nexthdr != IPPROTO_UDP) {
+      return XDP_PASS;
+    }
+    udp = (void*)(ip6 + 1);
+  } else {
+    return XDP_PASS;
+  }
+  if ((void*)(udp + 1) > data_end) {
+    return XDP_PASS;
+  }
+
+  port = bpf_map_lookup_elem(&quic_port_map, &key);
+  if (!port || udp->dest != bpf_htons(*port)) {
+    return XDP_PASS;
+  }
+  return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+}
+
+char _license[] SEC("license") = "GPL";
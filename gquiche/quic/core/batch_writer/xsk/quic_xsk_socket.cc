@@ -0,0 +1,331 @@
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_socket.h"
+
+#include <errno.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <bpf/xsk.h>
+
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QuicXskRedirectProgram::QuicXskRedirectProgram()
+    : bpf_obj_(nullptr),
+      xsks_map_fd_(-1),
+      ifindex_(0),
+      xdp_flags_(0),
+      attached_(false) {}
+
+QuicXskRedirectProgram::~QuicXskRedirectProgram() {
+  Detach();
+}
+
+bool QuicXskRedirectProgram::Attach(const std::string& interface_name,
+                                    const std::string& bpf_object_path,
+                                    uint16_t port, bool generic_mode) {
+  ifindex_ = if_nametoindex(interface_name.c_str());
+  if (ifindex_ == 0) {
+    QUIC_LOG(ERROR) << "Unknown interface " << interface_name;
+    return false;
+  }
+  xdp_flags_ = XDP_FLAGS_UPDATE_IF_NOEXIST |
+               (generic_mode ? XDP_FLAGS_SKB_MODE : XDP_FLAGS_DRV_MODE);
+
+  bpf_obj_ = bpf_object__open_file(bpf_object_path.c_str(), nullptr);
+  if (libbpf_get_error(bpf_obj_)) {
+    bpf_obj_ = nullptr;
+    QUIC_LOG(ERROR) << "Failed to open " << bpf_object_path;
+    return false;
+  }
+  if (bpf_object__load(bpf_obj_) != 0) {
+    QUIC_LOG(ERROR) << "Failed to load " << bpf_object_path;
+    Detach();
+    return false;
+  }
+
+  bpf_program* program =
+      bpf_object__find_program_by_name(bpf_obj_, kQuicXskRedirectProgram);
+  bpf_map* xsks_map = bpf_object__find_map_by_name(bpf_obj_, kQuicXskSocketMap);
+  bpf_map* port_map = bpf_object__find_map_by_name(bpf_obj_, kQuicXskPortMap);
+  if (program == nullptr || xsks_map == nullptr || port_map == nullptr) {
+    QUIC_LOG(ERROR) << bpf_object_path
+                    << " is not built from quic_xsk_redirect_kern.c";
+    Detach();
+    return false;
+  }
+  xsks_map_fd_ = bpf_map__fd(xsks_map);
+
+  uint32_t key = 0;
+  uint32_t value = port;
+  if (bpf_map_update_elem(bpf_map__fd(port_map), &key, &value, BPF_ANY) != 0) {
+    QUIC_LOG(ERROR) << "Failed to set the XDP port: " << strerror(errno);
+    Detach();
+    return false;
+  }
+
+  if (bpf_set_link_xdp_fd(ifindex_, bpf_program__fd(program), xdp_flags_) < 0) {
+    QUIC_LOG(ERROR) << "Failed to attach the XDP program to " << interface_name
+                    << ", is another one attached already?";
+    Detach();
+    return false;
+  }
+  attached_ = true;
+  return true;
+}
+
+void QuicXskRedirectProgram::Detach() {
+  if (attached_) {
+    bpf_set_link_xdp_fd(ifindex_, -1, xdp_flags_ & ~XDP_FLAGS_UPDATE_IF_NOEXIST);
+    attached_ = false;
+  }
+  if (bpf_obj_ != nullptr) {
+    bpf_object__close(bpf_obj_);
+    bpf_obj_ = nullptr;
+  }
+  xsks_map_fd_ = -1;
+}
+
+QuicXskUmem::QuicXskUmem(size_t num_partitions)
+    : num_partitions_(num_partitions), rings_() {}
+
+QuicXskUmem::~QuicXskUmem() {
+  if (rings_.umem != nullptr) {
+    xsk_umem__delete(rings_.umem);
+    rings_.umem = nullptr;
+  }
+  if (rings_.buffer != nullptr) {
+    free(rings_.buffer);
+    rings_.buffer = nullptr;
+  }
+}
+
+bool QuicXskUmem::Create() {
+  size_t size = num_partitions_ * NUM_FRAMES * XSK_UMEM__DEFAULT_FRAME_SIZE;
+  if (posix_memalign(&rings_.buffer, getpagesize(), size) != 0) {
+    rings_.buffer = nullptr;
+    QUIC_LOG(ERROR) << "Failed to allocate the UMEM";
+    return false;
+  }
+  int ret = xsk_umem__create(&rings_.umem, rings_.buffer, size, &rings_.fq,
+                             &rings_.cq, nullptr);
+  if (ret != 0) {
+    rings_.umem = nullptr;
+    QUIC_LOG(ERROR) << "xsk_umem__create failed: " << strerror(-ret);
+    return false;
+  }
+  return true;
+}
+
+QuicXskStats& QuicXskStats::operator+=(const QuicXskStats& other) {
+  rx_empty_polls += other.rx_empty_polls;
+  fill_fail_polls += other.fill_fail_polls;
+  fill_wakeups += other.fill_wakeups;
+  copy_tx_sendtos += other.copy_tx_sendtos;
+  tx_wakeup_sendtos += other.tx_wakeup_sendtos;
+  tx_wakeups_skipped += other.tx_wakeups_skipped;
+  tx_ring_full += other.tx_ring_full;
+  tx_reaps += other.tx_reaps;
+  tx_frames_reaped += other.tx_frames_reaped;
+  return *this;
+}
+
+QuicXskStats QuicXskStats::operator-(const QuicXskStats& earlier) const {
+  QuicXskStats delta;
+  delta.rx_empty_polls = rx_empty_polls - earlier.rx_empty_polls;
+  delta.fill_fail_polls = fill_fail_polls - earlier.fill_fail_polls;
+  delta.fill_wakeups = fill_wakeups - earlier.fill_wakeups;
+  delta.copy_tx_sendtos = copy_tx_sendtos - earlier.copy_tx_sendtos;
+  delta.tx_wakeup_sendtos = tx_wakeup_sendtos - earlier.tx_wakeup_sendtos;
+  delta.tx_wakeups_skipped = tx_wakeups_skipped - earlier.tx_wakeups_skipped;
+  delta.tx_ring_full = tx_ring_full - earlier.tx_ring_full;
+  delta.tx_reaps = tx_reaps - earlier.tx_reaps;
+  delta.tx_frames_reaped = tx_frames_reaped - earlier.tx_frames_reaped;
+  return delta;
+}
+
+std::string QuicXskStats::ToString() const {
+  std::ostringstream os;
+  os << "{ rx_empty_polls: " << rx_empty_polls
+     << " fill_fail_polls: " << fill_fail_polls
+     << " fill_wakeups: " << fill_wakeups
+     << " copy_tx_sendtos: " << copy_tx_sendtos
+     << " tx_wakeup_sendtos: " << tx_wakeup_sendtos
+     << " tx_wakeups_skipped: " << tx_wakeups_skipped
+     << " tx_ring_full: " << tx_ring_full << " tx_reaps: " << tx_reaps
+     << " tx_frames_reaped: " << tx_frames_reaped << " }";
+  return os.str();
+}
+
+// |xsk_| is value initialized, so zeroed, stats included.
+QuicXskSocket::QuicXskSocket()
+    : xsk_(std::make_unique<xsk_socket_info>()), rings_() {
+  memset(self_mac_addr_, 0, sizeof(self_mac_addr_));
+  memset(peer_mac_addr_, 0, sizeof(peer_mac_addr_));
+}
+
+QuicXskSocket::~QuicXskSocket() {
+  Close();
+}
+
+bool QuicXskSocket::Open(const Options& options) {
+  QuicXskRedirectProgram* program = options.program;
+  if (program == nullptr) {
+    own_program_ = std::make_unique<QuicXskRedirectProgram>();
+    if (!own_program_->Attach(options.interface_name, options.bpf_object_path,
+                              options.port, options.generic_mode)) {
+      Close();
+      return false;
+    }
+    program = own_program_.get();
+  }
+  QuicXskUmem* umem = options.umem;
+  size_t partition = options.umem_partition;
+  if (umem == nullptr) {
+    own_umem_ = std::make_unique<QuicXskUmem>(1);
+    if (!own_umem_->Create()) {
+      Close();
+      return false;
+    }
+    umem = own_umem_.get();
+    partition = 0;
+  }
+  if (!CreateSocket(options, program, umem, partition)) {
+    Close();
+    return false;
+  }
+  ReadSelfMacAddr(options.interface_name);
+  QUIC_LOG(INFO) << "AF_XDP socket bound to " << options.interface_name
+                 << " queue " << options.queue_id
+                 << (options.generic_mode ? " (generic mode)" : "")
+                 << (options.umem != nullptr ? " (shared UMEM)" : "");
+  return true;
+}
+
+void QuicXskSocket::Close() {
+  if (xsk_->xsk != nullptr) {
+    xsk_socket__delete(xsk_->xsk);
+    xsk_->xsk = nullptr;
+  }
+  // Sockets go before the UMEM, which goes before the program.
+  own_umem_.reset();
+  own_program_.reset();
+}
+
+QuicXskStats QuicXskSocket::GetStats() const {
+  const xsk_app_stats& stats = xsk_->stats;
+  QuicXskStats result;
+  result.rx_empty_polls = stats.rx_empty_polls.load(std::memory_order_relaxed);
+  result.fill_fail_polls =
+      stats.fill_fail_polls.load(std::memory_order_relaxed);
+  result.fill_wakeups = stats.fill_wakeups.load(std::memory_order_relaxed);
+  result.copy_tx_sendtos =
+      stats.copy_tx_sendtos.load(std::memory_order_relaxed);
+  result.tx_wakeup_sendtos =
+      stats.tx_wakeup_sendtos.load(std::memory_order_relaxed);
+  result.tx_wakeups_skipped =
+      stats.tx_wakeups_skipped.load(std::memory_order_relaxed);
+  result.tx_ring_full = stats.tx_ring_full.load(std::memory_order_relaxed);
+  result.tx_reaps = stats.tx_reaps.load(std::memory_order_relaxed);
+  result.tx_frames_reaped =
+      stats.tx_frames_reaped.load(std::memory_order_relaxed);
+  return result;
+}
+
+int QuicXskSocket::fd() const {
+  return xsk_->xsk == nullptr ? -1 : xsk_socket__fd(xsk_->xsk);
+}
+
+void QuicXskSocket::OnSelfMacAddrUpdate(unsigned char* self_mac_addr) {
+  memcpy(self_mac_addr_, self_mac_addr, ETH_ALEN);
+}
+
+void QuicXskSocket::OnPeerMacAddrUpdate(unsigned char* peer_mac_addr) {
+  memcpy(peer_mac_addr_, peer_mac_addr, ETH_ALEN);
+}
+
+bool QuicXskSocket::CreateSocket(const Options& options,
+                                 QuicXskRedirectProgram* program,
+                                 QuicXskUmem* umem, size_t partition) {
+  if (partition >= umem->num_partitions()) {
+    QUIC_LOG(ERROR) << "UMEM partition " << partition << " out of range";
+    return false;
+  }
+  rings_.umem = umem->umem();
+  rings_.buffer = umem->buffer();
+  xsk_->umem = &rings_;
+  xsk_socket_config& config = xsk_->socket_config;
+  config.rx_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+  config.tx_size = XSK_RING_PROD__DEFAULT_NUM_DESCS;
+  // The redirect program is ours, not the libbpf default.
+  config.libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
+  config.xdp_flags = options.generic_mode ? XDP_FLAGS_SKB_MODE
+                                          : XDP_FLAGS_DRV_MODE;
+  config.bind_flags =
+      XDP_USE_NEED_WAKEUP | (options.generic_mode ? XDP_COPY : XDP_ZEROCOPY);
+
+  // Every socket gets its own fill and completion rings, so queues sharing
+  // the UMEM never contend on them.
+  int ret = xsk_socket__create_shared(
+      &xsk_->xsk, options.interface_name.c_str(), options.queue_id,
+      rings_.umem, &xsk_->rx, &xsk_->tx, &rings_.fq, &rings_.cq, &config);
+  if (ret != 0) {
+    xsk_->xsk = nullptr;
+    QUIC_LOG(ERROR) << "xsk_socket__create_shared failed: " << strerror(-ret);
+    return false;
+  }
+  ret = xsk_socket__update_xskmap(xsk_->xsk, program->xsks_map_fd());
+  if (ret != 0) {
+    QUIC_LOG(ERROR) << "xsk_socket__update_xskmap failed: " << strerror(-ret);
+    return false;
+  }
+
+  const uint64_t base = umem->partition_base(partition);
+  for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+    xsk_->umem_frame_addr[i] = base + i * XSK_UMEM__DEFAULT_FRAME_SIZE;
+  }
+  xsk_->umem_frame_free = NUM_FRAMES;
+  xsk_->outstanding_tx = 0;
+
+  // Hand the fill ring its frames. They cycle between the fill and RX rings
+  // (see QuicXdpSocketUtils::ReleaseRxRing); the remaining frames are used
+  // for TX.
+  uint32_t idx;
+  ret = xsk_ring_prod__reserve(&rings_.fq, XSK_RING_PROD__DEFAULT_NUM_DESCS,
+                               &idx);
+  if (ret != XSK_RING_PROD__DEFAULT_NUM_DESCS) {
+    QUIC_LOG(ERROR) << "Failed to populate the fill ring";
+    return false;
+  }
+  for (uint32_t i = 0; i < XSK_RING_PROD__DEFAULT_NUM_DESCS; i++) {
+    *xsk_ring_prod__fill_addr(&rings_.fq, idx++) =
+        xsk_alloc_umem_frame(xsk_.get());
+  }
+  xsk_ring_prod__submit(&rings_.fq, XSK_RING_PROD__DEFAULT_NUM_DESCS);
+  return true;
+}
+
+void QuicXskSocket::ReadSelfMacAddr(const std::string& interface_name) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return;
+  }
+  struct ifreq ifr;
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, interface_name.c_str(), IFNAMSIZ - 1);
+  if (ioctl(fd, SIOCGIFHWADDR, &ifr) == 0) {
+    memcpy(self_mac_addr_, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+  }
+  close(fd);
+}
+
+}  // namespace quic
@@ -0,0 +1,163 @@
+#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_SOCKET_H_
+#define QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_SOCKET_H_
+
+#include <linux/if_ether.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gquiche/quic/core/batch_writer/xsk/quic_xdp_socket_utils.h"
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_types.h"
+
+namespace quic {
+
+// Name of the XDP program and maps in quic_xsk_redirect_kern.c.
+constexpr char kQuicXskRedirectProgram[] = "quic_xsk_redirect";
+constexpr char kQuicXskSocketMap[] = "xsks_map";
+constexpr char kQuicXskPortMap[] = "quic_port_map";
+
+// The XDP program of quic_xsk_redirect_kern.c attached to an interface. One
+// instance serves the sockets of all the interface's queues.
+class QuicXskRedirectProgram {
+ public:
+  QuicXskRedirectProgram();
+  QuicXskRedirectProgram(const QuicXskRedirectProgram&) = delete;
+  QuicXskRedirectProgram& operator=(const QuicXskRedirectProgram&) = delete;
+  ~QuicXskRedirectProgram();
+
+  // Loads |bpf_object_path|, sets the redirected |port| and attaches the
+  // program, in generic (skb) mode if |generic_mode|.
+  bool Attach(const std::string& interface_name,
+              const std::string& bpf_object_path, uint16_t port,
+              bool generic_mode);
+  void Detach();
+
+  // The XSKMAP sockets insert themselves in, keyed by queue.
+  int xsks_map_fd() const { return xsks_map_fd_; }
+
+ private:
+  bpf_object* bpf_obj_;
+  int xsks_map_fd_;
+  int ifindex_;
+  uint32_t xdp_flags_;
+  bool attached_;
+};
+
+// A UMEM split into |num_partitions| partitions of NUM_FRAMES frames. Each
+// socket using it owns one partition and its own fill and completion rings,
+// so sockets bound to different queues can share one UMEM without sharing
+// any ring.
+class QuicXskUmem {
+ public:
+  explicit QuicXskUmem(size_t num_partitions);
+  QuicXskUmem(const QuicXskUmem&) = delete;
+  QuicXskUmem& operator=(const QuicXskUmem&) = delete;
+  // Must outlive the sockets using it.
+  ~QuicXskUmem();
+
+  bool Create();
+
+  size_t num_partitions() const { return num_partitions_; }
+  xsk_umem* umem() { return rings_.umem; }
+  void* buffer() { return rings_.buffer; }
+  // Address of the first frame of |partition|.
+  uint64_t partition_base(size_t partition) const {
+    return partition * NUM_FRAMES * XSK_UMEM__DEFAULT_FRAME_SIZE;
+  }
+
+ private:
+  size_t num_partitions_;
+  // The rings created with the UMEM; libbpf hands them over to the first
+  // socket bound with it.
+  xsk_umem_info rings_;
+};
+
+// The counters of xsk_app_stats, read at one time.
+struct QuicXskStats {
+  uint64_t rx_empty_polls = 0;
+  uint64_t fill_fail_polls = 0;
+  uint64_t fill_wakeups = 0;
+  uint64_t copy_tx_sendtos = 0;
+  uint64_t tx_wakeup_sendtos = 0;
+  uint64_t tx_wakeups_skipped = 0;
+  uint64_t tx_ring_full = 0;
+  uint64_t tx_reaps = 0;
+  uint64_t tx_frames_reaped = 0;
+
+  QuicXskStats& operator+=(const QuicXskStats& other);
+  // Counts since |earlier|.
+  QuicXskStats operator-(const QuicXskStats& earlier) const;
+  std::string ToString() const;
+};
+
+// Owns an AF_XDP socket bound to one queue of an interface, its fill and
+// completion rings and, unless given shared ones, its UMEM and the XDP
+// program redirecting the QUIC server port to it. It is also the
+// QuicXdpSocketUtils::Visitor holding the MAC addresses learnt by
+// QuicXskPacketReader and used by the xsk writers.
+class QuicXskSocket : public QuicXdpSocketUtils::Visitor {
+ public:
+  struct Options {
+    std::string interface_name;
+    uint32_t queue_id = 0;
+    // UDP port redirected to the socket.
+    uint16_t port = 0;
+    // Object file built from quic_xsk_redirect_kern.c.
+    std::string bpf_object_path;
+    // Attach in XDP generic (skb) mode and copy frames. Works on any
+    // interface, including veth; otherwise native mode and zero copy are
+    // required.
+    bool generic_mode = false;
+    // If set, the socket joins this already attached program instead of
+    // loading its own from |bpf_object_path|.
+    QuicXskRedirectProgram* program = nullptr;
+    // If set, the socket uses partition |umem_partition| of this UMEM
+    // instead of allocating its own.
+    QuicXskUmem* umem = nullptr;
+    size_t umem_partition = 0;
+  };
+
+  QuicXskSocket();
+  QuicXskSocket(const QuicXskSocket&) = delete;
+  QuicXskSocket& operator=(const QuicXskSocket&) = delete;
+  ~QuicXskSocket() override;
+
+  // Attaches the XDP program if needed and creates the socket. Returns false
+  // and releases everything on failure.
+  bool Open(const Options& options);
+  void Close();
+
+  bool IsOpen() const { return xsk_->xsk != nullptr; }
+  int fd() const;
+  xsk_socket_info* xsk() { return xsk_.get(); }
+  // May be called from any thread.
+  QuicXskStats GetStats() const;
+
+  // QuicXdpSocketUtils::Visitor
+  unsigned char* self_mac_addr() override { return self_mac_addr_; }
+  unsigned char* peer_mac_addr() override { return peer_mac_addr_; }
+  void OnSelfMacAddrUpdate(unsigned char* self_mac_addr) override;
+  void OnPeerMacAddrUpdate(unsigned char* peer_mac_addr) override;
+
+ private:
+  bool CreateSocket(const Options& options, QuicXskRedirectProgram* program,
+                    QuicXskUmem* umem, size_t partition);
+  void ReadSelfMacAddr(const std::string& interface_name);
+
+  // Large (one address per UMEM frame), so kept off the stack and out of the
+  // owning object.
+  std::unique_ptr<xsk_socket_info> xsk_;
+  // This socket's fill and completion rings, over the UMEM in use.
+  xsk_umem_info rings_;
+
+  std::unique_ptr<QuicXskRedirectProgram> own_program_;
+  std::unique_ptr<QuicXskUmem> own_umem_;
+
+  unsigned char self_mac_addr_[ETH_ALEN];
+  unsigned char peer_mac_addr_[ETH_ALEN];
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_SOCKET_H_
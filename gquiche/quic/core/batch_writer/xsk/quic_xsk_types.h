@@ -1,49 +1,71 @@
-#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_TYPES_H_
-#define QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_TYPES_H_
-
-#include <cstdint>
-#include <bpf/xsk.h>
-#include <bpf/libbpf.h>
-
-#define NUM_FRAMES (4 * 1024)
-#define INVALID_UMEM_FRAME UINT64_MAX
-
-namespace quic {
-
-struct xsk_app_stats {
-	unsigned long rx_empty_polls;
-	unsigned long fill_fail_polls;
-	unsigned long copy_tx_sendtos;
-	unsigned long opt_polls;
-	unsigned long prev_rx_empty_polls;
-	unsigned long prev_fill_fail_polls;
-	unsigned long prev_copy_tx_sendtos;
-	unsigned long prev_tx_wakeup_sendtos;
-	unsigned long prev_opt_polls;
-};
-
-typedef struct xsk_socket_info {
- struct xsk_ring_cons rx;
- struct xsk_ring_prod tx;
- struct xsk_umem_info *umem;
- struct xsk_socket *xsk;
- struct xsk_socket_config socket_config;
-
- uint64_t umem_frame_addr[NUM_FRAMES];
- uint32_t umem_frame_free;
-
- uint32_t outstanding_tx;
-} xsk_socket_info;
-
-typedef struct xsk_umem_info {
- struct xsk_ring_prod fq;
- struct xsk_ring_cons cq;
- struct xsk_umem *umem;
- void *buffer;
-} xsk_umem_info;
-
-typedef struct bpf_object bpf_object;
-typedef struct bpf_map    bpf_map;
-
-} // namespace quic
+#ifndef QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_TYPES_H_
+#define QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_TYPES_H_
+
+#include <atomic>
+#include <cstdint>
+#include <bpf/xsk.h>
+#include <bpf/libbpf.h>
+
+#define NUM_FRAMES (4 * 1024)
+#define INVALID_UMEM_FRAME UINT64_MAX
+
+namespace quic {
+
+// Counters of the ring and syscall activity of one socket, to tell whether
+// the XDP path is bound by syscalls (sendtos, wakeups) or by the rings
+// (empty polls, full rings). Only the socket's thread writes them, see
+// xsk_stats_add(); any thread may read them.
+struct xsk_app_stats {
+	// RX polls which found the RX ring empty.
+	std::atomic<unsigned long> rx_empty_polls;
+	// RX polls which could not reserve the fill ring.
+	std::atomic<unsigned long> fill_fail_polls;
+	// recvfrom() calls waking the kernel up to consume the fill ring.
+	std::atomic<unsigned long> fill_wakeups;
+	// sendto() calls in copy mode, where each one copies the TX ring out.
+	std::atomic<unsigned long> copy_tx_sendtos;
+	// sendto() calls in zero copy mode, where each one is a wakeup.
+	std::atomic<unsigned long> tx_wakeup_sendtos;
+	// Wakeups left out because the kernel was still processing the TX ring.
+	std::atomic<unsigned long> tx_wakeups_skipped;
+	// Writes that found the TX ring full.
+	std::atomic<unsigned long> tx_ring_full;
+	// Completion ring reaps and the frames they recycled.
+	std::atomic<unsigned long> tx_reaps;
+	std::atomic<unsigned long> tx_frames_reaped;
+};
+
+inline void xsk_stats_add(std::atomic<unsigned long>& counter,
+                          unsigned long n = 1) {
+	// Single writer: no locked read-modify-write needed.
+	counter.store(counter.load(std::memory_order_relaxed) + n,
+	              std::memory_order_relaxed);
+}
+
+typedef struct xsk_socket_info {
+ struct xsk_ring_cons rx;
+ struct xsk_ring_prod tx;
+ struct xsk_umem_info *umem;
+ struct xsk_socket *xsk;
+ struct xsk_socket_config socket_config;
+
+ uint64_t umem_frame_addr[NUM_FRAMES];
+ uint32_t umem_frame_free;
+
+ uint32_t outstanding_tx;
+
+ struct xsk_app_stats stats;
+} xsk_socket_info;
+
+typedef struct xsk_umem_info {
+ struct xsk_ring_prod fq;
+ struct xsk_ring_cons cq;
+ struct xsk_umem *umem;
+ void *buffer;
+} xsk_umem_info;
+
+typedef struct bpf_object bpf_object;
+typedef struct bpf_map    bpf_map;
+
+} // namespace quic
 #endif // QUICHE_QUIC_CORE_BATCH_WRITER_XSK_QUIC_XSK_TYPES_H_
\ No newline at end of file
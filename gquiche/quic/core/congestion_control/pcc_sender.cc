@@ -0,0 +1,636 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/congestion_control/pcc_sender.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "gquiche/quic/core/congestion_control/rtt_stats.h"
+#include "gquiche/quic/core/quic_time_accumulator.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Utility function parameters, from the PCC Vivace paper.
+const double kUtilityExponent = 0.9;
+const double kLatencyCoefficient = 900;
+const double kLossCoefficient = 11.35;
+// RTT gradients smaller than this are noise.
+const double kRttGradientTolerance = 0.01;
+
+// The rate is multiplied by this every monitor interval in STARTING.
+const float kStartingGain = 2.0f;
+
+// Relative distance of the probing rates from the sending rate. Grows after
+// every round of probing whose pairs disagree.
+const float kMinProbingStep = 0.05f;
+const float kMaxProbingStep = 0.10f;
+const float kProbingStepIncrement = 0.01f;
+
+// Rate change, in Mbps, per unit of utility gradient, in utility per Mbps.
+const double kRateStepGain = 1.0;
+// A step may change the rate by this fraction at most, plus the increment for
+// every consecutive step that hit the bound.
+const double kInitialRateChangeBound = 0.05;
+const double kRateChangeBoundIncrement = 0.1;
+
+// Monitor intervals last at least this many packets at their rate.
+const QuicPacketCount kMinPacketsPerInterval = 10;
+
+// The congestion window is this many times the BDP at the current rate.
+const float kCongestionWindowGain = 2.0f;
+const QuicByteCount kDefaultMinimumCongestionWindow = 4 * kMaxSegmentSize;
+
+// The delivery rate filter window, in round trips.
+const QuicRoundTripCount kBandwidthWindowSize = 10;
+
+double ToMegabitsPerSecond(QuicBandwidth rate) {
+  return rate.ToBitsPerSecond() / 1e6;
+}
+
+QuicBandwidth FromMegabitsPerSecond(double rate) {
+  return QuicBandwidth::FromBitsPerSecond(static_cast<int64_t>(rate * 1e6));
+}
+
+}  // namespace
+
+PccSender::DebugState::DebugState(const PccSender& sender)
+    : mode(sender.mode_),
+      sending_rate(sender.sending_rate_),
+      bandwidth_estimate(sender.BandwidthEstimate()),
+      congestion_window(sender.GetCongestionWindow()),
+      probing_step(sender.probing_step_),
+      rate_change_amplifier(sender.rate_change_amplifier_),
+      num_monitor_intervals(sender.monitor_intervals_.size()),
+      last_utility(sender.last_utility_),
+      smoothed_rtt(sender.rtt_stats_->smoothed_rtt()),
+      min_rtt(sender.rtt_stats_->min_rtt()) {}
+
+PccSender::DebugState::DebugState(const DebugState& state) = default;
+
+PccSender::MonitorInterval::MonitorInterval(
+    QuicBandwidth sending_rate, bool is_useful, QuicTime start_time,
+    QuicTime end_time, QuicPacketNumber first_packet_number)
+    : sending_rate(sending_rate),
+      is_useful(is_useful),
+      is_app_limited(false),
+      start_time(start_time),
+      end_time(end_time),
+      first_packet_number(first_packet_number),
+      last_packet_number(first_packet_number),
+      packets_sent(0),
+      packets_done(0),
+      bytes_acked(0),
+      bytes_lost(0),
+      first_rtt_sample_time(QuicTime::Zero()),
+      num_rtt_samples(0),
+      sum_time(0),
+      sum_rtt(0),
+      sum_time_squared(0),
+      sum_time_rtt(0) {}
+
+float PccSender::MonitorInterval::RttGradient() const {
+  if (num_rtt_samples < 2) {
+    return 0;
+  }
+  const double denominator =
+      num_rtt_samples * sum_time_squared - sum_time * sum_time;
+  if (denominator <= 0) {
+    return 0;
+  }
+  return (num_rtt_samples * sum_time_rtt - sum_time * sum_rtt) / denominator;
+}
+
+PccSender::PccSender(const RttStats* rtt_stats,
+                     const QuicUnackedPacketMap* unacked_packets,
+                     QuicPacketCount initial_tcp_congestion_window,
+                     QuicPacketCount max_tcp_congestion_window,
+                     QuicRandom* random, QuicConnectionStats* stats)
+    : rtt_stats_(rtt_stats),
+      unacked_packets_(unacked_packets),
+      random_(random),
+      stats_(stats),
+      mode_(STARTING),
+      sending_rate_(QuicBandwidth::Zero()),
+      sampler_(unacked_packets, kBandwidthWindowSize),
+      max_bandwidth_(kBandwidthWindowSize, QuicBandwidth::Zero(), 0),
+      round_trip_count_(0),
+      has_non_app_limited_sample_(false),
+      double_rate_on_next_interval_(false),
+      num_probing_intervals_sent_(0),
+      num_probing_intervals_completed_(0),
+      probing_step_(kMinProbingStep),
+      moving_up_(true),
+      rate_change_amplifier_(0),
+      rate_change_bound_hits_(0),
+      moving_interval_pending_(false),
+      last_utility_(0),
+      initial_congestion_window_(initial_tcp_congestion_window *
+                                 kDefaultTCPMSS),
+      max_congestion_window_(max_tcp_congestion_window * kDefaultTCPMSS) {
+  if (stats_) {
+    // Clear some startup stats if |stats_| has been used by another sender,
+    // which happens e.g. when QuicConnection switch send algorithms.
+    stats_->slowstart_count = 0;
+    stats_->slowstart_duration = QuicTimeAccumulator();
+  }
+  EnterStarting();
+}
+
+PccSender::~PccSender() {}
+
+bool PccSender::InSlowStart() const { return mode_ == STARTING; }
+
+bool PccSender::InRecovery() const { return false; }
+
+void PccSender::AdjustNetworkParameters(const NetworkParams& params) {
+  if (params.bandwidth.IsZero() || mode_ != STARTING) {
+    return;
+  }
+  if (params.allow_cwnd_to_decrease || params.bandwidth > sending_rate_) {
+    sending_rate_ = ClampRate(params.bandwidth);
+  }
+}
+
+void PccSender::SetInitialCongestionWindowInPackets(
+    QuicPacketCount congestion_window) {
+  if (mode_ == STARTING && monitor_intervals_.empty()) {
+    initial_congestion_window_ = congestion_window * kDefaultTCPMSS;
+    EnterStarting();
+  }
+}
+
+void PccSender::SetExtraLossThreshold(float /*extra_loss_threshold*/) {}
+
+void PccSender::SetUpdateRangeTime(QuicTime::Delta /*update_range_time*/) {}
+
+void PccSender::SetIsUpdatePacketLostFlag(
+    bool /*is_update_min_packet_lost*/) {}
+
+void PccSender::SetUseBandwidthListFlag(bool /*is_use_bandwidth_list*/) {}
+
+void PccSender::OnPacketSent(QuicTime sent_time, QuicByteCount bytes_in_flight,
+                             QuicPacketNumber packet_number,
+                             QuicByteCount bytes,
+                             HasRetransmittableData is_retransmittable) {
+  if (stats_ && InSlowStart()) {
+    ++stats_->slowstart_packets_sent;
+    stats_->slowstart_bytes_sent += bytes;
+  }
+
+  last_sent_packet_ = packet_number;
+  sampler_.OnPacketSent(sent_time, packet_number, bytes, bytes_in_flight,
+                        is_retransmittable);
+
+  // Only packets in flight are ever acked or lost.
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    return;
+  }
+  if (monitor_intervals_.empty() ||
+      sent_time >= monitor_intervals_.back().end_time) {
+    StartMonitorInterval(sent_time, packet_number);
+  }
+  MonitorInterval& interval = monitor_intervals_.back();
+  interval.last_packet_number = packet_number;
+  ++interval.packets_sent;
+}
+
+void PccSender::OnPacketNeutered(QuicPacketNumber packet_number) {
+  sampler_.OnPacketNeutered(packet_number);
+  MonitorInterval* interval = IntervalOf(packet_number);
+  if (interval != nullptr) {
+    ++interval->packets_done;
+  }
+}
+
+void PccSender::OnCongestionEvent(bool rtt_updated,
+                                  QuicByteCount /*prior_in_flight*/,
+                                  QuicTime event_time,
+                                  const AckedPacketVector& acked_packets,
+                                  const LostPacketVector& lost_packets) {
+  if (!acked_packets.empty()) {
+    UpdateRoundTripCounter(acked_packets.rbegin()->packet_number);
+  }
+  const BandwidthSamplerInterface::CongestionEventSample sample =
+      sampler_.OnCongestionEvent(event_time, acked_packets, lost_packets,
+                                 max_bandwidth_.GetBest(),
+                                 QuicBandwidth::Infinite(), round_trip_count_);
+  if (!sample.sample_max_bandwidth.IsZero()) {
+    if (!sample.sample_is_app_limited) {
+      has_non_app_limited_sample_ = true;
+    }
+    if (!sample.sample_is_app_limited ||
+        sample.sample_max_bandwidth > max_bandwidth_.GetBest()) {
+      max_bandwidth_.Update(sample.sample_max_bandwidth, round_trip_count_);
+    }
+  }
+
+  for (const AckedPacket& acked : acked_packets) {
+    MonitorInterval* interval = IntervalOf(acked.packet_number);
+    if (interval != nullptr) {
+      ++interval->packets_done;
+      interval->bytes_acked += acked.bytes_acked;
+    }
+  }
+  for (const LostPacket& lost : lost_packets) {
+    MonitorInterval* interval = IntervalOf(lost.packet_number);
+    if (interval != nullptr) {
+      ++interval->packets_done;
+      interval->bytes_lost += lost.bytes_lost;
+    }
+  }
+  // The RTT sample is the largest acked packet's.
+  if (rtt_updated && !acked_packets.empty()) {
+    MonitorInterval* interval =
+        IntervalOf(acked_packets.rbegin()->packet_number);
+    if (interval != nullptr) {
+      if (interval->num_rtt_samples == 0) {
+        interval->first_rtt_sample_time = event_time;
+      }
+      const double time =
+          (event_time - interval->first_rtt_sample_time).ToMicroseconds() /
+          1e6;
+      const double rtt = rtt_stats_->latest_rtt().ToMicroseconds() / 1e6;
+      ++interval->num_rtt_samples;
+      interval->sum_time += time;
+      interval->sum_rtt += rtt;
+      interval->sum_time_squared += time * time;
+      interval->sum_time_rtt += time * rtt;
+    }
+  }
+
+  ProcessCompletedIntervals(event_time);
+  sampler_.RemoveObsoletePackets(unacked_packets_->GetLeastUnacked());
+}
+
+void PccSender::OnConnectionMigration() { EnterStarting(); }
+
+bool PccSender::CanSend(QuicByteCount bytes_in_flight) {
+  return bytes_in_flight < GetCongestionWindow();
+}
+
+QuicBandwidth PccSender::PacingRate(QuicByteCount /*bytes_in_flight*/) const {
+  if (!monitor_intervals_.empty()) {
+    return monitor_intervals_.back().sending_rate;
+  }
+  return sending_rate_;
+}
+
+QuicBandwidth PccSender::BandwidthEstimate() const {
+  return max_bandwidth_.GetBest();
+}
+
+QuicByteCount PccSender::GetCongestionWindow() const {
+  const QuicByteCount bdp =
+      PacingRate(0) * rtt_stats_->SmoothedOrInitialRtt();
+  const QuicByteCount congestion_window = kCongestionWindowGain * bdp;
+  return std::min(max_congestion_window_,
+                  std::max(kDefaultMinimumCongestionWindow,
+                           congestion_window));
+}
+
+QuicByteCount PccSender::GetSlowStartThreshold() const { return 0; }
+
+CongestionControlType PccSender::GetCongestionControlType() const {
+  return kPCC;
+}
+
+std::string PccSender::GetDebugState() const {
+  std::ostringstream stream;
+  stream << ExportDebugState();
+  return stream.str();
+}
+
+void PccSender::OnApplicationLimited(QuicByteCount bytes_in_flight) {
+  if (bytes_in_flight >= GetCongestionWindow()) {
+    return;
+  }
+  sampler_.OnAppLimited();
+  // The interval did not send at its rate, so its utility says nothing about
+  // that rate.
+  if (!monitor_intervals_.empty()) {
+    monitor_intervals_.back().is_app_limited = true;
+  }
+  QUIC_DVLOG(2) << "Becoming application limited. Last sent packet: "
+                << last_sent_packet_ << ", CWND: " << GetCongestionWindow();
+}
+
+void PccSender::PopulateConnectionStats(QuicConnectionStats* stats) const {
+  stats->num_ack_aggregation_epochs = sampler_.num_ack_aggregation_epochs();
+}
+
+PccSender::DebugState PccSender::ExportDebugState() const {
+  return DebugState(*this);
+}
+
+PccSender::MonitorInterval* PccSender::IntervalOf(
+    QuicPacketNumber packet_number) {
+  for (MonitorInterval& interval : monitor_intervals_) {
+    if (packet_number >= interval.first_packet_number &&
+        packet_number <= interval.last_packet_number) {
+      return &interval;
+    }
+  }
+  return nullptr;
+}
+
+void PccSender::StartMonitorInterval(QuicTime sent_time,
+                                     QuicPacketNumber packet_number) {
+  QuicBandwidth rate = sending_rate_;
+  bool is_useful = false;
+  switch (mode_) {
+    case STARTING:
+      // An app-limited interval did not test its rate, so it is not doubled.
+      if (double_rate_on_next_interval_ &&
+          (monitor_intervals_.empty() ||
+           !monitor_intervals_.back().is_app_limited)) {
+        sending_rate_ = ClampRate(kStartingGain * sending_rate_);
+      }
+      double_rate_on_next_interval_ = true;
+      rate = sending_rate_;
+      is_useful = true;
+      break;
+    case PROBING:
+      if (num_probing_intervals_sent_ < 4) {
+        rate = probing_points_[num_probing_intervals_sent_++].rate;
+        is_useful = true;
+      }
+      break;
+    case MOVING:
+      is_useful = moving_interval_pending_;
+      moving_interval_pending_ = false;
+      break;
+  }
+  monitor_intervals_.emplace_back(rate, is_useful, sent_time,
+                                  sent_time + MonitorIntervalDuration(rate),
+                                  packet_number);
+}
+
+QuicTime::Delta PccSender::MonitorIntervalDuration(QuicBandwidth rate) const {
+  return std::max(rtt_stats_->SmoothedOrInitialRtt(),
+                  rate.TransferTime(kMinPacketsPerInterval * kDefaultTCPMSS));
+}
+
+void PccSender::ProcessCompletedIntervals(QuicTime event_time) {
+  const QuicPacketNumber least_unacked = unacked_packets_->GetLeastUnacked();
+  while (!monitor_intervals_.empty()) {
+    const MonitorInterval& interval = monitor_intervals_.front();
+    const bool done_sending =
+        monitor_intervals_.size() > 1 || event_time >= interval.end_time;
+    // Packets no longer tracked, e.g. PINGs not counted in flight, are done
+    // too.
+    const bool all_packets_done =
+        interval.packets_done >= interval.packets_sent ||
+        (least_unacked.IsInitialized() &&
+         least_unacked > interval.last_packet_number);
+    if (!done_sending || !all_packets_done) {
+      return;
+    }
+    if (interval.is_useful) {
+      OnMonitorIntervalCompleted(interval);
+    }
+    monitor_intervals_.pop_front();
+  }
+}
+
+void PccSender::OnMonitorIntervalCompleted(const MonitorInterval& interval) {
+  if (interval.is_app_limited) {
+    switch (mode_) {
+      case STARTING:
+        break;
+      case PROBING:
+        // The probing pairs must all be compared at their rates.
+        EnterProbing(sending_rate_);
+        break;
+      case MOVING:
+        // Tries the same rate again.
+        moving_interval_pending_ = true;
+        break;
+    }
+    return;
+  }
+
+  const float utility = ComputeUtility(interval);
+  last_utility_ = utility;
+  QUIC_DVLOG(2) << "Monitor interval at " << interval.sending_rate
+                << " completed in " << mode_ << ", utility " << utility;
+  switch (mode_) {
+    case STARTING:
+      if (best_starting_point_.rate.IsZero() ||
+          utility >= best_starting_point_.utility) {
+        best_starting_point_ = {interval.sending_rate, utility};
+        return;
+      }
+      // The previous rate was better.
+      probing_step_ = kMinProbingStep;
+      EnterProbing(best_starting_point_.rate);
+      return;
+    case PROBING: {
+      probing_points_[num_probing_intervals_completed_++].utility = utility;
+      if (num_probing_intervals_completed_ < 4) {
+        return;
+      }
+      // Each pair is a higher and a lower rate, in random order.
+      int pairs_voting_up = 0;
+      float gradient = 0;
+      float utility_up = 0;
+      float utility_down = 0;
+      for (int pair = 0; pair < 2; ++pair) {
+        const UtilityPoint* higher = &probing_points_[2 * pair];
+        const UtilityPoint* lower = &probing_points_[2 * pair + 1];
+        if (lower->rate > higher->rate) {
+          std::swap(higher, lower);
+        }
+        if (higher->utility > lower->utility) {
+          ++pairs_voting_up;
+        }
+        gradient += (higher->utility - lower->utility) /
+                    (ToMegabitsPerSecond(higher->rate) -
+                     ToMegabitsPerSecond(lower->rate)) /
+                    2;
+        utility_up += higher->utility / 2;
+        utility_down += lower->utility / 2;
+      }
+      if (pairs_voting_up == 1) {
+        // The pairs disagree, probe further apart.
+        probing_step_ = std::min(kMaxProbingStep,
+                                 probing_step_ + kProbingStepIncrement);
+        EnterProbing(sending_rate_);
+        return;
+      }
+      UtilityPoint reference;
+      if (pairs_voting_up == 2) {
+        reference = {sending_rate_ * (1 + probing_step_), utility_up};
+      } else {
+        reference = {sending_rate_ * (1 - probing_step_), utility_down};
+      }
+      EnterMoving(reference, gradient);
+      return;
+    }
+    case MOVING: {
+      const double rate_change =
+          ToMegabitsPerSecond(interval.sending_rate) -
+          ToMegabitsPerSecond(last_moving_point_.rate);
+      const float gradient =
+          rate_change == 0
+              ? 0
+              : (utility - last_moving_point_.utility) / rate_change;
+      if (utility < last_moving_point_.utility || gradient == 0 ||
+          (gradient > 0) != moving_up_) {
+        // Went past the peak, look around the last rate that was better.
+        probing_step_ = kMinProbingStep;
+        EnterProbing(utility < last_moving_point_.utility
+                         ? last_moving_point_.rate
+                         : interval.sending_rate);
+        return;
+      }
+      ++rate_change_amplifier_;
+      last_moving_point_ = {interval.sending_rate, utility};
+      sending_rate_ = ComputeNextRate(interval.sending_rate, gradient);
+      moving_interval_pending_ = true;
+      return;
+    }
+  }
+}
+
+float PccSender::ComputeUtility(const MonitorInterval& interval) const {
+  const double rate = ToMegabitsPerSecond(interval.sending_rate);
+  const QuicByteCount bytes = interval.bytes_acked + interval.bytes_lost;
+  const double loss_rate =
+      bytes == 0 ? 0 : static_cast<double>(interval.bytes_lost) / bytes;
+  double rtt_gradient = interval.RttGradient();
+  if (std::abs(rtt_gradient) < kRttGradientTolerance) {
+    rtt_gradient = 0;
+  }
+  return std::pow(rate, kUtilityExponent) -
+         kLatencyCoefficient * rate * rtt_gradient -
+         kLossCoefficient * rate * loss_rate;
+}
+
+void PccSender::EnterStarting() {
+  mode_ = STARTING;
+  sending_rate_ = ClampRate(QuicBandwidth::FromBytesAndTimeDelta(
+      initial_congestion_window_, rtt_stats_->SmoothedOrInitialRtt()));
+  monitor_intervals_.clear();
+  best_starting_point_ = UtilityPoint();
+  double_rate_on_next_interval_ = false;
+  probing_step_ = kMinProbingStep;
+  rate_change_amplifier_ = 0;
+  rate_change_bound_hits_ = 0;
+  moving_interval_pending_ = false;
+}
+
+void PccSender::EnterProbing(QuicBandwidth rate) {
+  mode_ = PROBING;
+  sending_rate_ = ClampRate(rate);
+  DiscardPendingDecisions();
+  num_probing_intervals_sent_ = 0;
+  num_probing_intervals_completed_ = 0;
+  for (int pair = 0; pair < 2; ++pair) {
+    const bool higher_first = random_->RandUint64() % 2 == 0;
+    const QuicBandwidth higher = sending_rate_ * (1 + probing_step_);
+    const QuicBandwidth lower = sending_rate_ * (1 - probing_step_);
+    probing_points_[2 * pair] = {higher_first ? higher : lower, 0};
+    probing_points_[2 * pair + 1] = {higher_first ? lower : higher, 0};
+  }
+}
+
+void PccSender::EnterMoving(const UtilityPoint& reference, float gradient) {
+  mode_ = MOVING;
+  DiscardPendingDecisions();
+  moving_up_ = gradient > 0;
+  rate_change_amplifier_ = 1;
+  rate_change_bound_hits_ = 0;
+  last_moving_point_ = reference;
+  sending_rate_ = ComputeNextRate(reference.rate, gradient);
+  moving_interval_pending_ = true;
+}
+
+QuicBandwidth PccSender::ComputeNextRate(QuicBandwidth rate, float gradient) {
+  const double rate_mbps = ToMegabitsPerSecond(rate);
+  double change = kRateStepGain * rate_change_amplifier_ * gradient;
+  const double bound =
+      (kInitialRateChangeBound +
+       rate_change_bound_hits_ * kRateChangeBoundIncrement) *
+      rate_mbps;
+  if (std::abs(change) > bound) {
+    change = std::copysign(bound, change);
+    ++rate_change_bound_hits_;
+  } else {
+    rate_change_bound_hits_ = 0;
+  }
+  return ClampRate(FromMegabitsPerSecond(rate_mbps + change));
+}
+
+void PccSender::DiscardPendingDecisions() {
+  for (MonitorInterval& interval : monitor_intervals_) {
+    interval.is_useful = false;
+  }
+}
+
+QuicBandwidth PccSender::ClampRate(QuicBandwidth rate) const {
+  const QuicTime::Delta rtt = rtt_stats_->MinOrInitialRtt();
+  const QuicBandwidth max_rate =
+      QuicBandwidth::FromBytesAndTimeDelta(max_congestion_window_, rtt);
+  return std::min(max_rate, std::max(MinSendingRate(), rate));
+}
+
+QuicBandwidth PccSender::MinSendingRate() const {
+  return QuicBandwidth::FromBytesAndTimeDelta(
+      kDefaultMinimumCongestionWindow, rtt_stats_->SmoothedOrInitialRtt());
+}
+
+bool PccSender::UpdateRoundTripCounter(QuicPacketNumber last_acked_packet) {
+  if (!current_round_trip_end_.IsInitialized() ||
+      last_acked_packet > current_round_trip_end_) {
+    round_trip_count_++;
+    current_round_trip_end_ = last_sent_packet_;
+    return true;
+  }
+  return false;
+}
+
+static std::string ModeToString(PccSender::Mode mode) {
+  switch (mode) {
+    case PccSender::STARTING:
+      return "STARTING";
+    case PccSender::PROBING:
+      return "PROBING";
+    case PccSender::MOVING:
+      return "MOVING";
+  }
+  return "???";
+}
+
+std::ostream& operator<<(std::ostream& os, const PccSender::Mode& mode) {
+  os << ModeToString(mode);
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const PccSender::DebugState& state) {
+  os << "Mode: " << ModeToString(state.mode) << std::endl;
+  os << "Sending rate: " << state.sending_rate << std::endl;
+  os << "Bandwidth estimate: " << state.bandwidth_estimate << std::endl;
+  os << "Congestion window: " << state.congestion_window << " bytes"
+     << std::endl;
+  if (state.mode == PccSender::PROBING) {
+    os << "(probing) Step: " << state.probing_step << std::endl;
+  }
+  if (state.mode == PccSender::MOVING) {
+    os << "(moving) Amplifier: " << state.rate_change_amplifier << std::endl;
+  }
+  os << "Monitor intervals: " << state.num_monitor_intervals << std::endl;
+  os << "Last utility: " << state.last_utility << std::endl;
+  os << "Smoothed RTT: " << state.smoothed_rtt << std::endl;
+  os << "Minimum RTT: " << state.min_rtt;
+  return os;
+}
+
+}  // namespace quic
@@ -0,0 +1,259 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PCC Vivace (Performance-oriented Congestion Control) send algorithm.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "gquiche/quic/core/congestion_control/bandwidth_sampler.h"
+#include "gquiche/quic/core/congestion_control/send_algorithm_interface.h"
+#include "gquiche/quic/core/congestion_control/windowed_filter.h"
+#include "gquiche/quic/core/crypto/quic_random.h"
+#include "gquiche/quic/core/quic_bandwidth.h"
+#include "gquiche/quic/core/quic_packet_number.h"
+#include "gquiche/quic/core/quic_packets.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/core/quic_unacked_packet_map.h"
+#include "gquiche/quic/platform/api/quic_export.h"
+#include "gquiche/common/quiche_circular_deque.h"
+
+namespace quic {
+
+class RttStats;
+
+// PccSender implements PCC Vivace. Instead of reacting to individual losses,
+// it sends at a fixed rate for a monitor interval of about one RTT, scores
+// the interval with a utility function of its rate, its loss rate and the
+// slope of its RTT samples, and moves the rate in the direction the utility
+// grows:
+//
+//   u(r) = r^0.9 - 900 * r * dRTT/dt - 11.35 * r * loss_rate, r in Mbps.
+//
+// Random loss below about 5% barely moves the utility, which keeps PCC at the
+// link rate on lossy links where loss-based algorithms back off, while a
+// growing RTT, i.e. a growing queue, quickly makes higher rates worse.
+//
+// PCC is rate based and relies on pacing. Its congestion window only bounds
+// the bytes in flight to a few BDPs at the current rate.
+class QUIC_EXPORT_PRIVATE PccSender : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    // Doubles the rate every monitor interval until the utility drops.
+    STARTING,
+    // Sends pairs of intervals slightly above and below the rate, in random
+    // order, until they agree on which way the utility grows.
+    PROBING,
+    // Follows the utility gradient until the utility drops or the gradient
+    // changes sign.
+    MOVING,
+  };
+
+  // Debug state can be exported in order to troubleshoot potential congestion
+  // control issues.
+  struct QUIC_EXPORT_PRIVATE DebugState {
+    explicit DebugState(const PccSender& sender);
+    DebugState(const DebugState& state);
+
+    Mode mode;
+    QuicBandwidth sending_rate;
+    QuicBandwidth bandwidth_estimate;
+    QuicByteCount congestion_window;
+    // Relative distance of the probing rates from the sending rate.
+    float probing_step;
+    // Consecutive steps taken in the same direction while MOVING.
+    int rate_change_amplifier;
+    size_t num_monitor_intervals;
+    // Utility of the last monitor interval a decision was made on.
+    float last_utility;
+    QuicTime::Delta smoothed_rtt;
+    QuicTime::Delta min_rtt;
+  };
+
+  PccSender(const RttStats* rtt_stats,
+            const QuicUnackedPacketMap* unacked_packets,
+            QuicPacketCount initial_tcp_congestion_window,
+            QuicPacketCount max_tcp_congestion_window, QuicRandom* random,
+            QuicConnectionStats* stats);
+  PccSender(const PccSender&) = delete;
+  PccSender& operator=(const PccSender&) = delete;
+  ~PccSender() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+
+  void SetFromConfig(const QuicConfig& /*config*/,
+                     Perspective /*perspective*/) override {}
+  void ApplyConnectionOptions(
+      const QuicTagVector& /*connection_options*/) override {}
+
+  void AdjustNetworkParameters(const NetworkParams& params) override;
+  void SetInitialCongestionWindowInPackets(
+      QuicPacketCount congestion_window) override;
+  void SetExtraLossThreshold(float extra_loss_threshold) override;
+  void SetUpdateRangeTime(QuicTime::Delta update_range_time) override;
+  void SetIsUpdatePacketLostFlag(bool is_update_min_packet_lost) override;
+  void SetUseBandwidthListFlag(bool is_use_bandwidth_list) override;
+  void OnCongestionEvent(bool rtt_updated, QuicByteCount prior_in_flight,
+                         QuicTime event_time,
+                         const AckedPacketVector& acked_packets,
+                         const LostPacketVector& lost_packets) override;
+  void OnPacketSent(QuicTime sent_time, QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number, QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnPacketNeutered(QuicPacketNumber packet_number) override;
+  void OnRetransmissionTimeout(bool /*packets_retransmitted*/) override {}
+  void OnConnectionMigration() override;
+  bool CanSend(QuicByteCount bytes_in_flight) override;
+  QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  bool HasGoodBandwidthEstimateForResumption() const override {
+    return has_non_app_limited_sample_;
+  }
+  QuicByteCount GetCongestionWindow() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  std::string GetDebugState() const override;
+  void OnApplicationLimited(QuicByteCount bytes_in_flight) override;
+  void PopulateConnectionStats(QuicConnectionStats* stats) const override;
+  // End implementation of SendAlgorithmInterface.
+
+  Mode mode() const { return mode_; }
+  QuicBandwidth sending_rate() const { return sending_rate_; }
+
+  DebugState ExportDebugState() const;
+
+ private:
+  using MaxBandwidthFilter =
+      WindowedFilter<QuicBandwidth, MaxFilter<QuicBandwidth>,
+                     QuicRoundTripCount, QuicRoundTripCount>;
+
+  // The packets sent at one rate, and what became of them.
+  struct MonitorInterval {
+    MonitorInterval(QuicBandwidth sending_rate, bool is_useful,
+                    QuicTime start_time, QuicTime end_time,
+                    QuicPacketNumber first_packet_number);
+
+    // Slope of the RTT samples taken while the interval's packets were
+    // acknowledged, by least squares. Zero with fewer than two samples.
+    float RttGradient() const;
+
+    QuicBandwidth sending_rate;
+    // Whether a rate decision waits for the utility of this interval.
+    bool is_useful;
+    // Set if the sender ran out of data while sending the interval.
+    bool is_app_limited;
+    QuicTime start_time;
+    // Packets sent at or after this time go to the next interval.
+    QuicTime end_time;
+    QuicPacketNumber first_packet_number;
+    QuicPacketNumber last_packet_number;
+    QuicPacketCount packets_sent;
+    // Acked, lost or neutered.
+    QuicPacketCount packets_done;
+    QuicByteCount bytes_acked;
+    QuicByteCount bytes_lost;
+    // Sums for the least squares fit of RTT, in seconds, against the time
+    // elapsed since the first sample, in seconds.
+    QuicTime first_rtt_sample_time;
+    int num_rtt_samples;
+    double sum_time;
+    double sum_rtt;
+    double sum_time_squared;
+    double sum_time_rtt;
+  };
+
+  // A rate and the utility measured at it.
+  struct UtilityPoint {
+    QuicBandwidth rate = QuicBandwidth::Zero();
+    float utility = 0;
+  };
+
+  // Returns the interval |packet_number| was sent in, or nullptr if it was
+  // not a tracked packet.
+  MonitorInterval* IntervalOf(QuicPacketNumber packet_number);
+  // Starts an interval at the rate the current mode wants next.
+  void StartMonitorInterval(QuicTime sent_time,
+                            QuicPacketNumber packet_number);
+  QuicTime::Delta MonitorIntervalDuration(QuicBandwidth rate) const;
+  // Makes rate decisions on the intervals whose packets are all accounted
+  // for, oldest first.
+  void ProcessCompletedIntervals(QuicTime event_time);
+  void OnMonitorIntervalCompleted(const MonitorInterval& interval);
+  float ComputeUtility(const MonitorInterval& interval) const;
+  // Starts over from the initial rate.
+  void EnterStarting();
+  // Starts probing around |rate|.
+  void EnterProbing(QuicBandwidth rate);
+  // Moves from |reference| along |gradient|, in utility per Mbps.
+  void EnterMoving(const UtilityPoint& reference, float gradient);
+  // Returns the rate one gradient step away from |rate|, bounded.
+  QuicBandwidth ComputeNextRate(QuicBandwidth rate, float gradient);
+  // Marks every interval in flight as not useful, so that a new decision
+  // only uses intervals sent after it.
+  void DiscardPendingDecisions();
+  QuicBandwidth ClampRate(QuicBandwidth rate) const;
+  QuicBandwidth MinSendingRate() const;
+  bool UpdateRoundTripCounter(QuicPacketNumber last_acked_packet);
+
+  const RttStats* rtt_stats_;
+  const QuicUnackedPacketMap* unacked_packets_;
+  QuicRandom* random_;
+  QuicConnectionStats* stats_;
+
+  Mode mode_;
+  QuicBandwidth sending_rate_;
+
+  // Bandwidth sampler provides the delivery rate behind BandwidthEstimate(),
+  // which the rate control itself does not use.
+  BandwidthSampler sampler_;
+  MaxBandwidthFilter max_bandwidth_;
+  QuicRoundTripCount round_trip_count_;
+  QuicPacketNumber last_sent_packet_;
+  QuicPacketNumber current_round_trip_end_;
+  bool has_non_app_limited_sample_;
+
+  quiche::QuicheCircularDeque<MonitorInterval> monitor_intervals_;
+
+  // STARTING: the best interval so far, and whether the next interval
+  // doubles the rate.
+  UtilityPoint best_starting_point_;
+  bool double_rate_on_next_interval_;
+
+  // PROBING: the rates of the probing intervals, in sending order, with the
+  // utilities of those that completed.
+  UtilityPoint probing_points_[4];
+  int num_probing_intervals_sent_;
+  int num_probing_intervals_completed_;
+  float probing_step_;
+
+  // MOVING: the last interval a decision was made on, the direction taken
+  // and how many times in a row.
+  UtilityPoint last_moving_point_;
+  bool moving_up_;
+  int rate_change_amplifier_;
+  // How many steps in a row were cut short by the change bound.
+  int rate_change_bound_hits_;
+  // Whether the interval of the last decision is still to be sent.
+  bool moving_interval_pending_;
+
+  float last_utility_;
+
+  QuicByteCount initial_congestion_window_;
+  const QuicByteCount max_congestion_window_;
+};
+
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
+                                             const PccSender::Mode& mode);
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(
+    std::ostream& os, const PccSender::DebugState& state);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
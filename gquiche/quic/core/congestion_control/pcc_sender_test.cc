@@ -0,0 +1,235 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/congestion_control/pcc_sender.h"
+
+#include <cmath>
+#include <memory>
+
+#include "gquiche/quic/core/congestion_control/rtt_stats.h"
+#include "gquiche/quic/core/congestion_control/send_algorithm_interface.h"
+#include "gquiche/quic/core/quic_bandwidth.h"
+#include "gquiche/quic/core/quic_packets.h"
+#include "gquiche/quic/core/quic_unacked_packet_map.h"
+#include "gquiche/quic/platform/api/quic_flags.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "gquiche/quic/test_tools/mock_clock.h"
+#include "gquiche/quic/test_tools/mock_random.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicPacketCount kInitialCongestionWindowPackets = 10;
+const QuicPacketCount kMaxCongestionWindowPackets = 1000;
+const QuicPacketCount kPacketsPerInterval = 20;
+// Longer than any interval at the rates the tests send at.
+const QuicTime::Delta kIntervalDuration = QuicTime::Delta::FromSeconds(1);
+const QuicTime::Delta kRtt = QuicTime::Delta::FromMilliseconds(100);
+const QuicTime::Delta kAckSpacing = QuicTime::Delta::FromMilliseconds(10);
+
+double ToMegabitsPerSecond(QuicBandwidth rate) {
+  return rate.ToBitsPerSecond() / 1e6;
+}
+
+class PccSenderTest : public QuicTest {
+ protected:
+  PccSenderTest()
+      : unacked_packets_(Perspective::IS_SERVER),
+        sender_(&rtt_stats_, &unacked_packets_,
+                kInitialCongestionWindowPackets, kMaxCongestionWindowPackets,
+                &random_, &stats_),
+        next_packet_number_(1),
+        first_packet_of_interval_(1),
+        bytes_in_flight_(0) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  // Sends a monitor interval and returns its rate.
+  QuicBandwidth SendInterval() {
+    first_packet_of_interval_ = next_packet_number_;
+    for (QuicPacketCount i = 0; i < kPacketsPerInterval; ++i) {
+      sender_.OnPacketSent(clock_.Now(), bytes_in_flight_,
+                           QuicPacketNumber(next_packet_number_++),
+                           kDefaultTCPMSS, HAS_RETRANSMITTABLE_DATA);
+      bytes_in_flight_ += kDefaultTCPMSS;
+    }
+    return sender_.PacingRate(bytes_in_flight_);
+  }
+
+  // Acknowledges the last interval once it has ended, one packet every
+  // kAckSpacing. The first |packets_lost| packets are lost, and the RTT grows
+  // by |rtt_gradient| seconds per second from kRtt.
+  void AckInterval(QuicPacketCount packets_lost, double rtt_gradient) {
+    clock_.AdvanceTime(kIntervalDuration);
+    QuicTime::Delta rtt = kRtt;
+    for (uint64_t packet_number = first_packet_of_interval_;
+         packet_number < next_packet_number_; ++packet_number) {
+      clock_.AdvanceTime(kAckSpacing);
+      AckedPacketVector acked_packets;
+      LostPacketVector lost_packets;
+      if (packet_number - first_packet_of_interval_ < packets_lost) {
+        lost_packets.push_back(
+            LostPacket(QuicPacketNumber(packet_number), kDefaultTCPMSS));
+      } else {
+        rtt_stats_.UpdateRtt(rtt, QuicTime::Delta::Zero(), clock_.Now());
+        acked_packets.push_back(AckedPacket(QuicPacketNumber(packet_number),
+                                            kDefaultTCPMSS, QuicTime::Zero()));
+      }
+      sender_.OnCongestionEvent(!acked_packets.empty(), bytes_in_flight_,
+                                clock_.Now(), acked_packets, lost_packets);
+      bytes_in_flight_ -= kDefaultTCPMSS;
+      rtt = rtt + kAckSpacing * rtt_gradient;
+    }
+  }
+
+  // Runs STARTING up to the interval whose utility drops, at the third rate.
+  // Returns the rate PROBING starts from.
+  QuicBandwidth EnterProbing() {
+    SendInterval();
+    AckInterval(0, 0);
+    const QuicBandwidth best_rate = SendInterval();
+    AckInterval(0, 0);
+    SendInterval();
+    AckInterval(kPacketsPerInterval / 2, 0);
+    EXPECT_EQ(PccSender::PROBING, sender_.mode());
+    return best_rate;
+  }
+
+  MockClock clock_;
+  RttStats rtt_stats_;
+  QuicUnackedPacketMap unacked_packets_;
+  MockRandom random_;
+  QuicConnectionStats stats_;
+  PccSender sender_;
+  uint64_t next_packet_number_;
+  uint64_t first_packet_of_interval_;
+  QuicByteCount bytes_in_flight_;
+};
+
+TEST_F(PccSenderTest, CreatedOnlyWhenEnabled) {
+  std::unique_ptr<SendAlgorithmInterface> send_algorithm(
+      SendAlgorithmInterface::Create(&clock_, &rtt_stats_, &unacked_packets_,
+                                     kPCC, &random_, &stats_,
+                                     kInitialCongestionWindowPackets, nullptr,
+                                     0));
+  EXPECT_EQ(kCubicBytes, send_algorithm->GetCongestionControlType());
+
+  SetQuicFlag(FLAGS_quic_enable_pcc_sender, true);
+  send_algorithm.reset(SendAlgorithmInterface::Create(
+      &clock_, &rtt_stats_, &unacked_packets_, kPCC, &random_, &stats_,
+      kInitialCongestionWindowPackets, nullptr, 0));
+  EXPECT_EQ(kPCC, send_algorithm->GetCongestionControlType());
+}
+
+TEST_F(PccSenderTest, UtilityPenalizesLoss) {
+  const double rate = ToMegabitsPerSecond(SendInterval());
+  AckInterval(/*packets_lost=*/5, /*rtt_gradient=*/0);
+  const double expected_utility =
+      std::pow(rate, 0.9) - 11.35 * rate * 5 / kPacketsPerInterval;
+  EXPECT_NEAR(expected_utility, sender_.ExportDebugState().last_utility,
+              1e-4);
+}
+
+TEST_F(PccSenderTest, UtilityPenalizesRttGradient) {
+  const double rate = ToMegabitsPerSecond(SendInterval());
+  AckInterval(/*packets_lost=*/5, /*rtt_gradient=*/0.2);
+  const double expected_utility = std::pow(rate, 0.9) -
+                                  900 * rate * 0.2 -
+                                  11.35 * rate * 5 / kPacketsPerInterval;
+  EXPECT_NEAR(expected_utility, sender_.ExportDebugState().last_utility,
+              1e-4);
+}
+
+TEST_F(PccSenderTest, UtilityIgnoresSmallRttGradients) {
+  const double rate = ToMegabitsPerSecond(SendInterval());
+  AckInterval(/*packets_lost=*/0, /*rtt_gradient=*/0.005);
+  EXPECT_NEAR(std::pow(rate, 0.9), sender_.ExportDebugState().last_utility,
+              1e-4);
+}
+
+TEST_F(PccSenderTest, StartingDoublesRateUntilUtilityDrops) {
+  EXPECT_EQ(PccSender::STARTING, sender_.mode());
+  EXPECT_TRUE(sender_.InSlowStart());
+  const QuicBandwidth first_rate = SendInterval();
+  AckInterval(0, 0);
+  EXPECT_EQ(PccSender::STARTING, sender_.mode());
+
+  const QuicBandwidth second_rate = SendInterval();
+  EXPECT_NEAR(2 * first_rate.ToBitsPerSecond(), second_rate.ToBitsPerSecond(),
+              1);
+  AckInterval(0, 0);
+  EXPECT_EQ(PccSender::STARTING, sender_.mode());
+
+  // Half of the packets are lost at the third rate.
+  const QuicBandwidth third_rate = SendInterval();
+  EXPECT_NEAR(2 * second_rate.ToBitsPerSecond(), third_rate.ToBitsPerSecond(),
+              1);
+  AckInterval(kPacketsPerInterval / 2, 0);
+  EXPECT_EQ(PccSender::PROBING, sender_.mode());
+  EXPECT_FALSE(sender_.InSlowStart());
+  EXPECT_EQ(second_rate, sender_.sending_rate());
+}
+
+TEST_F(PccSenderTest, ProbingMovesTowardsHigherUtility) {
+  const QuicBandwidth rate = EnterProbing();
+  // MockRandom sends the lower rate of each pair first.
+  const QuicBandwidth lower_rate = rate * (1 - 0.05f);
+  const QuicBandwidth higher_rate = rate * (1 + 0.05f);
+  for (int pair = 0; pair < 2; ++pair) {
+    EXPECT_EQ(lower_rate, SendInterval());
+    AckInterval(0, 0);
+    EXPECT_EQ(PccSender::PROBING, sender_.mode());
+    EXPECT_EQ(higher_rate, SendInterval());
+    AckInterval(0, 0);
+  }
+  // Without loss or queueing, the higher rates are better.
+  EXPECT_EQ(PccSender::MOVING, sender_.mode());
+  EXPECT_LT(higher_rate, sender_.sending_rate());
+  EXPECT_EQ(1, sender_.ExportDebugState().rate_change_amplifier);
+}
+
+TEST_F(PccSenderTest, ProbingPairsDisagreeing) {
+  const QuicBandwidth rate = EnterProbing();
+  // The first pair votes up, the second one down.
+  SendInterval();
+  AckInterval(0, 0);
+  SendInterval();
+  AckInterval(0, 0);
+  SendInterval();
+  AckInterval(0, 0);
+  SendInterval();
+  AckInterval(kPacketsPerInterval / 2, 0);
+  // Probes again, further apart.
+  EXPECT_EQ(PccSender::PROBING, sender_.mode());
+  EXPECT_EQ(rate, sender_.sending_rate());
+  EXPECT_FLOAT_EQ(0.06f, sender_.ExportDebugState().probing_step);
+  EXPECT_EQ(rate * (1 - 0.06f), SendInterval());
+}
+
+TEST_F(PccSenderTest, MovingUntilUtilityDrops) {
+  EnterProbing();
+  for (int i = 0; i < 4; ++i) {
+    SendInterval();
+    AckInterval(0, 0);
+  }
+  ASSERT_EQ(PccSender::MOVING, sender_.mode());
+
+  // A better rate keeps the direction, with a larger step.
+  const QuicBandwidth first_moving_rate = SendInterval();
+  AckInterval(0, 0);
+  EXPECT_EQ(PccSender::MOVING, sender_.mode());
+  EXPECT_EQ(2, sender_.ExportDebugState().rate_change_amplifier);
+  const QuicBandwidth second_moving_rate = SendInterval();
+  EXPECT_LT(first_moving_rate, second_moving_rate);
+
+  // A worse one probes again around the last better rate.
+  AckInterval(kPacketsPerInterval / 2, 0);
+  EXPECT_EQ(PccSender::PROBING, sender_.mode());
+  EXPECT_EQ(first_moving_rate, sender_.sending_rate());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
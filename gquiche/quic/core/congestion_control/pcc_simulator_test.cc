@@ -0,0 +1,199 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "gquiche/quic/core/congestion_control/pcc_sender.h"
+#include "gquiche/quic/core/congestion_control/rtt_stats.h"
+#include "gquiche/quic/core/congestion_control/send_algorithm_interface.h"
+#include "gquiche/quic/core/quic_bandwidth.h"
+#include "gquiche/quic/core/quic_types.h"
+#include "gquiche/quic/platform/api/quic_flags.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "gquiche/quic/test_tools/mock_clock.h"
+#include "gquiche/quic/test_tools/quic_connection_peer.h"
+#include "gquiche/quic/test_tools/quic_sent_packet_manager_peer.h"
+#include "gquiche/quic/test_tools/quic_test_utils.h"
+#include "gquiche/quic/test_tools/simulator/link.h"
+#include "gquiche/quic/test_tools/simulator/packet_filter.h"
+#include "gquiche/quic/test_tools/simulator/quic_endpoint.h"
+#include "gquiche/quic/test_tools/simulator/simulator.h"
+#include "gquiche/quic/test_tools/simulator/switch.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const uint32_t kInitialCwndPackets = 10;
+
+// Drops every packet that goes through it with probability |loss_rate|.
+class RandomLossFilter : public simulator::PacketFilter {
+ public:
+  RandomLossFilter(simulator::Simulator* simulator, std::string name,
+                   simulator::Endpoint* input, double loss_rate)
+      : simulator::PacketFilter(simulator, name, input),
+        random_(simulator->GetRandomGenerator()),
+        loss_rate_(loss_rate) {}
+
+ protected:
+  bool FilterPacket(const simulator::Packet& /*packet*/) override {
+    return random_->RandUint64() >=
+           static_cast<uint64_t>(loss_rate_ *
+                                 static_cast<double>(UINT64_MAX));
+  }
+
+ private:
+  QuicRandom* random_;
+  const double loss_rate_;
+};
+
+struct TransferResult {
+  bool completed = false;
+  QuicBandwidth goodput = QuicBandwidth::Zero();
+  // Mean of latest_rtt - min_rtt, sampled every 10ms.
+  QuicTime::Delta mean_queueing_delay = QuicTime::Delta::Zero();
+  float packet_loss = 0;
+};
+
+// Sender -> switch -> receiver, with the bottleneck on the switch to
+// receiver link, a switch queue of two BDPs and random loss of the data
+// packets on the bottleneck.
+class PccSimulatorTest : public QuicTest {
+ protected:
+  PccSimulatorTest()
+      : bottleneck_bandwidth_(QuicBandwidth::FromKBitsPerSecond(10000)),
+        local_delay_(QuicTime::Delta::FromMilliseconds(2)),
+        bottleneck_delay_(QuicTime::Delta::FromMilliseconds(18)) {
+    // Prevent the receiver, which only sends acks, from closing the
+    // connection due to too many outstanding packets.
+    SetQuicFlag(FLAGS_quic_max_tracked_packet_count, 1000000);
+    SetQuicFlag(FLAGS_quic_enable_pcc_sender, true);
+  }
+
+  QuicTime::Delta RTT() const { return 2 * (local_delay_ + bottleneck_delay_); }
+
+  // Runs a transfer of |transfer_size| bytes with |type| in a network of its
+  // own, so that results of different send algorithms can be compared.
+  TransferResult DoTransfer(CongestionControlType type, double loss_rate,
+                            QuicByteCount transfer_size,
+                            QuicTime::Delta timeout) {
+    SimpleRandom random;
+    random.set_seed(42);
+    simulator::Simulator simulator(&random);
+    simulator::QuicEndpoint sender(&simulator, "Sender", "Receiver",
+                                   Perspective::IS_CLIENT,
+                                   TestConnectionId(42));
+    simulator::QuicEndpoint receiver(&simulator, "Receiver", "Sender",
+                                     Perspective::IS_SERVER,
+                                     TestConnectionId(42));
+    QuicConnection* connection = sender.connection();
+    // Ownership of the sender will be overtaken by the endpoint.
+    SendAlgorithmInterface* send_algorithm = SendAlgorithmInterface::Create(
+        connection->clock(), connection->sent_packet_manager().GetRttStats(),
+        QuicSentPacketManagerPeer::GetUnackedPacketMap(
+            QuicConnectionPeer::GetSentPacketManager(connection)),
+        type, &random, QuicConnectionPeer::GetStats(connection),
+        kInitialCwndPackets, /*old_send_algorithm=*/nullptr,
+        /*extra_loss_threshold=*/0);
+    QuicConnectionPeer::SetSendAlgorithm(connection, send_algorithm);
+
+    const QuicByteCount bdp = bottleneck_bandwidth_ * RTT();
+    simulator::Switch network_switch(&simulator, "Switch", 2, 2 * bdp);
+    simulator::SymmetricLink local_link(&sender, network_switch.port(1),
+                                        2 * bottleneck_bandwidth_,
+                                        local_delay_);
+    RandomLossFilter loss_filter(&simulator, "Loss filter",
+                                 network_switch.port(2), loss_rate);
+    simulator::SymmetricLink bottleneck_link(&receiver, &loss_filter,
+                                             bottleneck_bandwidth_,
+                                             bottleneck_delay_);
+
+    const RttStats* rtt_stats = connection->sent_packet_manager().GetRttStats();
+    const QuicTime start = simulator.GetClock()->Now();
+    const QuicTime deadline = start + timeout;
+    QuicTime::Delta total_queueing_delay = QuicTime::Delta::Zero();
+    int num_samples = 0;
+    sender.AddBytesToTransfer(transfer_size);
+    while (sender.bytes_to_transfer() > 0 &&
+           simulator.GetClock()->Now() < deadline) {
+      simulator.RunFor(QuicTime::Delta::FromMilliseconds(10));
+      if (!rtt_stats->min_rtt().IsZero()) {
+        total_queueing_delay =
+            total_queueing_delay + rtt_stats->latest_rtt() -
+            rtt_stats->min_rtt();
+        ++num_samples;
+      }
+    }
+
+    TransferResult result;
+    result.completed = sender.bytes_to_transfer() == 0;
+    result.goodput = QuicBandwidth::FromBytesAndTimeDelta(
+        transfer_size - sender.bytes_to_transfer(),
+        simulator.GetClock()->Now() - start);
+    if (num_samples > 0) {
+      result.mean_queueing_delay = QuicTime::Delta::FromMicroseconds(
+          total_queueing_delay.ToMicroseconds() / num_samples);
+    }
+    const QuicConnectionStats& stats = connection->GetStats();
+    result.packet_loss =
+        static_cast<float>(stats.packets_lost) / stats.packets_sent;
+    QUIC_LOG(INFO) << type << " at " << 100 * loss_rate
+                   << "% random loss: goodput " << result.goodput
+                   << ", mean queueing delay " << result.mean_queueing_delay
+                   << ", packet loss " << 100 * result.packet_loss << "%";
+    if (type == kPCC) {
+      QUIC_LOG(INFO) << static_cast<PccSender*>(send_algorithm)
+                            ->ExportDebugState();
+    }
+    return result;
+  }
+
+  const QuicBandwidth bottleneck_bandwidth_;
+  const QuicTime::Delta local_delay_;
+  const QuicTime::Delta bottleneck_delay_;
+};
+
+TEST_F(PccSimulatorTest, CreatedForPcc) {
+  SimpleRandom random;
+  RttStats rtt_stats;
+  QuicUnackedPacketMap unacked_packets(Perspective::IS_SERVER);
+  QuicConnectionStats stats;
+  MockClock clock;
+  std::unique_ptr<SendAlgorithmInterface> send_algorithm(
+      SendAlgorithmInterface::Create(&clock, &rtt_stats, &unacked_packets,
+                                     kPCC, &random, &stats,
+                                     kInitialCwndPackets, nullptr, 0));
+  EXPECT_EQ(kPCC, send_algorithm->GetCongestionControlType());
+  EXPECT_TRUE(send_algorithm->InSlowStart());
+}
+
+TEST_F(PccSimulatorTest, SimpleTransfer) {
+  TransferResult result = DoTransfer(kPCC, /*loss_rate=*/0, 12 * 1024 * 1024,
+                                     QuicTime::Delta::FromSeconds(30));
+  ASSERT_TRUE(result.completed);
+  EXPECT_GE(result.goodput, 0.85f * bottleneck_bandwidth_);
+  // The switch queue holds two BDPs, PCC must not keep it full.
+  EXPECT_LE(result.mean_queueing_delay, RTT());
+}
+
+TEST_F(PccSimulatorTest, RandomLoss) {
+  const double kLossRate = 0.02;
+  TransferResult pcc = DoTransfer(kPCC, kLossRate, 12 * 1024 * 1024,
+                                  QuicTime::Delta::FromSeconds(60));
+  TransferResult cubic = DoTransfer(kCubicBytes, kLossRate, 12 * 1024 * 1024,
+                                    QuicTime::Delta::FromSeconds(60));
+  // Only for comparison, BBRv2 is not expected to be better or worse here.
+  DoTransfer(kBBRv2, kLossRate, 12 * 1024 * 1024,
+             QuicTime::Delta::FromSeconds(60));
+
+  ASSERT_TRUE(pcc.completed);
+  EXPECT_GE(pcc.goodput, 0.8f * bottleneck_bandwidth_);
+  EXPECT_GT(pcc.goodput, cubic.goodput);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -7,6 +7,7 @@
 #include "absl/base/attributes.h"
 #include "gquiche/quic/core/congestion_control/bbr2_sender.h"
 #include "gquiche/quic/core/congestion_control/bbr_sender.h"
+#include "gquiche/quic/core/congestion_control/pcc_sender.h"
 #include "gquiche/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/platform/api/quic_bug_tracker.h"
@@ -42,7 +43,12 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
               ? static_cast<BbrSender*>(old_send_algorithm)
               : nullptr, extra_loss_threshold);
     case kPCC:
-      // PCC is currently not supported, fall back to CUBIC instead.
+      if (GetQuicFlag(FLAGS_quic_enable_pcc_sender)) {
+        return new PccSender(rtt_stats, unacked_packets,
+                             initial_congestion_window, max_congestion_window,
+                             random, stats);
+      }
+      // PCC is off by default, fall back to CUBIC instead.
       ABSL_FALLTHROUGH_INTENDED;
     case kCubicBytes:
       return new TcpCubicSenderBytes(
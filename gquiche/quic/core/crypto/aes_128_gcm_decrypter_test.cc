@@ -9,6 +9,7 @@
 
 #include "absl/base/macros.h"
 #include "absl/strings/escaping.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/quic_utils.h"
 #include "gquiche/quic/platform/api/quic_test.h"
 #include "gquiche/quic/test_tools/quic_test_utils.h"
@@ -287,5 +288,25 @@ TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMaskIntoSpan) {
+  Aes128GcmDecrypter decrypter;
+  std::string key = absl::HexStringToBytes("d9132370cb18476ab833649cf080d970");
+  // The sample is followed by the rest of the packet, which is ignored.
+  std::string sample = absl::HexStringToBytes(
+      "d1d7998068517adb769b48b924a32c47ffffffff");
+  ASSERT_TRUE(decrypter.SetHeaderProtectionKey(key));
+  uint8_t mask[QuicDecrypter::kHeaderProtectionMaskLength];
+  ASSERT_TRUE(
+      decrypter.GenerateHeaderProtectionMask(sample, absl::MakeSpan(mask)));
+  std::string expected_mask = absl::HexStringToBytes("b132c37d61");
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", reinterpret_cast<const char*>(mask),
+      sizeof(mask), expected_mask.data(), expected_mask.size());
+
+  // Samples that are too short are rejected.
+  EXPECT_FALSE(decrypter.GenerateHeaderProtectionMask(
+      absl::string_view(sample).substr(0, 15), absl::MakeSpan(mask)));
+}
+
 }  // namespace test
 }  // namespace quic
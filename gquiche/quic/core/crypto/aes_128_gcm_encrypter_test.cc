@@ -9,6 +9,7 @@
 
 #include "absl/base/macros.h"
 #include "absl/strings/escaping.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/quic_utils.h"
 #include "gquiche/quic/platform/api/quic_test.h"
 #include "gquiche/quic/test_tools/quic_test_utils.h"
@@ -269,5 +270,20 @@ TEST_F(Aes128GcmEncrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(Aes128GcmEncrypterTest, GenerateHeaderProtectionMaskIntoSpan) {
+  Aes128GcmEncrypter encrypter;
+  std::string key = absl::HexStringToBytes("d9132370cb18476ab833649cf080d970");
+  std::string sample =
+      absl::HexStringToBytes("d1d7998068517adb769b48b924a32c47");
+  ASSERT_TRUE(encrypter.SetHeaderProtectionKey(key));
+  uint8_t mask[QuicEncrypter::kHeaderProtectionMaskLength];
+  ASSERT_TRUE(
+      encrypter.GenerateHeaderProtectionMask(sample, absl::MakeSpan(mask)));
+  std::string expected_mask = absl::HexStringToBytes("b132c37d61");
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", reinterpret_cast<const char*>(mask),
+      sizeof(mask), expected_mask.data(), expected_mask.size());
+}
+
 }  // namespace test
 }  // namespace quic
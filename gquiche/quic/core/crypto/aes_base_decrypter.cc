@@ -4,6 +4,8 @@
 
 #include "gquiche/quic/core/crypto/aes_base_decrypter.h"
 
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "openssl/aes.h"
 #include "gquiche/quic/platform/api/quic_bug_tracker.h"
@@ -30,12 +32,26 @@ std::string AesBaseDecrypter::GenerateHeaderProtectionMask(
     return std::string();
   }
   std::string out(AES_BLOCK_SIZE, 0);
-  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()),
-              reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
-              &pne_key_);
+  if (!GenerateHeaderProtectionMask(
+          sample, absl::MakeSpan(reinterpret_cast<uint8_t*>(&out[0]),
+                                 out.size()))) {
+    return std::string();
+  }
   return out;
 }
 
+bool AesBaseDecrypter::GenerateHeaderProtectionMask(absl::string_view sample,
+                                                    absl::Span<uint8_t> out) {
+  if (sample.size() < AES_BLOCK_SIZE || out.size() > AES_BLOCK_SIZE) {
+    return false;
+  }
+  uint8_t mask[AES_BLOCK_SIZE];
+  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()), mask,
+              &pne_key_);
+  memcpy(out.data(), mask, out.size());
+  return true;
+}
+
 QuicPacketCount AesBaseDecrypter::GetIntegrityLimit() const {
   // For AEAD_AES_128_GCM ... endpoints that do not attempt to remove
   // protection from packets larger than 2^11 bytes can attempt to remove
@@ -4,6 +4,8 @@
 
 #include "gquiche/quic/core/crypto/aes_base_encrypter.h"
 
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "openssl/aes.h"
 #include "gquiche/quic/platform/api/quic_bug_tracker.h"
@@ -26,16 +28,27 @@ bool AesBaseEncrypter::SetHeaderProtectionKey(absl::string_view key) {
 
 std::string AesBaseEncrypter::GenerateHeaderProtectionMask(
     absl::string_view sample) {
-  if (sample.size() != AES_BLOCK_SIZE) {
+  std::string out(AES_BLOCK_SIZE, 0);
+  if (!GenerateHeaderProtectionMask(
+          sample, absl::MakeSpan(reinterpret_cast<uint8_t*>(&out[0]),
+                                 out.size()))) {
     return std::string();
   }
-  std::string out(AES_BLOCK_SIZE, 0);
-  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()),
-              reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
-              &pne_key_);
   return out;
 }
 
+bool AesBaseEncrypter::GenerateHeaderProtectionMask(absl::string_view sample,
+                                                    absl::Span<uint8_t> out) {
+  if (sample.size() != AES_BLOCK_SIZE || out.size() > AES_BLOCK_SIZE) {
+    return false;
+  }
+  uint8_t mask[AES_BLOCK_SIZE];
+  AES_encrypt(reinterpret_cast<const uint8_t*>(sample.data()), mask,
+              &pne_key_);
+  memcpy(out.data(), mask, out.size());
+  return true;
+}
+
 QuicPacketCount AesBaseEncrypter::GetConfidentialityLimit() const {
   // For AEAD_AES_128_GCM and AEAD_AES_256_GCM ... endpoints that do not send
   // packets larger than 2^11 bytes cannot protect more than 2^28 packets.
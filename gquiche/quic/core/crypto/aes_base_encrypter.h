@@ -8,6 +8,7 @@
 #include <cstddef>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "openssl/aes.h"
 #include "gquiche/quic/core/crypto/aead_base_encrypter.h"
 #include "gquiche/quic/platform/api/quic_export.h"
@@ -20,10 +21,13 @@ class QUIC_EXPORT_PRIVATE AesBaseEncrypter : public AeadBaseEncrypter {
 
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                    absl::Span<uint8_t> out) override;
   QuicPacketCount GetConfidentialityLimit() const override;
 
  private:
-  // The key used for packet number encryption.
+  // The key schedule used for packet number encryption, expanded once when the
+  // header protection key is set.
   AES_KEY pne_key_;
 };
 
@@ -8,6 +8,7 @@
 #include <cstddef>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/aead_base_decrypter.h"
 #include "gquiche/quic/platform/api/quic_export.h"
 
@@ -20,6 +21,8 @@ class QUIC_EXPORT_PRIVATE ChaChaBaseDecrypter : public AeadBaseDecrypter {
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                    absl::Span<uint8_t> out) override;
 
  private:
   // The key used for packet number encryption.
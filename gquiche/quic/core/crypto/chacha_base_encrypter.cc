@@ -4,7 +4,6 @@
 
 #include "gquiche/quic/core/crypto/chacha_base_encrypter.h"
 
-#include "absl/base/macros.h"
 #include "absl/strings/string_view.h"
 #include "openssl/chacha.h"
 #include "gquiche/quic/core/quic_data_reader.h"
@@ -24,18 +23,28 @@ bool ChaChaBaseEncrypter::SetHeaderProtectionKey(absl::string_view key) {
 
 std::string ChaChaBaseEncrypter::GenerateHeaderProtectionMask(
     absl::string_view sample) {
-  if (sample.size() != 16) {
+  std::string out(kHeaderProtectionMaskLength, 0);
+  if (!GenerateHeaderProtectionMask(
+          sample, absl::MakeSpan(reinterpret_cast<uint8_t*>(&out[0]),
+                                 out.size()))) {
     return std::string();
   }
+  return out;
+}
+
+bool ChaChaBaseEncrypter::GenerateHeaderProtectionMask(
+    absl::string_view sample, absl::Span<uint8_t> out) {
+  if (sample.size() != kHeaderProtectionSampleLength ||
+      out.size() > kHeaderProtectionSampleLength) {
+    return false;
+  }
   const uint8_t* nonce = reinterpret_cast<const uint8_t*>(sample.data()) + 4;
   uint32_t counter;
   QuicDataReader(sample.data(), 4, quiche::HOST_BYTE_ORDER)
       .ReadUInt32(&counter);
-  const uint8_t zeroes[] = {0, 0, 0, 0, 0};
-  std::string out(ABSL_ARRAYSIZE(zeroes), 0);
-  CRYPTO_chacha_20(reinterpret_cast<uint8_t*>(const_cast<char*>(out.data())),
-                   zeroes, ABSL_ARRAYSIZE(zeroes), pne_key_, nonce, counter);
-  return out;
+  const uint8_t zeroes[kHeaderProtectionSampleLength] = {};
+  CRYPTO_chacha_20(out.data(), zeroes, out.size(), pne_key_, nonce, counter);
+  return true;
 }
 
 }  // namespace quic
@@ -8,6 +8,7 @@
 #include <cstddef>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/aead_base_encrypter.h"
 #include "gquiche/quic/platform/api/quic_export.h"
 
@@ -19,6 +20,8 @@ class QUIC_EXPORT_PRIVATE ChaChaBaseEncrypter : public AeadBaseEncrypter {
 
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                    absl::Span<uint8_t> out) override;
 
  private:
   // The key used for packet number encryption.
@@ -5,6 +5,7 @@
 #include "gquiche/quic/core/crypto/null_decrypter.h"
 
 #include <cstdint>
+#include <cstring>
 
 #include "absl/numeric/int128.h"
 #include "absl/strings/string_view.h"
@@ -74,6 +75,12 @@ std::string NullDecrypter::GenerateHeaderProtectionMask(
   return std::string(5, 0);
 }
 
+bool NullDecrypter::GenerateHeaderProtectionMask(absl::string_view /*sample*/,
+                                                 absl::Span<uint8_t> out) {
+  memset(out.data(), 0, out.size());
+  return true;
+}
+
 size_t NullDecrypter::GetKeySize() const { return 0; }
 
 size_t NullDecrypter::GetNoncePrefixSize() const { return 0; }
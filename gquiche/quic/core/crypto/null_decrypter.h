@@ -10,6 +10,7 @@
 
 #include "absl/numeric/int128.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/quic_decrypter.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/platform/api/quic_export.h"
@@ -40,6 +41,8 @@ class QUIC_EXPORT_PRIVATE NullDecrypter : public QuicDecrypter {
                      size_t* output_length, size_t max_output_length) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                    absl::Span<uint8_t> out) override;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
@@ -4,6 +4,8 @@
 
 #include "gquiche/quic/core/crypto/null_encrypter.h"
 
+#include <cstring>
+
 #include "absl/numeric/int128.h"
 #include "absl/strings/string_view.h"
 #include "gquiche/quic/core/quic_data_writer.h"
@@ -59,6 +61,12 @@ std::string NullEncrypter::GenerateHeaderProtectionMask(
   return std::string(5, 0);
 }
 
+bool NullEncrypter::GenerateHeaderProtectionMask(absl::string_view /*sample*/,
+                                                 absl::Span<uint8_t> out) {
+  memset(out.data(), 0, out.size());
+  return true;
+}
+
 size_t NullEncrypter::GetKeySize() const { return 0; }
 
 size_t NullEncrypter::GetNoncePrefixSize() const { return 0; }
@@ -8,6 +8,7 @@
 #include <cstddef>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/quic_encrypter.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/platform/api/quic_export.h"
@@ -33,6 +34,8 @@ class QUIC_EXPORT_PRIVATE NullEncrypter : public QuicEncrypter {
                      absl::string_view plaintext, char* output,
                      size_t* output_length, size_t max_output_length) override;
   std::string GenerateHeaderProtectionMask(absl::string_view sample) override;
+  bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                    absl::Span<uint8_t> out) override;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_CORE_CRYPTO_QUIC_CRYPTER_H_
 #define QUICHE_QUIC_CORE_CRYPTO_QUIC_CRYPTER_H_
 
+#include <cstddef>
+
 #include "absl/strings/string_view.h"
 #include "gquiche/quic/core/quic_versions.h"
 #include "gquiche/quic/platform/api/quic_export.h"
@@ -17,6 +19,12 @@ namespace quic {
 // decrypters.
 class QUIC_EXPORT_PRIVATE QuicCrypter {
  public:
+  // The length of the ciphertext sample used for header protection.
+  static constexpr size_t kHeaderProtectionSampleLength = 16;
+  // The number of header protection mask bytes used to protect a header: one
+  // for the first byte and up to four for the packet number.
+  static constexpr size_t kHeaderProtectionMaskLength = 5;
+
   virtual ~QuicCrypter() {}
 
   // Sets the symmetric encryption/decryption key. Returns true on success,
@@ -11,6 +11,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/quic_crypter.h"
 #include "gquiche/quic/core/quic_data_reader.h"
 #include "gquiche/quic/core/quic_packets.h"
@@ -68,6 +69,14 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) = 0;
 
+  // Like above, but takes the |sample| directly, which may be longer than
+  // needed, and writes the first |out.size()| bytes of the mask to |out|
+  // instead of allocating. |out| must be between kHeaderProtectionMaskLength
+  // and kHeaderProtectionSampleLength bytes long. Returns false on failure.
+  // QuicFramer uses this one on every packet.
+  virtual bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                            absl::Span<uint8_t> out) = 0;
+
   // The ID of the cipher. Return 0x03000000 ORed with the 'cryptographic suite
   // selector'.
   virtual uint32_t cipher_id() const = 0;
@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/crypto/quic_crypter.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/platform/api/quic_export.h"
@@ -48,6 +49,13 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       absl::string_view sample) = 0;
 
+  // Like above, but writes the first |out.size()| bytes of the mask to |out|
+  // instead of allocating. |out| must be between kHeaderProtectionMaskLength
+  // and kHeaderProtectionSampleLength bytes long. Returns false on failure.
+  // QuicFramer uses this one on every packet.
+  virtual bool GenerateHeaderProtectionMask(absl::string_view sample,
+                                            absl::Span<uint8_t> out) = 0;
+
   // Returns the maximum length of plaintext that can be encrypted
   // to ciphertext no larger than |ciphertext_size|.
   virtual size_t GetMaxPlaintextSize(size_t ciphertext_size) const = 0;
@@ -7,6 +7,7 @@
 
 #include <ostream>
 
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_interval.h"
 #include "gquiche/quic/core/quic_interval_set.h"
 #include "gquiche/quic/core/quic_types.h"
@@ -88,7 +89,7 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
   QuicIntervalSet<QuicPacketNumber> packet_number_intervals_;
 };
 
-struct QUIC_EXPORT_PRIVATE QuicAckFrame {
+struct QUIC_EXPORT_PRIVATE QuicAckFrame : public QuicArenaAllocatedFrame {
   QuicAckFrame();
   QuicAckFrame(const QuicAckFrame& other);
   ~QuicAckFrame();
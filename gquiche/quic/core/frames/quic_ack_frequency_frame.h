@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <ostream>
 
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_constants.h"
 #include "gquiche/quic/core/quic_time.h"
 #include "gquiche/quic/core/quic_types.h"
@@ -16,7 +17,8 @@
 namespace quic {
 
 // A frame that allows sender control of acknowledgement delays.
-struct QUIC_EXPORT_PRIVATE QuicAckFrequencyFrame {
+struct QUIC_EXPORT_PRIVATE QuicAckFrequencyFrame
+    : public QuicArenaAllocatedFrame {
   friend QUIC_EXPORT_PRIVATE std::ostream& operator<<(
       std::ostream& os, const QuicAckFrequencyFrame& ack_frequency_frame);
 
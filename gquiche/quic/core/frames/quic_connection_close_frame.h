@@ -8,6 +8,7 @@
 #include <ostream>
 #include <string>
 
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_error_codes.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/core/quic_versions.h"
@@ -15,7 +16,8 @@
 
 namespace quic {
 
-struct QUIC_EXPORT_PRIVATE QuicConnectionCloseFrame {
+struct QUIC_EXPORT_PRIVATE QuicConnectionCloseFrame
+    : public QuicArenaAllocatedFrame {
   QuicConnectionCloseFrame() = default;
 
   // Builds a connection close frame based on the transport version
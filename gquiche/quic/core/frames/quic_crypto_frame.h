@@ -9,12 +9,13 @@
 #include <ostream>
 
 #include "absl/strings/string_view.h"
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/platform/api/quic_export.h"
 
 namespace quic {
 
-struct QUIC_EXPORT_PRIVATE QuicCryptoFrame {
+struct QUIC_EXPORT_PRIVATE QuicCryptoFrame : public QuicArenaAllocatedFrame {
   QuicCryptoFrame() = default;
   QuicCryptoFrame(EncryptionLevel level, QuicStreamOffset offset,
                   QuicPacketLength data_length);
@@ -0,0 +1,168 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "gquiche/quic/core/quic_connection_context.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Block payload sizes. The frames QuicFrame points to are between about 30 and
+// 150 bytes.
+constexpr size_t kBlockSizes[] = {64, 128, 256};
+constexpr size_t kNumBlockSizes = sizeof(kBlockSizes) / sizeof(kBlockSizes[0]);
+// The first slab is small, as most connections only ever hold a handful of
+// frames. The second one tops it up to kMaxSlabSize, so that busy connections
+// hold no more than they would with kMaxSlabSize slabs alone.
+constexpr size_t kMinSlabSize = 512;
+constexpr size_t kMaxSlabSize = 16 * 1024;
+
+}  // namespace
+
+namespace internal {
+
+// Precedes each block. |core| is null for blocks from the heap.
+struct alignas(16) FrameBlockHeader {
+  FrameArenaCore* core;
+  size_t size_index;
+};
+
+struct FreeFrameBlock {
+  FreeFrameBlock* next;
+};
+
+// The slabs and free lists. Owned by the arena, or, once the arena is gone, by
+// the blocks still in use.
+struct FrameArenaCore {
+  void* Allocate(size_t size_index) {
+    QUICHE_DCHECK(std::this_thread::get_id() == owner_thread)
+        << "Frame arena used off its thread";
+    FrameBlockHeader* header;
+    if (free_lists[size_index] != nullptr) {
+      FreeFrameBlock* block = free_lists[size_index];
+      free_lists[size_index] = block->next;
+      header = reinterpret_cast<FrameBlockHeader*>(block) - 1;
+    } else {
+      const size_t block_size =
+          sizeof(FrameBlockHeader) + kBlockSizes[size_index];
+      if (static_cast<size_t>(slab_end - slab_next) < block_size) {
+        slabs.emplace_back(new char[next_slab_size]);
+        slab_next = slabs.back().get();
+        slab_end = slab_next + next_slab_size;
+        slab_bytes += next_slab_size;
+        next_slab_size = slab_bytes < kMaxSlabSize ? kMaxSlabSize - slab_bytes
+                                                   : kMaxSlabSize;
+      }
+      header = reinterpret_cast<FrameBlockHeader*>(slab_next);
+      slab_next += block_size;
+      header->core = this;
+      header->size_index = size_index;
+    }
+    ++num_in_use;
+    return header + 1;
+  }
+
+  void Free(FrameBlockHeader* header) {
+    QUICHE_DCHECK(std::this_thread::get_id() == owner_thread)
+        << "Frame freed off its arena's thread";
+    QUICHE_DCHECK_GT(num_in_use, 0u);
+    --num_in_use;
+    if (orphaned) {
+      if (num_in_use == 0) {
+        delete this;
+      }
+      return;
+    }
+    auto* block = reinterpret_cast<FreeFrameBlock*>(header + 1);
+    block->next = free_lists[header->size_index];
+    free_lists[header->size_index] = block;
+  }
+
+  std::vector<std::unique_ptr<char[]>> slabs;
+  // The unused part of the last slab.
+  char* slab_next = nullptr;
+  char* slab_end = nullptr;
+  size_t next_slab_size = kMinSlabSize;
+  size_t slab_bytes = 0;
+  FreeFrameBlock* free_lists[kNumBlockSizes] = {};
+  size_t num_in_use = 0;
+  bool orphaned = false;
+  const std::thread::id owner_thread = std::this_thread::get_id();
+};
+
+}  // namespace internal
+
+QuicFrameArena::QuicFrameArena() : core_(new internal::FrameArenaCore()) {}
+
+QuicFrameArena::~QuicFrameArena() {
+  if (core_->num_in_use == 0) {
+    delete core_;
+    return;
+  }
+  QUIC_DVLOG(1) << "Destroying frame arena with " << core_->num_in_use
+                << " frames in use";
+  core_->orphaned = true;
+}
+
+void* QuicFrameArena::Allocate(size_t size) {
+  for (size_t i = 0; i < kNumBlockSizes; ++i) {
+    if (size <= kBlockSizes[i]) {
+      return core_->Allocate(i);
+    }
+  }
+  return AllocateFromHeap(size);
+}
+
+// static
+void* QuicFrameArena::AllocateFromHeap(size_t size) {
+  auto* header = static_cast<internal::FrameBlockHeader*>(
+      ::operator new(sizeof(internal::FrameBlockHeader) + size));
+  header->core = nullptr;
+  header->size_index = 0;
+  return header + 1;
+}
+
+// static
+void QuicFrameArena::Free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* header = static_cast<internal::FrameBlockHeader*>(ptr) - 1;
+  if (header->core == nullptr) {
+    ::operator delete(header);
+    return;
+  }
+  header->core->Free(header);
+}
+
+size_t QuicFrameArena::num_blocks_in_use() const { return core_->num_in_use; }
+
+size_t QuicFrameArena::num_slabs() const { return core_->slabs.size(); }
+
+size_t QuicFrameArena::num_slab_bytes() const { return core_->slab_bytes; }
+
+// static
+void* QuicArenaAllocatedFrame::operator new(size_t size) {
+  QuicConnectionContext* context = QuicConnectionContext::Current();
+  if (context != nullptr && context->frame_arena != nullptr) {
+    return context->frame_arena->Allocate(size);
+  }
+  return QuicFrameArena::AllocateFromHeap(size);
+}
+
+// static
+void QuicArenaAllocatedFrame::operator delete(void* ptr) {
+  QuicFrameArena::Free(ptr);
+}
+
+}  // namespace quic
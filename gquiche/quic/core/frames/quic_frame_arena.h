@@ -0,0 +1,68 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
+#define QUICHE_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
+
+#include <cstddef>
+
+#include "gquiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+namespace internal {
+struct FrameArenaCore;
+}  // namespace internal
+
+// A per-connection slab allocator for the frames QuicFrame holds by pointer.
+// Frames are carved out of slabs, a first one of 512 bytes, then one topping
+// it up to 16KB and 16KB ones after that, and freed frames go on per-size
+// free lists for the next ones, so that the control frames, their
+// retransmittable copies held by QuicUnackedPacketMap and crypto and message
+// frames do not each cost a heap allocation and free.
+//
+// Frames may outlive the arena: the slabs are all released when the arena is
+// destroyed, or, if frames from it are left then, when the last one is freed.
+// Not thread safe: an arena must only be used, and all of its frames freed, on
+// the thread that created it, which debug builds check.
+class QUIC_EXPORT_PRIVATE QuicFrameArena {
+ public:
+  QuicFrameArena();
+  QuicFrameArena(const QuicFrameArena&) = delete;
+  QuicFrameArena& operator=(const QuicFrameArena&) = delete;
+  ~QuicFrameArena();
+
+  // Returns |size| bytes from the arena, or from the heap if |size| is larger
+  // than the arena's blocks. Freed with Free().
+  void* Allocate(size_t size);
+
+  // Returns |size| bytes from the heap, which Free() frees.
+  static void* AllocateFromHeap(size_t size);
+
+  // Frees |ptr|, returned by Allocate() of any arena or by AllocateFromHeap().
+  static void Free(void* ptr);
+
+  // Blocks handed out and not freed yet.
+  size_t num_blocks_in_use() const;
+  // Slabs allocated so far, which is the number of heap allocations made for
+  // the blocks.
+  size_t num_slabs() const;
+  // Total size of those slabs.
+  size_t num_slab_bytes() const;
+
+ private:
+  internal::FrameArenaCore* core_;
+};
+
+// Base of the frames QuicFrame holds by pointer. While a connection's context
+// is current, these frames are allocated from its QuicFrameArena, otherwise
+// from the heap. Either way they are freed with delete, from any context.
+struct QUIC_EXPORT_PRIVATE QuicArenaAllocatedFrame {
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
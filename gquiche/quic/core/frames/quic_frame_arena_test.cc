@@ -0,0 +1,105 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gquiche/quic/core/frames/quic_frame.h"
+#include "gquiche/quic/core/quic_connection_context.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicFrameArenaTest : public QuicTest {};
+
+TEST_F(QuicFrameArenaTest, ReusesFreedBlocks) {
+  QuicFrameArena arena;
+  void* block = arena.Allocate(40);
+  EXPECT_EQ(1u, arena.num_blocks_in_use());
+  EXPECT_EQ(1u, arena.num_slabs());
+  QuicFrameArena::Free(block);
+  EXPECT_EQ(0u, arena.num_blocks_in_use());
+
+  EXPECT_EQ(block, arena.Allocate(60));
+  // A larger block does not reuse it.
+  void* larger_block = arena.Allocate(100);
+  EXPECT_NE(block, larger_block);
+  EXPECT_EQ(2u, arena.num_blocks_in_use());
+  EXPECT_EQ(1u, arena.num_slabs());
+  QuicFrameArena::Free(block);
+  QuicFrameArena::Free(larger_block);
+}
+
+TEST_F(QuicFrameArenaTest, SlabsGrow) {
+  QuicFrameArena arena;
+  std::vector<void*> blocks;
+  blocks.push_back(arena.Allocate(40));
+  EXPECT_EQ(512u, arena.num_slab_bytes());
+
+  // 80 byte blocks, from slabs of 512B, 16KB - 512B, 16KB, 16KB.
+  while (arena.num_slabs() < 4) {
+    blocks.push_back(arena.Allocate(40));
+  }
+  EXPECT_EQ(512u + (16384 - 512) + 16384 + 16384, arena.num_slab_bytes());
+  for (void* block : blocks) {
+    QuicFrameArena::Free(block);
+  }
+}
+
+TEST_F(QuicFrameArenaTest, LargeBlocksComeFromTheHeap) {
+  QuicFrameArena arena;
+  void* block = arena.Allocate(1000);
+  EXPECT_EQ(0u, arena.num_blocks_in_use());
+  EXPECT_EQ(0u, arena.num_slabs());
+  QuicFrameArena::Free(block);
+}
+
+TEST_F(QuicFrameArenaTest, FramesUseTheCurrentConnectionsArena) {
+  QuicConnectionContext context;
+  context.frame_arena = std::make_unique<QuicFrameArena>();
+  QuicFrameArena* arena = context.frame_arena.get();
+
+  // Outside of the connection's context, frames come from the heap.
+  QuicFrames frames;
+  frames.push_back(QuicFrame(new QuicRstStreamFrame(1, 3, QUIC_STREAM_CANCELLED,
+                                                    /*bytes_written=*/0)));
+  EXPECT_EQ(0u, arena->num_blocks_in_use());
+  {
+    QuicConnectionContextSwitcher switcher(&context);
+    frames.push_back(QuicFrame(new QuicRstStreamFrame(
+        2, 7, QUIC_STREAM_CANCELLED, /*bytes_written=*/0)));
+    frames.push_back(
+        QuicFrame(new QuicCryptoFrame(ENCRYPTION_INITIAL, 0, 100)));
+    EXPECT_EQ(2u, arena->num_blocks_in_use());
+  }
+
+  // Frames are freed from any context.
+  DeleteFrames(&frames);
+  EXPECT_EQ(0u, arena->num_blocks_in_use());
+}
+
+TEST_F(QuicFrameArenaTest, FramesOutliveTheArena) {
+  QuicFrameArena* arena = new QuicFrameArena();
+  void* block = arena->Allocate(64);
+  delete arena;
+  // The slab is still there until the block is freed.
+  memset(block, 0, 64);
+  QuicFrameArena::Free(block);
+}
+
+TEST_F(QuicFrameArenaTest, UsedOffItsThread) {
+  QuicFrameArena arena;
+  EXPECT_QUICHE_DEBUG_DEATH(
+      std::thread([&arena] { arena.Allocate(40); }).join(), "");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
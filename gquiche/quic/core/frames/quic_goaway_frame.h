@@ -8,13 +8,14 @@
 #include <ostream>
 #include <string>
 
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_constants.h"
 #include "gquiche/quic/core/quic_error_codes.h"
 #include "gquiche/quic/core/quic_types.h"
 
 namespace quic {
 
-struct QUIC_EXPORT_PRIVATE QuicGoAwayFrame {
+struct QUIC_EXPORT_PRIVATE QuicGoAwayFrame : public QuicArenaAllocatedFrame {
   QuicGoAwayFrame() = default;
   QuicGoAwayFrame(QuicControlFrameId control_frame_id, QuicErrorCode error_code,
                   QuicStreamId last_good_stream_id, const std::string& reason);
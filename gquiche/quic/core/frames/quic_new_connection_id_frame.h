@@ -7,6 +7,7 @@
 
 #include <ostream>
 
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/core/quic_connection_id.h"
 #include "gquiche/quic/core/quic_constants.h"
 #include "gquiche/quic/core/quic_error_codes.h"
@@ -14,7 +15,8 @@
 
 namespace quic {
 
-struct QUIC_EXPORT_PRIVATE QuicNewConnectionIdFrame {
+struct QUIC_EXPORT_PRIVATE QuicNewConnectionIdFrame
+    : public QuicArenaAllocatedFrame {
   QuicNewConnectionIdFrame() = default;
   QuicNewConnectionIdFrame(QuicControlFrameId control_frame_id,
                            QuicConnectionId connection_id,
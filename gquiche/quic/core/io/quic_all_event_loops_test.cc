@@ -214,6 +214,27 @@ TEST_P(QuicEventLoopFactoryTest, WriterUnblocked) {
   loop_->RunEventLoopOnce(QuicTime::Delta::FromMilliseconds(1));
 }
 
+// A hangup is only reported along with the events the listener asked for.
+TEST_P(QuicEventLoopFactoryTest, Hangup) {
+  testing::StrictMock<MockQuicSocketEventListener> listener;
+  ASSERT_TRUE(loop_->RegisterSocket(read_fd_, kAllEvents, &listener));
+
+  ASSERT_EQ(4, write(write_fd_, "test", 4));
+  close(write_fd_);
+  write_fd_ = -1;
+  EXPECT_CALL(listener, OnSocketEvent(_, read_fd_, kSocketEventReadable));
+  loop_->RunEventLoopOnce(QuicTime::Delta::FromMilliseconds(1));
+
+  char buf[4];
+  ASSERT_EQ(4, read(read_fd_, buf, sizeof(buf)));
+  ASSERT_EQ(0, read(read_fd_, buf, sizeof(buf)));
+  if (!loop_->SupportsEdgeTriggered()) {
+    ASSERT_TRUE(loop_->RearmSocket(read_fd_, kAllEvents));
+  }
+  // Expect no further calls.
+  loop_->RunEventLoopOnce(QuicTime::Delta::FromMilliseconds(1));
+}
+
 TEST_P(QuicEventLoopFactoryTest, ArtificialEvent) {
   testing::StrictMock<MockQuicSocketEventListener> listener;
   ASSERT_TRUE(loop_->RegisterSocket(read_fd_, kAllEvents, &listener));
@@ -7,12 +7,22 @@
 #include <memory>
 
 #include "gquiche/quic/core/io/quic_poll_event_loop.h"
+#include "gquiche/quic/core/io/quic_timer_wheel_event_loop.h"
 #include "gquiche/common/platform/api/quiche_event_loop.h"
 
 #ifdef QUICHE_ENABLE_LIBEVENT
 #include "gquiche/quic/bindings/quic_libevent.h"
 #endif
 
+#if defined(__linux__)
+#include "gquiche/quic/core/io/quic_epoll_event_loop.h"
+#endif
+
+#ifdef QUIC_ENABLE_IO_URING
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/io/quic_io_uring_event_loop.h"
+#endif
+
 namespace quic {
 
 QuicEventLoopFactory* GetDefaultEventLoop() {
@@ -22,6 +32,8 @@ QuicEventLoopFactory* GetDefaultEventLoop() {
   }
 #ifdef QUICHE_ENABLE_LIBEVENT
   return QuicLibeventEventLoopFactory::Get();
+#elif defined(__linux__)
+  return QuicEpollEventLoopFactory::Get();
 #else
   return QuicPollEventLoopFactory::Get();
 #endif
@@ -33,7 +45,15 @@ std::vector<QuicEventLoopFactory*> GetAllSupportedEventLoops() {
       QuicLibeventEventLoopFactory::Get(),
       QuicLibeventEventLoopFactory::GetLevelTriggeredBackendForTests(),
 #endif
-      QuicPollEventLoopFactory::Get()};
+#if defined(__linux__)
+      QuicEpollEventLoopFactory::Get(),
+#endif
+      QuicPollEventLoopFactory::Get(), QuicTimerWheelEventLoopFactory::Get()};
+#ifdef QUIC_ENABLE_IO_URING
+  if (QuicIoUring::IsSupported()) {
+    loops.push_back(QuicIoUringEventLoopFactory::Get());
+  }
+#endif
   std::vector<QuicEventLoopFactory*> extra =
       quiche::GetExtraEventLoopImplementations();
   loops.insert(loops.end(), extra.begin(), extra.end());
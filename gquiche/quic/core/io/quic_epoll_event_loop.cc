@@ -0,0 +1,306 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_epoll_event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_constants.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The number of events taken per epoll call.  Edge-triggered events that do
+// not fit stay queued for the next call.
+constexpr size_t kMaxEventsPerWait = 256;
+
+uint32_t GetEpollMask(QuicSocketEventMask event_mask) {
+  return ((event_mask & kSocketEventReadable) ? EPOLLIN : 0) |
+         ((event_mask & kSocketEventWritable) ? EPOLLOUT : 0) |
+         ((event_mask & kSocketEventError) ? EPOLLERR : 0);
+}
+
+QuicSocketEventMask GetEventMask(uint32_t epoll_mask) {
+  return ((epoll_mask & EPOLLIN) ? kSocketEventReadable : 0) |
+         ((epoll_mask & EPOLLOUT) ? kSocketEventWritable : 0) |
+         ((epoll_mask & EPOLLERR) ? kSocketEventError : 0);
+}
+
+}  // namespace
+
+QuicEpollEventLoop::QuicEpollEventLoop(QuicClock* clock, QuicTime::Delta tick)
+    : clock_(clock),
+      epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      events_(kMaxEventsPerWait),
+      epoll_pwait2_supported_(true),
+      wheel_(clock->Now(), tick) {
+  if (epoll_fd_ < 0) {
+    QUIC_BUG(quic_epoll_create_failed)
+        << "epoll_create1() failed: " << strerror(errno);
+  }
+}
+
+QuicEpollEventLoop::~QuicEpollEventLoop() {
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+  }
+}
+
+bool QuicEpollEventLoop::RegisterSocket(QuicUdpSocketFd fd,
+                                        QuicSocketEventMask events,
+                                        QuicSocketEventListener* listener) {
+  auto [it, success] =
+      registrations_.insert({fd, std::make_shared<Registration>()});
+  if (!success) {
+    return false;
+  }
+  epoll_event event = {};
+  event.events = GetEpollMask(events) | EPOLLET;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+    QUIC_LOG(ERROR) << "epoll_ctl(EPOLL_CTL_ADD) failed for fd " << fd << ": "
+                    << strerror(errno);
+    registrations_.erase(it);
+    return false;
+  }
+  Registration& registration = *it->second;
+  registration.events = events;
+  registration.listener = listener;
+  return true;
+}
+
+bool QuicEpollEventLoop::UnregisterSocket(QuicUdpSocketFd fd) {
+  if (!registrations_.erase(fd)) {
+    return false;
+  }
+  // Closing |fd| already removed it from the epoll set, and the call fails
+  // with EBADF.
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) != 0 &&
+      errno != EBADF) {
+    QUIC_LOG(ERROR) << "epoll_ctl(EPOLL_CTL_DEL) failed for fd " << fd << ": "
+                    << strerror(errno);
+  }
+  return true;
+}
+
+bool QuicEpollEventLoop::RearmSocket(QuicUdpSocketFd /*fd*/,
+                                     QuicSocketEventMask /*events*/) {
+  QUIC_BUG(quic_epoll_rearm_called)
+      << "RearmSocket() called on an edge-triggered event loop";
+  return false;
+}
+
+bool QuicEpollEventLoop::ArtificiallyNotifyEvent(QuicUdpSocketFd fd,
+                                                 QuicSocketEventMask events) {
+  auto it = registrations_.find(fd);
+  if (it == registrations_.end()) {
+    return false;
+  }
+  Registration& registration = *it->second;
+  if (registration.artificially_notify_at_next_iteration == 0) {
+    artificial_events_pending_.push_back(fd);
+  }
+  registration.artificially_notify_at_next_iteration |= events;
+  return true;
+}
+
+void QuicEpollEventLoop::RunEventLoopOnce(QuicTime::Delta default_timeout) {
+  const QuicTime start_time = clock_->Now();
+  ProcessAlarmsUpTo(start_time);
+
+  QuicTime::Delta timeout = ComputeTimeout(start_time, default_timeout);
+  ProcessIoEvents(start_time, timeout);
+
+  const QuicTime end_time = clock_->Now();
+  ProcessAlarmsUpTo(end_time);
+}
+
+QuicTime::Delta QuicEpollEventLoop::ComputeTimeout(
+    QuicTime now, QuicTime::Delta default_timeout) const {
+  default_timeout = std::max(default_timeout, QuicTime::Delta::Zero());
+  if (!artificial_events_pending_.empty()) {
+    return QuicTime::Delta::Zero();
+  }
+  const QuicTime next_alarm_time = wheel_.NextExpiration();
+  if (next_alarm_time == QuicTime::Infinite()) {
+    return default_timeout;
+  }
+  const QuicTime end_time = std::min(now + default_timeout, next_alarm_time);
+  return std::max(end_time - now, QuicTime::Delta::Zero());
+}
+
+int QuicEpollEventLoop::EpollWait(QuicTime::Delta timeout) {
+  const int max_events = static_cast<int>(events_.size());
+#ifdef __NR_epoll_pwait2
+  if (epoll_pwait2_supported_) {
+    const int64_t timeout_us = timeout.ToMicroseconds();
+    struct timespec timeout_ts;
+    timeout_ts.tv_sec = timeout_us / kNumMicrosPerSecond;
+    timeout_ts.tv_nsec = (timeout_us % kNumMicrosPerSecond) * 1000;
+    // Called directly, as the glibc wrapper is only in 2.35 and later.
+    int result = syscall(__NR_epoll_pwait2, epoll_fd_, events_.data(),
+                         max_events, &timeout_ts, nullptr, 0);
+    // Seccomp filters that predate the system call fail it with EPERM.
+    if (result >= 0 || (errno != ENOSYS && errno != EPERM)) {
+      return result;
+    }
+    QUIC_LOG(INFO) << "epoll_pwait2() is not available, using epoll_wait()";
+    epoll_pwait2_supported_ = false;
+  }
+#endif
+  const float timeout_ms = std::ceil(timeout.ToMicroseconds() / 1000.f);
+  return epoll_wait(
+      epoll_fd_, events_.data(), max_events,
+      static_cast<int>(std::min<float>(
+          timeout_ms, static_cast<float>(std::numeric_limits<int>::max()))));
+}
+
+int QuicEpollEventLoop::EpollWaitWithRetries(QuicTime start_time,
+                                             QuicTime::Delta timeout) {
+  const QuicTime timeout_at = start_time + timeout;
+  int result;
+  for (;;) {
+    result = EpollWait(timeout);
+
+    // Retry if EINTR happens.
+    bool is_eintr = result < 0 && errno == EINTR;
+    if (!is_eintr) {
+      break;
+    }
+    QuicTime now = clock_->Now();
+    if (now >= timeout_at) {
+      break;
+    }
+    timeout = timeout_at - now;
+  }
+  return result;
+}
+
+void QuicEpollEventLoop::ProcessIoEvents(QuicTime start_time,
+                                         QuicTime::Delta timeout) {
+  int num_events = EpollWaitWithRetries(start_time, timeout);
+  if (num_events < 0) {
+    if (errno != EINTR) {
+      QUIC_LOG_FIRST_N(ERROR, 10) << "epoll wait failed: " << strerror(errno);
+    }
+    num_events = 0;
+  }
+  if (num_events == 0 && artificial_events_pending_.empty()) {
+    return;
+  }
+
+  // Prepare the list of all callbacks to be called, merging the artificial
+  // events of the sockets that also have real ones.
+  std::vector<ReadyListEntry> ready_list;
+  ready_list.reserve(num_events + artificial_events_pending_.size());
+  for (int i = 0; i < num_events; ++i) {
+    const QuicUdpSocketFd fd = events_[i].data.fd;
+    auto it = registrations_.find(fd);
+    if (it == registrations_.end()) {
+      continue;
+    }
+    Registration& registration = *it->second;
+    QuicSocketEventMask events =
+        GetEventMask(events_[i].events) |
+        registration.artificially_notify_at_next_iteration;
+    registration.artificially_notify_at_next_iteration = 0;
+    // epoll reports errors and hangups even if not requested; like
+    // QuicPollEventLoop, only the requested events are delivered.
+    events &= registration.events;
+    if (events != 0) {
+      ready_list.push_back(ReadyListEntry{fd, it->second, events});
+    }
+  }
+  for (QuicUdpSocketFd fd : artificial_events_pending_) {
+    auto it = registrations_.find(fd);
+    if (it == registrations_.end()) {
+      continue;
+    }
+    Registration& registration = *it->second;
+    const QuicSocketEventMask events =
+        registration.artificially_notify_at_next_iteration &
+        registration.events;
+    registration.artificially_notify_at_next_iteration = 0;
+    if (events != 0) {
+      ready_list.push_back(ReadyListEntry{fd, it->second, events});
+    }
+  }
+  artificial_events_pending_.clear();
+
+  // Actually call all of the callbacks.
+  RunReadyCallbacks(ready_list);
+}
+
+void QuicEpollEventLoop::RunReadyCallbacks(
+    std::vector<ReadyListEntry>& ready_list) {
+  for (ReadyListEntry& entry : ready_list) {
+    std::shared_ptr<Registration> registration = entry.registration.lock();
+    if (!registration) {
+      // The socket has been unregistered from within one of the callbacks.
+      continue;
+    }
+    registration->listener->OnSocketEvent(this, entry.fd, entry.events);
+  }
+  ready_list.clear();
+}
+
+void QuicEpollEventLoop::ProcessAlarmsUpTo(QuicTime time) {
+  // Alarms set from the callbacks, even in the past, wait for the next call.
+  // Alarms cancelled or destroyed from the callbacks leave the expired list.
+  wheel_.Advance(time);
+  while (QuicTimerWheel::Entry* entry = wheel_.PopExpired()) {
+    static_cast<Alarm*>(entry)->DoFire();
+  }
+}
+
+QuicAlarm* QuicEpollEventLoop::AlarmFactory::CreateAlarm(
+    QuicAlarm::Delegate* delegate) {
+  return new Alarm(loop_, QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
+}
+
+QuicArenaScopedPtr<QuicAlarm> QuicEpollEventLoop::AlarmFactory::CreateAlarm(
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+    QuicConnectionArena* arena) {
+  if (arena != nullptr) {
+    return arena->New<Alarm>(loop_, std::move(delegate));
+  }
+  return QuicArenaScopedPtr<QuicAlarm>(new Alarm(loop_, std::move(delegate)));
+}
+
+QuicEpollEventLoop::Alarm::Alarm(
+    QuicEpollEventLoop* loop, QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
+    : QuicAlarm(std::move(delegate)), loop_(loop) {}
+
+void QuicEpollEventLoop::Alarm::SetImpl() {
+  loop_->wheel_.Schedule(this, deadline());
+}
+
+void QuicEpollEventLoop::Alarm::CancelImpl() {
+  // Not scheduled anymore if the event loop is gone.
+  if (IsScheduled()) {
+    loop_->wheel_.Cancel(this);
+  }
+}
+
+std::unique_ptr<QuicAlarmFactory> QuicEpollEventLoop::CreateAlarmFactory() {
+  return std::make_unique<AlarmFactory>(this);
+}
+
+}  // namespace quic
@@ -0,0 +1,162 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_IO_QUIC_EPOLL_EVENT_LOOP_H_
+#define QUICHE_QUIC_CORE_IO_QUIC_EPOLL_EVENT_LOOP_H_
+
+#include <sys/epoll.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/io/quic_timer_wheel.h"
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_alarm_factory.h"
+#include "gquiche/quic/core/quic_clock.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+
+namespace quic {
+
+// An edge-triggered implementation of QuicEventLoop using epoll(7).  Unlike
+// QuicPollEventLoop, an iteration only costs the number of ready file
+// descriptors, not the number of registered ones, and sockets never have to
+// be re-armed.
+//
+// The timeouts are passed to epoll_pwait2(2) with microsecond precision, or
+// to epoll_wait(2) rounded up to milliseconds on kernels older than 5.11.
+// Alarms are kept in a QuicTimerWheel, so they fire up to |tick| after their
+// deadline, and alarms firing in the same tick run in no particular order.
+//
+// Like QuicPollEventLoop, callbacks only run once the state of the loop is
+// consistent, and registrations are tracked through weak pointers, since
+// callbacks can unregister other sockets.
+class QUICHE_NO_EXPORT QuicEpollEventLoop : public QuicEventLoop {
+ public:
+  static constexpr QuicTime::Delta kDefaultTick =
+      QuicTime::Delta::FromMicroseconds(100);
+
+  QuicEpollEventLoop(QuicClock* clock, QuicTime::Delta tick);
+  QuicEpollEventLoop(const QuicEpollEventLoop&) = delete;
+  QuicEpollEventLoop& operator=(const QuicEpollEventLoop&) = delete;
+  ~QuicEpollEventLoop() override;
+
+  // QuicEventLoop implementation.
+  bool SupportsEdgeTriggered() const override { return true; }
+  ABSL_MUST_USE_RESULT bool RegisterSocket(
+      QuicUdpSocketFd fd, QuicSocketEventMask events,
+      QuicSocketEventListener* listener) override;
+  ABSL_MUST_USE_RESULT bool UnregisterSocket(QuicUdpSocketFd fd) override;
+  ABSL_MUST_USE_RESULT bool RearmSocket(QuicUdpSocketFd fd,
+                                        QuicSocketEventMask events) override;
+  ABSL_MUST_USE_RESULT bool ArtificiallyNotifyEvent(
+      QuicUdpSocketFd fd, QuicSocketEventMask events) override;
+  void RunEventLoopOnce(QuicTime::Delta default_timeout) override;
+  std::unique_ptr<QuicAlarmFactory> CreateAlarmFactory() override;
+  const QuicClock* GetClock() override { return clock_; }
+
+ private:
+  struct Registration {
+    QuicSocketEventMask events = 0;
+    QuicSocketEventListener* listener;
+
+    QuicSocketEventMask artificially_notify_at_next_iteration = 0;
+  };
+
+  class Alarm : public QuicAlarm, public QuicTimerWheel::Entry {
+   public:
+    Alarm(QuicEpollEventLoop* loop,
+          QuicArenaScopedPtr<QuicAlarm::Delegate> delegate);
+
+    void SetImpl() override;
+    void CancelImpl() override;
+
+    void DoFire() { Fire(); }
+
+   private:
+    QuicEpollEventLoop* loop_;
+  };
+
+  class AlarmFactory : public QuicAlarmFactory {
+   public:
+    AlarmFactory(QuicEpollEventLoop* loop) : loop_(loop) {}
+
+    // QuicAlarmFactory implementation.
+    QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override;
+    QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+        QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+        QuicConnectionArena* arena) override;
+
+   private:
+    QuicEpollEventLoop* loop_;
+  };
+
+  // Used for deferred execution of I/O callbacks.
+  struct ReadyListEntry {
+    QuicUdpSocketFd fd;
+    std::weak_ptr<Registration> registration;
+    QuicSocketEventMask events;
+  };
+
+  using RegistrationMap =
+      absl::flat_hash_map<QuicUdpSocketFd, std::shared_ptr<Registration>>;
+
+  // Returns the timeout for the next epoll call, typically the time at which
+  // the next alarm is supposed to activate.
+  QuicTime::Delta ComputeTimeout(QuicTime now,
+                                 QuicTime::Delta default_timeout) const;
+  // Waits for I/O events for at most |timeout| and dispatches the callbacks
+  // accordingly.
+  void ProcessIoEvents(QuicTime start_time, QuicTime::Delta timeout);
+  // Calls all of the alarm callbacks that are scheduled before or at |time|.
+  void ProcessAlarmsUpTo(QuicTime time);
+  // Runs all of the callbacks on the ready list.
+  void RunReadyCallbacks(std::vector<ReadyListEntry>& ready_list);
+
+  // Waits while handling EINTR.  Returns the number of events in |events_|,
+  // or -1 on error.
+  int EpollWaitWithRetries(QuicTime start_time, QuicTime::Delta timeout);
+  int EpollWait(QuicTime::Delta timeout);
+
+  const QuicClock* clock_;
+  const int epoll_fd_;
+  RegistrationMap registrations_;
+  // The file descriptors ArtificiallyNotifyEvent() was called on since the
+  // last iteration, some possibly unregistered since.
+  std::vector<QuicUdpSocketFd> artificial_events_pending_;
+  std::vector<epoll_event> events_;
+  // Cleared the first time epoll_pwait2(2) turns out not to be available.
+  bool epoll_pwait2_supported_;
+  QuicTimerWheel wheel_;
+};
+
+class QUICHE_NO_EXPORT QuicEpollEventLoopFactory : public QuicEventLoopFactory {
+ public:
+  // Returns the factory of event loops with the default tick.
+  static QuicEpollEventLoopFactory* Get() {
+    static QuicEpollEventLoopFactory* factory =
+        new QuicEpollEventLoopFactory(QuicEpollEventLoop::kDefaultTick);
+    return factory;
+  }
+
+  explicit QuicEpollEventLoopFactory(QuicTime::Delta tick) : tick_(tick) {}
+
+  std::unique_ptr<QuicEventLoop> Create(QuicClock* clock) override {
+    return std::make_unique<QuicEpollEventLoop>(clock, tick_);
+  }
+
+  std::string GetName() const override {
+    return "epoll(7), " + tick_.ToDebuggingValue() + " tick";
+  }
+
+ private:
+  const QuicTime::Delta tick_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_IO_QUIC_EPOLL_EVENT_LOOP_H_
@@ -0,0 +1,289 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_io_uring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "gquiche/quic/core/quic_constants.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+void* MapRing(int ring_fd, size_t size, off_t offset) {
+  void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+  return ring == MAP_FAILED ? nullptr : ring;
+}
+
+template <typename T>
+T* RingField(void* ring, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+}  // namespace
+
+// static
+bool QuicIoUring::IsSupported() {
+  static const bool supported = []() {
+    QuicIoUring ring;
+    if (!ring.Initialize(8)) {
+      QUIC_LOG(INFO) << "io_uring is not available: " << strerror(errno);
+      return false;
+    }
+    // Provided buffer rings are the most recent feature used after the setup
+    // flags, which need 6.1.
+    if (!ring.RegisterBufferRing(/*group_id=*/0, /*num_buffers=*/1,
+                                 /*buffer_size=*/64)) {
+      QUIC_LOG(INFO) << "io_uring provided buffer rings are not available: "
+                     << strerror(errno);
+      return false;
+    }
+    return true;
+  }();
+  return supported;
+}
+
+QuicIoUring::QuicIoUring() { Reset(); }
+
+QuicIoUring::~QuicIoUring() { Close(); }
+
+void QuicIoUring::Close() {
+  if (buf_ring_ != nullptr) {
+    munmap(buf_ring_, buf_ring_size_);
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+  Reset();
+}
+
+bool QuicIoUring::CloseAfterError() {
+  const int error = errno;
+  Close();
+  errno = error;
+  return false;
+}
+
+void QuicIoUring::Reset() {
+  ring_fd_ = -1;
+  sq_ring_ = nullptr;
+  sq_ring_size_ = 0;
+  cq_ring_ = nullptr;
+  cq_ring_size_ = 0;
+  sqes_ = nullptr;
+  sqes_size_ = 0;
+  sq_khead_ = nullptr;
+  sq_ktail_ = nullptr;
+  sq_mask_ = 0;
+  sq_entries_ = 0;
+  sq_tail_ = 0;
+  cq_khead_ = nullptr;
+  cq_ktail_ = nullptr;
+  cq_mask_ = 0;
+  cqes_ = nullptr;
+  buf_ring_ = nullptr;
+  buf_ring_size_ = 0;
+  buffers_ = nullptr;
+  buffer_size_ = 0;
+  buf_ring_mask_ = 0;
+  buf_ring_tail_ = 0;
+}
+
+bool QuicIoUring::Initialize(uint32_t entries, uint32_t cq_entries) {
+  QUICHE_DCHECK(!initialized());
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER |
+                 IORING_SETUP_DEFER_TASKRUN;
+  if (cq_entries > 0) {
+    // Rounded up to a power of two by the kernel, which also requires at
+    // least |entries|.
+    params.flags |= IORING_SETUP_CQSIZE;
+    params.cq_entries = std::max(cq_entries, entries);
+  }
+  int ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+  if (ring_fd < 0) {
+    return false;
+  }
+  if (!(params.features & IORING_FEAT_EXT_ARG)) {
+    close(ring_fd);
+    errno = EOPNOTSUPP;
+    return false;
+  }
+  ring_fd_ = ring_fd;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = MapRing(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == nullptr) {
+    return CloseAfterError();
+  }
+  cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP)
+                 ? sq_ring_
+                 : MapRing(ring_fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+  if (cq_ring_ == nullptr) {
+    return CloseAfterError();
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = static_cast<io_uring_sqe*>(
+      MapRing(ring_fd_, sqes_size_, IORING_OFF_SQES));
+  if (sqes_ == nullptr) {
+    return CloseAfterError();
+  }
+
+  sq_khead_ = RingField<uint32_t>(sq_ring_, params.sq_off.head);
+  sq_ktail_ = RingField<uint32_t>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *RingField<uint32_t>(sq_ring_, params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_tail_ = *sq_ktail_;
+  // Submission queue entries are always used in order.
+  uint32_t* sq_array = RingField<uint32_t>(sq_ring_, params.sq_off.array);
+  for (uint32_t i = 0; i < sq_entries_; ++i) {
+    sq_array[i] = i;
+  }
+
+  cq_khead_ = RingField<uint32_t>(cq_ring_, params.cq_off.head);
+  cq_ktail_ = RingField<uint32_t>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *RingField<uint32_t>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = RingField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+  return true;
+}
+
+io_uring_sqe* QuicIoUring::GetSqe() {
+  QUICHE_DCHECK(initialized());
+  if (sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    if (Submit() < 0 ||
+        sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >=
+            sq_entries_) {
+      return nullptr;
+    }
+  }
+  io_uring_sqe* sqe = &sqes_[sq_tail_ & sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  ++sq_tail_;
+  return sqe;
+}
+
+int QuicIoUring::Submit(unsigned wait_nr, QuicTime::Delta timeout) {
+  QUICHE_DCHECK(initialized());
+  __atomic_store_n(sq_ktail_, sq_tail_, __ATOMIC_RELEASE);
+  const unsigned to_submit =
+      sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE);
+
+  // Always getting events runs the completions deferred to this thread.
+  unsigned flags = IORING_ENTER_GETEVENTS;
+  __kernel_timespec ts;
+  io_uring_getevents_arg arg;
+  const void* argp = nullptr;
+  size_t argsz = 0;
+  if (wait_nr > 0 && !timeout.IsInfinite()) {
+    const int64_t timeout_us = std::max<int64_t>(timeout.ToMicroseconds(), 0);
+    ts.tv_sec = timeout_us / kNumMicrosPerSecond;
+    ts.tv_nsec = (timeout_us % kNumMicrosPerSecond) * 1000;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    flags |= IORING_ENTER_EXT_ARG;
+    argp = &arg;
+    argsz = sizeof(arg);
+  }
+  int result = syscall(__NR_io_uring_enter, ring_fd_, to_submit, wait_nr,
+                       flags, argp, argsz);
+  return result < 0 ? -errno : result;
+}
+
+io_uring_cqe* QuicIoUring::PeekCqe(unsigned index) const {
+  const uint32_t head = *cq_khead_;
+  const uint32_t tail = __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE);
+  if (tail - head <= index) {
+    return nullptr;
+  }
+  return &cqes_[(head + index) & cq_mask_];
+}
+
+void QuicIoUring::ConsumeCqes(unsigned count) {
+  __atomic_store_n(cq_khead_, *cq_khead_ + count, __ATOMIC_RELEASE);
+}
+
+bool QuicIoUring::RegisterBufferRing(uint16_t group_id, uint16_t num_buffers,
+                                     size_t buffer_size) {
+  QUICHE_DCHECK(initialized());
+  QUICHE_DCHECK(buf_ring_ == nullptr);
+  QUICHE_DCHECK_EQ(0, num_buffers & (num_buffers - 1));
+  // The ring must be page aligned, the buffers follow it.
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t ring_size =
+      (num_buffers * sizeof(io_uring_buf) + page_size - 1) / page_size *
+      page_size;
+  const size_t mapping_size = ring_size + num_buffers * buffer_size;
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64_t>(mapping);
+  reg.ring_entries = num_buffers;
+  reg.bgid = group_id;
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING,
+              &reg, 1) != 0) {
+    const int error = errno;
+    munmap(mapping, mapping_size);
+    errno = error;
+    return false;
+  }
+
+  buf_ring_ = static_cast<io_uring_buf_ring*>(mapping);
+  buf_ring_size_ = mapping_size;
+  buffers_ = static_cast<char*>(mapping) + ring_size;
+  buffer_size_ = buffer_size;
+  buf_ring_mask_ = num_buffers - 1;
+  buf_ring_tail_ = 0;
+  for (uint16_t i = 0; i < num_buffers; ++i) {
+    RecycleBuffer(i);
+  }
+  CommitBuffers();
+  return true;
+}
+
+void QuicIoUring::RecycleBuffer(uint16_t buffer_id) {
+  // Not through |bufs|, which C++ compilers place at offset 8 because of the
+  // empty struct __DECLARE_FLEX_ARRAY puts before it. Only the fields of the
+  // entry are written, its reserved field aliases the ring tail.
+  io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(buf_ring_) +
+                      (buf_ring_tail_ & buf_ring_mask_);
+  buf->addr = reinterpret_cast<uint64_t>(buffer(buffer_id));
+  buf->len = buffer_size_;
+  buf->bid = buffer_id;
+  ++buf_ring_tail_;
+}
+
+void QuicIoUring::CommitBuffers() {
+  __atomic_store_n(&buf_ring_->tail, buf_ring_tail_, __ATOMIC_RELEASE);
+}
+
+}  // namespace quic
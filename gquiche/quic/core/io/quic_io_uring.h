@@ -0,0 +1,118 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_IO_QUIC_IO_URING_H_
+#define QUICHE_QUIC_CORE_IO_QUIC_IO_URING_H_
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// A minimal io_uring(7) instance, talking to the kernel through the raw
+// system calls so that it does not depend on liburing.
+//
+// The ring is set up with IORING_SETUP_SINGLE_ISSUER and
+// IORING_SETUP_DEFER_TASKRUN: it must only be used by the thread that
+// initialized it, and completions are only posted while that thread waits in
+// Submit(), which is why the users of this class initialize it lazily, on
+// the thread that runs their event loop.
+class QUICHE_NO_EXPORT QuicIoUring {
+ public:
+  // Returns true if the kernel supports what the io_uring based classes use,
+  // which Linux 6.1 and later do: deferred task running, provided buffer
+  // rings, multishot poll and recvmsg, and waiting with a timeout. Probed
+  // once. io_uring may also be disabled by a sysctl or a seccomp filter.
+  static bool IsSupported();
+
+  QuicIoUring();
+  QuicIoUring(const QuicIoUring&) = delete;
+  QuicIoUring& operator=(const QuicIoUring&) = delete;
+  ~QuicIoUring();
+
+  // Sets up a ring with room for |entries| submissions, a power of two, and
+  // |cq_entries| completions, or twice |entries| if 0. The kernel ends
+  // multishot requests when the completion queue is full, so rings carrying
+  // them size it to the completions they expect between two waits.
+  // Returns false, with errno set, on failure.
+  bool Initialize(uint32_t entries, uint32_t cq_entries = 0);
+  bool initialized() const { return ring_fd_ >= 0; }
+  int ring_fd() const { return ring_fd_; }
+
+  // Returns a zeroed submission queue entry, submitting the queued ones
+  // first if the queue is full. Returns nullptr if that fails.
+  io_uring_sqe* GetSqe();
+
+  // Submits the queued entries, runs the deferred completions and waits
+  // until at least |wait_nr| completions are available or |timeout| passed.
+  // An infinite |timeout| waits for |wait_nr| completions. Returns the number
+  // of entries submitted, or -errno; -ETIME if the timeout passed.
+  int Submit(unsigned wait_nr, QuicTime::Delta timeout);
+  int Submit() { return Submit(0, QuicTime::Delta::Zero()); }
+
+  // Returns the |index|th completion not consumed yet, or nullptr if there
+  // are not that many. Completions stay valid until ConsumeCqes().
+  io_uring_cqe* PeekCqe(unsigned index) const;
+  void ConsumeCqes(unsigned count);
+
+  // Registers a ring of |num_buffers| (a power of two) buffers of
+  // |buffer_size| bytes as buffer group |group_id|, and provides all of them.
+  // Returns false, with errno set, on failure.
+  bool RegisterBufferRing(uint16_t group_id, uint16_t num_buffers,
+                          size_t buffer_size);
+  char* buffer(uint16_t buffer_id) const {
+    return buffers_ + buffer_id * buffer_size_;
+  }
+  // Provides a buffer consumed by a completion back to the kernel. Takes
+  // effect at the next CommitBuffers().
+  void RecycleBuffer(uint16_t buffer_id);
+  void CommitBuffers();
+
+ private:
+  // Unmaps the rings and closes the ring, leaving it uninitialized.
+  void Close();
+  // Close()s the ring and returns false, preserving errno.
+  bool CloseAfterError();
+  void Reset();
+
+  int ring_fd_;
+
+  // The mmap(2)ed rings, the submission one possibly shared with the
+  // completion one.
+  void* sq_ring_;
+  size_t sq_ring_size_;
+  void* cq_ring_;
+  size_t cq_ring_size_;
+  io_uring_sqe* sqes_;
+  size_t sqes_size_;
+
+  uint32_t* sq_khead_;
+  uint32_t* sq_ktail_;
+  uint32_t sq_mask_;
+  uint32_t sq_entries_;
+  // Entries handed out by GetSqe(), published to the kernel on Submit().
+  uint32_t sq_tail_;
+
+  uint32_t* cq_khead_;
+  uint32_t* cq_ktail_;
+  uint32_t cq_mask_;
+  io_uring_cqe* cqes_;
+
+  // The provided buffer ring and its buffers, in one mapping.
+  io_uring_buf_ring* buf_ring_;
+  size_t buf_ring_size_;
+  char* buffers_;
+  size_t buffer_size_;
+  uint16_t buf_ring_mask_;
+  uint16_t buf_ring_tail_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_IO_QUIC_IO_URING_H_
@@ -0,0 +1,311 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_io_uring_event_loop.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The submissions queued before the ring is submitted anyway.
+constexpr uint32_t kRingEntries = 256;
+// Every registered socket's multishot poll posts a completion each time it
+// becomes ready, and the kernel ends the polls that find the completion queue
+// full, so it has room for many more completions than submissions.
+constexpr uint32_t kCompletionEntries = 16 * kRingEntries;
+
+// The user data of the requests whose completions are ignored. Registrations
+// never have generation 0.
+constexpr uint64_t kIgnoredUserData = 0;
+
+uint32_t GetPollMask(QuicSocketEventMask event_mask) {
+  return ((event_mask & kSocketEventReadable) ? POLLIN : 0) |
+         ((event_mask & kSocketEventWritable) ? POLLOUT : 0) |
+         ((event_mask & kSocketEventError) ? POLLERR : 0);
+}
+
+QuicSocketEventMask GetEventMask(uint32_t poll_mask) {
+  // A hangup is reported to both readers and writers, which find out about
+  // it from their next read or write.
+  return ((poll_mask & (POLLIN | POLLHUP)) ? kSocketEventReadable : 0) |
+         ((poll_mask & (POLLOUT | POLLHUP)) ? kSocketEventWritable : 0) |
+         ((poll_mask & POLLERR) ? kSocketEventError : 0);
+}
+
+uint64_t GetUserData(QuicUdpSocketFd fd, uint32_t generation) {
+  return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+}
+
+}  // namespace
+
+QuicIoUringEventLoop::QuicIoUringEventLoop(QuicClock* clock,
+                                           QuicTime::Delta tick)
+    : clock_(clock), next_generation_(1), wheel_(clock->Now(), tick) {}
+
+bool QuicIoUringEventLoop::RegisterSocket(QuicUdpSocketFd fd,
+                                          QuicSocketEventMask events,
+                                          QuicSocketEventListener* listener) {
+  auto [it, success] =
+      registrations_.insert({fd, std::make_shared<Registration>()});
+  if (!success) {
+    return false;
+  }
+  Registration& registration = *it->second;
+  registration.events = events;
+  registration.listener = listener;
+  registration.generation = next_generation_++;
+  if (next_generation_ == 0) {
+    next_generation_ = 1;
+  }
+  sockets_to_arm_.push_back(fd);
+  return true;
+}
+
+bool QuicIoUringEventLoop::UnregisterSocket(QuicUdpSocketFd fd) {
+  auto it = registrations_.find(fd);
+  if (it == registrations_.end()) {
+    return false;
+  }
+  const Registration& registration = *it->second;
+  if (registration.armed) {
+    // Submitted with the next wait. The ring keeps a reference to the file
+    // until then, even if |fd| is closed.
+    io_uring_sqe* sqe = ring_.GetSqe();
+    if (sqe != nullptr) {
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->fd = -1;
+      sqe->addr = GetUserData(fd, registration.generation);
+      sqe->user_data = kIgnoredUserData;
+    } else {
+      QUIC_LOG_FIRST_N(ERROR, 10) << "Failed to remove the poll of fd " << fd;
+    }
+  }
+  registrations_.erase(it);
+  return true;
+}
+
+bool QuicIoUringEventLoop::RearmSocket(QuicUdpSocketFd /*fd*/,
+                                       QuicSocketEventMask /*events*/) {
+  QUIC_BUG(quic_io_uring_rearm_called)
+      << "RearmSocket() called on an edge-triggered event loop";
+  return false;
+}
+
+bool QuicIoUringEventLoop::ArtificiallyNotifyEvent(
+    QuicUdpSocketFd fd, QuicSocketEventMask events) {
+  auto it = registrations_.find(fd);
+  if (it == registrations_.end()) {
+    return false;
+  }
+  Registration& registration = *it->second;
+  if (registration.events_to_notify == 0) {
+    sockets_to_notify_.push_back(fd);
+  }
+  registration.events_to_notify |= events;
+  return true;
+}
+
+void QuicIoUringEventLoop::RunEventLoopOnce(QuicTime::Delta default_timeout) {
+  if (!ring_.initialized() &&
+      !ring_.Initialize(kRingEntries, kCompletionEntries)) {
+    QUIC_BUG(quic_io_uring_setup_failed)
+        << "Failed to set up io_uring: " << strerror(errno);
+    return;
+  }
+
+  const QuicTime start_time = clock_->Now();
+  ProcessAlarmsUpTo(start_time);
+
+  ArmPendingSockets();
+  QuicTime::Delta timeout = ComputeTimeout(start_time, default_timeout);
+  ProcessIoEvents(timeout);
+
+  const QuicTime end_time = clock_->Now();
+  ProcessAlarmsUpTo(end_time);
+}
+
+QuicTime::Delta QuicIoUringEventLoop::ComputeTimeout(
+    QuicTime now, QuicTime::Delta default_timeout) const {
+  default_timeout = std::max(default_timeout, QuicTime::Delta::Zero());
+  if (!sockets_to_notify_.empty()) {
+    return QuicTime::Delta::Zero();
+  }
+  const QuicTime next_alarm_time = wheel_.NextExpiration();
+  if (next_alarm_time == QuicTime::Infinite()) {
+    return default_timeout;
+  }
+  const QuicTime end_time = std::min(now + default_timeout, next_alarm_time);
+  return std::max(end_time - now, QuicTime::Delta::Zero());
+}
+
+void QuicIoUringEventLoop::ArmPendingSockets() {
+  size_t armed = 0;
+  for (; armed < sockets_to_arm_.size(); ++armed) {
+    const QuicUdpSocketFd fd = sockets_to_arm_[armed];
+    auto it = registrations_.find(fd);
+    if (it == registrations_.end() || it->second->armed) {
+      continue;
+    }
+    Registration& registration = *it->second;
+    io_uring_sqe* sqe = ring_.GetSqe();
+    if (sqe == nullptr) {
+      // Retried on the next iteration.
+      QUIC_LOG_FIRST_N(ERROR, 10)
+          << "Failed to queue the poll of fd " << fd << ": " << strerror(errno);
+      break;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = GetPollMask(registration.events);
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = GetUserData(fd, registration.generation);
+    registration.armed = true;
+  }
+  sockets_to_arm_.erase(sockets_to_arm_.begin(),
+                        sockets_to_arm_.begin() + armed);
+}
+
+void QuicIoUringEventLoop::ProcessIoEvents(QuicTime::Delta timeout) {
+  // Submits the queued requests, and runs and waits for their completions.
+  int result = ring_.Submit(timeout.IsZero() ? 0 : 1, timeout);
+  if (result < 0 && result != -ETIME && result != -EINTR) {
+    QUIC_LOG_FIRST_N(ERROR, 10)
+        << "io_uring_enter() failed: " << strerror(-result);
+  }
+
+  // Completions of the same socket are merged together, and with its
+  // artificial events.
+  unsigned num_cqes = 0;
+  while (io_uring_cqe* cqe = ring_.PeekCqe(num_cqes)) {
+    ++num_cqes;
+    if (cqe->user_data == kIgnoredUserData) {
+      continue;
+    }
+    const QuicUdpSocketFd fd = static_cast<int32_t>(cqe->user_data);
+    auto it = registrations_.find(fd);
+    if (it == registrations_.end() ||
+        it->second->generation != cqe->user_data >> 32) {
+      // The completion of an unregistered socket's poll.
+      continue;
+    }
+    Registration& registration = *it->second;
+    if (cqe->res < 0) {
+      QUIC_LOG_FIRST_N(ERROR, 10)
+          << "Polling fd " << fd << " failed: " << strerror(-cqe->res);
+      if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        registration.armed = false;
+      }
+      continue;
+    }
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+      // The kernel ended the multishot poll, e.g. on a full completion queue.
+      registration.armed = false;
+      sockets_to_arm_.push_back(fd);
+    }
+    const QuicSocketEventMask events =
+        GetEventMask(cqe->res) & registration.events;
+    if (events == 0) {
+      continue;
+    }
+    if (registration.events_to_notify == 0) {
+      sockets_to_notify_.push_back(fd);
+    }
+    registration.events_to_notify |= events;
+  }
+  ring_.ConsumeCqes(num_cqes);
+
+  if (sockets_to_notify_.empty()) {
+    return;
+  }
+  std::vector<ReadyListEntry> ready_list;
+  ready_list.reserve(sockets_to_notify_.size());
+  for (QuicUdpSocketFd fd : sockets_to_notify_) {
+    auto it = registrations_.find(fd);
+    if (it == registrations_.end()) {
+      continue;
+    }
+    Registration& registration = *it->second;
+    const QuicSocketEventMask events =
+        registration.events_to_notify & registration.events;
+    registration.events_to_notify = 0;
+    if (events != 0) {
+      ready_list.push_back(ReadyListEntry{fd, it->second, events});
+    }
+  }
+  sockets_to_notify_.clear();
+
+  // Actually call all of the callbacks.
+  RunReadyCallbacks(ready_list);
+}
+
+void QuicIoUringEventLoop::RunReadyCallbacks(
+    std::vector<ReadyListEntry>& ready_list) {
+  for (ReadyListEntry& entry : ready_list) {
+    std::shared_ptr<Registration> registration = entry.registration.lock();
+    if (!registration) {
+      // The socket has been unregistered from within one of the callbacks.
+      continue;
+    }
+    registration->listener->OnSocketEvent(this, entry.fd, entry.events);
+  }
+  ready_list.clear();
+}
+
+void QuicIoUringEventLoop::ProcessAlarmsUpTo(QuicTime time) {
+  // Alarms set from the callbacks, even in the past, wait for the next call.
+  // Alarms cancelled or destroyed from the callbacks leave the expired list.
+  wheel_.Advance(time);
+  while (QuicTimerWheel::Entry* entry = wheel_.PopExpired()) {
+    static_cast<Alarm*>(entry)->DoFire();
+  }
+}
+
+QuicAlarm* QuicIoUringEventLoop::AlarmFactory::CreateAlarm(
+    QuicAlarm::Delegate* delegate) {
+  return new Alarm(loop_, QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
+}
+
+QuicArenaScopedPtr<QuicAlarm> QuicIoUringEventLoop::AlarmFactory::CreateAlarm(
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+    QuicConnectionArena* arena) {
+  if (arena != nullptr) {
+    return arena->New<Alarm>(loop_, std::move(delegate));
+  }
+  return QuicArenaScopedPtr<QuicAlarm>(new Alarm(loop_, std::move(delegate)));
+}
+
+QuicIoUringEventLoop::Alarm::Alarm(
+    QuicIoUringEventLoop* loop,
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
+    : QuicAlarm(std::move(delegate)), loop_(loop) {}
+
+void QuicIoUringEventLoop::Alarm::SetImpl() {
+  loop_->wheel_.Schedule(this, deadline());
+}
+
+void QuicIoUringEventLoop::Alarm::CancelImpl() {
+  // Not scheduled anymore if the event loop is gone.
+  if (IsScheduled()) {
+    loop_->wheel_.Cancel(this);
+  }
+}
+
+std::unique_ptr<QuicAlarmFactory> QuicIoUringEventLoop::CreateAlarmFactory() {
+  return std::make_unique<AlarmFactory>(this);
+}
+
+}  // namespace quic
@@ -0,0 +1,165 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_IO_QUIC_IO_URING_EVENT_LOOP_H_
+#define QUICHE_QUIC_CORE_IO_QUIC_IO_URING_EVENT_LOOP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/io/quic_timer_wheel.h"
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_alarm_factory.h"
+#include "gquiche/quic/core/quic_clock.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+
+namespace quic {
+
+// An edge-triggered implementation of QuicEventLoop using io_uring(7).  Each
+// registered socket has a multishot poll request, which posts a completion
+// every time the socket becomes ready, so that, like with epoll(7), an
+// iteration only costs the number of ready sockets and sockets never have to
+// be re-armed.  Arming the polls of the sockets registered during an
+// iteration and waiting for the next events take a single system call.
+//
+// The ring is set up on the first iteration, on the thread running the loop,
+// as QuicIoUring requires.  QuicIoUring::IsSupported() must be true.
+//
+// Alarms are kept in a QuicTimerWheel, so they fire up to |tick| after their
+// deadline, and alarms firing in the same tick run in no particular order.
+class QUICHE_NO_EXPORT QuicIoUringEventLoop : public QuicEventLoop {
+ public:
+  static constexpr QuicTime::Delta kDefaultTick =
+      QuicTime::Delta::FromMicroseconds(100);
+
+  QuicIoUringEventLoop(QuicClock* clock, QuicTime::Delta tick);
+  QuicIoUringEventLoop(const QuicIoUringEventLoop&) = delete;
+  QuicIoUringEventLoop& operator=(const QuicIoUringEventLoop&) = delete;
+
+  // QuicEventLoop implementation.
+  bool SupportsEdgeTriggered() const override { return true; }
+  ABSL_MUST_USE_RESULT bool RegisterSocket(
+      QuicUdpSocketFd fd, QuicSocketEventMask events,
+      QuicSocketEventListener* listener) override;
+  ABSL_MUST_USE_RESULT bool UnregisterSocket(QuicUdpSocketFd fd) override;
+  ABSL_MUST_USE_RESULT bool RearmSocket(QuicUdpSocketFd fd,
+                                        QuicSocketEventMask events) override;
+  ABSL_MUST_USE_RESULT bool ArtificiallyNotifyEvent(
+      QuicUdpSocketFd fd, QuicSocketEventMask events) override;
+  void RunEventLoopOnce(QuicTime::Delta default_timeout) override;
+  std::unique_ptr<QuicAlarmFactory> CreateAlarmFactory() override;
+  const QuicClock* GetClock() override { return clock_; }
+
+ private:
+  struct Registration {
+    QuicSocketEventMask events = 0;
+    QuicSocketEventListener* listener;
+    // Distinguishes the completions of this registration from those of an
+    // earlier one of the same file descriptor.
+    uint32_t generation = 0;
+    // Whether the poll request of the registration is in the ring.
+    bool armed = false;
+
+    // The events of the completions and artificial events of the iteration.
+    QuicSocketEventMask events_to_notify = 0;
+  };
+
+  class Alarm : public QuicAlarm, public QuicTimerWheel::Entry {
+   public:
+    Alarm(QuicIoUringEventLoop* loop,
+          QuicArenaScopedPtr<QuicAlarm::Delegate> delegate);
+
+    void SetImpl() override;
+    void CancelImpl() override;
+
+    void DoFire() { Fire(); }
+
+   private:
+    QuicIoUringEventLoop* loop_;
+  };
+
+  class AlarmFactory : public QuicAlarmFactory {
+   public:
+    AlarmFactory(QuicIoUringEventLoop* loop) : loop_(loop) {}
+
+    // QuicAlarmFactory implementation.
+    QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override;
+    QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+        QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+        QuicConnectionArena* arena) override;
+
+   private:
+    QuicIoUringEventLoop* loop_;
+  };
+
+  // Used for deferred execution of I/O callbacks.
+  struct ReadyListEntry {
+    QuicUdpSocketFd fd;
+    std::weak_ptr<Registration> registration;
+    QuicSocketEventMask events;
+  };
+
+  using RegistrationMap =
+      absl::flat_hash_map<QuicUdpSocketFd, std::shared_ptr<Registration>>;
+
+  // Returns the timeout for the next wait, typically the time at which the
+  // next alarm is supposed to activate.
+  QuicTime::Delta ComputeTimeout(QuicTime now,
+                                 QuicTime::Delta default_timeout) const;
+  // Queues the poll requests of the sockets registered since the last wait.
+  void ArmPendingSockets();
+  // Waits for I/O events for at most |timeout| and dispatches the callbacks
+  // accordingly.
+  void ProcessIoEvents(QuicTime::Delta timeout);
+  // Calls all of the alarm callbacks that are scheduled before or at |time|.
+  void ProcessAlarmsUpTo(QuicTime time);
+  // Runs all of the callbacks on the ready list.
+  void RunReadyCallbacks(std::vector<ReadyListEntry>& ready_list);
+
+  const QuicClock* clock_;
+  QuicIoUring ring_;
+  RegistrationMap registrations_;
+  uint32_t next_generation_;
+  // The file descriptors whose poll request has to be queued, some possibly
+  // unregistered since.
+  std::vector<QuicUdpSocketFd> sockets_to_arm_;
+  // The file descriptors with events to notify, some possibly unregistered
+  // since.
+  std::vector<QuicUdpSocketFd> sockets_to_notify_;
+  QuicTimerWheel wheel_;
+};
+
+class QUICHE_NO_EXPORT QuicIoUringEventLoopFactory
+    : public QuicEventLoopFactory {
+ public:
+  // Returns the factory of event loops with the default tick.
+  static QuicIoUringEventLoopFactory* Get() {
+    static QuicIoUringEventLoopFactory* factory =
+        new QuicIoUringEventLoopFactory(QuicIoUringEventLoop::kDefaultTick);
+    return factory;
+  }
+
+  explicit QuicIoUringEventLoopFactory(QuicTime::Delta tick) : tick_(tick) {}
+
+  std::unique_ptr<QuicEventLoop> Create(QuicClock* clock) override {
+    return std::make_unique<QuicIoUringEventLoop>(clock, tick_);
+  }
+
+  std::string GetName() const override {
+    return "io_uring(7), " + tick_.ToDebuggingValue() + " tick";
+  }
+
+ private:
+  const QuicTime::Delta tick_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_IO_QUIC_IO_URING_EVENT_LOOP_H_
@@ -94,10 +94,11 @@ QuicTime::Delta QuicPollEventLoop::ComputePollTimeout(
   if (has_artificial_events_pending_) {
     return QuicTime::Delta::Zero();
   }
-  if (alarms_.empty()) {
+  const QuicTime next_alarm_time = GetNextAlarmTime();
+  if (next_alarm_time == QuicTime::Infinite()) {
     return default_timeout;
   }
-  QuicTime end_time = std::min(now + default_timeout, alarms_.begin()->first);
+  QuicTime end_time = std::min(now + default_timeout, next_alarm_time);
   if (end_time < now) {
     // Since we call ProcessAlarmsUpTo() right before this, this should never
     // happen.
@@ -205,6 +206,10 @@ void QuicPollEventLoop::RunReadyCallbacks(
   ready_list.clear();
 }
 
+QuicTime QuicPollEventLoop::GetNextAlarmTime() const {
+  return alarms_.empty() ? QuicTime::Infinite() : alarms_.begin()->first;
+}
+
 void QuicPollEventLoop::ProcessAlarmsUpTo(QuicTime time) {
   // Determine which alarm callbacks needs to be run.
   std::vector<std::weak_ptr<Alarm*>> alarms_to_call;
@@ -59,6 +59,13 @@ class QUICHE_NO_EXPORT QuicPollEventLoop : public QuicEventLoop {
     return ::poll(fds, nfds, timeout);
   }
 
+  // Alarm storage, which subclasses can replace along with
+  // CreateAlarmFactory().  Returns the time by which the next poll(2) call
+  // has to return for the alarms, or QuicTime::Infinite() if there is none.
+  virtual QuicTime GetNextAlarmTime() const;
+  // Calls all of the alarm callbacks that are scheduled before or at |time|.
+  virtual void ProcessAlarmsUpTo(QuicTime time);
+
  private:
   friend class QuicPollEventLoopPeer;
 
@@ -127,8 +134,6 @@ class QUICHE_NO_EXPORT QuicPollEventLoop : public QuicEventLoop {
   // Calls poll(2) with the provided timeout and dispatches the callbacks
   // accordingly.
   void ProcessIoEvents(QuicTime start_time, QuicTime::Delta timeout);
-  // Calls all of the alarm callbacks that are scheduled before or at |time|.
-  void ProcessAlarmsUpTo(QuicTime time);
 
   // Adds the I/O callbacks for |fd| to the |ready_lits| as appopriate.
   void DispatchIoEvent(std::vector<ReadyListEntry>& ready_list,
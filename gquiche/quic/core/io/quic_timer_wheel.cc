@@ -0,0 +1,275 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_timer_wheel.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "absl/numeric/bits.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+constexpr uint64_t kNoTick = std::numeric_limits<uint64_t>::max();
+constexpr int kTotalBits =
+    QuicTimerWheel::kBitsPerLevel * QuicTimerWheel::kNumLevels;
+
+// Returns the index of the first set bit of |words| after |index|, or -1.
+int NextSetBit(const uint64_t* words, size_t num_words, size_t index) {
+  size_t from = index + 1;
+  for (size_t word = from / 64; word < num_words; ++word) {
+    uint64_t bits = words[word];
+    if (word == from / 64) {
+      bits &= ~uint64_t{0} << (from % 64);
+    }
+    if (bits != 0) {
+      return static_cast<int>(word * 64 + absl::countr_zero(bits));
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+QuicTimerWheel::Entry::~Entry() {
+  if (wheel_ != nullptr) {
+    wheel_->Cancel(this);
+  }
+}
+
+QuicTimerWheel::QuicTimerWheel(QuicTime now, QuicTime::Delta granularity)
+    : granularity_(granularity), current_tick_(0), now_(now) {
+  QUICHE_DCHECK_GT(granularity_, QuicTime::Delta::Zero());
+  const int64_t now_us = (now - QuicTime::Zero()).ToMicroseconds();
+  if (now_us > 0) {
+    current_tick_ = now_us / granularity_.ToMicroseconds();
+  }
+}
+
+QuicTimerWheel::~QuicTimerWheel() {
+  auto clear = [](List* list) {
+    for (Entry* entry = list->head.next_; entry != &list->head;) {
+      Entry* next = entry->next_;
+      entry->prev_ = entry->next_ = nullptr;
+      entry->wheel_ = nullptr;
+      entry = next;
+    }
+    list->head.prev_ = list->head.next_ = &list->head;
+  };
+  for (auto& level : slots_) {
+    for (List& slot : level) {
+      clear(&slot);
+    }
+  }
+  clear(&overflow_);
+  clear(&due_);
+  clear(&expired_);
+}
+
+void QuicTimerWheel::Schedule(Entry* entry, QuicTime deadline) {
+  if (entry->wheel_ != nullptr) {
+    entry->wheel_->Cancel(entry);
+  }
+  entry->wheel_ = this;
+  entry->tick_ = TimeToTick(deadline);
+  ++size_;
+  Place(entry);
+}
+
+void QuicTimerWheel::Cancel(Entry* entry) {
+  if (entry->wheel_ == nullptr) {
+    return;
+  }
+  QUICHE_DCHECK_EQ(this, entry->wheel_);
+  Unlink(entry);
+  entry->wheel_ = nullptr;
+  --size_;
+}
+
+void QuicTimerWheel::Advance(QuicTime now) {
+  now_ = now;
+  SpliceToExpired(&due_);
+  const int64_t now_us = (now - QuicTime::Zero()).ToMicroseconds();
+  const uint64_t target =
+      now_us > 0 ? now_us / granularity_.ToMicroseconds() : 0;
+  if (target <= current_tick_) {
+    return;
+  }
+  for (uint64_t tick = NextEventTick(); tick <= target;
+       tick = NextEventTick()) {
+    AdvanceTo(tick);
+  }
+  current_tick_ = target;
+}
+
+QuicTimerWheel::Entry* QuicTimerWheel::PopExpired() {
+  if (expired_.empty()) {
+    return nullptr;
+  }
+  Entry* entry = expired_.head.next_;
+  Cancel(entry);
+  return entry;
+}
+
+QuicTime QuicTimerWheel::NextExpiration() const {
+  if (!due_.empty() || !expired_.empty()) {
+    return now_;
+  }
+  const uint64_t tick = NextEventTick();
+  if (tick == kNoTick) {
+    return QuicTime::Infinite();
+  }
+  return TickToTime(tick);
+}
+
+QuicTimerWheel::List* QuicTimerWheel::ListFor(int16_t list) {
+  switch (list) {
+    case kOverflowList:
+      return &overflow_;
+    case kDueList:
+      return &due_;
+    case kExpiredList:
+      return &expired_;
+    default:
+      return &slots_[list / kSlotsPerLevel][list % kSlotsPerLevel];
+  }
+}
+
+void QuicTimerWheel::Place(Entry* entry) {
+  if (entry->tick_ <= current_tick_) {
+    Link(entry, kDueList);
+    return;
+  }
+  // The entry goes to the lowest level whose block it shares with the
+  // current tick, in the slot of its digit at that level.
+  const uint64_t diff = entry->tick_ ^ current_tick_;
+  int level = 0;
+  while (level < kNumLevels && (diff >> (kBitsPerLevel * (level + 1))) != 0) {
+    ++level;
+  }
+  if (level == kNumLevels) {
+    Link(entry, kOverflowList);
+    return;
+  }
+  const size_t slot =
+      (entry->tick_ >> (kBitsPerLevel * level)) & (kSlotsPerLevel - 1);
+  Link(entry, static_cast<int16_t>(level * kSlotsPerLevel + slot));
+}
+
+void QuicTimerWheel::Link(Entry* entry, int16_t list) {
+  List* target = ListFor(list);
+  entry->list_ = list;
+  entry->prev_ = target->head.prev_;
+  entry->next_ = &target->head;
+  target->head.prev_->next_ = entry;
+  target->head.prev_ = entry;
+  if (list >= 0) {
+    occupied_[list / kSlotsPerLevel][(list % kSlotsPerLevel) / 64] |=
+        uint64_t{1} << (list % 64);
+  }
+}
+
+void QuicTimerWheel::Unlink(Entry* entry) {
+  entry->prev_->next_ = entry->next_;
+  entry->next_->prev_ = entry->prev_;
+  entry->prev_ = entry->next_ = nullptr;
+  const int16_t list = entry->list_;
+  if (list >= 0 && ListFor(list)->empty()) {
+    occupied_[list / kSlotsPerLevel][(list % kSlotsPerLevel) / 64] &=
+        ~(uint64_t{1} << (list % 64));
+  }
+}
+
+void QuicTimerWheel::SpliceToExpired(List* from) {
+  while (!from->empty()) {
+    Entry* entry = from->head.next_;
+    Unlink(entry);
+    Link(entry, kExpiredList);
+  }
+}
+
+void QuicTimerWheel::Cascade(List* from) {
+  while (!from->empty()) {
+    Entry* entry = from->head.next_;
+    Unlink(entry);
+    Place(entry);
+  }
+}
+
+uint64_t QuicTimerWheel::NextEventTick() const {
+  // Lower levels hold earlier ticks, so the first level with an occupied
+  // slot ahead of the current tick has the answer.
+  for (int level = 0; level < kNumLevels; ++level) {
+    const int shift = kBitsPerLevel * level;
+    const size_t index = (current_tick_ >> shift) & (kSlotsPerLevel - 1);
+    const int slot =
+        NextSetBit(occupied_[level], kSlotsPerLevel / 64, index);
+    if (slot >= 0) {
+      const int block_shift = shift + kBitsPerLevel;
+      return ((current_tick_ >> block_shift) << block_shift) |
+             (static_cast<uint64_t>(slot) << shift);
+    }
+  }
+  if (!overflow_.empty()) {
+    return ((current_tick_ >> kTotalBits) + 1) << kTotalBits;
+  }
+  return kNoTick;
+}
+
+void QuicTimerWheel::AdvanceTo(uint64_t tick) {
+  QUICHE_DCHECK_GT(tick, current_tick_);
+  current_tick_ = tick;
+  if ((tick & ((uint64_t{1} << kTotalBits) - 1)) == 0 && !overflow_.empty()) {
+    // Detach the overflow list first, as entries still too far away go back
+    // to it.
+    List overflow;
+    overflow.head.next_ = overflow_.head.next_;
+    overflow.head.prev_ = overflow_.head.prev_;
+    overflow.head.next_->prev_ = &overflow.head;
+    overflow.head.prev_->next_ = &overflow.head;
+    overflow_.head.prev_ = overflow_.head.next_ = &overflow_.head;
+    Cascade(&overflow);
+  }
+  // Higher levels first, as their entries can land in a lower level slot
+  // that starts at the same tick.
+  for (int level = kNumLevels - 1; level > 0; --level) {
+    const int shift = kBitsPerLevel * level;
+    if ((tick & ((uint64_t{1} << shift) - 1)) != 0) {
+      continue;
+    }
+    Cascade(&slots_[level][(tick >> shift) & (kSlotsPerLevel - 1)]);
+  }
+  SpliceToExpired(&slots_[0][tick & (kSlotsPerLevel - 1)]);
+  SpliceToExpired(&due_);
+}
+
+uint64_t QuicTimerWheel::TimeToTick(QuicTime time) const {
+  if (time >= QuicTime::Infinite()) {
+    return kNoTick;
+  }
+  const int64_t time_us = (time - QuicTime::Zero()).ToMicroseconds();
+  if (time_us <= 0) {
+    return 0;
+  }
+  // Rounded up, so that entries never expire before their deadline.
+  const uint64_t granularity_us = granularity_.ToMicroseconds();
+  return (static_cast<uint64_t>(time_us) + granularity_us - 1) /
+         granularity_us;
+}
+
+QuicTime QuicTimerWheel::TickToTime(uint64_t tick) const {
+  const uint64_t granularity_us = granularity_.ToMicroseconds();
+  if (tick >= static_cast<uint64_t>(QuicTime::Infinite().ToDebuggingValue()) /
+                  granularity_us) {
+    return QuicTime::Infinite();
+  }
+  return QuicTime::Zero() +
+         QuicTime::Delta::FromMicroseconds(tick * granularity_us);
+}
+
+}  // namespace quic
@@ -0,0 +1,143 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_H_
+#define QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// A hierarchical timing wheel. Deadlines are rounded up to ticks of a fixed
+// granularity and kept in kNumLevels wheels of kSlotsPerLevel slots each,
+// level k holding the entries due in a later slot of the current
+// kSlotsPerLevel^(k+1)-tick block. When the current tick reaches a slot of a
+// higher level, its entries are redistributed to the lower levels.
+//
+// Schedule() and Cancel() are O(1). Advance() is proportional to the number
+// of entries that expire or move down a level, plus the number of non-empty
+// slots it crosses, regardless of how many ticks it covers.
+//
+// Entries are intrusive: the wheel never allocates, and an entry destroyed
+// while scheduled removes itself. Entries expire no earlier than their
+// deadline and at most one tick later; entries expiring in the same tick
+// come out in no particular order.
+class QUIC_EXPORT_PRIVATE QuicTimerWheel {
+ public:
+  static constexpr int kBitsPerLevel = 8;
+  static constexpr size_t kSlotsPerLevel = 1u << kBitsPerLevel;
+  // 2^32 ticks, about 49 days with a 1ms granularity. Entries further away
+  // wait in an overflow list that is redistributed once per top level
+  // rotation.
+  static constexpr int kNumLevels = 4;
+
+  class QUIC_EXPORT_PRIVATE Entry {
+   public:
+    Entry() = default;
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+    ~Entry();
+
+    bool IsScheduled() const { return wheel_ != nullptr; }
+
+   private:
+    friend class QuicTimerWheel;
+
+    Entry* prev_ = nullptr;
+    Entry* next_ = nullptr;
+    QuicTimerWheel* wheel_ = nullptr;
+    uint64_t tick_ = 0;
+    // The list the entry is linked in, see QuicTimerWheel::ListFor().
+    int16_t list_ = 0;
+  };
+
+  // |now| is the time the wheel starts at.
+  QuicTimerWheel(QuicTime now, QuicTime::Delta granularity);
+  QuicTimerWheel(const QuicTimerWheel&) = delete;
+  QuicTimerWheel& operator=(const QuicTimerWheel&) = delete;
+  // Unschedules all the entries.
+  ~QuicTimerWheel();
+
+  // Schedules |entry| to expire at |deadline|, rescheduling it if it already
+  // is. Entries whose deadline is not after the current tick expire on the
+  // next call to Advance().
+  void Schedule(Entry* entry, QuicTime deadline);
+  // Unschedules |entry|, including if it expired but was not popped yet.
+  // No-op if it is not scheduled.
+  void Cancel(Entry* entry);
+
+  // Moves the current tick to |now| and queues the entries that expired, for
+  // PopExpired() to return.
+  void Advance(QuicTime now);
+  // Returns and unschedules the next expired entry, or nullptr if there is
+  // none left.
+  Entry* PopExpired();
+
+  // Returns a time at or before which an entry can expire: the end of the
+  // earliest slot holding an entry, which for higher levels is before the
+  // entry's own deadline. QuicTime::Infinite() if the wheel is empty.
+  QuicTime NextExpiration() const;
+
+  // The number of scheduled entries, including those expired not popped.
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  QuicTime::Delta granularity() const { return granularity_; }
+
+ private:
+  // Sentinels of the circular doubly linked lists.
+  struct List {
+    List() { head.prev_ = head.next_ = &head; }
+    bool empty() const { return head.next_ == &head; }
+    Entry head;
+  };
+
+  // Ids of the lists that are not wheel slots. Slots are numbered
+  // level * kSlotsPerLevel + slot.
+  static constexpr int16_t kOverflowList = -1;
+  // Entries due at or before the current tick, scheduled since the last
+  // Advance().
+  static constexpr int16_t kDueList = -2;
+  static constexpr int16_t kExpiredList = -3;
+
+  List* ListFor(int16_t list);
+  // Links |entry| in the list its tick belongs to given the current tick.
+  void Place(Entry* entry);
+  void Link(Entry* entry, int16_t list);
+  void Unlink(Entry* entry);
+  // Moves all of |from| to the end of the expired list.
+  void SpliceToExpired(List* from);
+  // Redistributes the entries of |from|.
+  void Cascade(List* from);
+
+  // Returns the next tick at which a slot holding entries is reached, or
+  // UINT64_MAX if there is none.
+  uint64_t NextEventTick() const;
+  // Moves the current tick to |tick|, which must not skip any non-empty
+  // slot, redistributing and expiring the slots it reaches.
+  void AdvanceTo(uint64_t tick);
+
+  uint64_t TimeToTick(QuicTime time) const;
+  QuicTime TickToTime(uint64_t tick) const;
+
+  const QuicTime::Delta granularity_;
+  uint64_t current_tick_;
+  // The time passed to the last Advance().
+  QuicTime now_;
+  size_t size_ = 0;
+
+  List slots_[kNumLevels][kSlotsPerLevel];
+  // One bit per non-empty slot.
+  uint64_t occupied_[kNumLevels][kSlotsPerLevel / 64] = {};
+  List overflow_;
+  List due_;
+  List expired_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_H_
@@ -0,0 +1,69 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_timer_wheel_event_loop.h"
+
+#include <memory>
+#include <utility>
+
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_time.h"
+
+namespace quic {
+
+QuicTimerWheelEventLoop::QuicTimerWheelEventLoop(QuicClock* clock,
+                                                 QuicTime::Delta tick)
+    : QuicPollEventLoop(clock), wheel_(clock->Now(), tick) {}
+
+QuicTime QuicTimerWheelEventLoop::GetNextAlarmTime() const {
+  return wheel_.NextExpiration();
+}
+
+void QuicTimerWheelEventLoop::ProcessAlarmsUpTo(QuicTime time) {
+  // Alarms set from the callbacks, even in the past, wait for the next call,
+  // like they do in QuicPollEventLoop.  Alarms cancelled or destroyed from
+  // the callbacks leave the expired list.
+  wheel_.Advance(time);
+  while (QuicTimerWheel::Entry* entry = wheel_.PopExpired()) {
+    static_cast<Alarm*>(entry)->DoFire();
+  }
+}
+
+QuicAlarm* QuicTimerWheelEventLoop::AlarmFactory::CreateAlarm(
+    QuicAlarm::Delegate* delegate) {
+  return new Alarm(loop_, QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
+}
+
+QuicArenaScopedPtr<QuicAlarm>
+QuicTimerWheelEventLoop::AlarmFactory::CreateAlarm(
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+    QuicConnectionArena* arena) {
+  if (arena != nullptr) {
+    return arena->New<Alarm>(loop_, std::move(delegate));
+  }
+  return QuicArenaScopedPtr<QuicAlarm>(new Alarm(loop_, std::move(delegate)));
+}
+
+QuicTimerWheelEventLoop::Alarm::Alarm(
+    QuicTimerWheelEventLoop* loop,
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate)
+    : QuicAlarm(std::move(delegate)), loop_(loop) {}
+
+void QuicTimerWheelEventLoop::Alarm::SetImpl() {
+  loop_->wheel_.Schedule(this, deadline());
+}
+
+void QuicTimerWheelEventLoop::Alarm::CancelImpl() {
+  // Not scheduled anymore if the event loop is gone.
+  if (IsScheduled()) {
+    loop_->wheel_.Cancel(this);
+  }
+}
+
+std::unique_ptr<QuicAlarmFactory>
+QuicTimerWheelEventLoop::CreateAlarmFactory() {
+  return std::make_unique<AlarmFactory>(this);
+}
+
+}  // namespace quic
@@ -0,0 +1,101 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_EVENT_LOOP_H_
+#define QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_EVENT_LOOP_H_
+
+#include <memory>
+#include <string>
+
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/io/quic_poll_event_loop.h"
+#include "gquiche/quic/core/io/quic_timer_wheel.h"
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_alarm_factory.h"
+#include "gquiche/quic/core/quic_clock.h"
+#include "gquiche/quic/core/quic_time.h"
+
+namespace quic {
+
+// A QuicPollEventLoop whose alarms are kept in a QuicTimerWheel instead of a
+// btree.  Setting and cancelling an alarm is O(1) and does not allocate,
+// which matters with many connections that each reschedule several alarms
+// per packet.  In exchange, alarms fire up to |tick| after their deadline,
+// and alarms firing in the same tick run in no particular order.
+class QUICHE_NO_EXPORT QuicTimerWheelEventLoop : public QuicPollEventLoop {
+ public:
+  static constexpr QuicTime::Delta kDefaultTick =
+      QuicTime::Delta::FromMilliseconds(1);
+
+  QuicTimerWheelEventLoop(QuicClock* clock, QuicTime::Delta tick);
+
+  // QuicEventLoop implementation.
+  std::unique_ptr<QuicAlarmFactory> CreateAlarmFactory() override;
+
+ protected:
+  // QuicPollEventLoop implementation.
+  QuicTime GetNextAlarmTime() const override;
+  void ProcessAlarmsUpTo(QuicTime time) override;
+
+ private:
+  class Alarm : public QuicAlarm, public QuicTimerWheel::Entry {
+   public:
+    Alarm(QuicTimerWheelEventLoop* loop,
+          QuicArenaScopedPtr<QuicAlarm::Delegate> delegate);
+
+    void SetImpl() override;
+    void CancelImpl() override;
+
+    void DoFire() { Fire(); }
+
+   private:
+    QuicTimerWheelEventLoop* loop_;
+  };
+
+  class AlarmFactory : public QuicAlarmFactory {
+   public:
+    AlarmFactory(QuicTimerWheelEventLoop* loop) : loop_(loop) {}
+
+    // QuicAlarmFactory implementation.
+    QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override;
+    QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+        QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+        QuicConnectionArena* arena) override;
+
+   private:
+    QuicTimerWheelEventLoop* loop_;
+  };
+
+  QuicTimerWheel wheel_;
+};
+
+class QUICHE_NO_EXPORT QuicTimerWheelEventLoopFactory
+    : public QuicEventLoopFactory {
+ public:
+  // Returns the factory of event loops with the default tick.
+  static QuicTimerWheelEventLoopFactory* Get() {
+    static QuicTimerWheelEventLoopFactory* factory =
+        new QuicTimerWheelEventLoopFactory(
+            QuicTimerWheelEventLoop::kDefaultTick);
+    return factory;
+  }
+
+  explicit QuicTimerWheelEventLoopFactory(QuicTime::Delta tick)
+      : tick_(tick) {}
+
+  std::unique_ptr<QuicEventLoop> Create(QuicClock* clock) override {
+    return std::make_unique<QuicTimerWheelEventLoop>(clock, tick_);
+  }
+
+  std::string GetName() const override {
+    return "poll(2) with timer wheel, " + tick_.ToDebuggingValue() + " tick";
+  }
+
+ private:
+  const QuicTime::Delta tick_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_IO_QUIC_TIMER_WHEEL_EVENT_LOOP_H_
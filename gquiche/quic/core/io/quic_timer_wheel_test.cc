@@ -0,0 +1,196 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/io/quic_timer_wheel.h"
+
+#include <memory>
+#include <vector>
+
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic::test {
+namespace {
+
+using testing::ElementsAre;
+using testing::UnorderedElementsAre;
+
+constexpr QuicTime::Delta kTick = QuicTime::Delta::FromMilliseconds(1);
+
+struct TestEntry : public QuicTimerWheel::Entry {
+  explicit TestEntry(int id) : id(id) {}
+  int id;
+};
+
+class QuicTimerWheelTest : public QuicTest {
+ protected:
+  QuicTimerWheelTest()
+      : start_(QuicTime::Zero() + QuicTime::Delta::FromSeconds(1000)),
+        wheel_(start_, kTick) {}
+
+  QuicTime At(int64_t ms) const {
+    return start_ + QuicTime::Delta::FromMilliseconds(ms);
+  }
+
+  std::vector<int> AdvanceTo(QuicTime now) {
+    std::vector<int> expired;
+    wheel_.Advance(now);
+    while (QuicTimerWheel::Entry* entry = wheel_.PopExpired()) {
+      expired.push_back(static_cast<TestEntry*>(entry)->id);
+    }
+    return expired;
+  }
+
+  const QuicTime start_;
+  QuicTimerWheel wheel_;
+};
+
+TEST_F(QuicTimerWheelTest, Empty) {
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_EQ(QuicTime::Infinite(), wheel_.NextExpiration());
+  EXPECT_TRUE(AdvanceTo(At(100000)).empty());
+}
+
+TEST_F(QuicTimerWheelTest, ExpiresAtDeadline) {
+  TestEntry entry(1);
+  wheel_.Schedule(&entry, At(5));
+  EXPECT_TRUE(entry.IsScheduled());
+  EXPECT_EQ(1u, wheel_.size());
+  EXPECT_EQ(At(5), wheel_.NextExpiration());
+
+  EXPECT_TRUE(AdvanceTo(At(4)).empty());
+  EXPECT_THAT(AdvanceTo(At(5)), ElementsAre(1));
+  EXPECT_FALSE(entry.IsScheduled());
+  EXPECT_TRUE(wheel_.empty());
+}
+
+TEST_F(QuicTimerWheelTest, DeadlineRoundedUpToTick) {
+  TestEntry entry(1);
+  wheel_.Schedule(&entry, At(5) + QuicTime::Delta::FromMicroseconds(1));
+  EXPECT_EQ(At(6), wheel_.NextExpiration());
+  EXPECT_TRUE(AdvanceTo(At(5) + QuicTime::Delta::FromMicroseconds(999))
+                  .empty());
+  EXPECT_THAT(AdvanceTo(At(6)), ElementsAre(1));
+}
+
+TEST_F(QuicTimerWheelTest, DeadlineInPast) {
+  TestEntry entry1(1);
+  TestEntry entry2(2);
+  wheel_.Schedule(&entry1, At(-10));
+  wheel_.Schedule(&entry2, At(0));
+  EXPECT_EQ(start_, wheel_.NextExpiration());
+  EXPECT_THAT(AdvanceTo(start_), ElementsAre(1, 2));
+}
+
+TEST_F(QuicTimerWheelTest, Cancel) {
+  TestEntry entry1(1);
+  TestEntry entry2(2);
+  wheel_.Schedule(&entry1, At(5));
+  wheel_.Schedule(&entry2, At(5));
+  wheel_.Cancel(&entry1);
+  EXPECT_FALSE(entry1.IsScheduled());
+  EXPECT_EQ(1u, wheel_.size());
+  EXPECT_THAT(AdvanceTo(At(10)), ElementsAre(2));
+
+  // Cancelling an entry that is not scheduled is a no-op.
+  wheel_.Cancel(&entry1);
+  EXPECT_TRUE(wheel_.empty());
+}
+
+TEST_F(QuicTimerWheelTest, Reschedule) {
+  TestEntry entry(1);
+  wheel_.Schedule(&entry, At(5));
+  wheel_.Schedule(&entry, At(500));
+  EXPECT_EQ(1u, wheel_.size());
+  EXPECT_TRUE(AdvanceTo(At(499)).empty());
+  EXPECT_THAT(AdvanceTo(At(500)), ElementsAre(1));
+}
+
+TEST_F(QuicTimerWheelTest, CancelExpiredBeforePop) {
+  TestEntry entry1(1);
+  TestEntry entry2(2);
+  wheel_.Schedule(&entry1, At(5));
+  wheel_.Schedule(&entry2, At(5));
+  wheel_.Advance(At(5));
+  QuicTimerWheel::Entry* first = wheel_.PopExpired();
+  ASSERT_NE(nullptr, first);
+  // The first one to run cancels the other.
+  wheel_.Cancel(first == &entry1 ? &entry2 : &entry1);
+  EXPECT_EQ(nullptr, wheel_.PopExpired());
+}
+
+TEST_F(QuicTimerWheelTest, DestroyedWhileScheduled) {
+  auto entry = std::make_unique<TestEntry>(1);
+  wheel_.Schedule(entry.get(), At(5));
+  entry.reset();
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_TRUE(AdvanceTo(At(10)).empty());
+}
+
+TEST_F(QuicTimerWheelTest, OutlivedByEntry) {
+  TestEntry entry(1);
+  {
+    QuicTimerWheel wheel(start_, kTick);
+    wheel.Schedule(&entry, At(5));
+  }
+  EXPECT_FALSE(entry.IsScheduled());
+}
+
+TEST_F(QuicTimerWheelTest, HigherLevels) {
+  // One entry per level, and one past the last level.
+  TestEntry entry1(1);
+  TestEntry entry2(2);
+  TestEntry entry3(3);
+  TestEntry entry4(4);
+  TestEntry entry5(5);
+  wheel_.Schedule(&entry1, At(100));
+  wheel_.Schedule(&entry2, At(10000));
+  wheel_.Schedule(&entry3, At(1000000));
+  wheel_.Schedule(&entry4, At(100000000));
+  wheel_.Schedule(&entry5, At(10000000000));
+
+  EXPECT_LE(wheel_.NextExpiration(), At(100));
+  EXPECT_TRUE(AdvanceTo(At(99)).empty());
+  EXPECT_THAT(AdvanceTo(At(100)), ElementsAre(1));
+  // Higher levels are reported no later than their entries expire.
+  EXPECT_LE(wheel_.NextExpiration(), At(10000));
+  EXPECT_TRUE(AdvanceTo(At(9999)).empty());
+  EXPECT_THAT(AdvanceTo(At(10000)), ElementsAre(2));
+  EXPECT_TRUE(AdvanceTo(At(999999)).empty());
+  EXPECT_THAT(AdvanceTo(At(1000000)), ElementsAre(3));
+  EXPECT_TRUE(AdvanceTo(At(99999999)).empty());
+  EXPECT_THAT(AdvanceTo(At(100000000)), ElementsAre(4));
+  EXPECT_TRUE(AdvanceTo(At(9999999999)).empty());
+  EXPECT_THAT(AdvanceTo(At(10000000000)), ElementsAre(5));
+  EXPECT_EQ(QuicTime::Infinite(), wheel_.NextExpiration());
+}
+
+TEST_F(QuicTimerWheelTest, ManyEntriesInOneAdvance) {
+  std::vector<std::unique_ptr<TestEntry>> entries;
+  for (int i = 0; i < 1000; ++i) {
+    entries.push_back(std::make_unique<TestEntry>(i));
+    wheel_.Schedule(entries.back().get(), At(i * 37));
+  }
+  std::vector<int> expired = AdvanceTo(At(999 * 37));
+  ASSERT_EQ(1000u, expired.size());
+  // Slots expire in tick order.
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, expired[i]);
+  }
+  EXPECT_TRUE(wheel_.empty());
+}
+
+TEST_F(QuicTimerWheelTest, SameTick) {
+  TestEntry entry1(1);
+  TestEntry entry2(2);
+  TestEntry entry3(3);
+  wheel_.Schedule(&entry1, At(300));
+  wheel_.Schedule(&entry2, At(300) - QuicTime::Delta::FromMicroseconds(500));
+  wheel_.Schedule(&entry3, At(301));
+  EXPECT_THAT(AdvanceTo(At(300)), UnorderedElementsAre(1, 2));
+  EXPECT_THAT(AdvanceTo(At(301)), ElementsAre(3));
+}
+
+}  // namespace
+}  // namespace quic::test
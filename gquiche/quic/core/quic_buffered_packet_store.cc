@@ -19,8 +19,6 @@ using BufferedPacket = QuicBufferedPacketStore::BufferedPacket;
 using BufferedPacketList = QuicBufferedPacketStore::BufferedPacketList;
 using EnqueuePacketResult = QuicBufferedPacketStore::EnqueuePacketResult;
 
-// Max number of connections this store can keep track.
-static const size_t kDefaultMaxConnectionsInStore = 100;
 // Up to half of the capacity can be used for storing non-CHLO packets.
 static const size_t kMaxConnectionsWithoutCHLO =
     kDefaultMaxConnectionsInStore / 2;
@@ -180,8 +178,8 @@ BufferedPacketList QuicBufferedPacketStore::DeliverPackets(
   if (it != undecryptable_packets_.end()) {
     packets_to_deliver = std::move(it->second);
     undecryptable_packets_.erase(connection_id);
-    std::list<BufferedPacket> initial_packets;
-    std::list<BufferedPacket> other_packets;
+    BufferedPacketQueue initial_packets;
+    BufferedPacketQueue other_packets;
     for (auto& packet : packets_to_deliver.buffered_packets) {
       QuicLongHeaderType long_packet_type = INVALID_PACKET_TYPE;
       PacketHeaderFormat unused_format;
@@ -208,8 +206,10 @@ BufferedPacketList QuicBufferedPacketStore::DeliverPackets(
       }
     }
 
-      initial_packets.splice(initial_packets.end(), other_packets);
-      packets_to_deliver.buffered_packets = std::move(initial_packets);
+    for (auto& packet : other_packets) {
+      initial_packets.push_back(std::move(packet));
+    }
+    packets_to_deliver.buffered_packets = std::move(initial_packets);
   }
   return packets_to_deliver;
 }
@@ -5,7 +5,6 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_BUFFERED_PACKET_STORE_H_
 #define QUICHE_QUIC_CORE_QUIC_BUFFERED_PACKET_STORE_H_
 
-#include <list>
 #include <string>
 
 #include "gquiche/quic/core/quic_alarm.h"
@@ -16,6 +15,7 @@
 #include "gquiche/quic/core/tls_chlo_extractor.h"
 #include "gquiche/quic/platform/api/quic_export.h"
 #include "gquiche/quic/platform/api/quic_socket_address.h"
+#include "gquiche/common/quiche_circular_deque.h"
 #include "gquiche/common/quiche_linked_hash_map.h"
 
 namespace quic {
@@ -56,6 +56,10 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
     QuicSocketAddress peer_address;
   };
 
+  // The packets of a connection are few and short lived, so they are kept in
+  // one contiguous buffer rather than a node per packet.
+  using BufferedPacketQueue = quiche::QuicheCircularDeque<BufferedPacket>;
+
   // A queue of BufferedPackets for a connection.
   struct QUIC_NO_EXPORT BufferedPacketList {
     BufferedPacketList();
@@ -65,7 +69,7 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
 
     ~BufferedPacketList();
 
-    std::list<BufferedPacket> buffered_packets;
+    BufferedPacketQueue buffered_packets;
     QuicTime creation_time;
     // |parsed_chlo| is set iff the entire CHLO has been received.
     absl::optional<ParsedClientHello> parsed_chlo;
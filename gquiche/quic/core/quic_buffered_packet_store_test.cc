@@ -4,7 +4,6 @@
 
 #include "gquiche/quic/core/quic_buffered_packet_store.h"
 
-#include <list>
 #include <memory>
 #include <string>
 
@@ -20,7 +19,6 @@
 #include "gquiche/quic/test_tools/quic_test_utils.h"
 
 namespace quic {
-static const size_t kDefaultMaxConnectionsInStore = 100;
 static const size_t kMaxConnectionsWithoutCHLO =
     kDefaultMaxConnectionsInStore / 2;
 
@@ -33,6 +31,7 @@ const absl::optional<ParsedClientHello> kDefaultParsedChlo =
 
 using BufferedPacket = QuicBufferedPacketStore::BufferedPacket;
 using BufferedPacketList = QuicBufferedPacketStore::BufferedPacketList;
+using BufferedPacketQueue = QuicBufferedPacketStore::BufferedPacketQueue;
 using EnqueuePacketResult = QuicBufferedPacketStore::EnqueuePacketResult;
 using ::testing::A;
 using ::testing::Conditional;
@@ -90,7 +89,7 @@ TEST_F(QuicBufferedPacketStoreTest, SimpleEnqueueAndDeliverPacket) {
                        peer_address_, invalid_version_, kNoParsedChlo);
   EXPECT_TRUE(store_.HasBufferedPackets(connection_id));
   auto packets = store_.DeliverPackets(connection_id);
-  const std::list<BufferedPacket>& queue = packets.buffered_packets;
+  const BufferedPacketQueue& queue = packets.buffered_packets;
   ASSERT_EQ(1u, queue.size());
   ASSERT_FALSE(packets.parsed_chlo.has_value());
   // There is no valid version because CHLO has not arrived.
@@ -112,7 +111,7 @@ TEST_F(QuicBufferedPacketStoreTest, DifferentPacketAddressOnOneConnection) {
                        peer_address_, invalid_version_, kNoParsedChlo);
   store_.EnqueuePacket(connection_id, false, packet_, self_address_,
                        addr_with_new_port, invalid_version_, kNoParsedChlo);
-  std::list<BufferedPacket> queue =
+  BufferedPacketQueue queue =
       store_.DeliverPackets(connection_id).buffered_packets;
   ASSERT_EQ(2u, queue.size());
   // The address migration path should be preserved.
@@ -134,7 +133,7 @@ TEST_F(QuicBufferedPacketStoreTest,
   // Deliver packets in reversed order.
   for (uint64_t conn_id = num_connections; conn_id > 0; --conn_id) {
     QuicConnectionId connection_id = TestConnectionId(conn_id);
-    std::list<BufferedPacket> queue =
+    BufferedPacketQueue queue =
         store_.DeliverPackets(connection_id).buffered_packets;
     ASSERT_EQ(2u, queue.size());
   }
@@ -188,7 +187,7 @@ TEST_F(QuicBufferedPacketStoreTest, ReachNonChloConnectionUpperLimit) {
   // Store only keeps early arrived packets upto |kNumConnections| connections.
   for (uint64_t conn_id = 1; conn_id <= kNumConnections; ++conn_id) {
     QuicConnectionId connection_id = TestConnectionId(conn_id);
-    std::list<BufferedPacket> queue =
+    BufferedPacketQueue queue =
         store_.DeliverPackets(connection_id).buffered_packets;
     if (conn_id <= kMaxConnectionsWithoutCHLO) {
       EXPECT_EQ(1u, queue.size());
@@ -7,6 +7,7 @@
 
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
 #include "gquiche/quic/platform/api/quic_export.h"
 #include "gquiche/common/platform/api/quiche_logging.h"
 
@@ -96,6 +97,10 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionContext final {
   std::unique_ptr<QuicConnectionTracer> tracer;
   std::unique_ptr<QuicBugListener> bug_listener;
 
+  // If set, the frames QuicFrame points to are allocated from it while this
+  // context is current.
+  std::unique_ptr<QuicFrameArena> frame_arena;
+
   // Information about the packet currently being processed.
   QuicConnectionProcessPacketContext process_packet_context;
 };
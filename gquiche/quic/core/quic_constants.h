@@ -157,6 +157,9 @@ inline constexpr int64_t kMaxTimeForCryptoHandshakeSecs = 10;  // 10 secs.
 // before the CHLO/SHLO arrive.
 inline constexpr size_t kDefaultMaxUndecryptablePackets = 10;
 
+// Max number of connections QuicBufferedPacketStore keeps track of.
+inline constexpr size_t kDefaultMaxConnectionsInStore = 100;
+
 // Default ping timeout.
 inline constexpr int64_t kPingTimeoutSecs = 15;  // 15 secs.
 
@@ -34,6 +34,7 @@ namespace quic {
 
 using BufferedPacket = QuicBufferedPacketStore::BufferedPacket;
 using BufferedPacketList = QuicBufferedPacketStore::BufferedPacketList;
+using BufferedPacketQueue = QuicBufferedPacketStore::BufferedPacketQueue;
 using EnqueuePacketResult = QuicBufferedPacketStore::EnqueuePacketResult;
 
 namespace {
@@ -326,6 +327,44 @@ bool MaybeHandleLegacyVersionEncapsulation(
   return true;
 }
 
+constexpr bool IsSourceUdpPortBlocked(uint16_t port) {
+  // These UDP source ports have been observed in large scale denial of service
+  // attacks and are not expected to ever carry user traffic, they are therefore
+  // blocked as a safety measure. See draft-ietf-quic-applicability for details.
+  constexpr uint16_t blocked_ports[] = {
+      0,      // We cannot send to port 0 so drop that source port.
+      17,     // Quote of the Day, can loop with QUIC.
+      19,     // Chargen, can loop with QUIC.
+      53,     // DNS, vulnerable to reflection attacks.
+      111,    // Portmap.
+      123,    // NTP, vulnerable to reflection attacks.
+      137,    // NETBIOS Name Service,
+      138,    // NETBIOS Datagram Service
+      161,    // SNMP.
+      389,    // CLDAP.
+      500,    // IKE, can loop with QUIC.
+      1900,   // SSDP, vulnerable to reflection attacks.
+      3702,   // WS-Discovery, vulnerable to reflection attacks.
+      5353,   // mDNS, vulnerable to reflection attacks.
+      5355,   // LLMNR, vulnerable to reflection attacks.
+      11211,  // memcache, vulnerable to reflection attacks.
+              // This list MUST be sorted in increasing order.
+  };
+  constexpr size_t num_blocked_ports = ABSL_ARRAYSIZE(blocked_ports);
+  constexpr uint16_t highest_blocked_port =
+      blocked_ports[num_blocked_ports - 1];
+  if (ABSL_PREDICT_TRUE(port > highest_blocked_port)) {
+    // Early-return to skip comparisons for the majority of traffic.
+    return false;
+  }
+  for (size_t i = 0; i < num_blocked_ports; i++) {
+    if (port == blocked_ports[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 QuicDispatcher::QuicDispatcher(
@@ -393,59 +432,128 @@ void QuicDispatcher::ProcessPacket(const QuicSocketAddress& self_address,
                 << quiche::QuicheTextUtils::HexDump(
                        absl::string_view(packet.data(), packet.length()));
   ReceivedPacketInfo packet_info(self_address, peer_address, packet);
+  if (!ParsePacketHeader(&packet_info)) {
+    return;
+  }
+  if (MaybeDispatchPacket(packet_info)) {
+    // Packet has been dropped or successfully dispatched, stop processing.
+    return;
+  }
+  ProcessHeader(&packet_info);
+}
+
+void QuicDispatcher::ProcessPackets(
+    absl::Span<const ReceivedPacketWithAddresses> packets) {
+  // Consecutive short header packets for the same existing session are handed
+  // to it together, with one session lookup for the run, so that it processes
+  // them back to back and flushes and schedules ACKs once. Decryption is not
+  // grouped. Other packets take the ProcessPacket path, after the run before
+  // them.
+  QuicSession* run_session = nullptr;
+  QuicConnectionId run_connection_id;
+  size_t run_begin = 0;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    const ReceivedPacketWithAddresses& packet = packets[i];
+    ReceivedPacketInfo packet_info(packet.self_address, packet.peer_address,
+                                   *packet.packet);
+    const bool parsed = ParsePacketHeader(&packet_info);
+    const bool short_header =
+        parsed && !packet_info.version_flag &&
+        !IsSourceUdpPortBlocked(packet_info.peer_address.port());
+    if (run_session != nullptr) {
+      if (short_header &&
+          packet_info.destination_connection_id == run_connection_id) {
+        continue;
+      }
+      ProcessPacketRun(run_session, packets.subspan(run_begin, i - run_begin));
+      run_session = nullptr;
+    }
+    if (short_header) {
+      // Looked up after the previous run is processed, which may have closed
+      // the session of this packet or added or retired connection IDs.
+      auto it = reference_counted_session_map_.find(
+          packet_info.destination_connection_id);
+      if (it != reference_counted_session_map_.end()) {
+        QUICHE_DCHECK(!buffered_packets_.HasBufferedPackets(
+            packet_info.destination_connection_id));
+        run_session = it->second.get();
+        run_connection_id = packet_info.destination_connection_id;
+        run_begin = i;
+        continue;
+      }
+    }
+    if (!parsed || MaybeDispatchPacket(packet_info)) {
+      continue;
+    }
+    ProcessHeader(&packet_info);
+  }
+  if (run_session != nullptr) {
+    ProcessPacketRun(run_session, packets.subspan(run_begin));
+  }
+}
+
+void QuicDispatcher::ProcessPacketRun(
+    QuicSession* session, absl::Span<const ReceivedPacketWithAddresses> run) {
+  const size_t num_processed = session->ProcessUdpPackets(run);
+  // The session stopped because its connection closed. Its connection IDs
+  // are no longer in the session map.
+  for (const ReceivedPacketWithAddresses& packet :
+       run.subspan(num_processed)) {
+    ProcessPacket(packet.self_address, packet.peer_address, *packet.packet);
+  }
+}
+
+bool QuicDispatcher::ParsePacketHeader(ReceivedPacketInfo* packet_info) {
+  const QuicReceivedPacket& packet = packet_info->packet;
   std::string detailed_error;
   const QuicErrorCode error = QuicFramer::ParsePublicHeaderDispatcher(
-      packet, expected_server_connection_id_length_, &packet_info.form,
-      &packet_info.long_packet_type, &packet_info.version_flag,
-      &packet_info.use_length_prefix, &packet_info.version_label,
-      &packet_info.version, &packet_info.destination_connection_id,
-      &packet_info.source_connection_id, &packet_info.retry_token,
+      packet, expected_server_connection_id_length_, &packet_info->form,
+      &packet_info->long_packet_type, &packet_info->version_flag,
+      &packet_info->use_length_prefix, &packet_info->version_label,
+      &packet_info->version, &packet_info->destination_connection_id,
+      &packet_info->source_connection_id, &packet_info->retry_token,
       &detailed_error);
   if (error != QUIC_NO_ERROR) {
     // Packet has framing error.
     SetLastError(error);
     QUIC_DLOG(ERROR) << detailed_error;
-    return;
+    return false;
   }
-  if (packet_info.destination_connection_id.length() !=
+  if (packet_info->destination_connection_id.length() !=
           expected_server_connection_id_length_ &&
       !should_update_expected_server_connection_id_length_ &&
-      packet_info.version.IsKnown() &&
-      !packet_info.version.AllowsVariableLengthConnectionIds()) {
+      packet_info->version.IsKnown() &&
+      !packet_info->version.AllowsVariableLengthConnectionIds()) {
     SetLastError(QUIC_INVALID_PACKET_HEADER);
     QUIC_DLOG(ERROR) << "Invalid Connection Id Length";
-    return;
+    return false;
   }
 
-  if (packet_info.version_flag && IsSupportedVersion(packet_info.version)) {
+  if (packet_info->version_flag && IsSupportedVersion(packet_info->version)) {
     if (!QuicUtils::IsConnectionIdValidForVersion(
-            packet_info.destination_connection_id,
-            packet_info.version.transport_version)) {
+            packet_info->destination_connection_id,
+            packet_info->version.transport_version)) {
       SetLastError(QUIC_INVALID_PACKET_HEADER);
       QUIC_DLOG(ERROR)
           << "Invalid destination connection ID length for version";
-      return;
+      return false;
     }
-    if (packet_info.version.SupportsClientConnectionIds() &&
+    if (packet_info->version.SupportsClientConnectionIds() &&
         !QuicUtils::IsConnectionIdValidForVersion(
-            packet_info.source_connection_id,
-            packet_info.version.transport_version)) {
+            packet_info->source_connection_id,
+            packet_info->version.transport_version)) {
       SetLastError(QUIC_INVALID_PACKET_HEADER);
       QUIC_DLOG(ERROR) << "Invalid source connection ID length for version";
-      return;
+      return false;
     }
   }
 
   if (should_update_expected_server_connection_id_length_) {
     expected_server_connection_id_length_ =
-        packet_info.destination_connection_id.length();
+        packet_info->destination_connection_id.length();
   }
 
-  if (MaybeDispatchPacket(packet_info)) {
-    // Packet has been dropped or successfully dispatched, stop processing.
-    return;
-  }
-  ProcessHeader(&packet_info);
+  return true;
 }
 
 absl::optional<QuicConnectionId> QuicDispatcher::MaybeReplaceServerConnectionId(
@@ -507,46 +615,6 @@ QuicConnectionId QuicDispatcher::ReplaceLongServerConnectionId(
       server_connection_id, expected_server_connection_id_length);
 }
 
-namespace {
-constexpr bool IsSourceUdpPortBlocked(uint16_t port) {
-  // These UDP source ports have been observed in large scale denial of service
-  // attacks and are not expected to ever carry user traffic, they are therefore
-  // blocked as a safety measure. See draft-ietf-quic-applicability for details.
-  constexpr uint16_t blocked_ports[] = {
-      0,      // We cannot send to port 0 so drop that source port.
-      17,     // Quote of the Day, can loop with QUIC.
-      19,     // Chargen, can loop with QUIC.
-      53,     // DNS, vulnerable to reflection attacks.
-      111,    // Portmap.
-      123,    // NTP, vulnerable to reflection attacks.
-      137,    // NETBIOS Name Service,
-      138,    // NETBIOS Datagram Service
-      161,    // SNMP.
-      389,    // CLDAP.
-      500,    // IKE, can loop with QUIC.
-      1900,   // SSDP, vulnerable to reflection attacks.
-      3702,   // WS-Discovery, vulnerable to reflection attacks.
-      5353,   // mDNS, vulnerable to reflection attacks.
-      5355,   // LLMNR, vulnerable to reflection attacks.
-      11211,  // memcache, vulnerable to reflection attacks.
-              // This list MUST be sorted in increasing order.
-  };
-  constexpr size_t num_blocked_ports = ABSL_ARRAYSIZE(blocked_ports);
-  constexpr uint16_t highest_blocked_port =
-      blocked_ports[num_blocked_ports - 1];
-  if (ABSL_PREDICT_TRUE(port > highest_blocked_port)) {
-    // Early-return to skip comparisons for the majority of traffic.
-    return false;
-  }
-  for (size_t i = 0; i < num_blocked_ports; i++) {
-    if (port == blocked_ports[i]) {
-      return true;
-    }
-  }
-  return false;
-}
-}  // namespace
-
 bool QuicDispatcher::MaybeDispatchPacket(
     const ReceivedPacketInfo& packet_info) {
   if (IsSourceUdpPortBlocked(packet_info.peer_address.port())) {
@@ -1276,7 +1344,7 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
     BufferedPacketList packet_list =
         buffered_packets_.DeliverPacketsForNextConnection(
             &server_connection_id);
-    const std::list<BufferedPacket>& packets = packet_list.buffered_packets;
+    const BufferedPacketQueue& packets = packet_list.buffered_packets;
     if (packets.empty()) {
       return;
     }
@@ -1354,7 +1422,7 @@ void QuicDispatcher::ProcessChlo(ParsedClientHello parsed_chlo,
   if (session_ptr == nullptr) {
     return;
   }
-  std::list<BufferedPacket> packets =
+  BufferedPacketQueue packets =
       buffered_packets_.DeliverPackets(packet_info->destination_connection_id)
           .buffered_packets;
   if (packet_info->destination_connection_id != session_ptr->connection_id()) {
@@ -1390,7 +1458,7 @@ const ParsedQuicVersionVector& QuicDispatcher::GetSupportedVersions() {
 }
 
 void QuicDispatcher::DeliverPacketsToSession(
-    const std::list<BufferedPacket>& packets, QuicSession* session) {
+    const BufferedPacketQueue& packets, QuicSession* session) {
   for (const BufferedPacket& packet : packets) {
     session->ProcessUdpPacket(packet.self_address, packet.peer_address,
                               *(packet.packet));
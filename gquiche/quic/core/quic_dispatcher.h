@@ -15,6 +15,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "gquiche/quic/core/connection_id_generator.h"
 #include "gquiche/quic/core/crypto/quic_compressed_certs_cache.h"
 #include "gquiche/quic/core/crypto/quic_random.h"
@@ -71,6 +72,12 @@ class QUIC_NO_EXPORT QuicDispatcher
                      const QuicSocketAddress& peer_address,
                      const QuicReceivedPacket& packet) override;
 
+  // Processes |packets| in order, handing runs of packets for the same existing
+  // session to it together. Only the session lookup and the session's flush
+  // are shared by a run; each packet is still decrypted and processed alone.
+  void ProcessPackets(
+      absl::Span<const ReceivedPacketWithAddresses> packets) override;
+
   // Called when the socket becomes writable to allow queued writes to happen.
   virtual void OnCanWrite();
 
@@ -359,6 +366,16 @@ class QUIC_NO_EXPORT QuicDispatcher
  private:
   friend class test::QuicDispatcherPeer;
 
+  // Parses the public header of |packet_info|'s packet into it and checks the
+  // connection ID lengths. Returns false if the packet should be dropped.
+  bool ParsePacketHeader(ReceivedPacketInfo* packet_info);
+
+  // Hands |run|, consecutive packets for |session|, to the session. If its
+  // connection closes partway through, the rest of the run takes the
+  // ProcessPacket path, which sends them to the time wait list.
+  void ProcessPacketRun(QuicSession* session,
+                        absl::Span<const ReceivedPacketWithAddresses> run);
+
   // TODO(fayang): Consider to rename this function to
   // ProcessValidatedPacketWithUnknownConnectionId.
   void ProcessHeader(ReceivedPacketInfo* packet_info);
@@ -387,7 +404,7 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   // Deliver |packets| to |session| for further processing.
   void DeliverPacketsToSession(
-      const std::list<QuicBufferedPacketStore::BufferedPacket>& packets,
+      const QuicBufferedPacketStore::BufferedPacketQueue& packets,
       QuicSession* session);
 
   // Returns true if |version| is a supported protocol version.
@@ -52,10 +52,10 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::SizeIs;
 using testing::WithArg;
 using testing::WithoutArgs;
 
-static const size_t kDefaultMaxConnectionsInStore = 100;
 static const size_t kMaxConnectionsWithoutCHLO =
     kDefaultMaxConnectionsInStore / 2;
 static const int16_t kMaxNumSessionsToCreate = 16;
@@ -74,6 +74,11 @@ class TestQuicSpdyServerSession : public QuicServerSessionBase {
                               nullptr, nullptr, crypto_config,
                               compressed_certs_cache) {
     Initialize();
+    ON_CALL(*this, ProcessUdpPackets(_))
+        .WillByDefault(Invoke(
+            [this](absl::Span<const ReceivedPacketWithAddresses> packets) {
+              return QuicServerSessionBase::ProcessUdpPackets(packets);
+            }));
   }
   TestQuicSpdyServerSession(const TestQuicSpdyServerSession&) = delete;
   TestQuicSpdyServerSession& operator=(const TestQuicSpdyServerSession&) =
@@ -85,6 +90,9 @@ class TestQuicSpdyServerSession : public QuicServerSessionBase {
               (const QuicConnectionCloseFrame& frame,
                ConnectionCloseSource source),
               (override));
+  MOCK_METHOD(size_t, ProcessUdpPackets,
+              (absl::Span<const ReceivedPacketWithAddresses> packets),
+              (override));
   MOCK_METHOD(QuicSpdyStream*, CreateIncomingStream, (QuicStreamId id),
               (override));
   MOCK_METHOD(QuicSpdyStream*, CreateIncomingStream, (PendingStream*),
@@ -758,6 +766,118 @@ TEST_P(QuicDispatcherTestAllVersions, ProcessPackets) {
   ProcessPacket(client_address, TestConnectionId(1), false, "data");
 }
 
+TEST_P(QuicDispatcherTestAllVersions, ProcessPacketsInBatch) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(TestConnectionId(1), _,
+                                              client_address, _, _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(1), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*connection1(), ProcessUdpPacket(_, _, _));
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(TestConnectionId(2), _,
+                                              client_address, _, _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(2), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session2_))));
+  EXPECT_CALL(*connection2(), ProcessUdpPacket(_, _, _));
+  ProcessFirstFlight(client_address, TestConnectionId(2));
+
+  // Short header packets for both sessions, which each receives in order.
+  ParsedQuicVersionVector versions(SupportedVersions(version_));
+  const QuicConnectionId connection_ids[] = {
+      TestConnectionId(1), TestConnectionId(1), TestConnectionId(2),
+      TestConnectionId(1)};
+  std::vector<std::unique_ptr<QuicReceivedPacket>> packets;
+  std::vector<ReceivedPacketWithAddresses> batch;
+  for (size_t i = 0; i < ABSL_ARRAYSIZE(connection_ids); ++i) {
+    std::unique_ptr<QuicEncryptedPacket> packet(ConstructEncryptedPacket(
+        connection_ids[i], EmptyQuicConnectionId(), false, false, i + 2,
+        absl::StrCat("data", i), true, CONNECTION_ID_PRESENT,
+        CONNECTION_ID_ABSENT, PACKET_4BYTE_PACKET_NUMBER, &versions));
+    packets.emplace_back(
+        ConstructReceivedPacket(*packet, mock_helper_.GetClock()->Now()));
+    batch.push_back({server_address_, client_address, packets.back().get()});
+  }
+
+  // Each run of packets for a session is handed to it in one call, and its
+  // packets are processed under the run's packet flusher, so that the
+  // connection flushes once for the run.
+  InSequence s;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    TestQuicSpdyServerSession* session =
+        connection_ids[i] == TestConnectionId(1) ? session1_ : session2_;
+    if (i == 0) {
+      EXPECT_CALL(*session, ProcessUdpPackets(SizeIs(2)));
+    } else if (i != 1) {
+      EXPECT_CALL(*session, ProcessUdpPackets(SizeIs(1)));
+    }
+    MockQuicConnection* connection =
+        reinterpret_cast<MockQuicConnection*>(session->connection());
+    EXPECT_CALL(*connection,
+                ProcessUdpPacket(server_address_, client_address, _))
+        .WillOnce(WithArg<2>(Invoke(
+            [&packets, i, connection](const QuicReceivedPacket& packet) {
+              EXPECT_EQ(packets[i]->AsStringPiece(), packet.AsStringPiece());
+              EXPECT_TRUE(QuicConnectionPeer::GetPacketCreator(connection)
+                              ->PacketFlusherAttached());
+            })));
+  }
+  dispatcher_->ProcessPackets(absl::MakeConstSpan(batch));
+  EXPECT_FALSE(QuicConnectionPeer::GetPacketCreator(connection1())
+                   ->PacketFlusherAttached());
+  EXPECT_FALSE(QuicConnectionPeer::GetPacketCreator(connection2())
+                   ->PacketFlusherAttached());
+}
+
+TEST_P(QuicDispatcherTestAllVersions, ProcessPacketsAfterConnectionCloses) {
+  CreateTimeWaitListManager();
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId connection_id = TestConnectionId(1);
+
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(connection_id, _, client_address, _, _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, connection_id, client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*connection1(), ProcessUdpPacket(_, _, _));
+  ProcessFirstFlight(client_address, connection_id);
+
+  ParsedQuicVersionVector versions(SupportedVersions(version_));
+  std::vector<std::unique_ptr<QuicReceivedPacket>> packets;
+  std::vector<ReceivedPacketWithAddresses> batch;
+  for (size_t i = 0; i < 3; ++i) {
+    std::unique_ptr<QuicEncryptedPacket> packet(ConstructEncryptedPacket(
+        connection_id, EmptyQuicConnectionId(), false, false, i + 2,
+        absl::StrCat("data", i), true, CONNECTION_ID_PRESENT,
+        CONNECTION_ID_ABSENT, PACKET_4BYTE_PACKET_NUMBER, &versions));
+    packets.emplace_back(
+        ConstructReceivedPacket(*packet, mock_helper_.GetClock()->Now()));
+    batch.push_back({server_address_, client_address, packets.back().get()});
+  }
+
+  // The first packet of the run closes the connection. The rest of the run
+  // goes to the time wait list.
+  MockServerConnection* connection =
+      reinterpret_cast<MockServerConnection*>(connection1());
+  EXPECT_CALL(*connection, ProcessUdpPacket(_, _, _))
+      .WillOnce(WithoutArgs(Invoke([connection]() {
+        connection->ReallyCloseConnection(
+            QUIC_PEER_GOING_AWAY, "Closed",
+            ConnectionCloseBehavior::SILENT_CLOSE);
+        connection->UnregisterOnConnectionClosed();
+      })));
+  EXPECT_CALL(*time_wait_list_manager_,
+              ProcessPacket(_, _, connection_id, _, _, _))
+      .Times(2);
+  dispatcher_->ProcessPackets(absl::MakeConstSpan(batch));
+  EXPECT_TRUE(time_wait_list_manager_->IsConnectionIdInTimeWait(connection_id));
+}
+
 // Regression test of b/93325907.
 TEST_P(QuicDispatcherTestAllVersions, DispatcherDoesNotRejectPacketNumberZero) {
   QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
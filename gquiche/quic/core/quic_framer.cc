@@ -4571,7 +4571,7 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
 
 namespace {
 
-const size_t kHPSampleLen = 16;
+const size_t kHPSampleLen = QuicEncrypter::kHeaderProtectionSampleLength;
 
 constexpr bool IsLongHeader(uint8_t type_byte) {
   return (type_byte & FLAGS_LONG_HEADER) != 0;
@@ -4608,12 +4608,14 @@ bool QuicFramer::ApplyHeaderProtection(EncryptionLevel level, char* buffer,
     return false;
   }
 
-  std::string mask = encrypter_[level]->GenerateHeaderProtectionMask(sample);
-  if (mask.empty()) {
+  uint8_t mask[QuicEncrypter::kHeaderProtectionMaskLength];
+  if (!encrypter_[level]->GenerateHeaderProtectionMask(sample,
+                                                       absl::MakeSpan(mask))) {
     QUIC_BUG(quic_bug_10850_61) << "Unable to generate header protection mask.";
     return false;
   }
-  QuicDataReader mask_reader(mask.data(), mask.size());
+  QuicDataReader mask_reader(reinterpret_cast<const char*>(mask),
+                             ABSL_ARRAYSIZE(mask));
 
   // Apply the mask to the 4 or 5 least significant bits of the first byte.
   uint8_t bitmask = 0x1f;
@@ -4705,12 +4707,16 @@ bool QuicFramer::RemoveHeaderProtection(QuicDataReader* reader,
       return false;
     }
   }
-  std::string mask = decrypter->GenerateHeaderProtectionMask(&sample_reader);
-  QuicDataReader mask_reader(mask.data(), mask.size());
-  if (mask.empty()) {
+  // The mask is computed on the stack, the sample may run into the rest of
+  // the packet.
+  uint8_t mask[QuicDecrypter::kHeaderProtectionMaskLength];
+  if (!decrypter->GenerateHeaderProtectionMask(
+          sample_reader.PeekRemainingPayload(), absl::MakeSpan(mask))) {
     QUIC_DVLOG(1) << "Failed to compute mask";
     return false;
   }
+  QuicDataReader mask_reader(reinterpret_cast<const char*>(mask),
+                             ABSL_ARRAYSIZE(mask));
 
   // Unmask the rest of the type byte.
   uint8_t bitmask = 0x1f;
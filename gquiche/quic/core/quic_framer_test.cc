@@ -122,6 +122,11 @@ class TestEncrypter : public QuicEncrypter {
       absl::string_view /*sample*/) override {
     return std::string(5, 0);
   }
+  bool GenerateHeaderProtectionMask(absl::string_view /*sample*/,
+                                    absl::Span<uint8_t> out) override {
+    memset(out.data(), 0, out.size());
+    return true;
+  }
   size_t GetKeySize() const override { return 0; }
   size_t GetNoncePrefixSize() const override { return 0; }
   size_t GetIVSize() const override { return 0; }
@@ -177,6 +182,11 @@ class TestDecrypter : public QuicDecrypter {
       QuicDataReader* /*sample_reader*/) override {
     return std::string(5, 0);
   }
+  bool GenerateHeaderProtectionMask(absl::string_view /*sample*/,
+                                    absl::Span<uint8_t> out) override {
+    memset(out.data(), 0, out.size());
+    return true;
+  }
   size_t GetKeySize() const override { return 0; }
   size_t GetNoncePrefixSize() const override { return 0; }
   size_t GetIVSize() const override { return 0; }
@@ -0,0 +1,204 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/quic_packet_buffer_pool.h"
+
+#include <new>
+
+#include "absl/base/optimization.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace internal {
+
+// The buffer's bookkeeping, followed in the same allocation by its data, which
+// starts on a cache line.
+struct alignas(ABSL_CACHELINE_SIZE) PooledPacketBufferSlab {
+  explicit PooledPacketBufferSlab(PacketBufferPoolCore* core) : core(core) {}
+
+  static PooledPacketBufferSlab* Create(PacketBufferPoolCore* core,
+                                        size_t buffer_size) {
+    void* block =
+        ::operator new(sizeof(PooledPacketBufferSlab) + buffer_size,
+                       std::align_val_t(alignof(PooledPacketBufferSlab)));
+    return new (block) PooledPacketBufferSlab(core);
+  }
+
+  static void Destroy(PooledPacketBufferSlab* slab) {
+    slab->~PooledPacketBufferSlab();
+    ::operator delete(slab, std::align_val_t(alignof(PooledPacketBufferSlab)));
+  }
+
+  char* data() { return reinterpret_cast<char*>(this + 1); }
+
+  PacketBufferPoolCore* core;
+  int ref_count = 0;
+  PooledPacketBufferSlab* next_free = nullptr;
+};
+
+// The state buffers need to find their way back. Owned by the pool, or, once
+// the pool is gone, by the buffers still in use.
+struct PacketBufferPoolCore {
+  PacketBufferPoolCore(size_t buffer_size, size_t max_free_buffers)
+      : buffer_size(buffer_size), max_free_buffers(max_free_buffers) {}
+
+  ~PacketBufferPoolCore() {
+    while (free_list != nullptr) {
+      PooledPacketBufferSlab* slab = free_list;
+      free_list = slab->next_free;
+      PooledPacketBufferSlab::Destroy(slab);
+    }
+  }
+
+  void Release(PooledPacketBufferSlab* slab) {
+    QUICHE_DCHECK_GT(num_in_use, 0u);
+    --num_in_use;
+    if (orphaned || num_free >= max_free_buffers) {
+      PooledPacketBufferSlab::Destroy(slab);
+      if (orphaned && num_in_use == 0) {
+        delete this;
+      }
+      return;
+    }
+    slab->next_free = free_list;
+    free_list = slab;
+    ++num_free;
+  }
+
+  const size_t buffer_size;
+  const size_t max_free_buffers;
+  PooledPacketBufferSlab* free_list = nullptr;
+  size_t num_free = 0;
+  size_t num_in_use = 0;
+  size_t num_allocated = 0;
+  bool orphaned = false;
+};
+
+}  // namespace internal
+
+QuicPooledPacketBuffer::QuicPooledPacketBuffer(
+    internal::PooledPacketBufferSlab* slab)
+    : slab_(slab) {
+  ++slab_->ref_count;
+}
+
+QuicPooledPacketBuffer::QuicPooledPacketBuffer(
+    const QuicPooledPacketBuffer& other)
+    : slab_(other.slab_) {
+  if (slab_ != nullptr) {
+    ++slab_->ref_count;
+  }
+}
+
+QuicPooledPacketBuffer::QuicPooledPacketBuffer(QuicPooledPacketBuffer&& other)
+    : slab_(other.slab_) {
+  other.slab_ = nullptr;
+}
+
+QuicPooledPacketBuffer& QuicPooledPacketBuffer::operator=(
+    const QuicPooledPacketBuffer& other) {
+  if (other.slab_ != nullptr) {
+    ++other.slab_->ref_count;
+  }
+  Reset();
+  slab_ = other.slab_;
+  return *this;
+}
+
+QuicPooledPacketBuffer& QuicPooledPacketBuffer::operator=(
+    QuicPooledPacketBuffer&& other) {
+  if (this != &other) {
+    Reset();
+    slab_ = other.slab_;
+    other.slab_ = nullptr;
+  }
+  return *this;
+}
+
+QuicPooledPacketBuffer::~QuicPooledPacketBuffer() { Reset(); }
+
+char* QuicPooledPacketBuffer::data() const {
+  return slab_ == nullptr ? nullptr : slab_->data();
+}
+
+size_t QuicPooledPacketBuffer::size() const {
+  return slab_ == nullptr ? 0 : slab_->core->buffer_size;
+}
+
+bool QuicPooledPacketBuffer::Contains(const char* data, size_t length) const {
+  if (slab_ == nullptr || data < slab_->data()) {
+    return false;
+  }
+  const size_t offset = data - slab_->data();
+  return offset <= size() && length <= size() - offset;
+}
+
+int QuicPooledPacketBuffer::ref_count() const {
+  return slab_ == nullptr ? 0 : slab_->ref_count;
+}
+
+void QuicPooledPacketBuffer::Reset() {
+  if (slab_ == nullptr) {
+    return;
+  }
+  internal::PooledPacketBufferSlab* slab = slab_;
+  slab_ = nullptr;
+  QUICHE_DCHECK_GT(slab->ref_count, 0);
+  if (--slab->ref_count == 0) {
+    slab->core->Release(slab);
+  }
+}
+
+QuicPacketBufferPool::QuicPacketBufferPool(size_t buffer_size,
+                                           size_t max_free_buffers)
+    : core_(new internal::PacketBufferPoolCore(buffer_size,
+                                               max_free_buffers)) {}
+
+QuicPacketBufferPool::~QuicPacketBufferPool() {
+  if (core_->num_in_use == 0) {
+    delete core_;
+    return;
+  }
+  QUIC_DVLOG(1) << "Destroying packet buffer pool with " << core_->num_in_use
+                << " buffers in use";
+  core_->orphaned = true;
+  // The free buffers are not needed anymore.
+  while (core_->free_list != nullptr) {
+    internal::PooledPacketBufferSlab* slab = core_->free_list;
+    core_->free_list = slab->next_free;
+    internal::PooledPacketBufferSlab::Destroy(slab);
+  }
+  core_->num_free = 0;
+}
+
+QuicPooledPacketBuffer QuicPacketBufferPool::Acquire() {
+  internal::PooledPacketBufferSlab* slab = core_->free_list;
+  if (slab != nullptr) {
+    core_->free_list = slab->next_free;
+    slab->next_free = nullptr;
+    --core_->num_free;
+  } else {
+    slab = internal::PooledPacketBufferSlab::Create(core_, core_->buffer_size);
+    ++core_->num_allocated;
+  }
+  ++core_->num_in_use;
+  return QuicPooledPacketBuffer(slab);
+}
+
+size_t QuicPacketBufferPool::buffer_size() const { return core_->buffer_size; }
+
+size_t QuicPacketBufferPool::num_free_buffers() const {
+  return core_->num_free;
+}
+
+size_t QuicPacketBufferPool::num_buffers_in_use() const {
+  return core_->num_in_use;
+}
+
+size_t QuicPacketBufferPool::num_buffers_allocated() const {
+  return core_->num_allocated;
+}
+
+}  // namespace quic
@@ -0,0 +1,85 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
+#define QUICHE_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
+
+#include <cstddef>
+
+#include "gquiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+namespace internal {
+struct PooledPacketBufferSlab;
+struct PacketBufferPoolCore;
+}  // namespace internal
+
+// A counted reference to a buffer of a QuicPacketBufferPool. Copies share the
+// buffer; it goes back to the pool when the last one is destroyed. Not thread
+// safe: all the references to a pool's buffers must be used on one thread.
+class QUIC_EXPORT_PRIVATE QuicPooledPacketBuffer {
+ public:
+  QuicPooledPacketBuffer() = default;
+  QuicPooledPacketBuffer(const QuicPooledPacketBuffer& other);
+  QuicPooledPacketBuffer(QuicPooledPacketBuffer&& other);
+  QuicPooledPacketBuffer& operator=(const QuicPooledPacketBuffer& other);
+  QuicPooledPacketBuffer& operator=(QuicPooledPacketBuffer&& other);
+  ~QuicPooledPacketBuffer();
+
+  explicit operator bool() const { return slab_ != nullptr; }
+
+  char* data() const;
+  size_t size() const;
+
+  // Returns true if the |length| bytes at |data| lie within the buffer.
+  bool Contains(const char* data, size_t length) const;
+
+  // The number of references to the buffer, 0 for a null reference.
+  int ref_count() const;
+
+  // Drops this reference.
+  void Reset();
+
+ private:
+  friend class QuicPacketBufferPool;
+
+  explicit QuicPooledPacketBuffer(internal::PooledPacketBufferSlab* slab);
+
+  internal::PooledPacketBufferSlab* slab_ = nullptr;
+};
+
+// A pool of packet buffers of one size, which packet readers receive into so
+// that the packets kept for later, e.g. by QuicBufferedPacketStore or as
+// undecryptable packets of a connection, can hold a reference to the buffer
+// instead of a copy of the packet.
+//
+// Buffers may outlive the pool: the ones still referenced when it is destroyed
+// are freed when their last reference goes.
+class QUIC_EXPORT_PRIVATE QuicPacketBufferPool {
+ public:
+  // Keeps up to |max_free_buffers| released buffers for reuse.
+  QuicPacketBufferPool(size_t buffer_size, size_t max_free_buffers);
+  QuicPacketBufferPool(const QuicPacketBufferPool&) = delete;
+  QuicPacketBufferPool& operator=(const QuicPacketBufferPool&) = delete;
+  ~QuicPacketBufferPool();
+
+  // Returns a reference to a free buffer of buffer_size() bytes.
+  QuicPooledPacketBuffer Acquire();
+
+  size_t buffer_size() const;
+  // Buffers waiting in the pool.
+  size_t num_free_buffers() const;
+  // Buffers referenced outside the pool.
+  size_t num_buffers_in_use() const;
+  // Buffers allocated over the pool's lifetime.
+  size_t num_buffers_allocated() const;
+
+ private:
+  internal::PacketBufferPoolCore* core_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
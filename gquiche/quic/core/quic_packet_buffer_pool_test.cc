@@ -0,0 +1,105 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/quic_packet_buffer_pool.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/base/optimization.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicPacketBufferPoolTest : public QuicTest {
+ protected:
+  QuicPacketBufferPoolTest() : pool_(1500, 2) {}
+
+  QuicPacketBufferPool pool_;
+};
+
+TEST_F(QuicPacketBufferPoolTest, AcquireAndRelease) {
+  QuicPooledPacketBuffer buffer = pool_.Acquire();
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(1500u, buffer.size());
+  EXPECT_EQ(1, buffer.ref_count());
+  EXPECT_EQ(1u, pool_.num_buffers_in_use());
+  EXPECT_EQ(0u, pool_.num_free_buffers());
+
+  buffer.Reset();
+  EXPECT_FALSE(buffer);
+  EXPECT_EQ(0, buffer.ref_count());
+  EXPECT_EQ(0u, pool_.num_buffers_in_use());
+  EXPECT_EQ(1u, pool_.num_free_buffers());
+}
+
+TEST_F(QuicPacketBufferPoolTest, ReusesFreeBuffers) {
+  char* data = pool_.Acquire().data();
+  QuicPooledPacketBuffer buffer = pool_.Acquire();
+  EXPECT_EQ(data, buffer.data());
+  EXPECT_EQ(1u, pool_.num_buffers_allocated());
+}
+
+TEST_F(QuicPacketBufferPoolTest, CopiesShareTheBuffer) {
+  QuicPooledPacketBuffer buffer = pool_.Acquire();
+  QuicPooledPacketBuffer copy = buffer;
+  EXPECT_EQ(buffer.data(), copy.data());
+  EXPECT_EQ(2, buffer.ref_count());
+
+  QuicPooledPacketBuffer moved = std::move(copy);
+  EXPECT_FALSE(copy);
+  EXPECT_EQ(2, moved.ref_count());
+
+  buffer.Reset();
+  EXPECT_EQ(1, moved.ref_count());
+  EXPECT_EQ(1u, pool_.num_buffers_in_use());
+  moved = QuicPooledPacketBuffer();
+  EXPECT_EQ(0u, pool_.num_buffers_in_use());
+}
+
+TEST_F(QuicPacketBufferPoolTest, KeepsAtMostMaxFreeBuffers) {
+  {
+    QuicPooledPacketBuffer buffers[] = {pool_.Acquire(), pool_.Acquire(),
+                                        pool_.Acquire()};
+    EXPECT_EQ(3u, pool_.num_buffers_in_use());
+  }
+  EXPECT_EQ(0u, pool_.num_buffers_in_use());
+  EXPECT_EQ(2u, pool_.num_free_buffers());
+}
+
+TEST_F(QuicPacketBufferPoolTest, Contains) {
+  QuicPooledPacketBuffer buffer = pool_.Acquire();
+  EXPECT_TRUE(buffer.Contains(buffer.data(), 1500));
+  EXPECT_TRUE(buffer.Contains(buffer.data() + 100, 1400));
+  EXPECT_TRUE(buffer.Contains(buffer.data() + 1500, 0));
+  EXPECT_FALSE(buffer.Contains(buffer.data() + 100, 1401));
+  EXPECT_FALSE(buffer.Contains(buffer.data() - 1, 10));
+  EXPECT_FALSE(QuicPooledPacketBuffer().Contains(buffer.data(), 10));
+}
+
+TEST_F(QuicPacketBufferPoolTest, BuffersStartOnACacheLine) {
+  QuicPooledPacketBuffer buffer = pool_.Acquire();
+  EXPECT_EQ(0u,
+            reinterpret_cast<uintptr_t>(buffer.data()) % ABSL_CACHELINE_SIZE);
+}
+
+TEST_F(QuicPacketBufferPoolTest, BuffersOutliveThePool) {
+  QuicPooledPacketBuffer buffer;
+  {
+    QuicPacketBufferPool pool(100, 1);
+    buffer = pool.Acquire();
+    QuicPooledPacketBuffer free_buffer = pool.Acquire();
+  }
+  ASSERT_TRUE(buffer);
+  buffer.data()[99] = 'a';
+  QuicPooledPacketBuffer copy = buffer;
+  buffer.Reset();
+  EXPECT_EQ('a', copy.data()[99]);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
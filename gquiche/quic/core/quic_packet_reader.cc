@@ -4,7 +4,10 @@
 
 #include "gquiche/quic/core/quic_packet_reader.h"
 
+#include <algorithm>
+
 #include "absl/base/macros.h"
+#include "gquiche/quic/core/quic_constants.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/core/quic_process_packet_interface.h"
 #include "gquiche/quic/platform/api/quic_bug_tracker.h"
@@ -17,19 +20,29 @@
 
 namespace quic {
 
-QuicPacketReader::QuicPacketReader()
-    : read_buffers_(kNumPacketsPerReadMmsgCall),
-      read_results_(kNumPacketsPerReadMmsgCall) {
-  QUICHE_DCHECK_EQ(read_buffers_.size(), read_results_.size());
-  for (size_t i = 0; i < read_results_.size(); ++i) {
-    read_results_[i].packet_buffer.buffer = read_buffers_[i].packet_buffer;
-    read_results_[i].packet_buffer.buffer_len =
-        sizeof(read_buffers_[i].packet_buffer);
+namespace {
 
-    read_results_[i].control_buffer.buffer = read_buffers_[i].control_buffer;
-    read_results_[i].control_buffer.buffer_len =
-        sizeof(read_buffers_[i].control_buffer);
-  }
+size_t RoundUpToCacheLine(size_t size) {
+  return (size + ABSL_CACHELINE_SIZE - 1) / ABSL_CACHELINE_SIZE *
+         ABSL_CACHELINE_SIZE;
+}
+
+}  // namespace
+
+QuicPacketReader::QuicPacketReader() : QuicPacketReader(false) {}
+
+QuicPacketReader::QuicPacketReader(bool enable_gro)
+    : gro_enabled_(enable_gro),
+      max_read_batch_size_(enable_gro ? kMaxGroBuffersPerReadMmsgCall
+                                      : kMaxPacketsPerReadMmsgCall),
+      packet_buffer_size_(RoundUpToCacheLine(
+          enable_gro ? kGroReadBufferSize : kMaxIncomingPacketSize)),
+      control_buffers_(max_read_batch_size_),
+      buffer_pool_(packet_buffer_size_, max_read_batch_size_),
+      packet_buffers_(max_read_batch_size_) {
+  read_results_.reserve(max_read_batch_size_);
+  SetReadBatchSize(std::min<size_t>(kNumPacketsPerReadMmsgCall,
+                                    max_read_batch_size_));
 }
 
 QuicPacketReader::~QuicPacketReader() = default;
@@ -37,25 +50,32 @@ QuicPacketReader::~QuicPacketReader() = default;
 bool QuicPacketReader::ReadAndDispatchPackets(
     int fd, int port, const QuicClock& clock, ProcessPacketInterface* processor,
     QuicPacketCount* /*packets_dropped*/) {
-  // Reset all read_results for reuse.
+  // Reset all read_results for reuse, replacing the buffers still referenced
+  // by packets of the previous reads.
   for (size_t i = 0; i < read_results_.size(); ++i) {
-    read_results_[i].Reset(
-        /*packet_buffer_length=*/sizeof(read_buffers_[i].packet_buffer));
+    if (packet_buffers_[i].ref_count() != 1) {
+      packet_buffers_[i] = buffer_pool_.Acquire();
+    }
+    read_results_[i].packet_buffer.buffer = packet_buffers_[i].data();
+    read_results_[i].Reset(/*packet_buffer_length=*/packet_buffer_size_);
   }
 
   // Use clock.Now() as the packet receipt time, the time between packet
   // arriving at the host and now is considered part of the network delay.
   QuicTime now = clock.Now();
 
+  BitMask64 packet_info_interested(
+      QuicUdpPacketInfoBit::DROPPED_PACKETS, QuicUdpPacketInfoBit::PEER_ADDRESS,
+      QuicUdpPacketInfoBit::V4_SELF_IP, QuicUdpPacketInfoBit::V6_SELF_IP,
+      QuicUdpPacketInfoBit::RECV_TIMESTAMP, QuicUdpPacketInfoBit::TTL,
+      QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER);
+  if (gro_enabled_) {
+    packet_info_interested.Set(QuicUdpPacketInfoBit::IS_GRO);
+  }
+  const size_t batch_size = read_results_.size();
   size_t packets_read = socket_api_.ReadMultiplePackets(
-      fd,
-      BitMask64(QuicUdpPacketInfoBit::DROPPED_PACKETS,
-                QuicUdpPacketInfoBit::PEER_ADDRESS,
-                QuicUdpPacketInfoBit::V4_SELF_IP,
-                QuicUdpPacketInfoBit::V6_SELF_IP,
-                QuicUdpPacketInfoBit::RECV_TIMESTAMP, QuicUdpPacketInfoBit::TTL,
-                QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER),
-      &read_results_);
+      fd, packet_info_interested, &read_results_);
+  PacketBatch batch(processor);
   for (size_t i = 0; i < packets_read; ++i) {
     auto& result = read_results_[i];
     if (!result.ok) {
@@ -63,48 +83,106 @@ bool QuicPacketReader::ReadAndDispatchPackets(
       continue;
     }
 
-    if (!result.packet_info.HasValue(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
-      QUIC_BUG(quic_bug_10329_1) << "Unable to get peer socket address.";
-      continue;
+    QuicPooledPacketBuffer pooled_buffer;
+    if (!gro_enabled_) {
+      pooled_buffer = packet_buffers_[i];
     }
+    DispatchPackets(result.packet_buffer.buffer,
+                    result.packet_buffer.buffer_len, result.packet_info, port,
+                    now, pooled_buffer, &batch);
+  }
+  batch.Flush();
 
-    QuicSocketAddress peer_address =
-        result.packet_info.peer_address().Normalized();
+  AdaptReadBatchSize(packets_read);
+  // We may not have read all of the packets available on the socket.
+  return packets_read == batch_size;
+}
 
-    QuicIpAddress self_ip = GetSelfIpFromPacketInfo(
-        result.packet_info, peer_address.host().IsIPv6());
-    if (!self_ip.IsInitialized()) {
-      QUIC_BUG(quic_bug_10329_2) << "Unable to get self IP address.";
-      continue;
-    }
+// static
+void QuicPacketReader::DispatchPackets(
+    char* buffer, size_t length, const QuicUdpPacketInfo& packet_info,
+    int port, QuicTime now, const QuicPooledPacketBuffer& pooled_buffer,
+    PacketBatch* batch) {
+  if (!packet_info.HasValue(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
+    QUIC_BUG(quic_bug_10329_1) << "Unable to get peer socket address.";
+    return;
+  }
 
-    bool has_ttl = result.packet_info.HasValue(QuicUdpPacketInfoBit::TTL);
-    int ttl = has_ttl ? result.packet_info.ttl() : 0;
-    if (!has_ttl) {
-      QUIC_CODE_COUNT(quic_packet_reader_no_ttl);
-    }
+  QuicSocketAddress peer_address = packet_info.peer_address().Normalized();
 
-    char* headers = nullptr;
-    size_t headers_length = 0;
-    if (result.packet_info.HasValue(
-            QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER)) {
-      headers = result.packet_info.google_packet_headers().buffer;
-      headers_length = result.packet_info.google_packet_headers().buffer_len;
-    } else {
-      QUIC_CODE_COUNT(quic_packet_reader_no_google_packet_header);
-    }
+  QuicIpAddress self_ip =
+      GetSelfIpFromPacketInfo(packet_info, peer_address.host().IsIPv6());
+  if (!self_ip.IsInitialized()) {
+    QUIC_BUG(quic_bug_10329_2) << "Unable to get self IP address.";
+    return;
+  }
 
-    QuicReceivedPacket packet(
-        result.packet_buffer.buffer, result.packet_buffer.buffer_len, now,
-        /*owns_buffer=*/false, ttl, has_ttl, headers, headers_length,
-        /*owns_header_buffer=*/false);
+  bool has_ttl = packet_info.HasValue(QuicUdpPacketInfoBit::TTL);
+  int ttl = has_ttl ? packet_info.ttl() : 0;
+  if (!has_ttl) {
+    QUIC_CODE_COUNT(quic_packet_reader_no_ttl);
+  }
 
-    QuicSocketAddress self_address(self_ip, port);
-    processor->ProcessPacket(self_address, peer_address, packet);
+  char* headers = nullptr;
+  size_t headers_length = 0;
+  if (packet_info.HasValue(QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER)) {
+    headers = packet_info.google_packet_headers().buffer;
+    headers_length = packet_info.google_packet_headers().buffer_len;
+  } else {
+    QUIC_CODE_COUNT(quic_packet_reader_no_google_packet_header);
   }
 
-  // We may not have read all of the packets available on the socket.
-  return packets_read == kNumPacketsPerReadMmsgCall;
+  QuicSocketAddress self_address(self_ip, port);
+  // A GRO buffer holds datagrams of |segment_size| bytes, but for the last
+  // one which may be shorter. Each is handed out in place, and so is an
+  // empty datagram.
+  size_t segment_size = length;
+  if (packet_info.HasValue(QuicUdpPacketInfoBit::IS_GRO) &&
+      packet_info.gso_size() > 0) {
+    segment_size = packet_info.gso_size();
+  }
+  size_t offset = 0;
+  do {
+    batch->Add(self_address, peer_address, buffer + offset,
+               std::min(segment_size, length - offset), now, pooled_buffer,
+               ttl, has_ttl, headers, headers_length,
+               /*owns_header_buffer=*/false);
+    offset += segment_size;
+  } while (offset < length);
+}
+
+void QuicPacketReader::PacketBatch::Flush() {
+  if (size_ == 0) {
+    return;
+  }
+  processor_->ProcessPackets(absl::MakeConstSpan(entries_, size_));
+  for (size_t i = 0; i < size_; ++i) {
+    packets_[i].reset();
+  }
+  size_ = 0;
+}
+
+void QuicPacketReader::AdaptReadBatchSize(size_t packets_read) {
+  const size_t batch_size = read_results_.size();
+  if (packets_read == batch_size) {
+    SetReadBatchSize(std::min(batch_size * 2, max_read_batch_size_));
+  } else if (packets_read < batch_size / 2) {
+    SetReadBatchSize(std::max<size_t>(
+        batch_size / 2,
+        std::min<size_t>(kMinPacketsPerReadMmsgCall, max_read_batch_size_)));
+  }
+}
+
+void QuicPacketReader::SetReadBatchSize(size_t batch_size) {
+  const size_t old_batch_size = read_results_.size();
+  // |read_results_| never outgrows the capacity reserved in the constructor.
+  read_results_.resize(batch_size);
+  // Packet buffers are assigned before each read.
+  for (size_t i = old_batch_size; i < batch_size; ++i) {
+    read_results_[i].control_buffer.buffer = control_buffers_[i].buffer;
+    read_results_[i].control_buffer.buffer_len =
+        sizeof(control_buffers_[i].buffer);
+  }
 }
 
 // static
@@ -7,8 +7,14 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_PACKET_READER_H_
 #define QUICHE_QUIC_CORE_QUIC_PACKET_READER_H_
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/base/optimization.h"
+#include "absl/types/optional.h"
 #include "gquiche/quic/core/quic_clock.h"
+#include "gquiche/quic/core/quic_packet_buffer_pool.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/core/quic_process_packet_interface.h"
 #include "gquiche/quic/core/quic_udp_socket.h"
@@ -17,12 +23,30 @@
 
 namespace quic {
 
-// Read in larger batches to minimize recvmmsg overhead.
+// Read in larger batches to minimize recvmmsg overhead. The number of
+// buffers per recvmmsg starts at kNumPacketsPerReadMmsgCall and adapts to how
+// many packets are queued on the socket, between the min and max below.
 const int kNumPacketsPerReadMmsgCall = 16;
+const int kMinPacketsPerReadMmsgCall = 4;
+const int kMaxPacketsPerReadMmsgCall = 64;
+// With UDP GRO, each buffer receives up to 64KB of coalesced datagrams.
+const int kMaxGroBuffersPerReadMmsgCall = 16;
+const size_t kGroReadBufferSize = 64 * 1024;
+// Packets read are handed to the processor in batches of up to this many.
+const size_t kMaxPacketsPerDispatchBatch = 64;
 
 class QUIC_EXPORT_PRIVATE QuicPacketReader {
  public:
   QuicPacketReader();
+  // If |enable_gro| is true, the reader receives into buffers large enough for
+  // UDP GRO and splits them into datagrams by the UDP_GRO segment size. GRO
+  // itself is enabled on the socket with QuicUdpSocketApi::EnableUdpGro().
+  //
+  // Without GRO, the packets handed to the processor reference their pooled
+  // buffer, and the reader only reuses a buffer nothing else references.
+  // Cloning a packet copies it, so that a kept packet does not pin a whole
+  // read buffer.
+  explicit QuicPacketReader(bool enable_gro);
   QuicPacketReader(const QuicPacketReader&) = delete;
   QuicPacketReader& operator=(const QuicPacketReader&) = delete;
 
@@ -39,6 +63,57 @@ class QUIC_EXPORT_PRIVATE QuicPacketReader {
                                       ProcessPacketInterface* processor,
                                       QuicPacketCount* packets_dropped);
 
+  // The number of buffers the next read fills at most.
+  size_t read_batch_size() const { return read_results_.size(); }
+
+ protected:
+  // Collects the packets of a read, and hands them to the processor through
+  // ProcessPackets() when full and when destroyed. The packets must stay valid
+  // until then.
+  class QUIC_EXPORT_PRIVATE PacketBatch {
+   public:
+    explicit PacketBatch(ProcessPacketInterface* processor)
+        : processor_(processor) {}
+    PacketBatch(const PacketBatch&) = delete;
+    PacketBatch& operator=(const PacketBatch&) = delete;
+    ~PacketBatch() { Flush(); }
+
+    // Adds a packet constructed from |packet_args|.
+    template <typename... Args>
+    void Add(const QuicSocketAddress& self_address,
+             const QuicSocketAddress& peer_address, Args&&... packet_args) {
+      if (size_ == kMaxPacketsPerDispatchBatch) {
+        Flush();
+      }
+      packets_[size_].emplace(std::forward<Args>(packet_args)...);
+      entries_[size_].self_address = self_address;
+      entries_[size_].peer_address = peer_address;
+      entries_[size_].packet = &*packets_[size_];
+      ++size_;
+    }
+
+    // Hands the packets added so far to the processor.
+    void Flush();
+
+   private:
+    ProcessPacketInterface* processor_;
+    size_t size_ = 0;
+    absl::optional<QuicReceivedPacket> packets_[kMaxPacketsPerDispatchBatch];
+    ReceivedPacketWithAddresses entries_[kMaxPacketsPerDispatchBatch];
+  };
+
+  bool gro_enabled() const { return gro_enabled_; }
+  QuicUdpSocketApi& socket_api() { return socket_api_; }
+
+  // Adds the packet in |buffer| to |batch|, or each of the datagrams it holds
+  // if it was coalesced by UDP GRO. The packets reference |pooled_buffer|,
+  // which may be empty.
+  static void DispatchPackets(char* buffer, size_t length,
+                              const QuicUdpPacketInfo& packet_info, int port,
+                              QuicTime now,
+                              const QuicPooledPacketBuffer& pooled_buffer,
+                              PacketBatch* batch);
+
  private:
   // Return the self ip from |packet_info|.
   // For dual stack sockets, |packet_info| may contain both a v4 and a v6 ip, in
@@ -47,15 +122,28 @@ class QUIC_EXPORT_PRIVATE QuicPacketReader {
   static QuicIpAddress GetSelfIpFromPacketInfo(
       const QuicUdpPacketInfo& packet_info, bool prefer_v6_ip);
 
-  struct QUIC_EXPORT_PRIVATE ReadBuffer {
+  // Grows the batch after a read filled it, shrinks it after a read used
+  // less than half of it.
+  void AdaptReadBatchSize(size_t packets_read);
+  void SetReadBatchSize(size_t batch_size);
+
+  struct QUIC_EXPORT_PRIVATE ControlBuffer {
     ABSL_CACHELINE_ALIGNED char
-        control_buffer[kDefaultUdpPacketControlBufferSize];  // For ancillary
-                                                             // data.
-    ABSL_CACHELINE_ALIGNED char packet_buffer[kMaxIncomingPacketSize];
+        buffer[kDefaultUdpPacketControlBufferSize];  // For ancillary data.
   };
 
+  const bool gro_enabled_;
+  const size_t max_read_batch_size_;
+  // Size of each packet buffer.
+  const size_t packet_buffer_size_;
+
   QuicUdpSocketApi socket_api_;
-  std::vector<ReadBuffer> read_buffers_;
+  std::vector<ControlBuffer> control_buffers_;
+  // Buffers of |packet_buffer_size_| bytes.
+  QuicPacketBufferPool buffer_pool_;
+  // The buffer of each entry of |read_results_|.
+  std::vector<QuicPooledPacketBuffer> packet_buffers_;
+  // Sized to the current batch, pointing at the first buffers.
   QuicUdpSocketApi::ReadPacketResults read_results_;
 };
 
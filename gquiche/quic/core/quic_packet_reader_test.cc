@@ -0,0 +1,86 @@
+// Copyright 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gquiche/quic/core/quic_packet_reader.h"
+
+#include <vector>
+
+#include "gquiche/quic/platform/api/quic_ip_address.h"
+#include "gquiche/quic/platform/api/quic_socket_address.h"
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr int kPort = 443;
+
+// Records the length of each packet.
+class RecordingPacketProcessor : public ProcessPacketInterface {
+ public:
+  void ProcessPacket(const QuicSocketAddress& /*self_address*/,
+                     const QuicSocketAddress& /*peer_address*/,
+                     const QuicReceivedPacket& packet) override {
+    lengths_.push_back(packet.length());
+  }
+
+  const std::vector<size_t>& lengths() const { return lengths_; }
+
+ private:
+  std::vector<size_t> lengths_;
+};
+
+// Exposes the dispatching of read packets to the tests.
+class TestPacketReader : public QuicPacketReader {
+ public:
+  using QuicPacketReader::DispatchPackets;
+  using QuicPacketReader::PacketBatch;
+};
+
+class QuicPacketReaderTest : public QuicTest {
+ protected:
+  QuicPacketReaderTest() {
+    packet_info_.SetPeerAddress(
+        QuicSocketAddress(QuicIpAddress::Loopback4(), 1234));
+    packet_info_.SetSelfIp(QuicIpAddress::Loopback4());
+  }
+
+  // Dispatches |length| bytes of |buffer_| and returns the lengths of the
+  // packets handed to the processor.
+  std::vector<size_t> Dispatch(size_t length) {
+    RecordingPacketProcessor processor;
+    {
+      TestPacketReader::PacketBatch batch(&processor);
+      TestPacketReader::DispatchPackets(buffer_, length, packet_info_, kPort,
+                                        QuicTime::Zero(),
+                                        QuicPooledPacketBuffer(), &batch);
+    }
+    return processor.lengths();
+  }
+
+  char buffer_[kMaxIncomingPacketSize] = {};
+  QuicUdpPacketInfo packet_info_;
+};
+
+TEST_F(QuicPacketReaderTest, DispatchesPacket) {
+  EXPECT_EQ(std::vector<size_t>({100}), Dispatch(100));
+}
+
+TEST_F(QuicPacketReaderTest, DispatchesEmptyPacket) {
+  EXPECT_EQ(std::vector<size_t>({0}), Dispatch(0));
+}
+
+TEST_F(QuicPacketReaderTest, SplitsGroBuffer) {
+  packet_info_.set_gso_size(100);
+  EXPECT_EQ(std::vector<size_t>({100, 100, 50}), Dispatch(250));
+}
+
+TEST_F(QuicPacketReaderTest, DispatchesEmptyGroBuffer) {
+  packet_info_.set_gso_size(100);
+  EXPECT_EQ(std::vector<size_t>({0}), Dispatch(0));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -320,6 +320,12 @@ QuicEncryptedPacket::QuicEncryptedPacket(const char* buffer, size_t length,
 QuicEncryptedPacket::QuicEncryptedPacket(absl::string_view data)
     : QuicData(data) {}
 
+QuicEncryptedPacket::QuicEncryptedPacket(const char* buffer, size_t length,
+                                         QuicPooledPacketBuffer pooled_buffer)
+    : QuicData(buffer, length), pooled_buffer_(std::move(pooled_buffer)) {
+  QUICHE_DCHECK(!pooled_buffer_ || pooled_buffer_.Contains(buffer, length));
+}
+
 std::unique_ptr<QuicEncryptedPacket> QuicEncryptedPacket::Clone() const {
   char* buffer = new char[this->length()];
   memcpy(buffer, this->data(), this->length());
@@ -362,6 +368,20 @@ QuicReceivedPacket::QuicReceivedPacket(const char* buffer, size_t length,
       headers_length_(headers_length),
       owns_header_buffer_(owns_header_buffer) {}
 
+QuicReceivedPacket::QuicReceivedPacket(const char* buffer, size_t length,
+                                       QuicTime receipt_time,
+                                       QuicPooledPacketBuffer pooled_buffer,
+                                       int ttl, bool ttl_valid,
+                                       char* packet_headers,
+                                       size_t headers_length,
+                                       bool owns_header_buffer)
+    : QuicEncryptedPacket(buffer, length, std::move(pooled_buffer)),
+      receipt_time_(receipt_time),
+      ttl_(ttl_valid ? ttl : -1),
+      packet_headers_(packet_headers),
+      headers_length_(headers_length),
+      owns_header_buffer_(owns_header_buffer) {}
+
 QuicReceivedPacket::~QuicReceivedPacket() {
   if (owns_header_buffer_) {
     delete[] static_cast<char*>(packet_headers_);
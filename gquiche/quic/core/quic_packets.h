@@ -18,6 +18,7 @@
 #include "gquiche/quic/core/quic_bandwidth.h"
 #include "gquiche/quic/core/quic_constants.h"
 #include "gquiche/quic/core/quic_error_codes.h"
+#include "gquiche/quic/core/quic_packet_buffer_pool.h"
 #include "gquiche/quic/core/quic_time.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/core/quic_versions.h"
@@ -264,19 +265,30 @@ class QUIC_EXPORT_PRIVATE QuicEncryptedPacket : public QuicData {
   // Creates a QuicEncryptedPacket from a absl::string_view.
   // Does not own the buffer.
   QuicEncryptedPacket(absl::string_view data);
+  // Creates a QuicEncryptedPacket from a buffer and length within
+  // |pooled_buffer|, which it keeps a reference to.
+  QuicEncryptedPacket(const char* buffer, size_t length,
+                      QuicPooledPacketBuffer pooled_buffer);
 
   QuicEncryptedPacket(const QuicEncryptedPacket&) = delete;
   QuicEncryptedPacket& operator=(const QuicEncryptedPacket&) = delete;
 
-  // Clones the packet into a new packet which owns the buffer.
+  // Clones the packet into a new packet which owns the buffer. A pooled buffer
+  // is not shared, so a kept packet only holds on to its own bytes.
   std::unique_ptr<QuicEncryptedPacket> Clone() const;
 
+  // The pooled buffer holding the packet, if any.
+  const QuicPooledPacketBuffer& pooled_buffer() const { return pooled_buffer_; }
+
   // By default, gtest prints the raw bytes of an object. The bool data
   // member (in the base class QuicData) causes this object to have padding
   // bytes, which causes the default gtest object printer to read
   // uninitialize memory. So we need to teach gtest how to print this object.
   QUIC_EXPORT_PRIVATE friend std::ostream& operator<<(
       std::ostream& os, const QuicEncryptedPacket& s);
+
+ private:
+  QuicPooledPacketBuffer pooled_buffer_;
 };
 
 // A received encrypted QUIC packet, with a recorded time of receipt.
@@ -291,6 +303,11 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacket : public QuicEncryptedPacket {
                      bool owns_buffer, int ttl, bool ttl_valid,
                      char* packet_headers, size_t headers_length,
                      bool owns_header_buffer);
+  // The packet is within |pooled_buffer|, which it keeps a reference to.
+  QuicReceivedPacket(const char* buffer, size_t length, QuicTime receipt_time,
+                     QuicPooledPacketBuffer pooled_buffer, int ttl,
+                     bool ttl_valid, char* packet_headers,
+                     size_t headers_length, bool owns_header_buffer);
   ~QuicReceivedPacket();
   QuicReceivedPacket(const QuicReceivedPacket&) = delete;
   QuicReceivedPacket& operator=(const QuicReceivedPacket&) = delete;
@@ -328,6 +345,14 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacket : public QuicEncryptedPacket {
   bool owns_header_buffer_;
 };
 
+// A received packet with the addresses it was received on and from, as handed
+// to packet processors in batches. Does not own |packet|.
+struct QUIC_EXPORT_PRIVATE ReceivedPacketWithAddresses {
+  QuicSocketAddress self_address;
+  QuicSocketAddress peer_address;
+  const QuicReceivedPacket* packet = nullptr;
+};
+
 // SerializedPacket contains information of a serialized(encrypted) packet.
 //
 // WARNING:
@@ -107,6 +107,41 @@ TEST_F(QuicPacketsTest, CopySerializedPacket) {
   EXPECT_EQ(1000u, copy2->encrypted_length);
 }
 
+TEST_F(QuicPacketsTest, CloneCopiesPooledPacket) {
+  QuicPacketBufferPool pool(kMaxIncomingPacketSize, 1);
+  QuicPooledPacketBuffer buffer = pool.Acquire();
+  memset(buffer.data(), 'a', 100);
+  char headers[] = "headers";
+  QuicReceivedPacket packet(buffer.data() + 10, 80, QuicTime::Zero(), buffer,
+                            /*ttl=*/5, /*ttl_valid=*/true, headers,
+                            sizeof(headers), /*owns_header_buffer=*/false);
+  buffer.Reset();
+
+  std::unique_ptr<QuicReceivedPacket> clone = packet.Clone();
+  EXPECT_NE(packet.data(), clone->data());
+  EXPECT_EQ(packet.AsStringPiece(), clone->AsStringPiece());
+  EXPECT_EQ(5, clone->ttl());
+  EXPECT_FALSE(clone->pooled_buffer());
+  EXPECT_NE(headers, clone->packet_headers());
+  EXPECT_EQ(std::string(headers), std::string(clone->packet_headers()));
+
+  std::unique_ptr<QuicEncryptedPacket> encrypted_clone =
+      static_cast<const QuicEncryptedPacket&>(packet).Clone();
+  EXPECT_NE(packet.data(), encrypted_clone->data());
+  EXPECT_FALSE(encrypted_clone->pooled_buffer());
+  // Only the original packet references the buffer.
+  EXPECT_EQ(1, packet.pooled_buffer().ref_count());
+}
+
+TEST_F(QuicPacketsTest, CloneCopiesUnpooledPacket) {
+  char data[] = "packet";
+  QuicReceivedPacket packet(data, sizeof(data), QuicTime::Zero());
+  std::unique_ptr<QuicReceivedPacket> clone = packet.Clone();
+  EXPECT_NE(packet.data(), clone->data());
+  EXPECT_FALSE(clone->pooled_buffer());
+  EXPECT_EQ(packet.AsStringPiece(), clone->AsStringPiece());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_PROCESS_PACKET_INTERFACE_H_
 #define QUICHE_QUIC_CORE_QUIC_PROCESS_PACKET_INTERFACE_H_
 
+#include "absl/types/span.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/platform/api/quic_socket_address.h"
 
@@ -17,6 +18,15 @@ class QUIC_NO_EXPORT ProcessPacketInterface {
   virtual void ProcessPacket(const QuicSocketAddress& self_address,
                              const QuicSocketAddress& peer_address,
                              const QuicReceivedPacket& packet) = 0;
+
+  // Processes |packets|, which were read together, in order. Implementations
+  // may override this to amortize per-packet work across the batch.
+  virtual void ProcessPackets(
+      absl::Span<const ReceivedPacketWithAddresses> packets) {
+    for (const ReceivedPacketWithAddresses& packet : packets) {
+      ProcessPacket(packet.self_address, packet.peer_address, *packet.packet);
+    }
+  }
 };
 
 }  // namespace quic
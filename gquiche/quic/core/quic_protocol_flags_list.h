@@ -180,6 +180,10 @@ QUIC_PROTOCOL_FLAG(
 QUIC_PROTOCOL_FLAG(int32_t, quic_max_congestion_window, 2000,
                    "The maximum congestion window in packets.")
 
+QUIC_PROTOCOL_FLAG(bool, quic_enable_pcc_sender, false,
+                   "If true, the PCC connection option selects PccSender. "
+                   "Otherwise it is ignored and kPCC creates a CUBIC sender.")
+
 QUIC_PROTOCOL_FLAG(
     int32_t, quic_max_streams_window_divisor, 2,
     "The divisor that controls how often MAX_STREAMS frame is sent.")
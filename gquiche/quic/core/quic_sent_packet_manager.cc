@@ -141,6 +141,10 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
     QUIC_RELOADABLE_FLAG_COUNT(quic_allow_client_enabled_bbr_v2);
     SetSendAlgorithm(kBBRv2);
   }
+  if (GetQuicFlag(FLAGS_quic_enable_pcc_sender) &&
+      config.HasClientRequestedIndependentOption(kTPCC, perspective)) {
+    SetSendAlgorithm(kPCC);
+  }
 
   if (config.HasClientRequestedIndependentOption(kRENO, perspective)) {
     SetSendAlgorithm(kRenoBytes);
@@ -235,6 +239,9 @@ void QuicSentPacketManager::ApplyConnectionOptions(
     cc_type = kBBRv2;
   } else if (ContainsQuicTag(connection_options, kTBBR)) {
     cc_type = kBBR;
+  } else if (GetQuicFlag(FLAGS_quic_enable_pcc_sender) &&
+             ContainsQuicTag(connection_options, kTPCC)) {
+    cc_type = kPCC;
   } else if (ContainsQuicTag(connection_options, kRENO)) {
     cc_type = kRenoBytes;
   } else if (ContainsQuicTag(connection_options, kQBIC)) {
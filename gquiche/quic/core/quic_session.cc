@@ -769,6 +769,22 @@ void QuicSession::ProcessUdpPacket(const QuicSocketAddress& self_address,
   connection_->ProcessUdpPacket(self_address, peer_address, packet);
 }
 
+size_t QuicSession::ProcessUdpPackets(
+    absl::Span<const ReceivedPacketWithAddresses> packets) {
+  QuicConnectionContextSwitcher cs(connection_->context());
+  // The flushers of the individual packets nest within this one.
+  QuicConnection::ScopedPacketFlusher flusher(connection_);
+  size_t num_processed = 0;
+  for (const ReceivedPacketWithAddresses& packet : packets) {
+    if (!connection_->connected()) {
+      break;
+    }
+    ProcessUdpPacket(packet.self_address, packet.peer_address, *packet.packet);
+    ++num_processed;
+  }
+  return num_processed;
+}
+
 QuicConsumedData QuicSession::WritevData(QuicStreamId id, size_t write_length,
                                          QuicStreamOffset offset,
                                          StreamSendingState state,
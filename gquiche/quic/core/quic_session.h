@@ -214,6 +214,15 @@ class QUIC_EXPORT_PRIVATE QuicSession
                                 const QuicSocketAddress& peer_address,
                                 const QuicReceivedPacket& packet);
 
+  // Called with consecutive incoming packets for this session. Passes each of
+  // |packets| to ProcessUdpPacket, under one packet flusher so that queued
+  // frames are flushed and the ACK alarm is updated once after the last one.
+  // The packets are not decrypted as a group: each is decrypted and its frames
+  // processed before the next one. Stops if the connection closes, and
+  // returns the number of packets processed.
+  virtual size_t ProcessUdpPackets(
+      absl::Span<const ReceivedPacketWithAddresses> packets);
+
   // Sends |message| as a QUIC DATAGRAM frame (QUIC MESSAGE frame in gQUIC).
   // See <https://datatracker.ietf.org/doc/html/draft-ietf-quic-datagram> for
   // more details.
@@ -100,10 +100,12 @@ void QuicTimeWaitListManager::AddConnectionIdDataToMap(
   for (const auto& cid : info.active_connection_ids) {
     indirect_connection_id_map_[cid] = canonical_connection_id;
   }
-  ConnectionIdData data(num_packets, clock_->ApproximateNow(), action,
-                        std::move(info));
-  connection_id_map_.emplace(
-      std::make_pair(canonical_connection_id, std::move(data)));
+  const uint64_t sequence_number = next_sequence_number_++;
+  expiration_queue_.push_back({canonical_connection_id, sequence_number});
+  ConnectionIdData data(num_packets, clock_->ApproximateNow(), sequence_number,
+                        action, std::move(info));
+  connection_id_map_.emplace(canonical_connection_id, std::move(data));
+  MaybeCompactExpirationQueue();
 }
 
 void QuicTimeWaitListManager::RemoveConnectionDataFromMap(
@@ -112,6 +114,45 @@ void QuicTimeWaitListManager::RemoveConnectionDataFromMap(
     indirect_connection_id_map_.erase(cid);
   }
   connection_id_map_.erase(it);
+  if (connection_id_map_.empty()) {
+    // Every record left is stale.
+    expiration_queue_.clear();
+  }
+}
+
+bool QuicTimeWaitListManager::IsStale(const ExpirationRecord& record) const {
+  auto it = connection_id_map_.find(record.canonical_connection_id);
+  return it == connection_id_map_.end() ||
+         it->second.sequence_number != record.sequence_number;
+}
+
+void QuicTimeWaitListManager::MaybeCompactExpirationQueue() {
+  // Entries re-added over and over leave stale records behind faster than
+  // expiry drops them from the front. Compacting once they outnumber the
+  // entries keeps the queue within twice the map, in amortized O(1).
+  if (expiration_queue_.size() <=
+      kMaxExpirationRecordsPerConnection * connection_id_map_.size()) {
+    return;
+  }
+  quiche::QuicheCircularDeque<ExpirationRecord> live_records;
+  for (const ExpirationRecord& record : expiration_queue_) {
+    if (!IsStale(record)) {
+      live_records.push_back(record);
+    }
+  }
+  expiration_queue_.swap(live_records);
+}
+
+QuicTimeWaitListManager::ConnectionIdMap::iterator
+QuicTimeWaitListManager::OldestConnection() {
+  while (!expiration_queue_.empty()) {
+    const ExpirationRecord& record = expiration_queue_.front();
+    if (!IsStale(record)) {
+      return connection_id_map_.find(record.canonical_connection_id);
+    }
+    expiration_queue_.pop_front();
+  }
+  return connection_id_map_.end();
 }
 
 void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
@@ -151,8 +192,7 @@ bool QuicTimeWaitListManager::IsConnectionIdInTimeWait(
 void QuicTimeWaitListManager::OnBlockedWriterCanWrite() {
   writer_->SetWritable();
   while (!pending_packets_queue_.empty()) {
-    QueuedPacket* queued_packet = pending_packets_queue_.front().get();
-    if (!WriteToWire(queued_packet)) {
+    if (!WriteToWire(*pending_packets_queue_.front())) {
       return;
     }
     pending_packets_queue_.pop_front();
@@ -191,10 +231,10 @@ void QuicTimeWaitListManager::ProcessPacket(
                   << " ietf=" << connection_data->info.ietf_quic
                   << ", action=" << connection_data->action
                   << ", number termination packets="
-                  << connection_data->info.termination_packets.size();
+                  << connection_data->termination_packets.size();
   switch (connection_data->action) {
     case SEND_TERMINATION_PACKETS:
-      if (connection_data->info.termination_packets.empty()) {
+      if (connection_data->termination_packets.empty()) {
         QUIC_BUG(quic_bug_10608_1) << "There are no termination packets.";
         return;
       }
@@ -220,22 +260,22 @@ void QuicTimeWaitListManager::ProcessPacket(
           break;
       }
 
-      for (const auto& packet : connection_data->info.termination_packets) {
-        SendOrQueuePacket(std::make_unique<QueuedPacket>(
-                              self_address, peer_address, packet->Clone()),
-                          packet_context.get());
+      for (const auto& packet : connection_data->termination_packets) {
+        SendOrQueuePacket(
+            std::make_unique<QueuedPacket>(self_address, peer_address, packet),
+            packet_context.get());
       }
       return;
 
     case SEND_CONNECTION_CLOSE_PACKETS:
-      if (connection_data->info.termination_packets.empty()) {
+      if (connection_data->termination_packets.empty()) {
         QUIC_BUG(quic_bug_10608_2) << "There are no termination packets.";
         return;
       }
-      for (const auto& packet : connection_data->info.termination_packets) {
-        SendOrQueuePacket(std::make_unique<QueuedPacket>(
-                              self_address, peer_address, packet->Clone()),
-                          packet_context.get());
+      for (const auto& packet : connection_data->termination_packets) {
+        SendOrQueuePacket(
+            std::make_unique<QueuedPacket>(self_address, peer_address, packet),
+            packet_context.get());
       }
       return;
 
@@ -362,7 +402,7 @@ bool QuicTimeWaitListManager::SendOrQueuePacket(
     QUIC_CODE_COUNT(quic_too_many_pending_packets_in_time_wait);
     return true;
   }
-  if (WriteToWire(packet.get())) {
+  if (WriteToWire(*packet)) {
     // Allow the packet to be deleted upon leaving this function.
     return true;
   }
@@ -370,19 +410,20 @@ bool QuicTimeWaitListManager::SendOrQueuePacket(
   return false;
 }
 
-bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
+bool QuicTimeWaitListManager::WriteToWire(const QueuedPacket& queued_packet) {
   if (writer_->IsWriteBlocked()) {
     visitor_->OnWriteBlocked(this);
     return false;
   }
   WriteResult result = writer_->WritePacket(
-      queued_packet->packet()->data(), queued_packet->packet()->length(),
-      queued_packet->self_address().host(), queued_packet->peer_address(),
+      queued_packet.packet()->data(), queued_packet.packet()->length(),
+      queued_packet.self_address().host(), queued_packet.peer_address(),
       nullptr);
 
-  // If using a batch writer and the packet is buffered, flush it.
-  if (writer_->IsBatchMode() && result.status == WRITE_STATUS_OK &&
-      result.bytes_written == 0) {
+  // If using a batch writer and the packet is buffered, flush it, unless the
+  // owner of the writer flushes the whole batch.
+  if (writer_->IsBatchMode() && !defer_batch_flush_ &&
+      result.status == WRITE_STATUS_OK && result.bytes_written == 0) {
     result = writer_->Flush();
   }
 
@@ -394,7 +435,7 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
   } else if (IsWriteError(result.status)) {
     QUIC_LOG_FIRST_N(WARNING, 1)
         << "Received unknown error while sending termination packet to "
-        << queued_packet->peer_address().ToString() << ": "
+        << queued_packet.peer_address().ToString() << ": "
         << strerror(result.error_code);
   }
   return true;
@@ -402,9 +443,9 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
 
 void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
   QuicTime::Delta next_alarm_interval = QuicTime::Delta::Zero();
-  if (!connection_id_map_.empty()) {
-    QuicTime oldest_connection_id =
-        connection_id_map_.begin()->second.time_added;
+  auto oldest = OldestConnection();
+  if (oldest != connection_id_map_.end()) {
+    QuicTime oldest_connection_id = oldest->second.time_added;
     QuicTime now = clock_->ApproximateNow();
     if (now - oldest_connection_id < time_wait_period_) {
       next_alarm_interval = oldest_connection_id + time_wait_period_ - now;
@@ -423,10 +464,10 @@ void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
 
 bool QuicTimeWaitListManager::MaybeExpireOldestConnection(
     QuicTime expiration_time) {
-  if (connection_id_map_.empty()) {
+  auto it = OldestConnection();
+  if (it == connection_id_map_.end()) {
     return false;
   }
-  auto it = connection_id_map_.begin();
   QuicTime oldest_connection_id_time = it->second.time_added;
   if (oldest_connection_id_time > expiration_time) {
     // Too recent, don't retire.
@@ -467,12 +508,20 @@ void QuicTimeWaitListManager::TrimTimeWaitListIfNeeded() {
 }
 
 QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
-    int num_packets, QuicTime time_added, TimeWaitAction action,
-    TimeWaitConnectionInfo info)
+    int num_packets, QuicTime time_added, uint64_t sequence_number,
+    TimeWaitAction action, TimeWaitConnectionInfo info)
     : num_packets(num_packets),
       time_added(time_added),
+      sequence_number(sequence_number),
       action(action),
-      info(std::move(info)) {}
+      info(std::move(info)) {
+  termination_packets.reserve(this->info.termination_packets.size());
+  for (auto& packet : this->info.termination_packets) {
+    termination_packets.push_back(std::move(packet));
+  }
+  this->info.termination_packets.clear();
+  this->info.termination_packets.shrink_to_fit();
+}
 
 QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
     ConnectionIdData&& other) = default;
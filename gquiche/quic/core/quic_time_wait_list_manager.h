@@ -9,7 +9,9 @@
 #define QUICHE_QUIC_CORE_QUIC_TIME_WAIT_LIST_MANAGER_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "gquiche/quic/core/quic_blocked_writer_interface.h"
@@ -20,7 +22,7 @@
 #include "gquiche/quic/core/quic_session.h"
 #include "gquiche/quic/core/quic_types.h"
 #include "gquiche/quic/platform/api/quic_flags.h"
-#include "gquiche/common/quiche_linked_hash_map.h"
+#include "gquiche/common/quiche_circular_deque.h"
 
 namespace quic {
 
@@ -171,6 +173,14 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // Return a non-owning pointer to the packet writer.
   QuicPacketWriter* writer() { return writer_; }
 
+  // If true, packets buffered by a batch writer are not flushed one by one,
+  // so the responses to a burst of packets in time wait go out in a few
+  // batches. The owner of the writer must then flush it after each batch of
+  // received packets. Has no effect on writers not in batch mode.
+  void set_defer_batch_flush(bool defer_batch_flush) {
+    defer_batch_flush_ = defer_batch_flush;
+  }
+
  protected:
   virtual std::unique_ptr<QuicEncryptedPacket> BuildPublicReset(
       const QuicPublicResetPacket& packet);
@@ -191,12 +201,21 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
         : self_address_(self_address),
           peer_address_(peer_address),
           packet_(std::move(packet)) {}
+    // Shares |packet| instead of copying it, used for termination packets.
+    QueuedPacket(const QuicSocketAddress& self_address,
+                 const QuicSocketAddress& peer_address,
+                 std::shared_ptr<const QuicEncryptedPacket> packet)
+        : self_address_(self_address),
+          peer_address_(peer_address),
+          shared_packet_(std::move(packet)) {}
     QueuedPacket(const QueuedPacket&) = delete;
     QueuedPacket& operator=(const QueuedPacket&) = delete;
 
     const QuicSocketAddress& self_address() const { return self_address_; }
     const QuicSocketAddress& peer_address() const { return peer_address_; }
-    QuicEncryptedPacket* packet() { return packet_.get(); }
+    const QuicEncryptedPacket* packet() const {
+      return packet_ != nullptr ? packet_.get() : shared_packet_.get();
+    }
 
    private:
     // Server address on which a packet was received for a connection_id in
@@ -204,8 +223,10 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
     const QuicSocketAddress self_address_;
     // Address of the peer to send this packet to.
     const QuicSocketAddress peer_address_;
-    // The pending termination packet that is to be sent to the peer.
+    // The pending termination packet that is to be sent to the peer, either
+    // owned or shared with the time-wait list.
     std::unique_ptr<QuicEncryptedPacket> packet_;
+    std::shared_ptr<const QuicEncryptedPacket> shared_packet_;
   };
 
   // Called right after |packet| is serialized. Either sends the packet and
@@ -233,7 +254,7 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // If the writer got blocked and did not buffer the packet, we'll need to keep
   // the packet and retry sending. In case of all other errors we drop the
   // packet.
-  bool WriteToWire(QueuedPacket* packet);
+  bool WriteToWire(const QueuedPacket& packet);
 
   // Register the alarm server to wake up at appropriate time.
   void SetConnectionIdCleanUpAlarm();
@@ -260,7 +281,8 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
   // connection_id.
   struct QUIC_NO_EXPORT ConnectionIdData {
     ConnectionIdData(int num_packets, QuicTime time_added,
-                     TimeWaitAction action, TimeWaitConnectionInfo info);
+                     uint64_t sequence_number, TimeWaitAction action,
+                     TimeWaitConnectionInfo info);
 
     ConnectionIdData(const ConnectionIdData& other) = delete;
     ConnectionIdData(ConnectionIdData&& other);
@@ -269,20 +291,50 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
 
     int num_packets;
     QuicTime time_added;
+    // Identifies the record of this entry in expiration_queue_.
+    uint64_t sequence_number;
     TimeWaitAction action;
+    // |info|.termination_packets is moved to |termination_packets|.
     TimeWaitConnectionInfo info;
+    // Shared with the queued copies of the packets, so they are never cloned.
+    std::vector<std::shared_ptr<const QuicEncryptedPacket>>
+        termination_packets;
   };
 
-  // QuicheLinkedHashMap allows lookup by ConnectionId
-  // and traversal in add order.
+  // An open addressing table, the add order is kept by expiration_queue_.
   using ConnectionIdMap =
-      quiche::QuicheLinkedHashMap<QuicConnectionId, ConnectionIdData,
-                                  QuicConnectionIdHash>;
+      absl::flat_hash_map<QuicConnectionId, ConnectionIdData,
+                          QuicConnectionIdHash>;
   // Do not use find/emplace/erase on this map directly. Use
   // FindConnectionIdDataInMap, AddConnectionIdDateToMap,
   // RemoveConnectionDataFromMap instead.
   ConnectionIdMap connection_id_map_;
 
+  // An entry of connection_id_map_ in add order. Replacing or removing an
+  // entry leaves its record behind, records whose sequence number does not
+  // match the entry any more are skipped.
+  struct QUIC_NO_EXPORT ExpirationRecord {
+    QuicConnectionId canonical_connection_id;
+    uint64_t sequence_number;
+  };
+  quiche::QuicheCircularDeque<ExpirationRecord> expiration_queue_;
+  uint64_t next_sequence_number_ = 0;
+
+  // expiration_queue_ is compacted when it holds more records than this
+  // many per entry of connection_id_map_.
+  static constexpr size_t kMaxExpirationRecordsPerConnection = 2;
+
+  // Returns true if |record| no longer matches an entry of
+  // connection_id_map_.
+  bool IsStale(const ExpirationRecord& record) const;
+
+  // Drops the stale records of expiration_queue_ if there are too many.
+  void MaybeCompactExpirationQueue();
+
+  // Returns the oldest entry of connection_id_map_, or end() if the map is
+  // empty. Drops the stale records in front of it.
+  ConnectionIdMap::iterator OldestConnection();
+
   // TODO(haoyuewang) Consider making connection_id_map_ a map of shared pointer
   // and remove the indirect map.
   // A connection can have multiple unretired ConnectionIds when it is closed.
@@ -324,6 +376,8 @@ class QUIC_NO_EXPORT QuicTimeWaitListManager
 
   // Interface that manages blocked writers.
   Visitor* visitor_;
+
+  bool defer_batch_flush_ = false;
 };
 
 }  // namespace quic
@@ -350,6 +350,53 @@ TEST_F(QuicTimeWaitListManagerTest, SendTwoConnectionCloses) {
   ProcessPacket(connection_id_);
 }
 
+TEST_F(QuicTimeWaitListManagerTest, TerminationPacketsAreNotCopied) {
+  const size_t kConnectionCloseLength = 100;
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id_));
+  std::vector<std::unique_ptr<QuicEncryptedPacket>> termination_packets;
+  termination_packets.push_back(
+      std::unique_ptr<QuicEncryptedPacket>(new QuicEncryptedPacket(
+          new char[kConnectionCloseLength], kConnectionCloseLength, true)));
+  const char* termination_data = termination_packets[0]->data();
+  AddConnectionId(connection_id_, QuicVersionMax(),
+                  QuicTimeWaitListManager::SEND_CONNECTION_CLOSE_PACKETS,
+                  &termination_packets);
+  // The first and second packets are responded to.
+  EXPECT_CALL(writer_, WritePacket(termination_data, kConnectionCloseLength,
+                                   self_address_.host(), peer_address_, _))
+      .Times(2)
+      .WillRepeatedly(Return(WriteResult(WRITE_STATUS_OK, 1)));
+
+  ProcessPacket(connection_id_);
+  ProcessPacket(connection_id_);
+}
+
+TEST_F(QuicTimeWaitListManagerTest, DeferBatchFlush) {
+  const size_t kConnectionCloseLength = 100;
+  EXPECT_CALL(writer_, IsBatchMode()).WillRepeatedly(Return(true));
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id_));
+  std::vector<std::unique_ptr<QuicEncryptedPacket>> termination_packets;
+  termination_packets.push_back(
+      std::unique_ptr<QuicEncryptedPacket>(new QuicEncryptedPacket(
+          new char[kConnectionCloseLength], kConnectionCloseLength, true)));
+  AddConnectionId(connection_id_, QuicVersionMax(),
+                  QuicTimeWaitListManager::SEND_CONNECTION_CLOSE_PACKETS,
+                  &termination_packets);
+  EXPECT_CALL(writer_, WritePacket(_, kConnectionCloseLength,
+                                   self_address_.host(), peer_address_, _))
+      .WillRepeatedly(Return(WriteResult(WRITE_STATUS_OK, 0)));
+
+  // Buffered packets are flushed after each write by default.
+  EXPECT_CALL(writer_, Flush())
+      .WillOnce(Return(WriteResult(WRITE_STATUS_OK, 0)));
+  ProcessPacket(connection_id_);
+
+  // Left to the owner of the writer once deferred.
+  time_wait_list_manager_.set_defer_batch_flush(true);
+  EXPECT_CALL(writer_, Flush()).Times(0);
+  ProcessPacket(connection_id_);
+}
+
 TEST_F(QuicTimeWaitListManagerTest, SendPublicReset) {
   EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id_));
   AddConnectionId(connection_id_,
@@ -440,6 +487,34 @@ TEST_F(QuicTimeWaitListManagerTest, CleanUpOldConnectionIds) {
             time_wait_list_manager_.num_connections());
 }
 
+TEST_F(QuicTimeWaitListManagerTest, ReAddedConnectionIdsDoNotPileUp) {
+  const QuicConnectionId old_connection_id = TestConnectionId(1);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(old_connection_id));
+  AddConnectionId(old_connection_id, QuicTimeWaitListManager::DO_NOTHING);
+
+  // Each re-add leaves a stale expiration record behind.
+  const QuicTime::Delta time_wait_period =
+      QuicTimeWaitListManagerPeer::time_wait_period(&time_wait_list_manager_);
+  clock_.AdvanceTime(time_wait_period * 0.5);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id_));
+  for (int i = 0; i < 1000; ++i) {
+    AddConnectionId(connection_id_, QuicTimeWaitListManager::DO_NOTHING);
+    EXPECT_GE(2u * time_wait_list_manager_.num_connections(),
+              QuicTimeWaitListManagerPeer::ExpirationQueueSize(
+                  &time_wait_list_manager_));
+  }
+  EXPECT_EQ(2u, time_wait_list_manager_.num_connections());
+
+  // The compacted records keep the expiry order.
+  clock_.AdvanceTime(time_wait_period * 0.75);
+  EXPECT_CALL(alarm_factory_, OnAlarmSet(_, _));
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_FALSE(IsConnectionIdInTimeWait(old_connection_id));
+  EXPECT_TRUE(IsConnectionIdInTimeWait(connection_id_));
+  EXPECT_EQ(1u, QuicTimeWaitListManagerPeer::ExpirationQueueSize(
+                    &time_wait_list_manager_));
+}
+
 TEST_F(QuicTimeWaitListManagerTest,
        CleanUpOldConnectionIdsForMultipleConnectionIdsPerConnection) {
   connection_id_ = TestConnectionId(7);
@@ -19,6 +19,8 @@
 #define UDP_GRO 104
 #endif
 
+struct msghdr;
+
 namespace quic {
 
 using QuicUdpSocketFd = SocketFd;
@@ -75,12 +77,16 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
     bitmask_.Set(QuicUdpPacketInfoBit::DROPPED_PACKETS);
   }
 
+  // The segment size of a buffer of datagrams coalesced by UDP GRO.
   void set_gso_size(size_t gso_size) {
     gso_size_ = gso_size;
     bitmask_.Set(QuicUdpPacketInfoBit::IS_GRO);
   }
 
-  size_t gso_size() { return gso_size_; }
+  size_t gso_size() const {
+    QUICHE_DCHECK(HasValue(QuicUdpPacketInfoBit::IS_GRO));
+    return gso_size_;
+  }
 
   const QuicIpAddress& self_v4_ip() const {
     QUICHE_DCHECK(HasValue(QuicUdpPacketInfoBit::V4_SELF_IP));
@@ -198,6 +204,9 @@ class QUIC_EXPORT_PRIVATE QuicUdpSocketApi {
   bool EnableReceiveTimestamp(QuicUdpSocketFd fd);
   bool EnableReceiveTtlForV4(QuicUdpSocketFd fd);
   bool EnableReceiveTtlForV6(QuicUdpSocketFd fd);
+  // Lets the kernel coalesce datagrams of the same flow into one read, see
+  // QuicUdpPacketInfoBit::IS_GRO.
+  bool EnableUdpGro(QuicUdpSocketFd fd);
 
   // Wait for |fd| to become readable, up to |timeout|.
   // Return true if |fd| is readable upon return.
@@ -241,6 +250,11 @@ class QUIC_EXPORT_PRIVATE QuicUdpSocketApi {
                              BitMask64 packet_info_interested,
                              ReadPacketResults* results);
 
+  // Populates |packet_info| from the control messages of |hdr|, for packets
+  // received by other means than the above, e.g. io_uring(7).
+  void ReadControlMessages(msghdr* hdr, BitMask64 packet_info_interested,
+                           QuicUdpPacketInfo* packet_info);
+
   // Write a packet to |fd|.
   // packet_buffer, packet_buffer_len:  The packet buffer to write.
   // packet_info:                       The per packet information to set.
@@ -25,6 +25,8 @@
 #include <alloca.h>
 // For SO_TIMESTAMPING.
 #include <linux/net_tstamp.h>
+// For SOL_UDP and UDP_GRO.
+#include <netinet/udp.h>
 #endif
 
 #if defined(__linux__) && !defined(__ANDROID__)
@@ -59,6 +61,7 @@ const size_t kMinCmsgSpaceForRead =
     + CMSG_SPACE(sizeof(in_pktinfo))   // V4 Self IP
     + CMSG_SPACE(sizeof(in6_pktinfo))  // V6 Self IP
     + kCmsgSpaceForRecvTimestamp + CMSG_SPACE(sizeof(int))  // TTL
+    + CMSG_SPACE(sizeof(int))                               // GRO size
     + kCmsgSpaceForGooglePacketHeader;
 
 void SetV4SelfIpInControlMessage(const QuicIpAddress& self_address,
@@ -85,9 +88,14 @@ void PopulatePacketInfoFromControlMessage(struct cmsghdr* cmsg,
                                           QuicUdpPacketInfo* packet_info,
                                           BitMask64 packet_info_interested) {
 #ifdef SOL_UDP
-  if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::IS_GRO) &&
-      cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
-    packet_info->set_gso_size(*reinterpret_cast<uint16_t*>(CMSG_DATA(cmsg)));
+  if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+    if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::IS_GRO)) {
+      // The kernel passes the segment size as an int.
+      int gso_size;
+      memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+      packet_info->set_gso_size(gso_size);
+    }
+    return;
   }
 #endif
 
@@ -356,6 +364,17 @@ bool QuicUdpSocketApi::EnableReceiveTtlForV6(QuicUdpSocketFd fd) {
 #endif
 }
 
+bool QuicUdpSocketApi::EnableUdpGro(QuicUdpSocketFd fd) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SOL_UDP)
+  int enable_gro = 1;
+  return 0 == setsockopt(fd, SOL_UDP, UDP_GRO, &enable_gro,
+                         sizeof(enable_gro));
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
 bool QuicUdpSocketApi::WaitUntilReadable(QuicUdpSocketFd fd,
                                          QuicTime::Delta timeout) {
   fd_set read_fds;
@@ -455,102 +474,81 @@ size_t QuicUdpSocketApi::ReadMultiplePackets(QuicUdpSocketFd fd,
                                              BitMask64 packet_info_interested,
                                              ReadPacketResults* results) {
 #if defined(__linux__) && !defined(__ANDROID__)
-  if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::IS_GRO)) {
-    size_t num_packets = 0;
-    for (ReadPacketResult& result : *results) {
-      result.ok = false;
-    }
-    for (ReadPacketResult& result : *results) {
-      ReadPacket(fd, packet_info_interested, &result);
-      if (!result.ok) {
-        break;
-      }
-      ++num_packets;
-    }
-    return num_packets;
-  } else {
-    // Use recvmmsg.
-    size_t hdrs_size = sizeof(mmsghdr) * results->size();
-    mmsghdr* hdrs = static_cast<mmsghdr*>(alloca(hdrs_size));
-    memset(hdrs, 0, hdrs_size);
-
-    struct TempPerPacketData {
-      iovec iov;
-      sockaddr_storage raw_peer_address;
-    };
-    TempPerPacketData* packet_data_array = static_cast<TempPerPacketData*>(
-        alloca(sizeof(TempPerPacketData) * results->size()));
-
-    for (size_t i = 0; i < results->size(); ++i) {
-      (*results)[i].ok = false;
-
-      msghdr* hdr = &hdrs[i].msg_hdr;
-      TempPerPacketData* packet_data = &packet_data_array[i];
-      packet_data->iov.iov_base = (*results)[i].packet_buffer.buffer;
-      packet_data->iov.iov_len = (*results)[i].packet_buffer.buffer_len;
-
-      hdr->msg_name = &packet_data->raw_peer_address;
-      hdr->msg_namelen = sizeof(sockaddr_storage);
-      hdr->msg_iov = &packet_data->iov;
-      hdr->msg_iovlen = 1;
-      hdr->msg_flags = 0;
-      hdr->msg_control = (*results)[i].control_buffer.buffer;
-      hdr->msg_controllen = (*results)[i].control_buffer.buffer_len;
-
-      QUICHE_DCHECK_GE(hdr->msg_controllen, kMinCmsgSpaceForRead);
-    }
-    // If MSG_TRUNC is set on Linux, recvmmsg will return the real packet size
-    // in |hdrs[i].msg_len| even if packet buffer is too small to receive it.
-    int packets_read = recvmmsg(fd, hdrs, results->size(), MSG_TRUNC, nullptr);
-    if (packets_read <= 0) {
-      const int error_num = errno;
-      if (error_num != EAGAIN) {
-        QUIC_LOG_FIRST_N(ERROR, 100)
-            << "Error reading packets: " << strerror(error_num);
-      }
-      return 0;
+  // Use recvmmsg.
+  size_t hdrs_size = sizeof(mmsghdr) * results->size();
+  mmsghdr* hdrs = static_cast<mmsghdr*>(alloca(hdrs_size));
+  memset(hdrs, 0, hdrs_size);
+
+  struct TempPerPacketData {
+    iovec iov;
+    sockaddr_storage raw_peer_address;
+  };
+  TempPerPacketData* packet_data_array = static_cast<TempPerPacketData*>(
+      alloca(sizeof(TempPerPacketData) * results->size()));
+
+  for (size_t i = 0; i < results->size(); ++i) {
+    (*results)[i].ok = false;
+
+    msghdr* hdr = &hdrs[i].msg_hdr;
+    TempPerPacketData* packet_data = &packet_data_array[i];
+    packet_data->iov.iov_base = (*results)[i].packet_buffer.buffer;
+    packet_data->iov.iov_len = (*results)[i].packet_buffer.buffer_len;
+
+    hdr->msg_name = &packet_data->raw_peer_address;
+    hdr->msg_namelen = sizeof(sockaddr_storage);
+    hdr->msg_iov = &packet_data->iov;
+    hdr->msg_iovlen = 1;
+    hdr->msg_flags = 0;
+    hdr->msg_control = (*results)[i].control_buffer.buffer;
+    hdr->msg_controllen = (*results)[i].control_buffer.buffer_len;
+
+    QUICHE_DCHECK_GE(hdr->msg_controllen, kMinCmsgSpaceForRead);
+  }
+  // If MSG_TRUNC is set on Linux, recvmmsg will return the real packet size
+  // in |hdrs[i].msg_len| even if packet buffer is too small to receive it.
+  int packets_read = recvmmsg(fd, hdrs, results->size(), MSG_TRUNC, nullptr);
+  if (packets_read <= 0) {
+    const int error_num = errno;
+    if (error_num != EAGAIN) {
+      QUIC_LOG_FIRST_N(ERROR, 100)
+          << "Error reading packets: " << strerror(error_num);
     }
+    return 0;
+  }
 
-    for (int i = 0; i < packets_read; ++i) {
-      if (hdrs[i].msg_len == 0) {
-        continue;
-      }
+  for (int i = 0; i < packets_read; ++i) {
+    if (hdrs[i].msg_len == 0) {
+      continue;
+    }
 
-      msghdr& hdr = hdrs[i].msg_hdr;
-      if (ABSL_PREDICT_FALSE(hdr.msg_flags & MSG_CTRUNC)) {
-        QUIC_BUG(quic_bug_10751_4) << "Control buffer too small. size:"
-                                   << (*results)[i].control_buffer.buffer_len
-                                   << ", need:" << hdr.msg_controllen;
-        continue;
-      }
+    msghdr& hdr = hdrs[i].msg_hdr;
+    if (ABSL_PREDICT_FALSE(hdr.msg_flags & MSG_CTRUNC)) {
+      QUIC_BUG(quic_bug_10751_4) << "Control buffer too small. size:"
+                                 << (*results)[i].control_buffer.buffer_len
+                                 << ", need:" << hdr.msg_controllen;
+      continue;
+    }
 
-      if (ABSL_PREDICT_FALSE(hdr.msg_flags & MSG_TRUNC)) {
-        QUIC_LOG_FIRST_N(WARNING, 100)
-            << "Received truncated QUIC packet: buffer size:"
-            << (*results)[i].packet_buffer.buffer_len
-            << " packet size:" << hdrs[i].msg_len;
-        continue;
-      }
+    if (ABSL_PREDICT_FALSE(hdr.msg_flags & MSG_TRUNC)) {
+      QUIC_LOG_FIRST_N(WARNING, 100)
+          << "Received truncated QUIC packet: buffer size:"
+          << (*results)[i].packet_buffer.buffer_len
+          << " packet size:" << hdrs[i].msg_len;
+      continue;
+    }
 
-      (*results)[i].ok = true;
-      (*results)[i].packet_buffer.buffer_len = hdrs[i].msg_len;
+    (*results)[i].ok = true;
+    (*results)[i].packet_buffer.buffer_len = hdrs[i].msg_len;
 
-      QuicUdpPacketInfo* packet_info = &(*results)[i].packet_info;
-      if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
-        packet_info->SetPeerAddress(
-            QuicSocketAddress(packet_data_array[i].raw_peer_address));
-      }
-
-      if (hdr.msg_controllen > 0) {
-        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
-             cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
-          PopulatePacketInfoFromControlMessage(cmsg, packet_info,
-                                               packet_info_interested);
-        }
-      }
+    QuicUdpPacketInfo* packet_info = &(*results)[i].packet_info;
+    if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::PEER_ADDRESS)) {
+      packet_info->SetPeerAddress(
+          QuicSocketAddress(packet_data_array[i].raw_peer_address));
     }
-    return packets_read;
+
+    ReadControlMessages(&hdr, packet_info_interested, packet_info);
   }
+  return packets_read;
 #else
   size_t num_packets = 0;
   for (ReadPacketResult& result : *results) {
@@ -568,6 +566,19 @@ size_t QuicUdpSocketApi::ReadMultiplePackets(QuicUdpSocketFd fd,
 #endif
 }
 
+void QuicUdpSocketApi::ReadControlMessages(msghdr* hdr,
+                                           BitMask64 packet_info_interested,
+                                           QuicUdpPacketInfo* packet_info) {
+  if (hdr->msg_controllen == 0) {
+    return;
+  }
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(hdr); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+    PopulatePacketInfoFromControlMessage(cmsg, packet_info,
+                                         packet_info_interested);
+  }
+}
+
 WriteResult QuicUdpSocketApi::WritePacket(
     QuicUdpSocketFd fd, const char* packet_buffer, size_t packet_buffer_len,
     const QuicUdpPacketInfo& packet_info) {
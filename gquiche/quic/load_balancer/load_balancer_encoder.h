@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ENCODER_H_
 #define QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ENCODER_H_
 
+#include "absl/numeric/int128.h"
 #include "gquiche/quic/core/connection_id_generator.h"
 #include "gquiche/quic/core/crypto/quic_random.h"
 #include "gquiche/quic/load_balancer/load_balancer_config.h"
@@ -41,5 +41,11 @@ size_t QuicTimeWaitListManagerPeer::PendingPacketsQueueSize(
   return manager->pending_packets_queue_.size();
 }
 
+// static
+size_t QuicTimeWaitListManagerPeer::ExpirationQueueSize(
+    QuicTimeWaitListManager* manager) {
+  return manager->expiration_queue_.size();
+}
+
 }  // namespace test
 }  // namespace quic
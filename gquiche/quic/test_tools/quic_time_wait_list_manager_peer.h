@@ -28,6 +28,8 @@ class QuicTimeWaitListManagerPeer {
       const QuicPerPacketContext* packet_context);
 
   static size_t PendingPacketsQueueSize(QuicTimeWaitListManager* manager);
+
+  static size_t ExpirationQueueSize(QuicTimeWaitListManager* manager);
 };
 
 }  // namespace test
@@ -0,0 +1,333 @@
+#include "gquiche/quic/tools/quic_async_proof_source.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "gquiche/quic/core/quic_default_clock.h"
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+int64_t MeanMicroseconds(QuicTime::Delta total, uint64_t count) {
+  return count == 0 ? 0 : total.ToMicroseconds() / count;
+}
+
+}  // namespace
+
+std::string QuicSigningThreadPool::Stats::ToString() const {
+  return absl::StrCat(
+      "posted ", jobs_posted, " rejected ", jobs_rejected, " completed ",
+      jobs_completed, " queue_depth ", queue_depth, " max_queue_depth ",
+      max_queue_depth, " queue_delay_us mean ",
+      MeanMicroseconds(total_queue_delay, jobs_completed), " max ",
+      max_queue_delay.ToMicroseconds(), " run_time_us mean ",
+      MeanMicroseconds(total_run_time, jobs_completed), " max ",
+      max_run_time.ToMicroseconds());
+}
+
+std::string QuicAsyncProofSource::Stats::ToString() const {
+  const uint64_t completed = signatures_offloaded - signatures_pending;
+  return absl::StrCat("offloaded ", signatures_offloaded, " inline ",
+                      signatures_inline, " pending ", signatures_pending,
+                      " latency_us mean ",
+                      MeanMicroseconds(total_latency, completed), " max ",
+                      max_latency.ToMicroseconds());
+}
+
+QuicSigningThreadPool::QuicSigningThreadPool(size_t num_threads,
+                                             size_t max_queue_depth)
+    : num_threads_(num_threads),
+      max_queue_depth_(max_queue_depth),
+      job_fd_(-1),
+      stopping_(false) {}
+
+QuicSigningThreadPool::~QuicSigningThreadPool() {
+  if (job_fd_ < 0) {
+    return;
+  }
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    stopping_ = true;
+    jobs_.clear();
+  }
+  // Wakes every thread up, whatever the count of queued jobs was.
+  uint64_t count = workers_.size();
+  if (!workers_.empty() &&
+      write(job_fd_, &count, sizeof(count)) != sizeof(count)) {
+    QUIC_LOG(ERROR) << "Failed to stop the signing threads: "
+                    << strerror(errno);
+  }
+  for (auto& worker : workers_) {
+    worker->Join();
+  }
+  close(job_fd_);
+  QUIC_LOG(INFO) << "Signing thread pool stats: " << stats().ToString();
+}
+
+bool QuicSigningThreadPool::Initialize() {
+  // Each read of a semaphore eventfd takes one job, blocking while there is
+  // none.
+  job_fd_ = eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC);
+  if (job_fd_ < 0) {
+    QUIC_LOG(ERROR) << "eventfd() failed: " << strerror(errno);
+    return false;
+  }
+  for (size_t i = 0; i < num_threads_; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this, i));
+    workers_.back()->Start();
+  }
+  QUIC_LOG(INFO) << "Signing TLS handshakes on " << num_threads_
+                 << " threads, up to " << max_queue_depth_ << " queued";
+  return true;
+}
+
+bool QuicSigningThreadPool::Post(std::function<void()> job) {
+  const QuicTime now = QuicDefaultClock::Get()->Now();
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    if (job_fd_ < 0 || stopping_ || jobs_.size() >= max_queue_depth_) {
+      ++stats_.jobs_rejected;
+      return false;
+    }
+    jobs_.push_back(Job{std::move(job), now});
+    ++stats_.jobs_posted;
+    stats_.queue_depth = jobs_.size();
+    stats_.max_queue_depth =
+        std::max(stats_.max_queue_depth, stats_.queue_depth);
+  }
+  uint64_t one = 1;
+  if (write(job_fd_, &one, sizeof(one)) != sizeof(one)) {
+    QUIC_LOG_FIRST_N(ERROR, 10)
+        << "Failed to wake a signing thread up: " << strerror(errno);
+  }
+  return true;
+}
+
+QuicSigningThreadPool::Stats QuicSigningThreadPool::stats() const {
+  QuicReaderMutexLock lock(&mutex_);
+  return stats_;
+}
+
+void QuicSigningThreadPool::RunJobs() {
+  while (true) {
+    uint64_t count;
+    if (read(job_fd_, &count, sizeof(count)) != sizeof(count)) {
+      if (errno == EINTR) {
+        continue;
+      }
+      QUIC_LOG(ERROR) << "Signing thread failed to wait for jobs: "
+                      << strerror(errno);
+      return;
+    }
+    Job job;
+    {
+      QuicWriterMutexLock lock(&mutex_);
+      if (stopping_) {
+        return;
+      }
+      if (jobs_.empty()) {
+        continue;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      stats_.queue_depth = jobs_.size();
+    }
+    const QuicTime start = QuicDefaultClock::Get()->Now();
+    job.run();
+    const QuicTime end = QuicDefaultClock::Get()->Now();
+
+    QuicWriterMutexLock lock(&mutex_);
+    ++stats_.jobs_completed;
+    const QuicTime::Delta queue_delay = start - job.posted;
+    stats_.total_queue_delay = stats_.total_queue_delay + queue_delay;
+    stats_.max_queue_delay = std::max(stats_.max_queue_delay, queue_delay);
+    stats_.total_run_time = stats_.total_run_time + (end - start);
+    stats_.max_run_time = std::max(stats_.max_run_time, end - start);
+    if (stats_.jobs_completed % kLogStatsEveryNJobs == 0) {
+      QUIC_LOG(INFO) << "Signing thread pool stats: " << stats_.ToString();
+    }
+  }
+}
+
+class QuicAsyncProofSource::CompletionQueue {
+ public:
+  struct Completion {
+    uint64_t id;
+    bool ok;
+    std::string signature;
+    std::unique_ptr<Details> details;
+  };
+
+  CompletionQueue() : event_fd_(-1) {}
+  CompletionQueue(const CompletionQueue&) = delete;
+  CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+  ~CompletionQueue() {
+    if (event_fd_ >= 0) {
+      close(event_fd_);
+    }
+  }
+
+  bool Initialize() {
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+      QUIC_LOG(ERROR) << "eventfd() failed: " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  int fd() const { return event_fd_; }
+
+  // Called on the pool's threads.
+  void Push(Completion completion) {
+    {
+      QuicWriterMutexLock lock(&mutex_);
+      completions_.push_back(std::move(completion));
+    }
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) != sizeof(one)) {
+      QUIC_LOG_FIRST_N(ERROR, 10)
+          << "Failed to wake the network thread up: " << strerror(errno);
+    }
+  }
+
+  // Called on the network thread. |completions| must be empty.
+  void Take(std::vector<Completion>* completions) {
+    // Reset the eventfd before taking the completions, so that a push racing
+    // with this wakes the network thread up again.
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+      QUIC_LOG_FIRST_N(ERROR, 10) << "eventfd read failed: " << strerror(errno);
+    }
+    QuicWriterMutexLock lock(&mutex_);
+    completions->swap(completions_);
+  }
+
+ private:
+  int event_fd_;
+  QuicMutex mutex_;
+  std::vector<Completion> completions_ QUIC_GUARDED_BY(mutex_);
+};
+
+// Passed to the wrapped proof source on a pool thread.
+class QuicAsyncProofSource::PoolSignatureCallback : public SignatureCallback {
+ public:
+  PoolSignatureCallback(std::shared_ptr<CompletionQueue> completions,
+                        uint64_t id)
+      : completions_(std::move(completions)), id_(id) {}
+
+  void Run(bool ok, std::string signature,
+           std::unique_ptr<Details> details) override {
+    completions_->Push(CompletionQueue::Completion{
+        id_, ok, std::move(signature), std::move(details)});
+  }
+
+ private:
+  std::shared_ptr<CompletionQueue> completions_;
+  const uint64_t id_;
+};
+
+QuicAsyncProofSource::QuicAsyncProofSource(
+    std::shared_ptr<ProofSource> proof_source,
+    std::shared_ptr<QuicSigningThreadPool> pool)
+    : proof_source_(std::move(proof_source)),
+      pool_(std::move(pool)),
+      completions_(std::make_shared<CompletionQueue>()),
+      next_signature_id_(0) {}
+
+QuicAsyncProofSource::~QuicAsyncProofSource() = default;
+
+bool QuicAsyncProofSource::Initialize() { return completions_->Initialize(); }
+
+int QuicAsyncProofSource::completion_fd() const { return completions_->fd(); }
+
+void QuicAsyncProofSource::RunCompletedCallbacks() {
+  std::vector<CompletionQueue::Completion> completed;
+  completions_->Take(&completed);
+  const QuicTime now = QuicDefaultClock::Get()->Now();
+  for (CompletionQueue::Completion& completion : completed) {
+    auto it = pending_.find(completion.id);
+    if (it == pending_.end()) {
+      QUIC_BUG(quic_async_proof_source_unknown_signature)
+          << "Completed signature " << completion.id << " is not pending";
+      continue;
+    }
+    std::unique_ptr<SignatureCallback> callback =
+        std::move(it->second.callback);
+    const QuicTime::Delta latency = now - it->second.start;
+    pending_.erase(it);
+    stats_.total_latency = stats_.total_latency + latency;
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+    // May start another signature.
+    callback->Run(completion.ok, std::move(completion.signature),
+                  std::move(completion.details));
+  }
+  stats_.signatures_pending = pending_.size();
+}
+
+void QuicAsyncProofSource::GetProof(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address, const std::string& hostname,
+    const std::string& server_config, QuicTransportVersion transport_version,
+    absl::string_view chlo_hash, std::unique_ptr<Callback> callback) {
+  proof_source_->GetProof(server_address, client_address, hostname,
+                          server_config, transport_version, chlo_hash,
+                          std::move(callback));
+}
+
+quiche::QuicheReferenceCountedPointer<ProofSource::Chain>
+QuicAsyncProofSource::GetCertChain(const QuicSocketAddress& server_address,
+                                   const QuicSocketAddress& client_address,
+                                   const std::string& hostname,
+                                   bool* cert_matched_sni) {
+  return proof_source_->GetCertChain(server_address, client_address, hostname,
+                                     cert_matched_sni);
+}
+
+void QuicAsyncProofSource::ComputeTlsSignature(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address, const std::string& hostname,
+    uint16_t signature_algorithm, absl::string_view in,
+    std::unique_ptr<SignatureCallback> callback) {
+  const uint64_t id = next_signature_id_++;
+  // |in| is only valid during this call.
+  auto job = [proof_source = proof_source_, completions = completions_, id,
+              server_address, client_address, hostname, signature_algorithm,
+              in = std::string(in)]() {
+    proof_source->ComputeTlsSignature(
+        server_address, client_address, hostname, signature_algorithm, in,
+        std::make_unique<PoolSignatureCallback>(completions, id));
+  };
+  if (completions_->fd() < 0 || !pool_->Post(std::move(job))) {
+    ++stats_.signatures_inline;
+    proof_source_->ComputeTlsSignature(server_address, client_address,
+                                       hostname, signature_algorithm, in,
+                                       std::move(callback));
+    return;
+  }
+  ++stats_.signatures_offloaded;
+  pending_[id] =
+      PendingSignature{std::move(callback), QuicDefaultClock::Get()->Now()};
+  stats_.signatures_pending = pending_.size();
+}
+
+QuicSignatureAlgorithmVector
+QuicAsyncProofSource::SupportedTlsSignatureAlgorithms() const {
+  return proof_source_->SupportedTlsSignatureAlgorithms();
+}
+
+ProofSource::TicketCrypter* QuicAsyncProofSource::GetTicketCrypter() {
+  return proof_source_->GetTicketCrypter();
+}
+
+}  // namespace quic
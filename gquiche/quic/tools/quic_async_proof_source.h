@@ -0,0 +1,182 @@
+// Computes the signatures of TLS handshakes on a pool of threads. Only the
+// signature leaves the network thread: the ECDHE key exchange and the rest
+// of the handshake still run on it, inside SSL_do_handshake(), which has no
+// asynchronous hook for them.
+//
+// QuicSigningThreadPool runs the jobs. Each network thread has its own
+// QuicAsyncProofSource, which wraps the proof source of its crypto config,
+// hands ComputeTlsSignature() calls to the pool and runs their callbacks back
+// on the network thread once the pool is done, as TlsServerHandshaker expects
+// of an asynchronous ProofSource.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_ASYNC_PROOF_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_ASYNC_PROOF_SOURCE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gquiche/quic/core/crypto/proof_source.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/platform/api/quic_mutex.h"
+#include "gquiche/quic/platform/api/quic_thread.h"
+#include "gquiche/common/quiche_circular_deque.h"
+
+namespace quic {
+
+// A fixed number of threads running jobs from a bounded queue. Jobs may be
+// posted from any thread.
+class QuicSigningThreadPool {
+ public:
+  struct Stats {
+    // Jobs accepted by Post().
+    uint64_t jobs_posted = 0;
+    // Jobs turned down because the queue was full.
+    uint64_t jobs_rejected = 0;
+    uint64_t jobs_completed = 0;
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    // From Post() to a thread starting the job.
+    QuicTime::Delta total_queue_delay = QuicTime::Delta::Zero();
+    QuicTime::Delta max_queue_delay = QuicTime::Delta::Zero();
+    // Running the job.
+    QuicTime::Delta total_run_time = QuicTime::Delta::Zero();
+    QuicTime::Delta max_run_time = QuicTime::Delta::Zero();
+
+    std::string ToString() const;
+  };
+
+  // The stats are logged every this many completed jobs.
+  static constexpr uint64_t kLogStatsEveryNJobs = 10000;
+
+  QuicSigningThreadPool(size_t num_threads, size_t max_queue_depth);
+  QuicSigningThreadPool(const QuicSigningThreadPool&) = delete;
+  QuicSigningThreadPool& operator=(const QuicSigningThreadPool&) = delete;
+  // Waits for the running jobs and drops the queued ones.
+  ~QuicSigningThreadPool();
+
+  // Starts the threads.
+  bool Initialize();
+
+  // Queues |job|. Returns false, without running it, if the queue is full.
+  bool Post(std::function<void()> job);
+
+  Stats stats() const;
+
+  size_t num_threads() const { return num_threads_; }
+
+ private:
+  class Worker : public QuicThread {
+   public:
+    Worker(QuicSigningThreadPool* pool, size_t index)
+        : QuicThread("quic_signer_" + std::to_string(index)), pool_(pool) {}
+
+    void Run() override { pool_->RunJobs(); }
+
+   private:
+    QuicSigningThreadPool* pool_;
+  };
+
+  struct Job {
+    std::function<void()> run;
+    QuicTime posted = QuicTime::Zero();
+  };
+
+  // Runs jobs until the pool stops.
+  void RunJobs();
+
+  const size_t num_threads_;
+  const size_t max_queue_depth_;
+  // A semaphore eventfd counting the queued jobs, which idle threads block
+  // reading.
+  int job_fd_;
+  mutable QuicMutex mutex_;
+  quiche::QuicheCircularDeque<Job> jobs_ QUIC_GUARDED_BY(mutex_);
+  bool stopping_ QUIC_GUARDED_BY(mutex_);
+  Stats stats_ QUIC_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+// A ProofSource computing TLS signatures with |proof_source| on |pool|. The
+// other methods are forwarded as is. All methods, and
+// RunCompletedCallbacks(), must be called on one thread, the network thread
+// of the crypto config owning this.
+class QuicAsyncProofSource : public ProofSource {
+ public:
+  struct Stats {
+    // Signatures handed to the pool.
+    uint64_t signatures_offloaded = 0;
+    // Signatures computed on the network thread because the pool was full.
+    uint64_t signatures_inline = 0;
+    // Offloaded signatures waiting for their callback.
+    size_t signatures_pending = 0;
+    // From ComputeTlsSignature() to running the callback of an offloaded
+    // signature.
+    QuicTime::Delta total_latency = QuicTime::Delta::Zero();
+    QuicTime::Delta max_latency = QuicTime::Delta::Zero();
+
+    std::string ToString() const;
+  };
+
+  QuicAsyncProofSource(std::shared_ptr<ProofSource> proof_source,
+                       std::shared_ptr<QuicSigningThreadPool> pool);
+  QuicAsyncProofSource(const QuicAsyncProofSource&) = delete;
+  QuicAsyncProofSource& operator=(const QuicAsyncProofSource&) = delete;
+  ~QuicAsyncProofSource() override;
+
+  // Creates the eventfd signalling completed signatures.
+  bool Initialize();
+
+  // Readable while completed signatures wait for RunCompletedCallbacks().
+  int completion_fd() const;
+
+  // Runs the callbacks of the signatures the pool completed.
+  void RunCompletedCallbacks();
+
+  const Stats& stats() const { return stats_; }
+
+  // ProofSource
+  void GetProof(const QuicSocketAddress& server_address,
+                const QuicSocketAddress& client_address,
+                const std::string& hostname, const std::string& server_config,
+                QuicTransportVersion transport_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+  quiche::QuicheReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      bool* cert_matched_sni) override;
+  void ComputeTlsSignature(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      uint16_t signature_algorithm, absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+  QuicSignatureAlgorithmVector SupportedTlsSignatureAlgorithms() const override;
+  TicketCrypter* GetTicketCrypter() override;
+
+ private:
+  // Signatures the pool completed, shared with the jobs so that it outlives
+  // this if the pool is still working on some.
+  class CompletionQueue;
+  class PoolSignatureCallback;
+
+  struct PendingSignature {
+    std::unique_ptr<SignatureCallback> callback;
+    QuicTime start = QuicTime::Zero();
+  };
+
+  std::shared_ptr<ProofSource> proof_source_;
+  std::shared_ptr<QuicSigningThreadPool> pool_;
+  std::shared_ptr<CompletionQueue> completions_;
+  // Keyed by the ID the pool's job reports its result with.
+  absl::flat_hash_map<uint64_t, PendingSignature> pending_;
+  uint64_t next_signature_id_;
+  Stats stats_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_ASYNC_PROOF_SOURCE_H_
@@ -0,0 +1,139 @@
+#include "gquiche/quic/tools/quic_async_proof_source.h"
+
+#include <poll.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "gquiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+// Signs by prefixing the input with "signed:", and records the thread it
+// signed on.
+class FakeSigningProofSource : public ProofSource {
+ public:
+  void GetProof(const QuicSocketAddress& /*server_address*/,
+                const QuicSocketAddress& /*client_address*/,
+                const std::string& /*hostname*/,
+                const std::string& /*server_config*/,
+                QuicTransportVersion /*transport_version*/,
+                absl::string_view /*chlo_hash*/,
+                std::unique_ptr<Callback> /*callback*/) override {}
+  quiche::QuicheReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& /*server_address*/,
+      const QuicSocketAddress& /*client_address*/,
+      const std::string& /*hostname*/, bool* /*cert_matched_sni*/) override {
+    return nullptr;
+  }
+  void ComputeTlsSignature(
+      const QuicSocketAddress& /*server_address*/,
+      const QuicSocketAddress& /*client_address*/,
+      const std::string& /*hostname*/, uint16_t /*signature_algorithm*/,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override {
+    signing_thread_ = std::this_thread::get_id();
+    callback->Run(true, "signed:" + std::string(in), nullptr);
+  }
+  QuicSignatureAlgorithmVector SupportedTlsSignatureAlgorithms()
+      const override {
+    return {};
+  }
+  TicketCrypter* GetTicketCrypter() override { return nullptr; }
+
+  std::thread::id signing_thread() const { return signing_thread_; }
+
+ private:
+  // Only read once the signature completed.
+  std::thread::id signing_thread_;
+};
+
+class RecordingCallback : public ProofSource::SignatureCallback {
+ public:
+  RecordingCallback(bool* ran, std::string* signature)
+      : ran_(ran), signature_(signature) {}
+
+  void Run(bool ok, std::string signature,
+           std::unique_ptr<ProofSource::Details> /*details*/) override {
+    *ran_ = ok;
+    *signature_ = std::move(signature);
+  }
+
+ private:
+  bool* ran_;
+  std::string* signature_;
+};
+
+class QuicAsyncProofSourceTest : public QuicTest {
+ protected:
+  void Init(size_t num_threads, size_t max_queue_depth) {
+    fake_ = std::make_shared<FakeSigningProofSource>();
+    pool_ = std::make_shared<QuicSigningThreadPool>(num_threads,
+                                                    max_queue_depth);
+    ASSERT_TRUE(pool_->Initialize());
+    proof_source_ = std::make_unique<QuicAsyncProofSource>(fake_, pool_);
+    ASSERT_TRUE(proof_source_->Initialize());
+  }
+
+  void Sign(absl::string_view in) {
+    proof_source_->ComputeTlsSignature(
+        QuicSocketAddress(), QuicSocketAddress(), "example.org", 0, in,
+        std::make_unique<RecordingCallback>(&ran_, &signature_));
+  }
+
+  bool WaitForCompletion() {
+    pollfd pfd = {proof_source_->completion_fd(), POLLIN, 0};
+    return poll(&pfd, 1, /*timeout=*/5000) == 1;
+  }
+
+  std::shared_ptr<FakeSigningProofSource> fake_;
+  std::shared_ptr<QuicSigningThreadPool> pool_;
+  std::unique_ptr<QuicAsyncProofSource> proof_source_;
+  bool ran_ = false;
+  std::string signature_;
+};
+
+TEST_F(QuicAsyncProofSourceTest, SignsOnThePoolAndCompletesOnCaller) {
+  Init(/*num_threads=*/2, /*max_queue_depth=*/16);
+  Sign("hello");
+  EXPECT_EQ(1u, proof_source_->stats().signatures_offloaded);
+  EXPECT_EQ(1u, proof_source_->stats().signatures_pending);
+
+  ASSERT_TRUE(WaitForCompletion());
+  // The callback only runs on the network thread.
+  EXPECT_FALSE(ran_);
+  proof_source_->RunCompletedCallbacks();
+  EXPECT_TRUE(ran_);
+  EXPECT_EQ("signed:hello", signature_);
+  EXPECT_NE(std::this_thread::get_id(), fake_->signing_thread());
+  EXPECT_EQ(0u, proof_source_->stats().signatures_pending);
+  EXPECT_EQ(1u, pool_->stats().jobs_posted);
+}
+
+TEST_F(QuicAsyncProofSourceTest, SignsInlineWhenThePoolIsFull) {
+  Init(/*num_threads=*/1, /*max_queue_depth=*/0);
+  Sign("hello");
+  EXPECT_TRUE(ran_);
+  EXPECT_EQ("signed:hello", signature_);
+  EXPECT_EQ(std::this_thread::get_id(), fake_->signing_thread());
+  EXPECT_EQ(1u, proof_source_->stats().signatures_inline);
+  EXPECT_EQ(1u, pool_->stats().jobs_rejected);
+}
+
+TEST_F(QuicAsyncProofSourceTest, OutlivedByPendingSignatures) {
+  Init(/*num_threads=*/1, /*max_queue_depth=*/16);
+  for (int i = 0; i < 10; ++i) {
+    Sign("hello");
+  }
+  // The pending callbacks are dropped, the jobs still in flight complete
+  // into the queue they share.
+  proof_source_.reset();
+  pool_.reset();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
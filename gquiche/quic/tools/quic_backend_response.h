@@ -5,6 +5,9 @@
 #ifndef QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 #define QUICHE_QUIC_TOOLS_QUIC_BACKEND_RESPONSE_H_
 
+#include <memory>
+#include <string>
+
 #include "absl/strings/string_view.h"
 #include "gquiche/quic/core/quic_time.h"
 #include "gquiche/quic/tools/quic_url.h"
@@ -57,7 +60,14 @@ class QuicBackendResponse {
   SpecialResponseType response_type() const { return response_type_; }
   const spdy::Http2HeaderBlock& headers() const { return headers_; }
   const spdy::Http2HeaderBlock& trailers() const { return trailers_; }
-  const absl::string_view body() const { return absl::string_view(body_); }
+  const absl::string_view body() const {
+    return body_ == nullptr ? absl::string_view() : absl::string_view(*body_);
+  }
+  // The body, which is immutable and shared with the streams sending it, so
+  // that they do not copy it. Null if no body was set.
+  const std::shared_ptr<const std::string>& shared_body() const {
+    return body_;
+  }
 
   void AddEarlyHints(const spdy::Http2HeaderBlock& headers) {
     spdy::Http2HeaderBlock hints = headers.Clone();
@@ -76,7 +86,7 @@ class QuicBackendResponse {
     trailers_ = std::move(trailers);
   }
   void set_body(absl::string_view body) {
-    body_.assign(body.data(), body.size());
+    body_ = std::make_shared<const std::string>(body);
   }
 
   // This would simulate a delay before sending the response
@@ -89,7 +99,7 @@ class QuicBackendResponse {
   SpecialResponseType response_type_;
   spdy::Http2HeaderBlock headers_;
   spdy::Http2HeaderBlock trailers_;
-  std::string body_;
+  std::shared_ptr<const std::string> body_;
   QuicTime::Delta delay_;
 };
 
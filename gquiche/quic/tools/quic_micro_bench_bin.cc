@@ -0,0 +1,982 @@
+// Copyright (c) 2023 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Micro benchmarks of the data structures on the packet path, run without a
+// peer; only rx uses the network, over loopback. Each prints one line per
+// configuration.
+//
+// Usage: quic_micro_bench [benchmark...]
+//
+// Runs all the benchmarks if none is named.
+
+#include <malloc.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base/bvc-qlog/src/qlog_binary_writer.h"
+#include "base/bvc-qlog/src/qlog_summary_snapshot.h"
+#include "gquiche/common/platform/api/quiche_mem_slice.h"
+#include "gquiche/common/simple_buffer_allocator.h"
+#include "gquiche/quic/core/batch_writer/quic_batch_writer_buffer.h"
+#include "gquiche/quic/core/batch_writer/quic_sendmmsg_batch_writer.h"
+#include "gquiche/quic/core/congestion_control/general_loss_algorithm.h"
+#include "gquiche/quic/core/congestion_control/rtt_stats.h"
+#include "gquiche/quic/core/crypto/aes_128_gcm_decrypter.h"
+#include "gquiche/quic/core/crypto/quic_decrypter.h"
+#include "gquiche/quic/core/frames/quic_frame.h"
+#include "gquiche/quic/core/frames/quic_frame_arena.h"
+#include "gquiche/quic/core/io/quic_default_event_loop.h"
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_connection_context.h"
+#include "gquiche/quic/core/quic_constants.h"
+#include "gquiche/quic/core/quic_data_reader.h"
+#include "gquiche/quic/core/quic_default_clock.h"
+#include "gquiche/quic/core/quic_linux_socket_utils.h"
+#include "gquiche/quic/core/quic_packet_buffer_pool.h"
+#include "gquiche/quic/core/quic_packet_reader.h"
+#include "gquiche/quic/core/quic_packets.h"
+#include "gquiche/quic/core/quic_process_packet_interface.h"
+#include "gquiche/quic/core/quic_stream_send_buffer.h"
+#include "gquiche/quic/core/quic_udp_socket.h"
+#include "gquiche/quic/core/quic_unacked_packet_map.h"
+#include "gquiche/quic/platform/api/quic_mutex.h"
+#include "gquiche/quic/tools/quic_worker_connection_id_generator.h"
+
+#if defined(QUIC_ENABLE_IO_URING)
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_batch_writer.h"
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_packet_reader.h"
+#endif
+#if defined(QUIC_ENABLE_XSK)
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_checksum.h"
+#endif
+
+namespace quic {
+namespace {
+
+// Resident set size of the process in kilobytes, 0 if unknown.
+size_t ResidentKilobytes() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return std::stoul(line.substr(6));
+    }
+  }
+  return 0;
+}
+
+// Bytes allocated from the heap and not freed yet. Unlike the resident set,
+// it drops when memory is freed, so it can be compared between runs.
+size_t HeapBytesInUse() {
+  const struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// Keeps the results of the benchmarked calls alive.
+volatile uint64_t benchmark_sink;
+
+// The number of operator new calls so far, see below.
+size_t operator_new_calls = 0;
+
+// Average duration of |op(i)| for i in [0, iterations), in nanoseconds.
+template <typename Op>
+double NanosecondsPerOp(size_t iterations, Op op) {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    op(i);
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+// Memory held by the frame arenas of idle connections: 10000 connections each
+// keep a few control frames, as after the handshake, or many of them, as
+// with a backlog of retransmittable frames. Each configuration runs in a
+// child process, so that it does not reuse the heap pages the previous ones
+// left resident.
+void BenchmarkFrameArena() {
+  constexpr size_t kNumConnections = 10000;
+  for (size_t frames_per_connection : {1, 4, 16, 64, 256}) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid != 0) {
+      waitpid(pid, nullptr, 0);
+      continue;
+    }
+    const size_t rss_before = ResidentKilobytes();
+    std::vector<QuicConnectionContext> contexts(kNumConnections);
+    std::vector<QuicFrames> frames(kNumConnections);
+    size_t slabs = 0;
+    size_t slab_bytes = 0;
+    for (size_t i = 0; i < kNumConnections; ++i) {
+      contexts[i].frame_arena = std::make_unique<QuicFrameArena>();
+      QuicConnectionContextSwitcher switcher(&contexts[i]);
+      for (size_t j = 0; j < frames_per_connection; ++j) {
+        frames[i].push_back(QuicFrame(new QuicRstStreamFrame(
+            j + 1, j * 4, QUIC_STREAM_CANCELLED, /*bytes_written=*/0)));
+      }
+      slabs += contexts[i].frame_arena->num_slabs();
+      slab_bytes += contexts[i].frame_arena->num_slab_bytes();
+    }
+    const size_t rss_after = ResidentKilobytes();
+    printf(
+        "frame_arena frames/connection=%zu slabs/connection=%.2f "
+        "slab_bytes/connection=%zu rss_kb/connection=%.2f\n",
+        frames_per_connection, static_cast<double>(slabs) / kNumConnections,
+        slab_bytes / kNumConnections,
+        static_cast<double>(rss_after - rss_before) / kNumConnections);
+    fflush(stdout);
+    _exit(0);
+  }
+
+  // Frame churn of a busy connection: each packet carries two retransmittable
+  // control frames, freed when it is acked 1000 packets later. Without an
+  // arena each frame is a heap allocation, with one only its slabs are.
+  constexpr size_t kNumPackets = 1000000;
+  constexpr size_t kPacketsInFlight = 1000;
+  constexpr size_t kFramesPerPacket = 2;
+  for (bool use_arena : {false, true}) {
+    QuicConnectionContext context;
+    if (use_arena) {
+      context.frame_arena = std::make_unique<QuicFrameArena>();
+    }
+    QuicConnectionContextSwitcher switcher(&context);
+    std::vector<QuicFrames> packets_in_flight(kPacketsInFlight);
+    const double ns = NanosecondsPerOp(kNumPackets, [&](size_t i) {
+      QuicFrames& packet_frames = packets_in_flight[i % kPacketsInFlight];
+      DeleteFrames(&packet_frames);
+      for (size_t j = 0; j < kFramesPerPacket; ++j) {
+        packet_frames.push_back(QuicFrame(new QuicRstStreamFrame(
+            i * kFramesPerPacket + j + 1, i * 4, QUIC_STREAM_CANCELLED,
+            /*bytes_written=*/0)));
+      }
+    });
+    const size_t heap_allocations =
+        use_arena ? context.frame_arena->num_slabs()
+                  : kNumPackets * kFramesPerPacket;
+    printf(
+        "frame_arena churn arena=%s ns/packet=%.1f "
+        "heap_allocations/packet=%.5f\n",
+        use_arena ? "on" : "off", ns,
+        static_cast<double>(heap_allocations) / kNumPackets);
+    for (QuicFrames& packet_frames : packets_in_flight) {
+      DeleteFrames(&packet_frames);
+    }
+  }
+}
+
+class NoopAlarmDelegate : public QuicAlarm::DelegateWithoutContext {
+ public:
+  void OnAlarm() override {}
+};
+
+// Alarm churn of a busy server: random sets and cancels over 100000 alarms,
+// with deadlines up to 30s out, in the alarm storage of each event loop.
+void BenchmarkAlarms() {
+  constexpr size_t kNumAlarms = 100000;
+  constexpr size_t kNumOperations = 5000000;
+  for (QuicEventLoopFactory* factory : GetAllSupportedEventLoops()) {
+    std::unique_ptr<QuicEventLoop> loop =
+        factory->Create(QuicDefaultClock::Get());
+    std::unique_ptr<QuicAlarmFactory> alarm_factory =
+        loop->CreateAlarmFactory();
+    std::vector<std::unique_ptr<QuicAlarm>> alarms;
+    for (size_t i = 0; i < kNumAlarms; ++i) {
+      alarms.emplace_back(alarm_factory->CreateAlarm(new NoopAlarmDelegate()));
+    }
+    std::mt19937_64 random(1);
+    const QuicTime now = QuicDefaultClock::Get()->Now();
+    const double ns = NanosecondsPerOp(kNumOperations, [&](size_t) {
+      QuicAlarm* alarm = alarms[random() % kNumAlarms].get();
+      if (alarm->IsSet()) {
+        alarm->Cancel();
+      } else {
+        alarm->Set(now + QuicTime::Delta::FromMicroseconds(random() % 30000000));
+      }
+    });
+    printf("alarms event_loop=\"%s\" ns/op=%.1f\n", factory->GetName().c_str(),
+           ns);
+    for (std::unique_ptr<QuicAlarm>& alarm : alarms) {
+      alarm->Cancel();
+    }
+  }
+}
+
+// Received packets kept for later, as QuicBufferedPacketStore keeps CHLOs
+// and early packets, copied out of a plain read buffer or out of a pooled
+// one, which goes back to the pool.
+void BenchmarkPacketClone() {
+  constexpr size_t kNumPackets = 100000;
+  for (size_t length : {100, 1350}) {
+    for (bool pooled : {false, true}) {
+      QuicPacketBufferPool pool(kMaxIncomingPacketSize, 16);
+      char read_buffer[kMaxIncomingPacketSize] = {};
+      std::vector<std::unique_ptr<QuicReceivedPacket>> kept_packets;
+      kept_packets.reserve(kNumPackets);
+      const size_t heap_before = HeapBytesInUse();
+      const double ns = NanosecondsPerOp(kNumPackets, [&](size_t) {
+        if (pooled) {
+          QuicPooledPacketBuffer buffer = pool.Acquire();
+          QuicReceivedPacket packet(buffer.data(), length, QuicTime::Zero(),
+                                    buffer, /*ttl=*/0, /*ttl_valid=*/false,
+                                    /*packet_headers=*/nullptr,
+                                    /*headers_length=*/0,
+                                    /*owns_header_buffer=*/false);
+          kept_packets.push_back(packet.Clone());
+        } else {
+          QuicReceivedPacket packet(read_buffer, length, QuicTime::Zero());
+          kept_packets.push_back(packet.Clone());
+        }
+      });
+      const size_t heap_after = HeapBytesInUse();
+      printf(
+          "packet_clone bytes=%zu buffer=%s ns/packet=%.1f "
+          "heap_bytes/packet=%.0f\n",
+          length, pooled ? "pooled" : "copied", ns,
+          static_cast<double>(heap_after - heap_before) / kNumPackets);
+    }
+  }
+}
+
+// Scans of the unacked packets when all but the last one are out of flight
+// yet still tracked, as when a lost packet holds back the removal of the
+// acked ones after it. Loss detection and the in flight lookups walk them.
+void BenchmarkUnackedPacketMap() {
+  constexpr size_t kPacketsScanned = 100000000;
+  for (size_t num_packets : {100, 1000, 10000}) {
+    QuicUnackedPacketMap unacked_packets(Perspective::IS_SERVER);
+    const QuicTime now = QuicTime::Zero() + QuicTime::Delta::FromSeconds(1);
+    for (uint64_t i = 1; i <= num_packets; ++i) {
+      SerializedPacket packet(QuicPacketNumber(i), PACKET_4BYTE_PACKET_NUMBER,
+                              nullptr, kDefaultMaxPacketSize,
+                              /*has_ack=*/false, /*has_stop_waiting=*/false);
+      packet.encryption_level = ENCRYPTION_FORWARD_SECURE;
+      packet.retransmittable_frames.push_back(QuicFrame(QuicStreamFrame(
+          /*stream_id=*/4, /*fin=*/false, /*offset=*/i * 1000, 1000)));
+      unacked_packets.AddSentPacket(&packet, NOT_RETRANSMISSION, now,
+                                    /*set_in_flight=*/true,
+                                    /*measure_rtt=*/true);
+    }
+    for (uint64_t i = 1; i < num_packets; ++i) {
+      unacked_packets.RemoveFromInFlight(QuicPacketNumber(i));
+    }
+    const QuicPacketNumber largest_acked(num_packets);
+    RttStats rtt_stats;
+    GeneralLossAlgorithm loss_algorithm;
+    loss_algorithm.Initialize(APPLICATION_DATA, nullptr);
+    AckedPacketVector packets_acked;
+    LostPacketVector packets_lost;
+
+    const size_t iterations = kPacketsScanned / num_packets;
+    const double detect_losses_ns = NanosecondsPerOp(iterations, [&](size_t) {
+      loss_algorithm.Reset();
+      loss_algorithm.DetectLosses(unacked_packets, now, rtt_stats,
+                                  largest_acked, packets_acked, &packets_lost);
+    });
+    const double first_in_flight_ns = NanosecondsPerOp(iterations, [&](size_t) {
+      benchmark_sink =
+          unacked_packets.GetFirstInFlightTransmissionInfo()->bytes_sent;
+    });
+    const double multiple_in_flight_ns =
+        NanosecondsPerOp(iterations, [&](size_t) {
+          benchmark_sink = unacked_packets.HasMultipleInFlightPackets();
+        });
+    printf(
+        "unacked_packet_map packets=%zu detect_losses_ns=%.0f "
+        "first_in_flight_ns=%.0f has_multiple_in_flight_ns=%.0f\n",
+        num_packets, detect_losses_ns, first_in_flight_ns,
+        multiple_in_flight_ns);
+  }
+}
+
+// A response body buffered by 100 streams: copied into each send buffer, as
+// WriteOrBufferBody() does, or referenced by a slice sharing the cached body,
+// as QuicSimpleServerStream sends cached responses.
+void BenchmarkSendBuffer() {
+  constexpr size_t kNumStreams = 100;
+  for (size_t body_size : {1024, 16 * 1024, 256 * 1024, 1024 * 1024}) {
+    auto body = std::make_shared<const std::string>(body_size, 'a');
+    for (bool shared : {false, true}) {
+      std::vector<std::unique_ptr<QuicStreamSendBuffer>> send_buffers;
+      const size_t heap_before = HeapBytesInUse();
+      const double ns = NanosecondsPerOp(kNumStreams, [&](size_t) {
+        send_buffers.push_back(std::make_unique<QuicStreamSendBuffer>(
+            quiche::SimpleBufferAllocator::Get()));
+        if (shared) {
+          send_buffers.back()->SaveMemSlice(
+              quiche::QuicheMemSlice(body, body->data(), body->size()));
+        } else {
+          send_buffers.back()->SaveStreamData(*body);
+        }
+      });
+      const size_t heap_after = HeapBytesInUse();
+      printf(
+          "send_buffer body_bytes=%zu body=%s us/response=%.2f "
+          "heap_bytes/stream=%zu\n",
+          body_size, shared ? "shared" : "copied", ns / 1000,
+          (heap_after - heap_before) / kNumStreams);
+    }
+  }
+}
+
+// The receive side of a bulk download over loopback: a child process sends
+// 256MB of 1200 byte datagrams as fast as it can, in sendmmsg batches or in
+// 16 segment UDP GSO sends, and a QuicPacketReader hands them to a processor
+// that only counts them, with and without UDP GRO. Reports the CPU time the
+// reading process spends per GB received. Sessions are not involved: it is
+// the cost of the reads and of the batches handed to ProcessPackets().
+class CountingPacketProcessor : public ProcessPacketInterface {
+ public:
+  void ProcessPacket(const QuicSocketAddress& /*self_address*/,
+                     const QuicSocketAddress& /*peer_address*/,
+                     const QuicReceivedPacket& packet) override {
+    ++packets;
+    bytes += packet.length();
+  }
+
+  void ProcessPackets(
+      absl::Span<const ReceivedPacketWithAddresses> batch) override {
+    ++batches;
+    ProcessPacketInterface::ProcessPackets(batch);
+  }
+
+  size_t packets = 0;
+  size_t batches = 0;
+  size_t bytes = 0;
+};
+
+double CpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void SendBulk(const QuicSocketAddress& address, bool gso) {
+  constexpr size_t kPacketSize = 1200;
+  constexpr size_t kPacketsPerCall = 16;
+  constexpr size_t kTotalBytes = 256 * 1024 * 1024;
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  const sockaddr_storage peer = address.generic_address();
+  connect(fd, reinterpret_cast<const sockaddr*>(&peer), sizeof(sockaddr_in));
+  if (gso) {
+    const int segment_size = kPacketSize;
+    setsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size));
+  }
+  std::vector<char> payload(kPacketSize * kPacketsPerCall, 'a');
+  iovec iovs[kPacketsPerCall];
+  mmsghdr messages[kPacketsPerCall] = {};
+  for (size_t i = 0; i < kPacketsPerCall; ++i) {
+    iovs[i].iov_base = payload.data() + i * kPacketSize;
+    iovs[i].iov_len = kPacketSize;
+    messages[i].msg_hdr.msg_iov = &iovs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  iovec gso_iov = {payload.data(), payload.size()};
+  for (size_t sent = 0; sent < kTotalBytes;
+       sent += kPacketSize * kPacketsPerCall) {
+    if (gso) {
+      msghdr hdr = {};
+      hdr.msg_iov = &gso_iov;
+      hdr.msg_iovlen = 1;
+      sendmsg(fd, &hdr, 0);
+    } else {
+      sendmmsg(fd, messages, kPacketsPerCall, 0);
+    }
+  }
+  close(fd);
+}
+
+// The readers the rx case compares.
+const char* const kReceiveReaders[] = {
+    "recvmmsg",
+#if defined(QUIC_ENABLE_IO_URING)
+    "io_uring",
+#endif
+};
+
+std::unique_ptr<QuicPacketReader> CreateReceiveReader(const char* name,
+                                                      bool gro) {
+#if defined(QUIC_ENABLE_IO_URING)
+  if (strcmp(name, "io_uring") == 0) {
+    return std::make_unique<QuicIoUringPacketReader>(gro);
+  }
+#endif
+  return std::make_unique<QuicPacketReader>(gro);
+}
+
+void BenchmarkReceive() {
+  for (const char* reader_name : kReceiveReaders) {
+    for (bool gro : {false, true}) {
+      QuicUdpSocketApi socket_api;
+      const QuicUdpSocketFd fd =
+          socket_api.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                            kDefaultSocketReceiveBuffer);
+      if (fd == kQuicInvalidSocketFd ||
+          !socket_api.Bind(fd,
+                           QuicSocketAddress(QuicIpAddress::Loopback4(), 0)) ||
+          (gro && !socket_api.EnableUdpGro(fd))) {
+        printf("rx reader=%s gro=%s unavailable\n", reader_name,
+               gro ? "on" : "off");
+        socket_api.Destroy(fd);
+        continue;
+      }
+      QuicSocketAddress address;
+      address.FromSocket(fd);
+      std::unique_ptr<QuicPacketReader> reader =
+          CreateReceiveReader(reader_name, gro);
+      CountingPacketProcessor processor;
+
+      fflush(stdout);
+      const pid_t pid = fork();
+      if (pid == 0) {
+        SendBulk(address, gro);
+        _exit(0);
+      }
+      const double cpu_before = CpuSeconds();
+      // Reads until the socket stays empty for 100ms after the sender exits.
+      bool sender_done = false;
+      while (!sender_done ||
+             socket_api.WaitUntilReadable(
+                 fd, QuicTime::Delta::FromMilliseconds(100))) {
+        if (!sender_done) {
+          sender_done = waitpid(pid, nullptr, WNOHANG) == pid;
+          socket_api.WaitUntilReadable(fd,
+                                       QuicTime::Delta::FromMilliseconds(10));
+        }
+        while (reader->ReadAndDispatchPackets(fd, address.port(),
+                                              *QuicDefaultClock::Get(),
+                                              &processor, nullptr)) {
+        }
+      }
+      const double cpu_seconds = CpuSeconds() - cpu_before;
+      const double gigabytes = processor.bytes / 1e9;
+      printf(
+          "rx reader=%s gro=%s received_mb=%.1f packets/batch=%.1f "
+          "cpu_s/gb=%.3f\n",
+          reader_name, gro ? "on" : "off", processor.bytes / 1e6,
+          static_cast<double>(processor.packets) /
+              std::max<size_t>(processor.batches, 1),
+          gigabytes > 0 ? cpu_seconds / gigabytes : 0);
+      reader.reset();
+      socket_api.Destroy(fd);
+    }
+  }
+}
+
+// The send side of a bulk upload over loopback: 256MB of 1200 byte packets
+// written through a batch writer and flushed every 16 packets, as after a
+// round of sends, to a socket that never reads them, so the kernel drops
+// what its receive buffer cannot take. Reports the CPU time the writing
+// process spends per GB sent.
+const char* const kSendWriters[] = {
+    "sendmmsg",
+#if defined(QUIC_ENABLE_IO_URING)
+    "io_uring",
+#endif
+};
+
+std::unique_ptr<QuicPacketWriter> CreateSendWriter(const char* name, int fd) {
+#if defined(QUIC_ENABLE_IO_URING)
+  if (strcmp(name, "io_uring") == 0) {
+    return std::make_unique<QuicIoUringBatchWriter>(
+        std::make_unique<QuicBatchWriterBuffer>(), fd);
+  }
+#endif
+  return std::make_unique<QuicSendmmsgBatchWriter>(
+      std::make_unique<QuicBatchWriterBuffer>(), fd);
+}
+
+void BenchmarkSend() {
+  constexpr size_t kPacketSize = 1200;
+  constexpr size_t kPacketsPerFlush = 16;
+  constexpr size_t kTotalBytes = 256 * 1024 * 1024;
+  for (const char* writer_name : kSendWriters) {
+    QuicUdpSocketApi socket_api;
+    const QuicUdpSocketFd receiver =
+        socket_api.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                          kDefaultSocketReceiveBuffer);
+    const QuicUdpSocketFd fd =
+        socket_api.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                          kDefaultSocketReceiveBuffer);
+    const QuicSocketAddress loopback(QuicIpAddress::Loopback4(), 0);
+    if (receiver == kQuicInvalidSocketFd || fd == kQuicInvalidSocketFd ||
+        !socket_api.Bind(receiver, loopback) ||
+        !socket_api.Bind(fd, loopback)) {
+      printf("tx writer=%s unavailable\n", writer_name);
+      socket_api.Destroy(receiver);
+      socket_api.Destroy(fd);
+      continue;
+    }
+    QuicSocketAddress peer_address;
+    peer_address.FromSocket(receiver);
+    std::unique_ptr<QuicPacketWriter> writer =
+        CreateSendWriter(writer_name, fd);
+    const std::vector<char> payload(kPacketSize, 'a');
+
+    size_t packets_sent = 0;
+    size_t errors = 0;
+    const double cpu_before = CpuSeconds();
+    for (size_t sent = 0; sent < kTotalBytes; sent += kPacketSize) {
+      WriteResult result =
+          writer->WritePacket(payload.data(), payload.size(),
+                              loopback.host(), peer_address, nullptr);
+      if (++packets_sent % kPacketsPerFlush == 0) {
+        result = writer->Flush();
+      }
+      if (IsWriteBlockedStatus(result.status)) {
+        writer->SetWritable();
+      } else if (IsWriteError(result.status)) {
+        ++errors;
+      }
+    }
+    writer->Flush();
+    const double cpu_seconds = CpuSeconds() - cpu_before;
+    printf("tx writer=%s errors=%zu cpu_s/gb=%.3f\n", writer_name, errors,
+           cpu_seconds / (kTotalBytes / 1e9));
+    writer.reset();
+    socket_api.Destroy(receiver);
+    socket_api.Destroy(fd);
+  }
+}
+
+// Short header packets of 64 connections sent over loopback, from a port of
+// their own, to a SO_REUSEPORT group of 1, 2 or 4 sockets. Each connection
+// ID names a socket where the multi-worker server's steering program reads
+// it. The packets are steered by that program, or for comparison by the
+// kernel's 4-tuple hash only. One thread reads every socket with a
+// QuicPacketReader of its own. Reports the CPU seconds per GB of the reading
+// process, the share of the packets the busiest socket got, and the share
+// that landed on a socket their connection ID does not name. With a single
+// reading thread this shows where packets land and what steering them
+// costs, not how workers on separate cores scale.
+class SteeredPacketProcessor : public ProcessPacketInterface {
+ public:
+  explicit SteeredPacketProcessor(uint8_t socket_index)
+      : socket_index_(socket_index) {}
+
+  void ProcessPacket(const QuicSocketAddress& /*self_address*/,
+                     const QuicSocketAddress& /*peer_address*/,
+                     const QuicReceivedPacket& packet) override {
+    ++packets;
+    bytes += packet.length();
+    if (packet.length() <= QuicWorkerConnectionIdGenerator::kServerIdOffset ||
+        static_cast<uint8_t>(
+            packet.data()[QuicWorkerConnectionIdGenerator::kServerIdOffset]) !=
+            socket_index_) {
+      ++misrouted;
+    }
+  }
+
+  size_t packets = 0;
+  size_t bytes = 0;
+  size_t misrouted = 0;
+
+ private:
+  const uint8_t socket_index_;
+};
+
+void SendSteeredPackets(const QuicSocketAddress& address, size_t num_sockets) {
+  constexpr size_t kNumConnections = 64;
+  constexpr size_t kPacketSize = 1200;
+  constexpr size_t kPacketsPerCall = 16;
+  constexpr size_t kTotalBytes = 128 * 1024 * 1024;
+  const sockaddr_storage peer = address.generic_address();
+  std::vector<int> fds;
+  std::vector<std::vector<char>> payloads;
+  for (size_t i = 0; i < kNumConnections; ++i) {
+    fds.push_back(socket(AF_INET, SOCK_DGRAM, 0));
+    connect(fds.back(), reinterpret_cast<const sockaddr*>(&peer),
+            sizeof(sockaddr_in));
+    // A short header, then a connection ID whose server ID names a socket.
+    payloads.emplace_back(kPacketSize, 'a');
+    payloads.back()[0] = 0x40;
+    payloads.back()[QuicWorkerConnectionIdGenerator::kServerIdOffset] =
+        static_cast<char>(i % num_sockets);
+  }
+  for (size_t sent = 0; sent < kTotalBytes;) {
+    for (size_t i = 0; i < kNumConnections && sent < kTotalBytes; ++i) {
+      iovec iov = {payloads[i].data(), kPacketSize};
+      mmsghdr messages[kPacketsPerCall] = {};
+      for (mmsghdr& message : messages) {
+        message.msg_hdr.msg_iov = &iov;
+        message.msg_hdr.msg_iovlen = 1;
+      }
+      sendmmsg(fds[i], messages, kPacketsPerCall, 0);
+      sent += kPacketSize * kPacketsPerCall;
+    }
+  }
+  for (int fd : fds) {
+    close(fd);
+  }
+}
+
+void BenchmarkReuseport() {
+  struct Config {
+    size_t num_sockets;
+    bool steering;
+  };
+  for (const Config& config : {Config{1, false}, Config{2, true},
+                               Config{4, true}, Config{4, false}}) {
+    QuicUdpSocketApi socket_api;
+    std::vector<QuicUdpSocketFd> fds;
+    QuicSocketAddress address(QuicIpAddress::Loopback4(), 0);
+    bool ok = true;
+    for (size_t i = 0; ok && i < config.num_sockets; ++i) {
+      const QuicUdpSocketFd fd =
+          socket_api.Create(AF_INET, kDefaultSocketReceiveBuffer,
+                            kDefaultSocketReceiveBuffer);
+      const int one = 1;
+      ok = fd != kQuicInvalidSocketFd &&
+           setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == 0 &&
+           socket_api.Bind(fd, address);
+      fds.push_back(fd);
+      if (ok && i == 0) {
+        address.FromSocket(fd);
+      }
+    }
+    if (ok && config.steering) {
+      ok = QuicWorkerConnectionIdGenerator::AttachSteeringProgram(
+          fds[0], config.num_sockets);
+    }
+    if (!ok) {
+      printf("reuseport sockets=%zu steering=%s unavailable\n",
+             config.num_sockets, config.steering ? "on" : "off");
+      for (QuicUdpSocketFd fd : fds) {
+        socket_api.Destroy(fd);
+      }
+      continue;
+    }
+    std::vector<std::unique_ptr<QuicPacketReader>> readers;
+    std::vector<SteeredPacketProcessor> processors;
+    std::vector<pollfd> poll_fds;
+    for (size_t i = 0; i < config.num_sockets; ++i) {
+      readers.push_back(std::make_unique<QuicPacketReader>());
+      processors.emplace_back(static_cast<uint8_t>(i));
+      poll_fds.push_back({fds[i], POLLIN, 0});
+    }
+
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+      SendSteeredPackets(address, config.num_sockets);
+      _exit(0);
+    }
+    const double cpu_before = CpuSeconds();
+    // Reads until the sockets stay empty for 100ms after the sender exits.
+    bool sender_done = false;
+    for (;;) {
+      if (!sender_done) {
+        sender_done = waitpid(pid, nullptr, WNOHANG) == pid;
+      }
+      if (poll(poll_fds.data(), poll_fds.size(), sender_done ? 100 : 10) <= 0) {
+        if (sender_done) {
+          break;
+        }
+        continue;
+      }
+      for (size_t i = 0; i < poll_fds.size(); ++i) {
+        if (poll_fds[i].revents & POLLIN) {
+          while (readers[i]->ReadAndDispatchPackets(
+              fds[i], address.port(), *QuicDefaultClock::Get(),
+              &processors[i], nullptr)) {
+          }
+        }
+      }
+    }
+    const double cpu_seconds = CpuSeconds() - cpu_before;
+    size_t packets = 0;
+    size_t bytes = 0;
+    size_t misrouted = 0;
+    size_t busiest = 0;
+    for (const SteeredPacketProcessor& processor : processors) {
+      packets += processor.packets;
+      bytes += processor.bytes;
+      misrouted += processor.misrouted;
+      busiest = std::max(busiest, processor.packets);
+    }
+    const double total = std::max<size_t>(packets, 1);
+    printf(
+        "reuseport sockets=%zu steering=%s received_mb=%.1f cpu_s/gb=%.3f "
+        "busiest_socket=%.0f%% misrouted=%.0f%%\n",
+        config.num_sockets, config.steering ? "on" : "off", bytes / 1e6,
+        bytes > 0 ? cpu_seconds / (bytes / 1e9) : 0, 100 * busiest / total,
+        100 * misrouted / total);
+    readers.clear();
+    for (QuicUdpSocketFd fd : fds) {
+      socket_api.Destroy(fd);
+    }
+  }
+}
+
+// Header protection removal on the receive path, the mask generated by an
+// AES-128-GCM decrypter for each packet as QuicFramer used to, into a string
+// read through a QuicDataReader, and as it does now, into a stack buffer.
+// Reports the time and heap allocations per packet.
+void BenchmarkHeaderProtection() {
+  constexpr size_t kNumPackets = 2000000;
+  Aes128GcmDecrypter decrypter;
+  const std::string key(decrypter.GetKeySize(), 'k');
+  if (!decrypter.SetHeaderProtectionKey(key)) {
+    printf("header_protection unavailable\n");
+    return;
+  }
+  char packet[kMaxOutgoingPacketSize];
+  for (size_t i = 0; i < sizeof(packet); ++i) {
+    packet[i] = static_cast<char>(i * 7);
+  }
+  for (bool stack_mask : {false, true}) {
+    const size_t calls_before = operator_new_calls;
+    const double ns = NanosecondsPerOp(kNumPackets, [&](size_t i) {
+      // Samples of consecutive packets differ.
+      const absl::string_view sample(
+          packet + i % 1024, QuicDecrypter::kHeaderProtectionSampleLength);
+      if (stack_mask) {
+        uint8_t mask[QuicDecrypter::kHeaderProtectionMaskLength];
+        decrypter.GenerateHeaderProtectionMask(sample, absl::MakeSpan(mask));
+        benchmark_sink = mask[0];
+      } else {
+        QuicDataReader sample_reader(sample);
+        const std::string mask =
+            decrypter.GenerateHeaderProtectionMask(&sample_reader);
+        benchmark_sink = mask[0];
+      }
+    });
+    printf(
+        "header_protection mask=%s ns/packet=%.1f "
+        "heap_allocations/packet=%.2f\n",
+        stack_mask ? "stack" : "string", ns,
+        static_cast<double>(operator_new_calls - calls_before) / kNumPackets);
+  }
+}
+
+// The binary qlog records of a 10000 packet connection: each packet sent
+// with a stream frame, an ack received every other packet along with an RTT
+// update, and one packet in 100 lost. The records are drained into a sink
+// that only counts them. Reports the events encoded per second, their size
+// and the heap allocations per event. The JSON path needs rapidjson, so it
+// is not measured here.
+void BenchmarkQLogBinary() {
+  constexpr size_t kNumConnections = 100;
+  constexpr uint64_t kPacketsPerConnection = 10000;
+  QLogBinaryWriter writer;
+  uint64_t bytes_drained = 0;
+  auto sink = [&bytes_drained](const char* /*data*/, size_t length) {
+    bytes_drained += length;
+  };
+  QuicPacketHeader ack_header;
+  ack_header.form = IETF_QUIC_SHORT_HEADER_PACKET;
+  // Built up front, so that only the writer's allocations are counted.
+  std::vector<QuicAckFrame> ack_frames(kPacketsPerConnection / 2);
+  for (size_t i = 0; i < ack_frames.size(); ++i) {
+    ack_frames[i].ack_delay_time = QuicTime::Delta::FromMilliseconds(1);
+    ack_frames[i].packets.AddRange(QuicPacketNumber(2 * i + 1),
+                                   QuicPacketNumber(2 * i + 3));
+  }
+  const std::chrono::microseconds rtt(20000);
+
+  const size_t calls_before = operator_new_calls;
+  const double ns = NanosecondsPerOp(kNumConnections, [&](size_t) {
+    writer.WriteFileHeader();
+    writer.WriteTraceHeader(std::chrono::microseconds(0),
+                            Perspective::IS_SERVER, "dcid", "scid", "QUIC",
+                            "127.0.0.1:443", "bench");
+    for (uint64_t packet_number = 1; packet_number <= kPacketsPerConnection;
+         ++packet_number) {
+      const std::chrono::microseconds now(packet_number * 100);
+      QuicStreamFrame stream_frame(4, false, packet_number * 1200, 1200);
+      writer.StartPacketSent(now, packet_number, kDefaultMaxPacketSize,
+                             NOT_RETRANSMISSION, ENCRYPTION_FORWARD_SECURE);
+      writer.AddPacketFrame(STREAM_FRAME, &stream_frame);
+      writer.FinishPacket();
+      if (packet_number % 2 == 0) {
+        ack_header.packet_number = QuicPacketNumber(packet_number / 2);
+        writer.StartPacketReceived(now, ack_header, 40);
+        writer.AddPacketFrame(ACK_FRAME, &ack_frames[packet_number / 2 - 1]);
+        writer.FinishPacket();
+        writer.WriteMetricUpdate(now, rtt, rtt, rtt,
+                                 std::chrono::microseconds(1000));
+      }
+      if (packet_number % 100 == 0) {
+        writer.WritePacketLost(now, packet_number - 10,
+                               ENCRYPTION_FORWARD_SECURE, NOT_RETRANSMISSION);
+      }
+      if (writer.NeedsDrain()) {
+        writer.Drain(sink);
+      }
+    }
+    writer.Drain(sink);
+  });
+  const double events = static_cast<double>(writer.records_written());
+  printf(
+      "qlog_binary events/s=%.0f bytes/event=%.1f "
+      "heap_allocations/event=%.5f\n",
+      events / (ns * kNumConnections / 1e9), bytes_drained / events,
+      (operator_new_calls - calls_before) / events);
+  benchmark_sink = bytes_drained;
+}
+
+// The qlog summary of a connection, published by its owning thread after
+// every packet while 0 to 4 sink threads poll it without pause: through the
+// QLogSummarySnapshot seqlock, and for reference through a copy behind a
+// QuicMutex, as the summary used to be published. The reference leaves out
+// the rapidjson Document the old path rebuilt on each update, so it is a
+// lower bound of that path. Reports the time per publish and the reads per
+// second of all the readers.
+void BenchmarkQLogSummary() {
+  constexpr size_t kNumUpdates = 2000000;
+  for (int num_readers : {0, 1, 4}) {
+    for (bool seqlock : {true, false}) {
+      QLogSummaryCounters counters;
+      QLogSummarySnapshot snapshot(counters, nullptr);
+      QuicMutex mutex;
+      QLogSummaryCounters locked_counters;
+      std::atomic<bool> done(false);
+      std::atomic<uint64_t> reads(0);
+      std::vector<std::thread> readers;
+      for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back([&] {
+          uint64_t thread_reads = 0;
+          uint64_t packets = 0;
+          while (!done.load(std::memory_order_relaxed)) {
+            if (seqlock) {
+              packets += snapshot.Read().total_packets_sent;
+            } else {
+              QuicReaderMutexLock lock(&mutex);
+              packets += locked_counters.total_packets_sent;
+            }
+            ++thread_reads;
+          }
+          benchmark_sink = packets;
+          reads += thread_reads;
+        });
+      }
+      const auto start = std::chrono::steady_clock::now();
+      const double ns = NanosecondsPerOp(kNumUpdates, [&](size_t i) {
+        counters.num_events += 2;
+        counters.end_time_us = i * 100;
+        ++counters.total_packets_sent;
+        counters.total_bytes_sent += kDefaultMaxPacketSize;
+        if (seqlock) {
+          snapshot.Publish(counters);
+        } else {
+          QuicWriterMutexLock lock(&mutex);
+          locked_counters = counters;
+        }
+      });
+      done = true;
+      for (std::thread& reader : readers) {
+        reader.join();
+      }
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      printf(
+          "qlog_summary publish=%s readers=%d ns/publish=%.1f "
+          "reads/s=%.0f\n",
+          seqlock ? "seqlock" : "mutex", num_readers, ns,
+          reads / elapsed.count());
+    }
+  }
+}
+
+#if defined(QUIC_ENABLE_XSK)
+// The IPv6 UDP checksum of the xsk writers: the payload sum with each
+// kernel, the scalar one being the loop they used before the vector ones.
+void BenchmarkXskChecksum() {
+  constexpr size_t kIterations = 2000000;
+  const std::pair<QuicXskChecksumKernel, const char*> kernels[] = {
+      {QuicXskChecksumKernel::kScalar, "scalar"},
+      {QuicXskChecksumKernel::kSse2, "sse2"},
+      {QuicXskChecksumKernel::kAvx2, "avx2"},
+  };
+  std::vector<uint8_t> payload(kMaxOutgoingPacketSize);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i * 7);
+  }
+  for (size_t length : {64, 512, 1200, 1452}) {
+    for (const auto& [kernel, name] : kernels) {
+      if (!QuicXskChecksumKernelSupported(kernel)) {
+        continue;
+      }
+      const double ns = NanosecondsPerOp(kIterations, [&](size_t i) {
+        benchmark_sink = QuicXskChecksumPartialWithKernel(
+            kernel, payload.data(), length, i);
+      });
+      printf("xsk_checksum payload_bytes=%zu kernel=%s ns/packet=%.1f\n",
+             length, name, ns);
+    }
+  }
+}
+#endif
+
+struct Benchmark {
+  const char* name;
+  void (*run)();
+};
+
+constexpr Benchmark kBenchmarks[] = {
+    {"frame_arena", BenchmarkFrameArena},
+    {"alarms", BenchmarkAlarms},
+    {"packet_clone", BenchmarkPacketClone},
+    {"unacked_packet_map", BenchmarkUnackedPacketMap},
+    {"send_buffer", BenchmarkSendBuffer},
+    {"rx", BenchmarkReceive},
+    {"tx", BenchmarkSend},
+    {"reuseport", BenchmarkReuseport},
+    {"header_protection", BenchmarkHeaderProtection},
+    {"qlog_binary", BenchmarkQLogBinary},
+    {"qlog_summary", BenchmarkQLogSummary},
+#if defined(QUIC_ENABLE_XSK)
+    {"xsk_checksum", BenchmarkXskChecksum},
+#endif
+};
+
+}  // namespace
+}  // namespace quic
+
+// Counts the allocations of the benchmarked code.
+void* operator new(size_t size) {
+  ++quic::operator_new_calls;
+  if (void* p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+int main(int argc, char* argv[]) {
+  for (const quic::Benchmark& benchmark : quic::kBenchmarks) {
+    bool selected = argc == 1;
+    for (int i = 1; i < argc; ++i) {
+      selected = selected || strcmp(argv[i], benchmark.name) == 0;
+    }
+    if (selected) {
+      benchmark.run();
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include "gquiche/quic/tools/quic_multi_worker_server.h"
+
+#include <utility>
+
+#include "gquiche/quic/core/quic_default_connection_helper.h"
+#include "gquiche/quic/core/quic_dispatcher.h"
+#include "gquiche/quic/platform/api/quic_flags.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
+#include "gquiche/quic/tools/quic_simple_dispatcher.h"
+
+namespace quic {
+
+QuicServerWorker::QuicServerWorker(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* quic_simple_server_backend,
+    const ParsedQuicVersionVector& supported_versions, size_t worker_index)
+    : QuicServer(std::move(proof_source), quic_simple_server_backend,
+                 supported_versions),
+      connection_id_generator_(worker_index,
+                               expected_server_connection_id_length()) {
+  set_reuse_port(true);
+}
+
+QuicServerWorker::~QuicServerWorker() = default;
+
+QuicDispatcher* QuicServerWorker::CreateQuicDispatcher() {
+  return new QuicSimpleDispatcher(
+      &config(), &crypto_config(), version_manager(),
+      std::make_unique<QuicDefaultConnectionHelper>(),
+      std::unique_ptr<QuicCryptoServerStreamBase::Helper>(
+          new QuicSimpleCryptoServerStreamHelper()),
+      event_loop()->CreateAlarmFactory(), server_backend(),
+      expected_server_connection_id_length(), connection_id_generator_);
+}
+
+QuicMultiWorkerServer::QuicMultiWorkerServer(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* quic_simple_server_backend,
+    const ParsedQuicVersionVector& supported_versions, size_t num_workers)
+    : proof_source_(std::move(proof_source)),
+      quic_simple_server_backend_(quic_simple_server_backend),
+      num_workers_(num_workers),
+      writer_mode_(QuicServer::WriterMode::kAuto),
+      udp_gro_(false),
+      io_uring_reader_(false),
+      event_loop_factory_(nullptr),
+      port_(0) {
+  QUICHE_DCHECK_GT(num_workers_, 0u);
+  // Steering relies on the server choosing every connection ID, which only
+  // versions with variable length connection IDs allow.
+  for (const ParsedQuicVersion& version : supported_versions) {
+    if (version.AllowsVariableLengthConnectionIds()) {
+      supported_versions_.push_back(version);
+    } else {
+      QUIC_LOG(WARNING) << "Multi-worker server does not support "
+                        << ParsedQuicVersionToString(version);
+    }
+  }
+  // Have the dispatchers and connections issue connection IDs through the
+  // workers' generators.
+  SetQuicRestartFlag(quic_abstract_connection_id_generator, true);
+  SetQuicReloadableFlag(quic_connection_uses_abstract_connection_id_generator,
+                        true);
+}
+
+QuicMultiWorkerServer::~QuicMultiWorkerServer() = default;
+
+bool QuicMultiWorkerServer::CreateUDPSocketAndListen(
+    const QuicSocketAddress& address) {
+  if (num_workers_ > QuicWorkerConnectionIdGenerator::kMaxWorkers) {
+    QUIC_LOG(ERROR) << "At most "
+                    << QuicWorkerConnectionIdGenerator::kMaxWorkers
+                    << " workers are supported";
+    return false;
+  }
+  QuicSocketAddress worker_address = address;
+  for (size_t i = 0; i < num_workers_; ++i) {
+    std::unique_ptr<ProofSource> worker_proof_source;
+    QuicAsyncProofSource* async_proof_source = nullptr;
+    if (signing_thread_pool_ != nullptr) {
+      auto proof_source = std::make_unique<QuicAsyncProofSource>(
+          proof_source_, signing_thread_pool_);
+      async_proof_source = proof_source.get();
+      worker_proof_source = std::move(proof_source);
+    } else {
+      worker_proof_source =
+          std::make_unique<QuicSharedProofSource>(proof_source_);
+    }
+    workers_.push_back(std::make_unique<QuicServerWorker>(
+        std::move(worker_proof_source), quic_simple_server_backend_,
+        supported_versions_, i));
+    workers_.back()->set_async_proof_source(async_proof_source);
+    workers_.back()->set_writer_mode(writer_mode_);
+    workers_.back()->set_udp_gro(udp_gro_);
+    workers_.back()->set_io_uring_reader(io_uring_reader_);
+    workers_.back()->set_event_loop_factory(event_loop_factory_);
+    if (!workers_.back()->CreateUDPSocketAndListen(worker_address)) {
+      return false;
+    }
+    if (i == 0) {
+      port_ = workers_[0]->port();
+      worker_address = QuicSocketAddress(address.host(), port_);
+    }
+  }
+  // The sockets of the group are indexed in the order they were bound, which
+  // is the workers' order.
+  if (!AttachSteeringProgram()) {
+    return false;
+  }
+  QUIC_LOG(INFO) << "Serving port " << port_ << " with " << num_workers_
+                 << " workers";
+  return true;
+}
+
+bool QuicMultiWorkerServer::AttachSteeringProgram() {
+  if (num_workers_ == 1) {
+    return true;
+  }
+  return QuicWorkerConnectionIdGenerator::AttachSteeringProgram(
+      workers_[0]->fd(), num_workers_);
+}
+
+void QuicMultiWorkerServer::HandleEventsForever() {
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    threads_.push_back(std::make_unique<WorkerThread>(workers_[i].get(), i));
+    threads_.back()->Start();
+  }
+  workers_[0]->HandleEventsForever();
+}
+
+}  // namespace quic
@@ -0,0 +1,125 @@
+// A server running several QuicServer workers, each with its own thread,
+// event loop, dispatcher and UDP socket, all bound to the same address with
+// SO_REUSEPORT.
+//
+// By default the kernel picks a socket of a reuseport group by hashing the
+// 4-tuple, which sends a migrated connection's packets to the wrong worker.
+// Instead, every worker issues connection IDs that carry its index in clear
+// (see QuicWorkerConnectionIdGenerator), and a classic BPF program attached
+// to the group reads it from the destination connection ID of short header
+// packets. Long header packets, and connection IDs no worker issued, still
+// go by the 4-tuple hash, so a handshake stays on the worker it started on.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_MULTI_WORKER_SERVER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_MULTI_WORKER_SERVER_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gquiche/quic/core/crypto/proof_source.h"
+#include "gquiche/quic/platform/api/quic_thread.h"
+#include "gquiche/quic/tools/quic_async_proof_source.h"
+#include "gquiche/quic/tools/quic_server.h"
+#include "gquiche/quic/tools/quic_shared_proof_source.h"
+#include "gquiche/quic/tools/quic_spdy_server_base.h"
+#include "gquiche/quic/tools/quic_worker_connection_id_generator.h"
+
+namespace quic {
+
+// One worker, listening on its own SO_REUSEPORT socket.
+class QuicServerWorker : public QuicServer {
+ public:
+  QuicServerWorker(std::unique_ptr<ProofSource> proof_source,
+                   QuicSimpleServerBackend* quic_simple_server_backend,
+                   const ParsedQuicVersionVector& supported_versions,
+                   size_t worker_index);
+
+  ~QuicServerWorker() override;
+
+  // The listening socket, e.g. to attach the steering program to its group.
+  using QuicServer::fd;
+
+ protected:
+  QuicDispatcher* CreateQuicDispatcher() override;
+
+ private:
+  QuicWorkerConnectionIdGenerator connection_id_generator_;
+};
+
+class QuicMultiWorkerServer : public QuicSpdyServerBase {
+ public:
+  QuicMultiWorkerServer(std::unique_ptr<ProofSource> proof_source,
+                        QuicSimpleServerBackend* quic_simple_server_backend,
+                        const ParsedQuicVersionVector& supported_versions,
+                        size_t num_workers);
+  QuicMultiWorkerServer(const QuicMultiWorkerServer&) = delete;
+  QuicMultiWorkerServer& operator=(const QuicMultiWorkerServer&) = delete;
+
+  ~QuicMultiWorkerServer() override;
+
+  // Binds every worker's socket to |address| and attaches the steering
+  // program. If the port of |address| is 0, all of them share the one the
+  // first worker gets.
+  bool CreateUDPSocketAndListen(const QuicSocketAddress& address) override;
+
+  // Runs the first worker on the calling thread and the others on their
+  // own. Does not return.
+  void HandleEventsForever() override;
+
+  // See QuicServer::set_writer_mode(). Applies to every worker.
+  void set_writer_mode(QuicServer::WriterMode mode) { writer_mode_ = mode; }
+  // See QuicServer::set_udp_gro(). Applies to every worker.
+  void set_udp_gro(bool value) { udp_gro_ = value; }
+  // See QuicServer::set_io_uring_reader(). Applies to every worker.
+  void set_io_uring_reader(bool value) { io_uring_reader_ = value; }
+  // See QuicServer::set_event_loop_factory(). Applies to every worker.
+  void set_event_loop_factory(QuicEventLoopFactory* factory) {
+    event_loop_factory_ = factory;
+  }
+  // If set, every worker computes its TLS signatures on |pool|.
+  void set_signing_thread_pool(std::shared_ptr<QuicSigningThreadPool> pool) {
+    signing_thread_pool_ = std::move(pool);
+  }
+
+  int port() const { return port_; }
+  size_t num_workers() const { return workers_.size(); }
+  QuicServerWorker* worker(size_t index) { return workers_[index].get(); }
+
+ private:
+  class WorkerThread : public QuicThread {
+   public:
+    WorkerThread(QuicServerWorker* worker, size_t index)
+        : QuicThread("quic_server_worker_" + std::to_string(index)),
+          worker_(worker) {}
+
+    void Run() override { worker_->HandleEventsForever(); }
+
+   private:
+    QuicServerWorker* worker_;
+  };
+
+  // Attaches the program steering short header packets to the worker whose
+  // index their connection ID carries.
+  bool AttachSteeringProgram();
+
+  // Shared by the workers' crypto configs.
+  std::shared_ptr<ProofSource> proof_source_;
+  QuicSimpleServerBackend* quic_simple_server_backend_;  // Unowned.
+  ParsedQuicVersionVector supported_versions_;
+  const size_t num_workers_;
+  QuicServer::WriterMode writer_mode_;
+  bool udp_gro_;
+  bool io_uring_reader_;
+  QuicEventLoopFactory* event_loop_factory_;  // Unowned.
+  std::shared_ptr<QuicSigningThreadPool> signing_thread_pool_;
+  int port_;
+
+  std::vector<std::unique_ptr<QuicServerWorker>> workers_;
+  std::vector<std::unique_ptr<WorkerThread>> threads_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_MULTI_WORKER_SERVER_H_
@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <memory>
 
+#include "gquiche/quic/core/batch_writer/quic_gso_batch_writer.h"
+#include "gquiche/quic/core/batch_writer/quic_sendmmsg_batch_writer.h"
 #include "gquiche/quic/core/crypto/crypto_handshake.h"
 #include "gquiche/quic/core/crypto/quic_random.h"
 #include "gquiche/quic/core/io/event_loop_socket_factory.h"
@@ -19,15 +21,22 @@
 #include "gquiche/quic/core/quic_default_connection_helper.h"
 #include "gquiche/quic/core/quic_default_packet_writer.h"
 #include "gquiche/quic/core/quic_dispatcher.h"
+#include "gquiche/quic/core/quic_linux_socket_utils.h"
 #include "gquiche/quic/core/quic_packet_reader.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/platform/api/quic_flags.h"
 #include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/tools/quic_async_proof_source.h"
 #include "gquiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
 #include "gquiche/quic/tools/quic_simple_dispatcher.h"
 #include "gquiche/quic/tools/quic_simple_server_backend.h"
 #include "gquiche/common/simple_buffer_allocator.h"
 
+#ifdef QUIC_ENABLE_IO_URING
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_batch_writer.h"
+#include "gquiche/quic/core/batch_writer/io_uring/quic_io_uring_packet_reader.h"
+#endif
+
 namespace quic {
 
 namespace {
@@ -61,6 +70,12 @@ QuicServer::QuicServer(
       packets_dropped_(0),
       overflow_supported_(false),
       silent_close_(false),
+      reuse_port_(false),
+      writer_mode_(WriterMode::kAuto),
+      udp_gro_(false),
+      io_uring_reader_(false),
+      async_proof_source_(nullptr),
+      event_loop_factory_(nullptr),
       config_(config),
       crypto_config_(kSourceAddressTokenSecret, QuicRandom::GetInstance(),
                      std::move(proof_source), KeyExchangeSource::Default()),
@@ -97,6 +112,9 @@ void QuicServer::Initialize() {
 }
 
 QuicServer::~QuicServer() {
+  // A no-op after Shutdown(). The proof source goes away with
+  // |crypto_config_| right after this.
+  UnregisterAsyncProofSource();
   close(fd_);
   fd_ = -1;
 
@@ -122,8 +140,34 @@ bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
     return false;
   }
 
+  if (reuse_port_) {
+    int one = 1;
+    if (setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+      QUIC_LOG(ERROR) << "Failed to set SO_REUSEPORT: " << strerror(errno);
+      return false;
+    }
+  }
+
   overflow_supported_ = socket_api.EnableDroppedPacketCount(fd_);
   socket_api.EnableReceiveTimestamp(fd_);
+  bool gro_enabled = false;
+  if (udp_gro_) {
+    gro_enabled = socket_api.EnableUdpGro(fd_);
+    if (gro_enabled) {
+      packet_reader_ = std::make_unique<QuicPacketReader>(/*enable_gro=*/true);
+    } else {
+      QUIC_LOG(WARNING) << "Failed to enable UDP GRO: " << strerror(errno);
+    }
+  }
+  if (io_uring_reader_) {
+#ifdef QUIC_ENABLE_IO_URING
+    QUIC_LOG(INFO) << "Reading with io_uring";
+    packet_reader_ = std::make_unique<QuicIoUringPacketReader>(gro_enabled);
+#else
+    QUIC_LOG(ERROR) << "io_uring reader requires QUIC_ENABLE_IO_URING";
+    return false;
+#endif
+  }
 
   sockaddr_storage addr = address.generic_address();
   int rc = bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
@@ -147,13 +191,72 @@ bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
   if (!register_result) {
     return false;
   }
+  if (async_proof_source_ != nullptr &&
+      (!async_proof_source_->Initialize() ||
+       !event_loop_->RegisterSocket(async_proof_source_->completion_fd(),
+                                    kSocketEventReadable, this))) {
+    QUIC_LOG(ERROR) << "Failed to wait for asynchronous signatures";
+    return false;
+  }
   dispatcher_.reset(CreateQuicDispatcher());
   dispatcher_->InitializeWithWriter(CreateWriter(fd_));
+  // WaitForEvents() flushes the resets buffered by a batch writer together.
+  dispatcher_->time_wait_list_manager()->set_defer_batch_flush(true);
 
   return true;
 }
 
+// static
+bool QuicServer::ParseWriterMode(absl::string_view name, WriterMode* mode) {
+  if (name == "auto") {
+    *mode = WriterMode::kAuto;
+  } else if (name == "default") {
+    *mode = WriterMode::kDefault;
+  } else if (name == "sendmmsg") {
+    *mode = WriterMode::kSendmmsg;
+  } else if (name == "gso") {
+    *mode = WriterMode::kGso;
+#ifdef QUIC_ENABLE_IO_URING
+  } else if (name == "io_uring") {
+    *mode = WriterMode::kIoUring;
+#endif
+  } else {
+    return false;
+  }
+  return true;
+}
+
 QuicPacketWriter* QuicServer::CreateWriter(int fd) {
+  WriterMode mode = writer_mode_;
+  if (mode == WriterMode::kAuto) {
+    mode = QuicLinuxSocketUtils::GetUDPSegmentSize(fd) < 0
+               ? WriterMode::kSendmmsg
+               : WriterMode::kGso;
+  }
+  switch (mode) {
+    case WriterMode::kGso: {
+      auto* writer = new QuicGsoBatchWriter(fd);
+      QUIC_LOG(INFO) << "Sending with GSO, release time "
+                     << (writer->SupportsReleaseTime() ? "enabled"
+                                                       : "disabled");
+      return writer;
+    }
+    case WriterMode::kSendmmsg:
+      QUIC_LOG(INFO) << "Sending with sendmmsg";
+      return new QuicSendmmsgBatchWriter(
+          std::make_unique<QuicBatchWriterBuffer>(), fd);
+    case WriterMode::kIoUring:
+#ifdef QUIC_ENABLE_IO_URING
+      QUIC_LOG(INFO) << "Sending with io_uring";
+      return new QuicIoUringBatchWriter(
+          std::make_unique<QuicBatchWriterBuffer>(), fd);
+#else
+      break;
+#endif
+    case WriterMode::kAuto:
+    case WriterMode::kDefault:
+      break;
+  }
   return new QuicDefaultPacketWriter(fd);
 }
 
@@ -167,8 +270,15 @@ QuicDispatcher* QuicServer::CreateQuicDispatcher() {
       expected_server_connection_id_length_, connection_id_generator_);
 }
 
+ProcessPacketInterface* QuicServer::packet_processor() {
+  return dispatcher_.get();
+}
+
 std::unique_ptr<QuicEventLoop> QuicServer::CreateEventLoop() {
-  return GetDefaultEventLoop()->Create(QuicDefaultClock::Get());
+  QuicEventLoopFactory* factory = event_loop_factory_ != nullptr
+                                      ? event_loop_factory_
+                                      : GetDefaultEventLoop();
+  return factory->Create(QuicDefaultClock::Get());
 }
 
 void QuicServer::HandleEventsForever() {
@@ -179,9 +289,29 @@ void QuicServer::HandleEventsForever() {
 
 void QuicServer::WaitForEvents() {
   event_loop_->RunEventLoopOnce(QuicTime::Delta::FromMilliseconds(50));
+  FlushWriter();
+}
+
+void QuicServer::FlushWriter() {
+  QuicPacketWriter* writer = dispatcher_->writer();
+  if (writer == nullptr || !writer->IsBatchMode() ||
+      writer->IsWriteBlocked()) {
+    return;
+  }
+  WriteResult result = writer->Flush();
+  if (result.status == WRITE_STATUS_BLOCKED &&
+      !event_loop_->SupportsEdgeTriggered()) {
+    // Flushed again once the socket is writable.
+    bool success = event_loop_->RearmSocket(fd_, kSocketEventWritable);
+    QUICHE_DCHECK(success);
+  } else if (IsWriteError(result.status)) {
+    QUIC_LOG_FIRST_N(WARNING, 10)
+        << "Flushing the writer failed: " << result;
+  }
 }
 
 void QuicServer::Shutdown() {
+  UnregisterAsyncProofSource();
   if (!silent_close_) {
     // Before we shut down the epoll server, give all active sessions a chance
     // to notify clients that they're closing.
@@ -192,8 +322,29 @@ void QuicServer::Shutdown() {
   event_loop_.reset();
 }
 
+void QuicServer::UnregisterAsyncProofSource() {
+  if (event_loop_ == nullptr || async_proof_source_ == nullptr ||
+      async_proof_source_->completion_fd() < 0) {
+    return;
+  }
+  // Signatures still on the pool complete into the queue, which the pool's
+  // jobs keep alive, but must not wake this loop up anymore.
+  event_loop_->UnregisterSocket(async_proof_source_->completion_fd());
+}
+
 void QuicServer::OnSocketEvent(QuicEventLoop* /*event_loop*/,
                                QuicUdpSocketFd fd, QuicSocketEventMask events) {
+  if (async_proof_source_ != nullptr &&
+      fd == async_proof_source_->completion_fd()) {
+    if (events & kSocketEventReadable) {
+      async_proof_source_->RunCompletedCallbacks();
+      if (!event_loop_->SupportsEdgeTriggered()) {
+        bool success = event_loop_->RearmSocket(fd, kSocketEventReadable);
+        QUICHE_DCHECK(success);
+      }
+    }
+    return;
+  }
   QUICHE_DCHECK_EQ(fd, fd_);
 
   if (events & kSocketEventReadable) {
@@ -204,7 +355,7 @@ void QuicServer::OnSocketEvent(QuicEventLoop* /*event_loop*/,
     bool more_to_read = true;
     while (more_to_read) {
       more_to_read = packet_reader_->ReadAndDispatchPackets(
-          fd_, port_, *QuicDefaultClock::Get(), dispatcher_.get(),
+          fd_, port_, *QuicDefaultClock::Get(), packet_processor(),
           overflow_supported_ ? &packets_dropped_ : nullptr);
     }
 
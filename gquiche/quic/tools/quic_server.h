@@ -20,6 +20,7 @@
 #include "gquiche/quic/core/io/socket_factory.h"
 #include "gquiche/quic/core/quic_config.h"
 #include "gquiche/quic/core/quic_packet_writer.h"
+#include "gquiche/quic/core/quic_process_packet_interface.h"
 #include "gquiche/quic/core/quic_udp_socket.h"
 #include "gquiche/quic/core/quic_version_manager.h"
 #include "gquiche/quic/platform/api/quic_socket_address.h"
@@ -32,11 +33,33 @@ namespace test {
 class QuicServerPeer;
 }  // namespace test
 
+class QuicAsyncProofSource;
 class QuicDispatcher;
 class QuicPacketReader;
 
 class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
  public:
+  // How CreateWriter() sends packets.
+  enum class WriterMode {
+    // GSO if the socket supports UDP_SEGMENT, sendmmsg otherwise.
+    kAuto,
+    // One sendmsg per packet.
+    kDefault,
+    // One sendmmsg per batch of packets, to any peers.
+    kSendmmsg,
+    // One sendmsg per batch of equal sized packets to the same peer, split
+    // by the kernel or the NIC. Also sets SO_TXTIME release times if
+    // quic_support_release_time_for_gso is set and the socket supports it.
+    kGso,
+    // One io_uring(7) submission per batch of packets, to any peers. Only
+    // with QUIC_ENABLE_IO_URING, sendmmsg if the ring cannot be set up.
+    kIoUring,
+  };
+
+  // Returns false if |name| ("auto", "default", "sendmmsg", "gso" or, with
+  // QUIC_ENABLE_IO_URING, "io_uring") names no mode.
+  static bool ParseWriterMode(absl::string_view name, WriterMode* mode);
+
   // `quic_simple_server_backend` must outlive the created QuicServer.
   QuicServer(std::unique_ptr<ProofSource> proof_source,
              QuicSimpleServerBackend* quic_simple_server_backend);
@@ -85,6 +108,33 @@ class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
 
   QuicEventLoop* event_loop() { return event_loop_.get(); }
 
+  // Must be set before CreateUDPSocketAndListen().
+  void set_writer_mode(WriterMode mode) { writer_mode_ = mode; }
+
+  // If true, UDP GRO is enabled on the socket, if supported, and coalesced
+  // reads are split into datagrams. Must be set before
+  // CreateUDPSocketAndListen().
+  void set_udp_gro(bool value) { udp_gro_ = value; }
+
+  // If true, the socket is read with a multishot recvmsg on an io_uring(7)
+  // rather than with recvmmsg. Only with QUIC_ENABLE_IO_URING. Must be set
+  // before CreateUDPSocketAndListen().
+  void set_io_uring_reader(bool value) { io_uring_reader_ = value; }
+
+  // If the proof source the server was created with is a
+  // QuicAsyncProofSource, it must be passed here too, so that the signatures
+  // it computes on other threads complete on the server's event loop. Must be
+  // set before CreateUDPSocketAndListen().
+  void set_async_proof_source(QuicAsyncProofSource* proof_source) {
+    async_proof_source_ = proof_source;
+  }
+
+  // The event loops the server is run with, GetDefaultEventLoop() if null.
+  // Must be set before CreateUDPSocketAndListen().
+  void set_event_loop_factory(QuicEventLoopFactory* factory) {
+    event_loop_factory_ = factory;
+  }
+
  protected:
   virtual QuicPacketWriter* CreateWriter(int fd);
 
@@ -97,6 +147,10 @@ class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
 
   QuicDispatcher* dispatcher() { return dispatcher_.get(); }
 
+  // Where packets read from the socket are handed to. Defaults to the
+  // dispatcher.
+  virtual ProcessPacketInterface* packet_processor();
+
   QuicVersionManager* version_manager() { return &version_manager_; }
 
   QuicSimpleServerBackend* server_backend() {
@@ -105,6 +159,14 @@ class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
 
   void set_silent_close(bool value) { silent_close_ = value; }
 
+  // If true, the socket is bound with SO_REUSEPORT so that several servers
+  // can listen on the same address. Must be set before
+  // CreateUDPSocketAndListen().
+  void set_reuse_port(bool value) { reuse_port_ = value; }
+
+  // The listening socket, once CreateUDPSocketAndListen() succeeded.
+  QuicUdpSocketFd fd() const { return fd_; }
+
   uint8_t expected_server_connection_id_length() {
     return expected_server_connection_id_length_;
   }
@@ -119,6 +181,14 @@ class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
   // Initialize the internal state of the server.
   void Initialize();
 
+  // Sends what a batch writer still holds, at the end of an event loop
+  // iteration. Connections flush their own writes, this catches the rest.
+  void FlushWriter();
+
+  // Stops watching the completion eventfd of |async_proof_source_|, before
+  // the event loop or the proof source goes away.
+  void UnregisterAsyncProofSource();
+
   // Schedules alarms and notifies the server of the I/O events.
   std::unique_ptr<QuicEventLoop> event_loop_;
   // Used by some backends to create additional sockets, e.g. for upstream
@@ -146,6 +216,22 @@ class QuicServer : public QuicSpdyServerBase, public QuicSocketEventListener {
   // without sending a final connection close.
   bool silent_close_;
 
+  // If true, the socket is bound with SO_REUSEPORT.
+  bool reuse_port_;
+
+  WriterMode writer_mode_;
+
+  // If true, the socket is read with UDP GRO.
+  bool udp_gro_;
+
+  // If true, the socket is read through io_uring.
+  bool io_uring_reader_;
+
+  // Owned by |crypto_config_|, if not null.
+  QuicAsyncProofSource* async_proof_source_;
+
+  QuicEventLoopFactory* event_loop_factory_;  // Unowned.
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
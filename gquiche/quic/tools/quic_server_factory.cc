@@ -4,18 +4,263 @@
 
 #include "gquiche/quic/tools/quic_server_factory.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <utility>
 
+#include "gquiche/common/platform/api/quiche_command_line_flags.h"
+#include "gquiche/quic/core/io/quic_poll_event_loop.h"
+#include "gquiche/quic/core/io/quic_timer_wheel_event_loop.h"
+#include "gquiche/quic/platform/api/quic_flags.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/tools/quic_async_proof_source.h"
+#include "gquiche/quic/tools/quic_multi_worker_server.h"
 #include "gquiche/quic/tools/quic_server.h"
 
+#if defined(__linux__)
+#include "gquiche/quic/core/io/quic_epoll_event_loop.h"
+#endif
+
+#ifdef QUIC_ENABLE_IO_URING
+#include "gquiche/quic/core/io/quic_io_uring.h"
+#include "gquiche/quic/core/io/quic_io_uring_event_loop.h"
+#endif
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, num_workers, 1,
+    "If greater than 1, this many worker threads, each with its own "
+    "SO_REUSEPORT socket and dispatcher, serve the port. Short header packets "
+    "are steered to the worker owning their connection ID.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, udp_writer, "auto",
+    "How packets are sent on UDP sockets: \"gso\" batches packets to the "
+    "same peer into one UDP_SEGMENT send, \"sendmmsg\" batches packets to "
+    "any peers into one sendmmsg, \"default\" sends them one by one and "
+    "\"auto\" picks gso if the socket supports it and sendmmsg otherwise. "
+    "With QUIC_ENABLE_IO_URING, \"io_uring\" batches packets to any peers "
+    "into one io_uring submission.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, udp_reader, "recvmmsg",
+    "How packets are read from UDP sockets: \"recvmmsg\" or, with "
+    "QUIC_ENABLE_IO_URING, \"io_uring\", a multishot recvmsg into a ring of "
+    "kernel-picked buffers.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, udp_release_time, true,
+    "If true and the socket supports SO_TXTIME, the gso writer hands paced "
+    "packets to the kernel ahead of time with their release time.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, udp_gro, false,
+    "If true, the server socket is read with UDP GRO, so that one recvmmsg "
+    "entry can carry many datagrams of a flow.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, handshake_threads, 0,
+    "If positive, TLS handshake signatures are computed on this many threads, "
+    "shared by all the workers, instead of on the network threads. The key "
+    "exchange stays on the network threads.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, handshake_queue_depth, 1024,
+    "Signatures beyond this many waiting for a --handshake_threads thread are "
+    "computed on the network thread.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, event_loop, "default",
+    "The event loop the server runs: \"default\" (\"epoll\" on Linux), "
+    "\"epoll\", edge-triggered with microsecond timeouts, \"poll\", "
+    "\"timer_wheel\", which polls but keeps alarms in a hierarchical timing "
+    "wheel, cheaper to set and cancel with many connections, or, with "
+    "QUIC_ENABLE_IO_URING, \"io_uring\", which waits on multishot polls.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, timer_wheel_tick_us, 1000,
+    "The granularity of --event_loop=timer_wheel alarms, which fire up to "
+    "this late.");
+
+#ifdef QUIC_ENABLE_XSK
+#include "gquiche/quic/tools/quic_xsk_multi_queue_server.h"
+#include "gquiche/quic/tools/quic_xsk_server.h"
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, xsk_interface, "",
+    "If set, the server port's traffic on --xsk_queue of this interface is "
+    "received and sent through an AF_XDP socket.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, xsk_queue, 0,
+                                "The interface queue the AF_XDP socket binds.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, xsk_num_queues, 1,
+    "If greater than 1, queues --xsk_queue to --xsk_queue + xsk_num_queues - 1 "
+    "each get an AF_XDP socket served by its own worker thread.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, xsk_shared_umem, false,
+    "If true, the AF_XDP sockets of all the queues share one UMEM, each with "
+    "its own fill and completion rings.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, xsk_bpf_object, "quic_xsk_redirect_kern.o",
+    "The XDP program object built from quic_xsk_redirect_kern.c.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, xsk_generic_mode, false,
+    "If true, attach the XDP program in generic (skb) mode and copy frames, "
+    "e.g. for veth interfaces or drivers without AF_XDP zero copy support.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, xsk_stats_interval_ms, 0,
+    "If positive, log the AF_XDP ring and syscall counters of every queue at "
+    "this interval, to tell whether the XDP path is syscall or ring bound.");
+#endif
+
 namespace quic {
 
+namespace {
+
+// Returns the factory --event_loop names, or nullptr for the default one.
+QuicEventLoopFactory* GetEventLoopFactory() {
+  const std::string event_loop =
+      quiche::GetQuicheCommandLineFlag(FLAGS_event_loop);
+  if (event_loop == "timer_wheel") {
+    static QuicTimerWheelEventLoopFactory* factory =
+        new QuicTimerWheelEventLoopFactory(QuicTime::Delta::FromMicroseconds(
+            std::max(1, quiche::GetQuicheCommandLineFlag(
+                            FLAGS_timer_wheel_tick_us))));
+    return factory;
+  }
+  if (event_loop == "poll") {
+    return QuicPollEventLoopFactory::Get();
+  }
+#if defined(__linux__)
+  if (event_loop == "epoll") {
+    return QuicEpollEventLoopFactory::Get();
+  }
+#endif
+#ifdef QUIC_ENABLE_IO_URING
+  if (event_loop == "io_uring") {
+    if (QuicIoUring::IsSupported()) {
+      return QuicIoUringEventLoopFactory::Get();
+    }
+    QUIC_LOG(ERROR) << "io_uring is not supported, using default";
+    return nullptr;
+  }
+#endif
+  if (event_loop != "default") {
+    QUIC_LOG(ERROR) << "Unknown --event_loop " << event_loop
+                    << ", using default";
+  }
+  return nullptr;
+}
+
+// Returns whether --udp_reader names the io_uring reader.
+bool UseIoUringReader() {
+  const std::string udp_reader =
+      quiche::GetQuicheCommandLineFlag(FLAGS_udp_reader);
+#ifdef QUIC_ENABLE_IO_URING
+  if (udp_reader == "io_uring") {
+    return true;
+  }
+#endif
+  if (udp_reader != "recvmmsg") {
+    QUIC_LOG(ERROR) << "Unknown --udp_reader " << udp_reader
+                    << ", using recvmmsg";
+  }
+  return false;
+}
+
+}  // namespace
+
 std::unique_ptr<quic::QuicSpdyServerBase> QuicServerFactory::CreateServer(
     quic::QuicSimpleServerBackend* backend,
     std::unique_ptr<quic::ProofSource> proof_source,
     const quic::ParsedQuicVersionVector& supported_versions) {
-  return std::make_unique<quic::QuicServer>(std::move(proof_source), backend,
-                                            supported_versions);
+#ifdef QUIC_ENABLE_XSK
+  if (!quiche::GetQuicheCommandLineFlag(FLAGS_xsk_interface).empty()) {
+    QuicXskSocket::Options xsk_options;
+    xsk_options.interface_name =
+        quiche::GetQuicheCommandLineFlag(FLAGS_xsk_interface);
+    xsk_options.queue_id = quiche::GetQuicheCommandLineFlag(FLAGS_xsk_queue);
+    xsk_options.bpf_object_path =
+        quiche::GetQuicheCommandLineFlag(FLAGS_xsk_bpf_object);
+    xsk_options.generic_mode =
+        quiche::GetQuicheCommandLineFlag(FLAGS_xsk_generic_mode);
+    const int32_t num_queues =
+        quiche::GetQuicheCommandLineFlag(FLAGS_xsk_num_queues);
+    const QuicTime::Delta stats_interval = QuicTime::Delta::FromMilliseconds(
+        std::max(0, quiche::GetQuicheCommandLineFlag(
+                        FLAGS_xsk_stats_interval_ms)));
+    if (num_queues > 1) {
+      auto server = std::make_unique<quic::QuicXskMultiQueueServer>(
+          std::move(proof_source), backend, supported_versions, xsk_options,
+          num_queues, quiche::GetQuicheCommandLineFlag(FLAGS_xsk_shared_umem));
+      server->set_xsk_stats_interval(stats_interval);
+      return server;
+    }
+    auto server = std::make_unique<quic::QuicXskServer>(
+        std::move(proof_source), backend, supported_versions, xsk_options);
+    server->set_xsk_stats_interval(stats_interval);
+    return server;
+  }
+#endif
+  QuicServer::WriterMode writer_mode;
+  if (!QuicServer::ParseWriterMode(
+          quiche::GetQuicheCommandLineFlag(FLAGS_udp_writer), &writer_mode)) {
+    QUIC_LOG(ERROR) << "Unknown --udp_writer "
+                    << quiche::GetQuicheCommandLineFlag(FLAGS_udp_writer)
+                    << ", using auto";
+    writer_mode = QuicServer::WriterMode::kAuto;
+  }
+  if (quiche::GetQuicheCommandLineFlag(FLAGS_udp_release_time)) {
+    SetQuicRestartFlag(quic_support_release_time_for_gso, true);
+  }
+  std::shared_ptr<QuicSigningThreadPool> signing_thread_pool;
+  const int32_t handshake_threads =
+      quiche::GetQuicheCommandLineFlag(FLAGS_handshake_threads);
+  if (handshake_threads > 0) {
+    signing_thread_pool = std::make_shared<QuicSigningThreadPool>(
+        handshake_threads,
+        std::max(0, quiche::GetQuicheCommandLineFlag(
+                        FLAGS_handshake_queue_depth)));
+    if (!signing_thread_pool->Initialize()) {
+      QUIC_LOG(ERROR) << "Failed to start the signing threads, signing on "
+                         "the network threads";
+      signing_thread_pool.reset();
+    }
+  }
+  const int32_t num_workers =
+      quiche::GetQuicheCommandLineFlag(FLAGS_num_workers);
+  if (num_workers > 1) {
+    auto server = std::make_unique<quic::QuicMultiWorkerServer>(
+        std::move(proof_source), backend, supported_versions, num_workers);
+    server->set_writer_mode(writer_mode);
+    server->set_udp_gro(quiche::GetQuicheCommandLineFlag(FLAGS_udp_gro));
+    server->set_io_uring_reader(UseIoUringReader());
+    server->set_event_loop_factory(GetEventLoopFactory());
+    server->set_signing_thread_pool(std::move(signing_thread_pool));
+    return server;
+  }
+  QuicAsyncProofSource* async_proof_source = nullptr;
+  if (signing_thread_pool != nullptr) {
+    auto wrapped = std::make_unique<QuicAsyncProofSource>(
+        std::shared_ptr<ProofSource>(std::move(proof_source)),
+        std::move(signing_thread_pool));
+    async_proof_source = wrapped.get();
+    proof_source = std::move(wrapped);
+  }
+  auto server = std::make_unique<quic::QuicServer>(std::move(proof_source),
+                                                   backend, supported_versions);
+  server->set_writer_mode(writer_mode);
+  server->set_udp_gro(quiche::GetQuicheCommandLineFlag(FLAGS_udp_gro));
+  server->set_io_uring_reader(UseIoUringReader());
+  server->set_event_loop_factory(GetEventLoopFactory());
+  server->set_async_proof_source(async_proof_source);
+  return server;
 }
 
 }  // namespace quic
@@ -220,6 +220,20 @@ TEST_F(QuicServerDispatchPacketTest, DispatchPacket) {
   DispatchPacket(encrypted_valid_packet);
 }
 
+TEST(QuicServerWriterModeTest, ParseWriterMode) {
+  QuicServer::WriterMode mode = QuicServer::WriterMode::kDefault;
+  EXPECT_TRUE(QuicServer::ParseWriterMode("auto", &mode));
+  EXPECT_EQ(QuicServer::WriterMode::kAuto, mode);
+  EXPECT_TRUE(QuicServer::ParseWriterMode("default", &mode));
+  EXPECT_EQ(QuicServer::WriterMode::kDefault, mode);
+  EXPECT_TRUE(QuicServer::ParseWriterMode("sendmmsg", &mode));
+  EXPECT_EQ(QuicServer::WriterMode::kSendmmsg, mode);
+  EXPECT_TRUE(QuicServer::ParseWriterMode("gso", &mode));
+  EXPECT_EQ(QuicServer::WriterMode::kGso, mode);
+  EXPECT_FALSE(QuicServer::ParseWriterMode("mmsg", &mode));
+  EXPECT_EQ(QuicServer::WriterMode::kGso, mode);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
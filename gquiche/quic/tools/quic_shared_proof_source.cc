@@ -0,0 +1,45 @@
+#include "gquiche/quic/tools/quic_shared_proof_source.h"
+
+#include <utility>
+
+namespace quic {
+
+void QuicSharedProofSource::GetProof(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address, const std::string& hostname,
+    const std::string& server_config, QuicTransportVersion transport_version,
+    absl::string_view chlo_hash, std::unique_ptr<Callback> callback) {
+  proof_source_->GetProof(server_address, client_address, hostname,
+                          server_config, transport_version, chlo_hash,
+                          std::move(callback));
+}
+
+quiche::QuicheReferenceCountedPointer<ProofSource::Chain>
+QuicSharedProofSource::GetCertChain(const QuicSocketAddress& server_address,
+                                    const QuicSocketAddress& client_address,
+                                    const std::string& hostname,
+                                    bool* cert_matched_sni) {
+  return proof_source_->GetCertChain(server_address, client_address, hostname,
+                                     cert_matched_sni);
+}
+
+void QuicSharedProofSource::ComputeTlsSignature(
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address, const std::string& hostname,
+    uint16_t signature_algorithm, absl::string_view in,
+    std::unique_ptr<SignatureCallback> callback) {
+  proof_source_->ComputeTlsSignature(server_address, client_address, hostname,
+                                     signature_algorithm, in,
+                                     std::move(callback));
+}
+
+QuicSignatureAlgorithmVector
+QuicSharedProofSource::SupportedTlsSignatureAlgorithms() const {
+  return proof_source_->SupportedTlsSignatureAlgorithms();
+}
+
+ProofSource::TicketCrypter* QuicSharedProofSource::GetTicketCrypter() {
+  return proof_source_->GetTicketCrypter();
+}
+
+}  // namespace quic
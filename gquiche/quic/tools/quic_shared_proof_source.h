@@ -0,0 +1,44 @@
+#ifndef QUICHE_QUIC_TOOLS_QUIC_SHARED_PROOF_SOURCE_H_
+#define QUICHE_QUIC_TOOLS_QUIC_SHARED_PROOF_SOURCE_H_
+
+#include <memory>
+#include <string>
+
+#include "gquiche/quic/core/crypto/proof_source.h"
+
+namespace quic {
+
+// Forwards to a ProofSource shared by the crypto configs of several servers,
+// e.g. the workers of a multi-threaded one. ProofSource methods may be
+// called concurrently.
+class QuicSharedProofSource : public ProofSource {
+ public:
+  explicit QuicSharedProofSource(std::shared_ptr<ProofSource> proof_source)
+      : proof_source_(std::move(proof_source)) {}
+
+  // ProofSource
+  void GetProof(const QuicSocketAddress& server_address,
+                const QuicSocketAddress& client_address,
+                const std::string& hostname, const std::string& server_config,
+                QuicTransportVersion transport_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+  quiche::QuicheReferenceCountedPointer<Chain> GetCertChain(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      bool* cert_matched_sni) override;
+  void ComputeTlsSignature(
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address, const std::string& hostname,
+      uint16_t signature_algorithm, absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+  QuicSignatureAlgorithmVector SupportedTlsSignatureAlgorithms() const override;
+  TicketCrypter* GetTicketCrypter() override;
+
+ private:
+  std::shared_ptr<ProofSource> proof_source_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_SHARED_PROOF_SOURCE_H_
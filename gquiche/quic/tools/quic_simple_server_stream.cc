@@ -6,12 +6,15 @@
 
 #include <cstdint>
 #include <list>
+#include <memory>
+#include <string>
 #include <utility>
 
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "gquiche/common/platform/api/quiche_mem_slice.h"
 #include "gquiche/quic/core/http/quic_spdy_stream.h"
 #include "gquiche/quic/core/http/spdy_utils.h"
 #include "gquiche/quic/core/http/web_transport_http3.h"
@@ -384,6 +387,7 @@ void QuicSimpleServerStream::Respond(const QuicBackendResponse* response) {
 
   QUIC_DVLOG(1) << "Stream " << id() << " sending response.";
   SendHeadersAndBodyAndTrailers(response->headers().Clone(), response->body(),
+                                response->shared_body(),
                                 response->trailers().Clone());
 }
 
@@ -477,6 +481,15 @@ void QuicSimpleServerStream::SendHeadersAndBody(
 void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
     absl::optional<Http2HeaderBlock> response_headers, absl::string_view body,
     Http2HeaderBlock response_trailers) {
+  SendHeadersAndBodyAndTrailers(std::move(response_headers), body,
+                                /*body_owner=*/nullptr,
+                                std::move(response_trailers));
+}
+
+void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
+    absl::optional<Http2HeaderBlock> response_headers, absl::string_view body,
+    std::shared_ptr<const std::string> body_owner,
+    Http2HeaderBlock response_trailers) {
   // Headers should be sent iff not sent in a previous response.
   QUICHE_DCHECK_NE(response_headers.has_value(), response_sent_);
 
@@ -499,7 +512,7 @@ void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
   QUIC_DLOG(INFO) << "Stream " << id() << " writing body (fin = " << send_fin
                   << ") with size: " << body.size();
   if (!body.empty() || send_fin) {
-    WriteOrBufferBody(body, send_fin);
+    WriteBody(body, std::move(body_owner), send_fin);
   }
   if (send_fin) {
     // Nothing else to send.
@@ -512,6 +525,22 @@ void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
   WriteTrailers(std::move(response_trailers), nullptr);
 }
 
+void QuicSimpleServerStream::WriteBody(
+    absl::string_view body, std::shared_ptr<const std::string> body_owner,
+    bool fin) {
+  if (body_owner != nullptr && !body.empty()) {
+    // Cached bodies are shared by every stream sending them, the send buffer
+    // references the body rather than holding a copy.
+    quiche::QuicheMemSlice slice(std::move(body_owner), body.data(),
+                                 body.size());
+    if (WriteBodySlices(absl::MakeSpan(&slice, 1), fin).bytes_consumed > 0) {
+      return;
+    }
+    // The send buffer is over its limit, which WriteOrBufferBody() ignores.
+  }
+  WriteOrBufferBody(body, fin);
+}
+
 bool QuicSimpleServerStream::IsConnectRequest() const {
   auto method_it = request_headers_.find(":method");
   return method_it != request_headers_.end() && method_it->second == "CONNECT";
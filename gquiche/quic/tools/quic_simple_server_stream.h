@@ -6,6 +6,8 @@
 #define QUICHE_QUIC_TOOLS_QUIC_SIMPLE_SERVER_STREAM_H_
 
 #include <cstdint>
+#include <memory>
+#include <string>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -116,6 +118,18 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
   std::string body_;
 
  private:
+  // As above, but |body| lies within |body_owner|, if set, which the stream
+  // keeps a reference to instead of copying the body.
+  void SendHeadersAndBodyAndTrailers(
+      absl::optional<spdy::Http2HeaderBlock> response_headers,
+      absl::string_view body, std::shared_ptr<const std::string> body_owner,
+      spdy::Http2HeaderBlock response_trailers);
+
+  // Writes |body|, which lies within |body_owner| if set, by reference when
+  // the send buffer can take it, and copies it otherwise.
+  void WriteBody(absl::string_view body,
+                 std::shared_ptr<const std::string> body_owner, bool fin);
+
   uint64_t generate_bytes_length_;
   // Whether response headers have already been sent.
   bool response_sent_ = false;
@@ -42,6 +42,7 @@ using testing::_;
 using testing::AnyNumber;
 using testing::InSequence;
 using testing::Invoke;
+using testing::Return;
 using testing::StrictMock;
 
 namespace quic {
@@ -526,6 +527,36 @@ TEST_P(QuicSimpleServerStreamTest, SendResponseWithValidHeaders) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
+TEST_P(QuicSimpleServerStreamTest, SendResponseSharesCachedBody) {
+  spdy::Http2HeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/bar";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":method"] = "GET";
+
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = "5";
+  memory_cache_backend_.AddResponse("www.google.com", "/bar",
+                                    std::move(response_headers_), "Yummm");
+  std::shared_ptr<const std::string> cached_body =
+      memory_cache_backend_.GetResponse("www.google.com", "/bar")
+          ->shared_body();
+  ASSERT_NE(nullptr, cached_body);
+  EXPECT_EQ(2, cached_body.use_count());
+  QuicStreamPeer::SetFinReceived(stream_);
+
+  EXPECT_CALL(*stream_, WriteHeadersMock(false));
+  EXPECT_CALL(*stream_, WriteOrBufferBody(_, _)).Times(0);
+  // Nothing gets sent, so the body stays in the send buffer.
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(Return(QuicConsumedData(0, false)));
+  stream_->DoSendResponse();
+
+  // The send buffer references the cached body instead of a copy.
+  EXPECT_EQ(3, cached_body.use_count());
+  EXPECT_EQ(5u, stream_->BufferedDataBytes() -
+                    (UsesHttp3() ? kDataFrameHeaderLength : 0));
+}
+
 TEST_P(QuicSimpleServerStreamTest, SendResponseWithEarlyHints) {
   std::string host = "www.google.com";
   std::string request_path = "/foo";
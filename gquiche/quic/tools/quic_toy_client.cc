@@ -53,6 +53,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "gquiche/quic/core/crypto/quic_client_session_cache.h"
+#include "gquiche/quic/core/quic_default_clock.h"
 #include "gquiche/quic/core/quic_packets.h"
 #include "gquiche/quic/core/quic_server_id.h"
 #include "gquiche/quic/core/quic_utils.h"
@@ -173,6 +174,11 @@ DEFINE_QUICHE_COMMAND_LINE_FLAG(bool, one_connection_per_request, false,
                                 "If true, close the connection after each "
                                 "request. This allows testing 0-RTT.");
 
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, print_request_latency, false,
+    "If true, print how long each request took, from sending it to receiving "
+    "the whole response, in microseconds.");
+
 DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, server_connection_id_length, -1,
                                 "Length of the server connection ID used.");
 
@@ -433,7 +439,14 @@ int QuicToyClient::SendRequestsAndPrintResponses(
 
   for (int i = 0; i < num_requests; ++i) {
     // Send the request.
+    const QuicTime request_start = QuicDefaultClock::Get()->Now();
     client->SendRequestAndWaitForResponse(header_block, body, /*fin=*/true);
+    if (quiche::GetQuicheCommandLineFlag(FLAGS_print_request_latency)) {
+      std::cout << "Request latency: "
+                << (QuicDefaultClock::Get()->Now() - request_start)
+                       .ToMicroseconds()
+                << " us" << std::endl;
+    }
 
     // Print request and response details.
     if (!quiche::GetQuicheCommandLineFlag(FLAGS_quiet)) {
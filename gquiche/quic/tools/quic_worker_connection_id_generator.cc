@@ -0,0 +1,121 @@
+#include "gquiche/quic/tools/quic_worker_connection_id_generator.h"
+
+#include <errno.h>
+#include <linux/filter.h>
+#include <sys/socket.h>
+
+#include <cstring>
+
+#include "absl/types/span.h"
+#include "gquiche/quic/core/crypto/quic_random.h"
+#include "gquiche/quic/load_balancer/load_balancer_config.h"
+#include "gquiche/quic/load_balancer/load_balancer_server_id.h"
+#include "gquiche/quic/platform/api/quic_bug_tracker.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Only one config is ever in use.
+const uint8_t kWorkerConfigId = 0;
+const uint8_t kWorkerServerIdLength = 1;
+
+// Socket index for the kernel to fall back on its 4-tuple hash.
+const uint32_t kReuseportFallback = 0xffffffff;
+
+}  // namespace
+
+QuicWorkerConnectionIdGenerator::QuicWorkerConnectionIdGenerator(
+    size_t worker_index, uint8_t expected_connection_id_length)
+    : worker_index_(static_cast<uint8_t>(worker_index)),
+      expected_connection_id_length_(expected_connection_id_length),
+      encoder_(LoadBalancerEncoder::Create(
+          *QuicRandom::GetInstance(), /*visitor=*/nullptr,
+          /*len_self_encoded=*/true, expected_connection_id_length)) {
+  QUICHE_DCHECK_LT(worker_index, kMaxWorkers);
+  absl::optional<LoadBalancerConfig> config =
+      LoadBalancerConfig::CreateUnencrypted(
+          kWorkerConfigId, kWorkerServerIdLength,
+          expected_connection_id_length - 1 - kWorkerServerIdLength);
+  absl::optional<LoadBalancerServerId> server_id =
+      LoadBalancerServerId::Create(absl::MakeConstSpan(&worker_index_, 1));
+  if (!encoder_.has_value() || !config.has_value() ||
+      !server_id.has_value() || !encoder_->UpdateConfig(*config, *server_id)) {
+    QUIC_BUG(quic_worker_connection_id_generator_config)
+        << "Cannot encode worker indexes in "
+        << static_cast<int>(expected_connection_id_length)
+        << " byte connection IDs";
+  }
+}
+
+absl::optional<QuicConnectionId>
+QuicWorkerConnectionIdGenerator::GenerateNextConnectionId(
+    const QuicConnectionId& /*original*/) {
+  if (!encoder_.has_value()) {
+    return absl::optional<QuicConnectionId>();
+  }
+  // LoadBalancerEncoder::GenerateNextConnectionId() leaves unencrypted
+  // configs to the caller's generator.
+  QuicConnectionId connection_id = encoder_->GenerateConnectionId();
+  if (connection_id.IsEmpty()) {
+    return absl::optional<QuicConnectionId>();
+  }
+  return connection_id;
+}
+
+absl::optional<QuicConnectionId>
+QuicWorkerConnectionIdGenerator::MaybeReplaceConnectionId(
+    const QuicConnectionId& original, const ParsedQuicVersion& version) {
+  // The server ID follows the first byte.
+  if (original.length() == expected_connection_id_length_ &&
+      static_cast<uint8_t>(original.data()[1]) == worker_index_) {
+    return absl::optional<QuicConnectionId>();
+  }
+  if (!version.AllowsVariableLengthConnectionIds()) {
+    return absl::optional<QuicConnectionId>();
+  }
+  absl::optional<QuicConnectionId> new_connection_id =
+      GenerateNextConnectionId(original);
+  if (new_connection_id.has_value()) {
+    QUIC_DLOG(INFO) << "Replacing incoming connection ID " << original
+                    << " with " << *new_connection_id << " of worker "
+                    << static_cast<int>(worker_index_);
+  }
+  return new_connection_id;
+}
+
+// static
+bool QuicWorkerConnectionIdGenerator::AttachSteeringProgram(
+    int fd, size_t num_workers) {
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  // For UDP, the program sees the datagram's payload. A short header packet
+  // is steered to the worker its connection ID names; anything else, or a
+  // worker index out of range, falls back to the 4-tuple hash.
+  sock_filter code[] = {
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+      BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 3, 0),
+      BPF_STMT(BPF_LD | BPF_B | BPF_ABS, kServerIdOffset),
+      BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, static_cast<uint32_t>(num_workers),
+               1, 0),
+      BPF_STMT(BPF_RET | BPF_A, 0),
+      BPF_STMT(BPF_RET | BPF_K, kReuseportFallback),
+  };
+  sock_fprog program;
+  program.len = sizeof(code) / sizeof(code[0]);
+  program.filter = code;
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program,
+                 sizeof(program)) != 0) {
+    QUIC_LOG(ERROR) << "Failed to attach the reuseport steering program: "
+                    << strerror(errno);
+    return false;
+  }
+  return true;
+#else
+  QUIC_LOG(WARNING) << "SO_ATTACH_REUSEPORT_CBPF is not supported, packets "
+                       "are spread by the 4-tuple hash only";
+  return true;
+#endif
+}
+
+}  // namespace quic
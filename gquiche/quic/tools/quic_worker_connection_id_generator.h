@@ -0,0 +1,50 @@
+#ifndef QUICHE_QUIC_TOOLS_QUIC_WORKER_CONNECTION_ID_GENERATOR_H_
+#define QUICHE_QUIC_TOOLS_QUIC_WORKER_CONNECTION_ID_GENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/types/optional.h"
+#include "gquiche/quic/core/connection_id_generator.h"
+#include "gquiche/quic/load_balancer/load_balancer_encoder.h"
+
+namespace quic {
+
+// Issues unencrypted QUIC-LB connection IDs (draft-ietf-quic-load-balancers)
+// whose one byte server ID is the worker index.
+class QuicWorkerConnectionIdGenerator : public ConnectionIdGeneratorInterface {
+ public:
+  // Offset of the server ID in a short header packet: the first byte, then
+  // the first byte of the connection ID.
+  static constexpr size_t kServerIdOffset = 2;
+  static constexpr size_t kMaxWorkers = 256;
+
+  QuicWorkerConnectionIdGenerator(size_t worker_index,
+                                  uint8_t expected_connection_id_length);
+
+  // Attaches to the SO_REUSEPORT group of |fd|, whose sockets are indexed in
+  // the order they were bound, a classic BPF program steering short header
+  // packets to the socket whose index their connection ID carries. Other
+  // packets, and indexes of |num_workers| or more, go by the kernel's
+  // 4-tuple hash. Returns true without attaching anything if the kernel
+  // headers lack SO_ATTACH_REUSEPORT_CBPF.
+  static bool AttachSteeringProgram(int fd, size_t num_workers);
+
+  // ConnectionIdGeneratorInterface
+  absl::optional<QuicConnectionId> GenerateNextConnectionId(
+      const QuicConnectionId& original) override;
+  // Keeps client chosen connection IDs of the expected length that already
+  // carry this worker's index, and replaces the others if |version| allows.
+  absl::optional<QuicConnectionId> MaybeReplaceConnectionId(
+      const QuicConnectionId& original,
+      const ParsedQuicVersion& version) override;
+
+ private:
+  const uint8_t worker_index_;
+  const uint8_t expected_connection_id_length_;
+  absl::optional<LoadBalancerEncoder> encoder_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_WORKER_CONNECTION_ID_GENERATOR_H_
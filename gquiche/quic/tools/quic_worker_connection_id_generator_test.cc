@@ -0,0 +1,68 @@
+#include "gquiche/quic/tools/quic_worker_connection_id_generator.h"
+
+#include "gquiche/quic/platform/api/quic_test.h"
+#include "gquiche/quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class QuicWorkerConnectionIdGeneratorTest : public QuicTest {};
+
+TEST_F(QuicWorkerConnectionIdGeneratorTest, CarriesWorkerIndex) {
+  for (size_t worker_index : {0, 1, 7, 255}) {
+    QuicWorkerConnectionIdGenerator generator(worker_index,
+                                              kQuicDefaultConnectionIdLength);
+    for (int i = 0; i < 100; ++i) {
+      absl::optional<QuicConnectionId> connection_id =
+          generator.GenerateNextConnectionId(TestConnectionId(i));
+      ASSERT_TRUE(connection_id.has_value());
+      EXPECT_EQ(kQuicDefaultConnectionIdLength, connection_id->length());
+      // Where the steering program reads it, past a short header's first
+      // byte.
+      const size_t offset = QuicWorkerConnectionIdGenerator::kServerIdOffset;
+      EXPECT_EQ(worker_index,
+                static_cast<uint8_t>(connection_id->data()[offset - 1]));
+    }
+  }
+}
+
+TEST_F(QuicWorkerConnectionIdGeneratorTest, ConnectionIdsDiffer) {
+  QuicWorkerConnectionIdGenerator generator(3, kQuicDefaultConnectionIdLength);
+  absl::optional<QuicConnectionId> first =
+      generator.GenerateNextConnectionId(TestConnectionId(1));
+  absl::optional<QuicConnectionId> second =
+      generator.GenerateNextConnectionId(TestConnectionId(1));
+  ASSERT_TRUE(first.has_value() && second.has_value());
+  EXPECT_NE(*first, *second);
+}
+
+TEST_F(QuicWorkerConnectionIdGeneratorTest, MaybeReplaceConnectionId) {
+  QuicWorkerConnectionIdGenerator generator(2, kQuicDefaultConnectionIdLength);
+  const ParsedQuicVersion version = ParsedQuicVersion::RFCv1();
+
+  // Already routed to this worker.
+  char owned[] = {0x07, 0x02, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+  EXPECT_FALSE(generator
+                   .MaybeReplaceConnectionId(
+                       QuicConnectionId(owned, sizeof(owned)), version)
+                   .has_value());
+
+  // Another worker's index.
+  char other[] = {0x07, 0x05, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+  absl::optional<QuicConnectionId> replaced =
+      generator.MaybeReplaceConnectionId(
+          QuicConnectionId(other, sizeof(other)), version);
+  ASSERT_TRUE(replaced.has_value());
+  EXPECT_EQ(2u, static_cast<uint8_t>(replaced->data()[1]));
+
+  // Wrong length.
+  replaced = generator.MaybeReplaceConnectionId(
+      QuicConnectionId(owned, sizeof(owned) - 1), version);
+  ASSERT_TRUE(replaced.has_value());
+  EXPECT_EQ(kQuicDefaultConnectionIdLength, replaced->length());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,310 @@
+#include "gquiche/quic/tools/quic_xsk_multi_queue_server.h"
+
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/quic_default_connection_helper.h"
+#include "gquiche/quic/core/quic_dispatcher.h"
+#include "gquiche/quic/platform/api/quic_flags.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+#include "gquiche/quic/tools/quic_simple_crypto_server_stream_helper.h"
+#include "gquiche/quic/tools/quic_simple_dispatcher.h"
+
+namespace quic {
+
+QuicXskWorkerConnectionIdGenerator::QuicXskWorkerConnectionIdGenerator(
+    size_t worker_index, size_t num_workers,
+    uint8_t expected_connection_id_length)
+    : worker_index_(worker_index),
+      num_workers_(num_workers),
+      deterministic_generator_(expected_connection_id_length),
+      expected_connection_id_length_(expected_connection_id_length) {
+  QUICHE_DCHECK_LT(worker_index_, num_workers_);
+  QUICHE_DCHECK_LE(num_workers_, 256u);
+  QUICHE_DCHECK_GT(expected_connection_id_length_, 0u);
+}
+
+absl::optional<QuicConnectionId>
+QuicXskWorkerConnectionIdGenerator::GenerateNextConnectionId(
+    const QuicConnectionId& original) {
+  absl::optional<QuicConnectionId> connection_id =
+      deterministic_generator_.GenerateNextConnectionId(original);
+  if (!connection_id.has_value() || connection_id->IsEmpty()) {
+    return connection_id;
+  }
+  // Keep the high bits of the first byte and put the worker index in its
+  // residue.
+  char* data = connection_id->mutable_data();
+  const uint8_t first_byte = static_cast<uint8_t>(data[0]);
+  size_t stamped = first_byte - first_byte % num_workers_ + worker_index_;
+  if (stamped > 0xff) {
+    stamped -= num_workers_;
+  }
+  data[0] = static_cast<char>(stamped);
+  return connection_id;
+}
+
+absl::optional<QuicConnectionId>
+QuicXskWorkerConnectionIdGenerator::MaybeReplaceConnectionId(
+    const QuicConnectionId& original, const ParsedQuicVersion& version) {
+  if (original.length() == expected_connection_id_length_ &&
+      WorkerOf(static_cast<uint8_t>(original.data()[0]), num_workers_) ==
+          worker_index_) {
+    return absl::optional<QuicConnectionId>();
+  }
+  if (!version.AllowsVariableLengthConnectionIds()) {
+    return absl::optional<QuicConnectionId>();
+  }
+  absl::optional<QuicConnectionId> new_connection_id =
+      GenerateNextConnectionId(original);
+  QUIC_DLOG(INFO) << "Replacing incoming connection ID " << original
+                  << " with " << new_connection_id.value() << " of worker "
+                  << worker_index_;
+  return new_connection_id;
+}
+
+QuicXskWorkerInbox::QuicXskWorkerInbox()
+    : event_fd_(-1), packets_dropped_(0) {}
+
+QuicXskWorkerInbox::~QuicXskWorkerInbox() {
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+  }
+}
+
+bool QuicXskWorkerInbox::Initialize() {
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) {
+    QUIC_LOG(ERROR) << "eventfd() failed: " << strerror(errno);
+    return false;
+  }
+  pending_.reserve(kMaxPendingPackets);
+  draining_.reserve(kMaxPendingPackets);
+  return true;
+}
+
+bool QuicXskWorkerInbox::Push(const QuicSocketAddress& self_address,
+                              const QuicSocketAddress& peer_address,
+                              const QuicReceivedPacket& packet) {
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    if (pending_.size() >= kMaxPendingPackets) {
+      ++packets_dropped_;
+      return false;
+    }
+    pending_.emplace_back();
+    PendingPacket& pending = pending_.back();
+    pending.self_address = self_address;
+    pending.peer_address = peer_address;
+    pending.receipt_time = packet.receipt_time();
+    pending.data.assign(packet.data(), packet.length());
+  }
+  uint64_t one = 1;
+  if (write(event_fd_, &one, sizeof(one)) != sizeof(one)) {
+    QUIC_LOG_FIRST_N(ERROR, 10)
+        << "Failed to wake a worker up: " << strerror(errno);
+  }
+  return true;
+}
+
+void QuicXskWorkerInbox::Drain(ProcessPacketInterface* processor) {
+  // Reset the eventfd before taking the packets, so that a push racing with
+  // this drain wakes the worker up again.
+  uint64_t count;
+  if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    QUIC_LOG_FIRST_N(ERROR, 10) << "eventfd read failed: " << strerror(errno);
+  }
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    draining_.swap(pending_);
+  }
+  for (const PendingPacket& pending : draining_) {
+    QuicReceivedPacket packet(pending.data.data(), pending.data.size(),
+                              pending.receipt_time);
+    processor->ProcessPacket(pending.self_address, pending.peer_address,
+                             packet);
+  }
+  draining_.clear();
+}
+
+QuicPacketCount QuicXskWorkerInbox::packets_dropped() const {
+  QuicReaderMutexLock lock(&mutex_);
+  return packets_dropped_;
+}
+
+QuicXskQueueWorker::QuicXskQueueWorker(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* quic_simple_server_backend,
+    const ParsedQuicVersionVector& supported_versions,
+    const QuicXskSocket::Options& xsk_options,
+    QuicXskMultiQueueServer* server, size_t worker_index, size_t num_workers)
+    : QuicXskServer(std::move(proof_source), quic_simple_server_backend,
+                    supported_versions, xsk_options),
+      server_(server),
+      worker_index_(worker_index),
+      num_workers_(num_workers),
+      connection_id_generator_(worker_index, num_workers,
+                               expected_server_connection_id_length()),
+      packets_forwarded_(0) {
+  // Every worker keeps a UDP socket for what the XDP program passes to the
+  // kernel.
+  set_reuse_port(true);
+}
+
+QuicXskQueueWorker::~QuicXskQueueWorker() = default;
+
+bool QuicXskQueueWorker::CreateUDPSocketAndListen(
+    const QuicSocketAddress& address) {
+  if (!inbox_.Initialize() ||
+      !QuicXskServer::CreateUDPSocketAndListen(address)) {
+    return false;
+  }
+  return event_loop()->RegisterSocket(inbox_.fd(), kSocketEventReadable, this);
+}
+
+void QuicXskQueueWorker::OnSocketEvent(QuicEventLoop* event_loop,
+                                       QuicUdpSocketFd fd,
+                                       QuicSocketEventMask events) {
+  if (fd != inbox_.fd()) {
+    QuicXskServer::OnSocketEvent(event_loop, fd, events);
+    return;
+  }
+  if (events & kSocketEventReadable) {
+    inbox_.Drain(dispatcher());
+    if (!event_loop->SupportsEdgeTriggered()) {
+      bool success = event_loop->RearmSocket(fd, kSocketEventReadable);
+      QUICHE_DCHECK(success);
+    }
+  }
+}
+
+void QuicXskQueueWorker::ProcessPacket(const QuicSocketAddress& self_address,
+                                       const QuicSocketAddress& peer_address,
+                                       const QuicReceivedPacket& packet) {
+  // Only short headers are steered. Long header packets may still carry the
+  // connection ID the client chose, and stay on the worker the handshake
+  // started on, which the NIC keeps picking as long as the 4-tuple is the
+  // same.
+  if (packet.length() > 1 && (packet.data()[0] & FLAGS_LONG_HEADER) == 0) {
+    const size_t owner = QuicXskWorkerConnectionIdGenerator::WorkerOf(
+        static_cast<uint8_t>(packet.data()[1]), num_workers_);
+    if (owner != worker_index_) {
+      if (server_->worker(owner)->inbox()->Push(self_address, peer_address,
+                                                packet)) {
+        ++packets_forwarded_;
+      }
+      return;
+    }
+  }
+  dispatcher()->ProcessPacket(self_address, peer_address, packet);
+}
+
+QuicDispatcher* QuicXskQueueWorker::CreateQuicDispatcher() {
+  return new QuicSimpleDispatcher(
+      &config(), &crypto_config(), version_manager(),
+      std::make_unique<QuicDefaultConnectionHelper>(),
+      std::unique_ptr<QuicCryptoServerStreamBase::Helper>(
+          new QuicSimpleCryptoServerStreamHelper()),
+      event_loop()->CreateAlarmFactory(), server_backend(),
+      expected_server_connection_id_length(), connection_id_generator_);
+}
+
+QuicXskMultiQueueServer::QuicXskMultiQueueServer(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* quic_simple_server_backend,
+    const ParsedQuicVersionVector& supported_versions,
+    const QuicXskSocket::Options& xsk_options, size_t num_queues,
+    bool shared_umem)
+    : proof_source_(std::move(proof_source)),
+      quic_simple_server_backend_(quic_simple_server_backend),
+      xsk_options_(xsk_options),
+      num_queues_(num_queues),
+      shared_umem_(shared_umem),
+      xsk_stats_interval_(QuicTime::Delta::Zero()) {
+  QUICHE_DCHECK_GT(num_queues_, 0u);
+  // Steering relies on the server choosing every connection ID, which only
+  // versions with variable length connection IDs allow.
+  for (const ParsedQuicVersion& version : supported_versions) {
+    if (version.AllowsVariableLengthConnectionIds()) {
+      supported_versions_.push_back(version);
+    } else {
+      QUIC_LOG(WARNING) << "Multi-queue AF_XDP server does not support "
+                        << ParsedQuicVersionToString(version);
+    }
+  }
+  // Have the dispatchers and connections issue connection IDs through the
+  // workers' generators.
+  SetQuicRestartFlag(quic_abstract_connection_id_generator, true);
+  SetQuicReloadableFlag(quic_connection_uses_abstract_connection_id_generator,
+                        true);
+}
+
+QuicXskMultiQueueServer::~QuicXskMultiQueueServer() = default;
+
+bool QuicXskMultiQueueServer::CreateUDPSocketAndListen(
+    const QuicSocketAddress& address) {
+  if (address.port() == 0) {
+    QUIC_LOG(ERROR) << "The AF_XDP server needs a fixed port";
+    return false;
+  }
+  if (num_queues_ > 256) {
+    QUIC_LOG(ERROR) << "At most 256 AF_XDP queues are supported";
+    return false;
+  }
+  xsk_options_.port = address.port();
+  if (!program_.Attach(xsk_options_.interface_name,
+                       xsk_options_.bpf_object_path, xsk_options_.port,
+                       xsk_options_.generic_mode)) {
+    return false;
+  }
+  if (shared_umem_) {
+    umem_ = std::make_unique<QuicXskUmem>(num_queues_);
+    if (!umem_->Create()) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < num_queues_; ++i) {
+    QuicXskSocket::Options options = xsk_options_;
+    options.queue_id = xsk_options_.queue_id + i;
+    options.program = &program_;
+    options.umem = umem_.get();
+    options.umem_partition = i;
+    workers_.push_back(std::make_unique<QuicXskQueueWorker>(
+        std::make_unique<QuicSharedProofSource>(proof_source_),
+        quic_simple_server_backend_, supported_versions_, options, this, i,
+        num_queues_));
+    workers_.back()->set_xsk_stats_interval(xsk_stats_interval_);
+    if (!workers_.back()->CreateUDPSocketAndListen(address)) {
+      return false;
+    }
+  }
+  QUIC_LOG(INFO) << "Serving " << num_queues_ << " queues of "
+                 << xsk_options_.interface_name << " from queue "
+                 << xsk_options_.queue_id
+                 << (shared_umem_ ? " with a shared UMEM" : "");
+  return true;
+}
+
+QuicXskStats QuicXskMultiQueueServer::xsk_stats() const {
+  QuicXskStats stats;
+  for (const auto& worker : workers_) {
+    stats += worker->xsk_stats();
+  }
+  return stats;
+}
+
+void QuicXskMultiQueueServer::HandleEventsForever() {
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    threads_.push_back(std::make_unique<WorkerThread>(workers_[i].get(), i));
+    threads_.back()->Start();
+  }
+  workers_[0]->HandleEventsForever();
+}
+
+}  // namespace quic
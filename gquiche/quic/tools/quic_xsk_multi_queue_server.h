@@ -0,0 +1,217 @@
+// A server running one QuicXskServer worker per queue of an interface, each
+// with its own thread, event loop, dispatcher and AF_XDP socket. The sockets
+// share one XDP program and, optionally, one UMEM.
+//
+// An AF_XDP socket only receives the frames of the queue it is bound to, so
+// which worker gets a datagram is decided by the NIC's RSS hash of the
+// 4-tuple. A connection is created by the worker its first packets arrive
+// on, and that worker only issues connection IDs whose first byte maps back
+// to it (see QuicXskWorkerConnectionIdGenerator). Short header packets that
+// arrive on another worker, e.g. after a migration, are forwarded to the
+// owner through its QuicXskWorkerInbox.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_XSK_MULTI_QUEUE_SERVER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_XSK_MULTI_QUEUE_SERVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_socket.h"
+#include "gquiche/quic/core/connection_id_generator.h"
+#include "gquiche/quic/core/crypto/proof_source.h"
+#include "gquiche/quic/core/deterministic_connection_id_generator.h"
+#include "gquiche/quic/core/quic_process_packet_interface.h"
+#include "gquiche/quic/platform/api/quic_mutex.h"
+#include "gquiche/quic/platform/api/quic_thread.h"
+#include "gquiche/quic/tools/quic_shared_proof_source.h"
+#include "gquiche/quic/tools/quic_spdy_server_base.h"
+#include "gquiche/quic/tools/quic_xsk_server.h"
+
+namespace quic {
+
+class QuicXskMultiQueueServer;
+
+// Issues server connection IDs whose first byte is congruent to the worker
+// index modulo the number of workers, so that any worker can tell which one
+// owns a connection from its destination connection ID alone. Otherwise
+// behaves like DeterministicConnectionIdGenerator.
+class QuicXskWorkerConnectionIdGenerator
+    : public ConnectionIdGeneratorInterface {
+ public:
+  QuicXskWorkerConnectionIdGenerator(size_t worker_index, size_t num_workers,
+                                     uint8_t expected_connection_id_length);
+
+  // Returns the worker owning connection IDs starting with |first_byte|.
+  static size_t WorkerOf(uint8_t first_byte, size_t num_workers) {
+    return first_byte % num_workers;
+  }
+
+  // ConnectionIdGeneratorInterface
+  absl::optional<QuicConnectionId> GenerateNextConnectionId(
+      const QuicConnectionId& original) override;
+  // Replaces client chosen connection IDs of the wrong length, as the
+  // deterministic generator does, and those another worker would own.
+  absl::optional<QuicConnectionId> MaybeReplaceConnectionId(
+      const QuicConnectionId& original,
+      const ParsedQuicVersion& version) override;
+
+ private:
+  const size_t worker_index_;
+  const size_t num_workers_;
+  // Derives the connection IDs before they are stamped.
+  DeterministicConnectionIdGenerator deterministic_generator_;
+  const uint8_t expected_connection_id_length_;
+};
+
+// Packets handed from one worker to another. Pushed from any thread, drained
+// on the owning worker's thread, which is woken through an eventfd.
+class QuicXskWorkerInbox {
+ public:
+  // Packets beyond this many waiting ones are dropped.
+  static const size_t kMaxPendingPackets = 1024;
+
+  QuicXskWorkerInbox();
+  QuicXskWorkerInbox(const QuicXskWorkerInbox&) = delete;
+  QuicXskWorkerInbox& operator=(const QuicXskWorkerInbox&) = delete;
+  ~QuicXskWorkerInbox();
+
+  bool Initialize();
+
+  // The eventfd readable while packets are waiting.
+  int fd() const { return event_fd_; }
+
+  // Copies |packet|. Returns false if it is dropped.
+  bool Push(const QuicSocketAddress& self_address,
+            const QuicSocketAddress& peer_address,
+            const QuicReceivedPacket& packet);
+
+  // Hands all the waiting packets to |processor|.
+  void Drain(ProcessPacketInterface* processor);
+
+  QuicPacketCount packets_dropped() const;
+
+ private:
+  struct PendingPacket {
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    QuicTime receipt_time = QuicTime::Zero();
+    std::string data;
+  };
+
+  int event_fd_;
+  mutable QuicMutex mutex_;
+  std::vector<PendingPacket> pending_ QUIC_GUARDED_BY(mutex_);
+  QuicPacketCount packets_dropped_ QUIC_GUARDED_BY(mutex_);
+  // Swapped with |pending_| when draining, to keep its capacity.
+  std::vector<PendingPacket> draining_;
+};
+
+// The worker of one queue.
+class QuicXskQueueWorker : public QuicXskServer, public ProcessPacketInterface {
+ public:
+  QuicXskQueueWorker(std::unique_ptr<ProofSource> proof_source,
+                     QuicSimpleServerBackend* quic_simple_server_backend,
+                     const ParsedQuicVersionVector& supported_versions,
+                     const QuicXskSocket::Options& xsk_options,
+                     QuicXskMultiQueueServer* server, size_t worker_index,
+                     size_t num_workers);
+
+  ~QuicXskQueueWorker() override;
+
+  bool CreateUDPSocketAndListen(const QuicSocketAddress& address) override;
+
+  // QuicSocketEventListener implementation.
+  void OnSocketEvent(QuicEventLoop* event_loop, QuicUdpSocketFd fd,
+                     QuicSocketEventMask events) override;
+
+  // ProcessPacketInterface implementation. Dispatches the packets of the
+  // connections this worker owns and forwards the others.
+  void ProcessPacket(const QuicSocketAddress& self_address,
+                     const QuicSocketAddress& peer_address,
+                     const QuicReceivedPacket& packet) override;
+
+  QuicXskWorkerInbox* inbox() { return &inbox_; }
+
+  // Number of packets forwarded to other workers.
+  QuicPacketCount packets_forwarded() const { return packets_forwarded_; }
+
+ protected:
+  QuicDispatcher* CreateQuicDispatcher() override;
+  ProcessPacketInterface* packet_processor() override { return this; }
+
+ private:
+  QuicXskMultiQueueServer* server_;  // Unowned.
+  const size_t worker_index_;
+  const size_t num_workers_;
+  QuicXskWorkerConnectionIdGenerator connection_id_generator_;
+  QuicXskWorkerInbox inbox_;
+  QuicPacketCount packets_forwarded_;
+};
+
+class QuicXskMultiQueueServer : public QuicSpdyServerBase {
+ public:
+  // Queues |xsk_options.queue_id| to |xsk_options.queue_id| + |num_queues| - 1
+  // each get a worker.
+  QuicXskMultiQueueServer(std::unique_ptr<ProofSource> proof_source,
+                          QuicSimpleServerBackend* quic_simple_server_backend,
+                          const ParsedQuicVersionVector& supported_versions,
+                          const QuicXskSocket::Options& xsk_options,
+                          size_t num_queues, bool shared_umem);
+  QuicXskMultiQueueServer(const QuicXskMultiQueueServer&) = delete;
+  QuicXskMultiQueueServer& operator=(const QuicXskMultiQueueServer&) = delete;
+
+  ~QuicXskMultiQueueServer() override;
+
+  // Attaches the XDP program and starts listening on every queue. |address|
+  // must have a fixed port.
+  bool CreateUDPSocketAndListen(const QuicSocketAddress& address) override;
+
+  // Runs the first worker on the calling thread and the others on their
+  // own. Does not return.
+  void HandleEventsForever() override;
+
+  // See QuicXskServer::set_xsk_stats_interval(). Applies to every worker.
+  void set_xsk_stats_interval(QuicTime::Delta interval) {
+    xsk_stats_interval_ = interval;
+  }
+
+  // The counters of all the workers' AF_XDP sockets, summed. May be called
+  // from any thread once listening.
+  QuicXskStats xsk_stats() const;
+
+  size_t num_workers() const { return workers_.size(); }
+  QuicXskQueueWorker* worker(size_t index) { return workers_[index].get(); }
+
+ private:
+  class WorkerThread : public QuicThread {
+   public:
+    WorkerThread(QuicXskQueueWorker* worker, size_t index)
+        : QuicThread("quic_xsk_worker_" + std::to_string(index)),
+          worker_(worker) {}
+
+    void Run() override { worker_->HandleEventsForever(); }
+
+   private:
+    QuicXskQueueWorker* worker_;
+  };
+
+  // Shared by the workers' crypto configs.
+  std::shared_ptr<ProofSource> proof_source_;
+  QuicSimpleServerBackend* quic_simple_server_backend_;  // Unowned.
+  ParsedQuicVersionVector supported_versions_;
+  QuicXskSocket::Options xsk_options_;
+  const size_t num_queues_;
+  const bool shared_umem_;
+  QuicTime::Delta xsk_stats_interval_;
+
+  // Declared before the workers, whose sockets must go first.
+  QuicXskRedirectProgram program_;
+  std::unique_ptr<QuicXskUmem> umem_;
+  std::vector<std::unique_ptr<QuicXskQueueWorker>> workers_;
+  std::vector<std::unique_ptr<WorkerThread>> threads_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_XSK_MULTI_QUEUE_SERVER_H_
@@ -0,0 +1,135 @@
+#include "gquiche/quic/tools/quic_xsk_server.h"
+
+#include <utility>
+
+#include "gquiche/quic/core/io/quic_event_loop.h"
+#include "gquiche/quic/core/quic_default_clock.h"
+#include "gquiche/quic/core/quic_dispatcher.h"
+#include "gquiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+const size_t kNumSessionsToCreatePerXskEvent = 16;
+
+}  // namespace
+
+QuicXskServer::QuicXskServer(
+    std::unique_ptr<ProofSource> proof_source,
+    QuicSimpleServerBackend* quic_simple_server_backend,
+    const ParsedQuicVersionVector& supported_versions,
+    const QuicXskSocket::Options& xsk_options)
+    : QuicServer(std::move(proof_source), quic_simple_server_backend,
+                 supported_versions),
+      xsk_options_(xsk_options),
+      xsk_packet_reader_(std::make_unique<QuicXskPacketReader>(&xsk_socket_)),
+      xsk_writer_(nullptr),
+      xsk_stats_interval_(QuicTime::Delta::Zero()) {}
+
+QuicXskServer::~QuicXskServer() {
+  // The alarm goes before the event loop it is scheduled on.
+  stats_alarm_.reset();
+  alarm_factory_.reset();
+  if (xsk_writer_ != nullptr) {
+    const QuicXskTxCopyStats& stats = xsk_writer_->copy_stats();
+    QUIC_LOG(INFO) << "AF_XDP TX: " << stats.packets << " packets, "
+                   << stats.packets_copied << " of them copied into UMEM, "
+                   << stats.bytes_copied << " bytes copied";
+  }
+  if (dispatcher() != nullptr) {
+    Shutdown();
+  }
+}
+
+bool QuicXskServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
+  if (address.port() == 0) {
+    QUIC_LOG(ERROR) << "The AF_XDP server needs a fixed port";
+    return false;
+  }
+  xsk_options_.port = address.port();
+  if (!xsk_socket_.Open(xsk_options_)) {
+    return false;
+  }
+  // Creates the dispatcher with CreateWriter(), which needs the xsk socket.
+  if (!QuicServer::CreateUDPSocketAndListen(address)) {
+    return false;
+  }
+  if (!event_loop()->RegisterSocket(
+          xsk_socket_.fd(), kSocketEventReadable | kSocketEventWritable,
+          this)) {
+    return false;
+  }
+  if (!xsk_stats_interval_.IsZero()) {
+    alarm_factory_ = event_loop()->CreateAlarmFactory();
+    stats_alarm_.reset(
+        alarm_factory_->CreateAlarm(new StatsAlarmDelegate(this)));
+    stats_alarm_->Set(QuicDefaultClock::Get()->ApproximateNow() +
+                      xsk_stats_interval_);
+  }
+  return true;
+}
+
+void QuicXskServer::OnStatsAlarm() {
+  const QuicXskStats stats = xsk_socket_.GetStats();
+  QUIC_LOG(INFO) << "AF_XDP queue " << xsk_options_.queue_id << " stats "
+                 << stats.ToString() << ", last "
+                 << xsk_stats_interval_.ToMilliseconds() << "ms "
+                 << (stats - last_xsk_stats_).ToString();
+  last_xsk_stats_ = stats;
+  stats_alarm_->Set(QuicDefaultClock::Get()->ApproximateNow() +
+                    xsk_stats_interval_);
+}
+
+QuicPacketWriter* QuicXskServer::CreateWriter(int fd) {
+  if (!xsk_socket_.IsOpen()) {
+    return QuicServer::CreateWriter(fd);
+  }
+  xsk_writer_ = new QuicXskBatchWriter(
+      std::make_unique<QuicXskBatchWriterBuffer>(xsk_socket_.xsk()),
+      xsk_socket_.fd(), xsk_options_.port, xsk_socket_.xsk(),
+      xsk_socket_.self_mac_addr(), xsk_socket_.peer_mac_addr());
+  return xsk_writer_;
+}
+
+void QuicXskServer::OnSocketEvent(QuicEventLoop* event_loop,
+                                  QuicUdpSocketFd fd,
+                                  QuicSocketEventMask events) {
+  if (fd != xsk_socket_.fd()) {
+    QuicServer::OnSocketEvent(event_loop, fd, events);
+    return;
+  }
+
+  if (events & kSocketEventReadable) {
+    dispatcher()->ProcessBufferedChlos(kNumSessionsToCreatePerXskEvent);
+
+    bool more_to_read = true;
+    while (more_to_read) {
+      more_to_read = xsk_packet_reader_->ReadAndDispatchPackets(
+          xsk_socket_.xsk(), port(), *QuicDefaultClock::Get(),
+          packet_processor(), nullptr);
+    }
+
+    if (dispatcher()->HasChlosBuffered()) {
+      bool success =
+          event_loop->ArtificiallyNotifyEvent(fd, kSocketEventReadable);
+      QUICHE_DCHECK(success);
+    }
+    if (!event_loop->SupportsEdgeTriggered()) {
+      bool success = event_loop->RearmSocket(fd, kSocketEventReadable);
+      QUICHE_DCHECK(success);
+    }
+  }
+  if (events & kSocketEventWritable) {
+    // Recycle the frames of completed transmissions before writing more.
+    complete_tx(xsk_socket_.xsk());
+    dispatcher()->OnCanWrite();
+    if (!event_loop->SupportsEdgeTriggered() &&
+        dispatcher()->HasPendingWrites()) {
+      bool success = event_loop->RearmSocket(fd, kSocketEventWritable);
+      QUICHE_DCHECK(success);
+    }
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,87 @@
+// A QuicServer which handles the server port's traffic on one queue of an
+// interface through an AF_XDP socket: QuicXskPacketReader for RX and
+// QuicXskBatchWriter for TX. The regular UDP socket stays open for the
+// datagrams the XDP program passes to the kernel, e.g. those arriving on
+// other queues.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_XSK_SERVER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_XSK_SERVER_H_
+
+#include <memory>
+
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_batch_writer.h"
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_packet_reader.h"
+#include "gquiche/quic/core/batch_writer/xsk/quic_xsk_socket.h"
+#include "gquiche/quic/core/quic_alarm.h"
+#include "gquiche/quic/core/quic_alarm_factory.h"
+#include "gquiche/quic/core/quic_time.h"
+#include "gquiche/quic/tools/quic_server.h"
+
+namespace quic {
+
+class QuicXskServer : public QuicServer {
+ public:
+  QuicXskServer(std::unique_ptr<ProofSource> proof_source,
+                QuicSimpleServerBackend* quic_simple_server_backend,
+                const ParsedQuicVersionVector& supported_versions,
+                const QuicXskSocket::Options& xsk_options);
+  QuicXskServer(const QuicXskServer&) = delete;
+  QuicXskServer& operator=(const QuicXskServer&) = delete;
+
+  // Shuts the dispatcher down first: its writer sends from, and returns
+  // frames to, the AF_XDP socket.
+  ~QuicXskServer() override;
+
+  // Opens the AF_XDP socket, then the UDP socket. |address| must have a
+  // fixed port, which is the one the XDP program redirects.
+  bool CreateUDPSocketAndListen(const QuicSocketAddress& address) override;
+
+  // QuicSocketEventListener implementation.
+  void OnSocketEvent(QuicEventLoop* event_loop, QuicUdpSocketFd fd,
+                     QuicSocketEventMask events) override;
+
+  // Logs the AF_XDP socket's counters, and their change, every |interval|
+  // once listening. Zero, the default, disables it.
+  void set_xsk_stats_interval(QuicTime::Delta interval) {
+    xsk_stats_interval_ = interval;
+  }
+
+  // Live ring and syscall counters of the AF_XDP socket. May be called from
+  // any thread.
+  QuicXskStats xsk_stats() const { return xsk_socket_.GetStats(); }
+
+  // The writer's copy accounting, or nullptr before listening.
+  const QuicXskTxCopyStats* tx_copy_stats() const {
+    return xsk_writer_ == nullptr ? nullptr : &xsk_writer_->copy_stats();
+  }
+
+ protected:
+  QuicPacketWriter* CreateWriter(int fd) override;
+
+ private:
+  class StatsAlarmDelegate : public QuicAlarm::DelegateWithoutContext {
+   public:
+    explicit StatsAlarmDelegate(QuicXskServer* server) : server_(server) {}
+    void OnAlarm() override { server_->OnStatsAlarm(); }
+
+   private:
+    QuicXskServer* server_;
+  };
+
+  void OnStatsAlarm();
+
+  QuicXskSocket::Options xsk_options_;
+  QuicXskSocket xsk_socket_;
+  std::unique_ptr<QuicXskPacketReader> xsk_packet_reader_;
+  // Owned by the dispatcher.
+  QuicXskBatchWriter* xsk_writer_;
+
+  QuicTime::Delta xsk_stats_interval_;
+  QuicXskStats last_xsk_stats_;
+  std::unique_ptr<QuicAlarmFactory> alarm_factory_;
+  std::unique_ptr<QuicAlarm> stats_alarm_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_XSK_SERVER_H_
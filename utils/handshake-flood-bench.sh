@@ -0,0 +1,106 @@
+#!/bin/bash
+# Runs simple_quic_server on loopback with --handshake_threads=0 and N, and
+# floods it with parallel simple_quic_client processes making a handshake per
+# request, while one more client makes many requests on a single established
+# connection. Prints the handshakes per second of the flood and the p50 and
+# p99 request latency of the established connection.
+#
+# Usage: handshake-flood-bench.sh <build dir>
+# Needs openssl.
+
+BUILD_DIR=$(cd "${1:?usage: $0 <build dir>}" && pwd) || exit 1
+UTILS_DIR=$(cd "$(dirname "$0")" && pwd)
+
+HOST=127.0.0.1
+PORT=${PORT:-6141}
+CLIENTS=${CLIENTS:-16}
+HANDSHAKES=${HANDSHAKES:-100}
+THREADS=${THREADS:-4}
+NUM_REQUESTS=${NUM_REQUESTS:-2000}
+
+WORK_DIR=$(mktemp -d)
+SERVER_PID=
+
+cleanup() {
+  [ -n "$SERVER_PID" ] && kill "$SERVER_PID" 2>/dev/null && wait "$SERVER_PID" 2>/dev/null
+  rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "FAIL: $*" >&2
+  [ -f "$WORK_DIR/server.log" ] && tail -20 "$WORK_DIR/server.log" >&2
+  exit 1
+}
+
+if ! command -v openssl > /dev/null; then
+  echo "SKIP: needs openssl"
+  exit 77
+fi
+
+# Certificates.
+cp "$UTILS_DIR/generate-certs.sh" "$UTILS_DIR/ca.cnf" "$UTILS_DIR/leaf.cnf" "$WORK_DIR/"
+(cd "$WORK_DIR" && sh ./generate-certs.sh > /dev/null 2>&1) || fail "generate-certs.sh"
+
+start_server() {
+  "$BUILD_DIR/simple_quic_server" \
+    --port=$PORT \
+    --generate_dynamic_responses=true \
+    --certificate_file="$WORK_DIR/out/leaf_cert.pem" \
+    --key_file="$WORK_DIR/out/leaf_cert.pkcs8" \
+    "$@" > "$WORK_DIR/server.log" 2>&1 &
+  SERVER_PID=$!
+  sleep 1
+  kill -0 "$SERVER_PID" 2>/dev/null || fail "server did not start: $*"
+}
+
+stop_server() {
+  kill "$SERVER_PID" 2>/dev/null
+  wait "$SERVER_PID" 2>/dev/null
+  SERVER_PID=
+}
+
+client() {
+  "$BUILD_DIR/simple_quic_client" \
+    --disable_certificate_verification=true \
+    --host=$HOST --port=$PORT --quiet=true "$@" "https://www.example.org/16"
+}
+
+# Prints "<handshakes/s> <p50 us> <p99 us>".
+run_flood() {
+  local start end i pids=() latency_pid
+  client --num_requests="$NUM_REQUESTS" --disable_port_changes=true \
+    --print_request_latency=true > "$WORK_DIR/latency.log" 2>&1 &
+  latency_pid=$!
+  start=$(date +%s.%N)
+  for ((i = 0; i < CLIENTS; i++)); do
+    client --num_requests="$HANDSHAKES" --one_connection_per_request=true \
+      > "$WORK_DIR/flood.$i.log" 2>&1 &
+    pids+=($!)
+  done
+  for ((i = 0; i < CLIENTS; i++)); do
+    wait "${pids[$i]}" || return 1
+  done
+  end=$(date +%s.%N)
+  wait "$latency_pid" || return 1
+  grep "Request latency:" "$WORK_DIR/latency.log" | awk '{ print $3 }' |
+    sort -n > "$WORK_DIR/latency.sorted"
+  local count p50 p99
+  count=$(wc -l < "$WORK_DIR/latency.sorted")
+  [ "$count" -gt 0 ] || return 1
+  p50=$(sed -n "$(((count + 1) / 2))p" "$WORK_DIR/latency.sorted")
+  p99=$(sed -n "$(((count * 99 + 99) / 100))p" "$WORK_DIR/latency.sorted")
+  awk "BEGIN { printf \"%.0f %s %s\n\", $CLIENTS * $HANDSHAKES / ($end - $start), $p50, $p99 }"
+}
+
+RESULTS=
+for threads in 0 "$THREADS"; do
+  start_server --handshake_threads="$threads"
+  RESULT=$(run_flood) || fail "flood with $threads handshake threads"
+  stop_server
+  echo "PASS: $threads handshake threads: $RESULT (handshakes/s, p50 us, p99 us)"
+  RESULTS="$RESULTS$threads $RESULT\n"
+done
+
+printf "handshake_threads handshakes/s p50(us) p99(us)\n$RESULTS" | column -t
+exit 0
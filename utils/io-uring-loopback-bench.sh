@@ -0,0 +1,122 @@
+#!/bin/bash
+# Runs simple_quic_server on loopback with the poll, epoll and io_uring event
+# loops, the last one also reading and writing packets through io_uring, and
+# loads it with parallel simple_quic_client processes downloading large
+# responses. Prints, for each, the packets the server read and wrote per
+# second of server CPU time, that is per core, and the wall time.
+#
+# Every datagram on loopback is either sent or received by the server, so
+# the packets are counted from the Udp OutDatagrams of /proc/net/snmp, and the
+# CPU time from the server's /proc/<pid>/stat. Nothing else should be using
+# UDP meanwhile.
+#
+# Usage: io-uring-loopback-bench.sh <build dir>
+# Needs openssl and a build with ENABLE_IO_URING.
+
+BUILD_DIR=$(cd "${1:?usage: $0 <build dir>}" && pwd) || exit 1
+UTILS_DIR=$(cd "$(dirname "$0")" && pwd)
+
+HOST=127.0.0.1
+PORT=${PORT:-6151}
+CLIENTS=${CLIENTS:-8}
+RESPONSE_SIZE=${RESPONSE_SIZE:-10485760}
+NUM_REQUESTS=${NUM_REQUESTS:-10}
+
+WORK_DIR=$(mktemp -d)
+SERVER_PID=
+
+cleanup() {
+  [ -n "$SERVER_PID" ] && kill "$SERVER_PID" 2>/dev/null && wait "$SERVER_PID" 2>/dev/null
+  rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "FAIL: $*" >&2
+  [ -f "$WORK_DIR/server.log" ] && tail -20 "$WORK_DIR/server.log" >&2
+  exit 1
+}
+
+if ! command -v openssl > /dev/null; then
+  echo "SKIP: needs openssl"
+  exit 77
+fi
+
+# Certificates.
+cp "$UTILS_DIR/generate-certs.sh" "$UTILS_DIR/ca.cnf" "$UTILS_DIR/leaf.cnf" "$WORK_DIR/"
+(cd "$WORK_DIR" && sh ./generate-certs.sh > /dev/null 2>&1) || fail "generate-certs.sh"
+
+start_server() {
+  "$BUILD_DIR/simple_quic_server" \
+    --port=$PORT \
+    --generate_dynamic_responses=true \
+    --certificate_file="$WORK_DIR/out/leaf_cert.pem" \
+    --key_file="$WORK_DIR/out/leaf_cert.pkcs8" \
+    "$@" > "$WORK_DIR/server.log" 2>&1 &
+  SERVER_PID=$!
+  sleep 1
+  kill -0 "$SERVER_PID" 2>/dev/null || fail "server did not start: $*"
+}
+
+stop_server() {
+  kill "$SERVER_PID" 2>/dev/null
+  wait "$SERVER_PID" 2>/dev/null
+  SERVER_PID=
+}
+
+udp_out_datagrams() {
+  awk '$1 == "Udp:" && $2 ~ /^[0-9]+$/ { print $5 }' /proc/net/snmp
+}
+
+# The server's user and system time, in clock ticks.
+server_cpu_ticks() {
+  awk '{ print $14 + $15 }' "/proc/$SERVER_PID/stat"
+}
+
+# Prints "<packets/s per core> <wall seconds>".
+run_clients() {
+  local start end packets_start packets_end cpu_start cpu_end i pids=()
+  packets_start=$(udp_out_datagrams)
+  cpu_start=$(server_cpu_ticks)
+  start=$(date +%s.%N)
+  for ((i = 0; i < CLIENTS; i++)); do
+    "$BUILD_DIR/simple_quic_client" \
+      --disable_certificate_verification=true \
+      --host=$HOST --port=$PORT \
+      --num_requests="$NUM_REQUESTS" --quiet=true \
+      "https://www.example.org/$RESPONSE_SIZE" > "$WORK_DIR/client.$i.log" 2>&1 &
+    pids+=($!)
+  done
+  for ((i = 0; i < CLIENTS; i++)); do
+    wait "${pids[$i]}" || return 1
+  done
+  end=$(date +%s.%N)
+  packets_end=$(udp_out_datagrams)
+  cpu_end=$(server_cpu_ticks)
+  awk "BEGIN { cpu = ($cpu_end - $cpu_start) / $(getconf CLK_TCK);
+               if (cpu <= 0) exit 1;
+               printf \"%.0f %.2f\n\", ($packets_end - $packets_start) / cpu, $end - $start }"
+}
+
+RESULTS=
+for mode in poll epoll io_uring; do
+  case "$mode" in
+    io_uring)
+      ARGS=(--event_loop=io_uring --udp_reader=io_uring --udp_writer=io_uring) ;;
+    *)
+      ARGS=(--event_loop="$mode") ;;
+  esac
+  start_server "${ARGS[@]}"
+  if [ "$mode" = io_uring ] && grep -q "io_uring is not supported\|Unknown --udp_reader" "$WORK_DIR/server.log"; then
+    stop_server
+    echo "SKIP: io_uring: not supported by this build or kernel"
+    continue
+  fi
+  RESULT=$(run_clients) || fail "$mode"
+  stop_server
+  echo "PASS: $mode: $RESULT (packets/s per core, s)"
+  RESULTS="$RESULTS$mode $RESULT\n"
+done
+
+printf "event_loop packets/s/core wall(s)\n$RESULTS" | column -t
+exit 0
@@ -0,0 +1,106 @@
+#!/bin/bash
+# Runs simple_quic_server on loopback with --num_workers=1, 2 and 4 and loads
+# it from parallel simple_quic_client processes: one workload of short
+# connections (a handshake per request) and one of large responses. Prints
+# the wall time of each. With --bench the load is heavier.
+#
+# Usage: reuseport-load-test.sh <build dir> [--bench]
+# Needs openssl.
+
+BUILD_DIR=$(cd "${1:?usage: $0 <build dir> [--bench]}" && pwd) || exit 1
+BENCH=$2
+UTILS_DIR=$(cd "$(dirname "$0")" && pwd)
+
+HOST=127.0.0.1
+PORT=${PORT:-6131}
+CLIENTS=${CLIENTS:-4}
+HANDSHAKES=${HANDSHAKES:-10}
+RESPONSE_SIZE=${RESPONSE_SIZE:-1048576}
+NUM_REQUESTS=${NUM_REQUESTS:-5}
+if [ "$BENCH" = "--bench" ]; then
+  CLIENTS=16
+  HANDSHAKES=100
+  NUM_REQUESTS=50
+fi
+
+WORK_DIR=$(mktemp -d)
+SERVER_PID=
+
+cleanup() {
+  [ -n "$SERVER_PID" ] && kill "$SERVER_PID" 2>/dev/null && wait "$SERVER_PID" 2>/dev/null
+  rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+fail() {
+  echo "FAIL: $*" >&2
+  [ -f "$WORK_DIR/server.log" ] && tail -20 "$WORK_DIR/server.log" >&2
+  exit 1
+}
+
+if ! command -v openssl > /dev/null; then
+  echo "SKIP: needs openssl"
+  # Reported as skipped by ctest (SKIP_RETURN_CODE).
+  exit 77
+fi
+
+# Certificates.
+cp "$UTILS_DIR/generate-certs.sh" "$UTILS_DIR/ca.cnf" "$UTILS_DIR/leaf.cnf" "$WORK_DIR/"
+(cd "$WORK_DIR" && sh ./generate-certs.sh > /dev/null 2>&1) || fail "generate-certs.sh"
+
+start_server() {
+  "$BUILD_DIR/simple_quic_server" \
+    --port=$PORT \
+    --generate_dynamic_responses=true \
+    --certificate_file="$WORK_DIR/out/leaf_cert.pem" \
+    --key_file="$WORK_DIR/out/leaf_cert.pkcs8" \
+    "$@" > "$WORK_DIR/server.log" 2>&1 &
+  SERVER_PID=$!
+  sleep 1
+  kill -0 "$SERVER_PID" 2>/dev/null || fail "server did not start: $*"
+}
+
+stop_server() {
+  kill "$SERVER_PID" 2>/dev/null
+  wait "$SERVER_PID" 2>/dev/null
+  SERVER_PID=
+}
+
+# Runs CLIENTS clients in parallel, each making $1 requests for $2 bytes with
+# the remaining arguments, and prints the wall time in seconds.
+run_clients() {
+  local requests=$1 size=$2 start end i pids=()
+  shift 2
+  start=$(date +%s.%N)
+  for ((i = 0; i < CLIENTS; i++)); do
+    "$BUILD_DIR/simple_quic_client" \
+      --disable_certificate_verification=true \
+      --host=$HOST --port=$PORT \
+      --num_requests="$requests" --quiet=true \
+      "$@" "https://www.example.org/$size" > "$WORK_DIR/client.$i.log" 2>&1 &
+    pids+=($!)
+  done
+  for ((i = 0; i < CLIENTS; i++)); do
+    wait "${pids[$i]}" || return 1
+    grep -q "Request succeeded (200)" "$WORK_DIR/client.$i.log" || return 1
+  done
+  end=$(date +%s.%N)
+  awk "BEGIN { print $end - $start }"
+}
+
+RESULTS=
+for workers in 1 2 4; do
+  start_server --num_workers=$workers
+  HANDSHAKE_TIME=$(run_clients "$HANDSHAKES" 16 --one_connection_per_request=true) ||
+    fail "handshakes with $workers workers"
+  BULK_TIME=$(run_clients "$NUM_REQUESTS" "$RESPONSE_SIZE" --drop_response_body=true) ||
+    fail "large responses with $workers workers"
+  stop_server
+  echo "PASS: $workers workers, $CLIENTS clients: $((CLIENTS * HANDSHAKES)) handshakes in ${HANDSHAKE_TIME}s, $((CLIENTS * NUM_REQUESTS)) x $RESPONSE_SIZE bytes in ${BULK_TIME}s"
+  RESULTS="$RESULTS$workers $HANDSHAKE_TIME $BULK_TIME\n"
+done
+
+if [ "$BENCH" = "--bench" ]; then
+  printf "workers handshakes(s) responses(s)\n$RESULTS" | column -t
+fi
+exit 0